@@ -29,7 +29,7 @@ extern "C" {
 /* Version */
 #define MODLOADER_VERSION_MAJOR         0
 #define MODLOADER_VERSION_MINOR         3
-#define MODLOADER_VERSION_REVISION      7
+#define MODLOADER_VERSION_REVISION      8
 #ifdef NDEBUG
 #define MODLOADER_VERSION_ISDEV         0
 #else
@@ -48,6 +48,10 @@ extern "C" {
 
 /* modloader_file_t flags */
 #define MODLOADER_FF_IS_DIRECTORY   1
+
+/* modloader_rule_t flags */
+#define MODLOADER_RULE_NODIR        1   /* The rule doesn't match directories */
+#define MODLOADER_RULE_ORHASH       2   /* The file hash is or'ed into the rule behaviour value */
     
 
 /**************************************
@@ -57,6 +61,7 @@ extern "C" {
 /* Forwarding */
 struct modloader_t;
 struct modloader_plugin_t;
+struct modloader_plugin_ex_t;
 
 
 /*
@@ -92,8 +97,66 @@ typedef struct
                                         /*  (as FILETIME, 100-nanosecond intervals since January 1, 1601 UTC) */
     uint64_t            behaviour;      /* The file behaviour */
 
+    /*
+     * Since 0.3.8, the same positions as above in 16 bits, the ones above are only right for paths up to 255 bytes.
+     * Plugins built before 0.3.8 aren't sent files with longer paths.
+     */
+    uint16_t            wpos_eos;
+    uint16_t            wpos_filedir;
+    uint16_t            wpos_filename;
+    uint16_t            wpos_filext;
+
 } modloader_file_t;
 
+#ifdef __cplusplus
+/* The layout up to 'behaviour' is the one of 0.3.7, plugins built against it still read the fields they know */
+static_assert(sizeof(void*) != 4 || offsetof(modloader_file_t, pos_eos) == 8,    "modloader_file_t layout changed");
+static_assert(sizeof(void*) != 4 || offsetof(modloader_file_t, hash) == 12,      "modloader_file_t layout changed");
+static_assert(sizeof(void*) != 4 || offsetof(modloader_file_t, parent) == 20,    "modloader_file_t layout changed");
+static_assert(sizeof(void*) != 4 || offsetof(modloader_file_t, behaviour) == 40, "modloader_file_t layout changed");
+static_assert(offsetof(modloader_file_t, wpos_eos) >= offsetof(modloader_file_t, behaviour) + sizeof(uint64_t), "modloader_file_t layout changed");
+#endif
+
+
+/*
+ * modloader_rule_t
+ *      A declarative behaviour rule, lets Mod Loader find the behaviour of a file without calling the plugin GetBehaviour.
+ *      All the conditions present in the rule must match the file (a zero hash or null string means no condition).
+ *      Strings are case insensitive.
+ */
+typedef struct
+{
+    uint32_t            hash;           /* Filename hash (as in "modloader/util/hash.hpp" of the lower case filename) */
+    uint32_t            flags;          /* MODLOADER_RULE_* flags */
+    const char*         extension;      /* File extension, without the dot ("" matches files without extension) */
+    const char*         folder;         /* Name of the folder the file is right inside */
+    const char*         glob;           /* Wildcard to match against the path relative to the mod folder, try to avoid it */
+    int                 result;         /* MODLOADER_BEHAVIOUR_YES or MODLOADER_BEHAVIOUR_CALLME */
+    uint64_t            behaviour;      /* The behaviour given to the file */
+
+} modloader_rule_t;
+
+
+/*
+ * modloader_batch_t
+ *      A set of files to be installed, reinstalled and uninstalled at once by a plugin (see BatchFiles).
+ *      The results are set by the plugin for each file, 0 on success and 1 on failure (as in InstallFile and friends),
+ *      Mod Loader initializes all of them to 1 before the call.
+ */
+typedef struct
+{
+    const modloader_file_t* const*  uninstall;          /* Files to uninstall, previosly installed */
+    const modloader_file_t* const*  reinstall;          /* Files to reinstall, previosly installed but updated */
+    const modloader_file_t* const*  install;            /* Files to install */
+    int*                            uninstall_result;   /* Result for each file at uninstall */
+    int*                            reinstall_result;   /* Result for each file at reinstall */
+    int*                            install_result;     /* Result for each file at install */
+    size_t                          uninstall_len;      /* Length of the uninstall and uninstall_result arrays */
+    size_t                          reinstall_len;      /* Length of the reinstall and reinstall_result arrays */
+    size_t                          install_len;        /* Length of the install and install_result arrays */
+
+} modloader_batch_t;
+
 
 
 
@@ -202,6 +265,12 @@ typedef void (*modloader_fGetLoaderVersion)(uint8_t* major, uint8_t* minor, uint
 */
 typedef void (*modloader_fGetPluginData)(modloader_plugin_t* data);
 
+/*
+        You may export this function, it's called after 'GetPluginData' to fill the extended plugin data at 'ex'.
+        'ex->size' is set to the size of the structure known by Mod Loader, do not write fields past it.
+*/
+typedef void (*modloader_fGetPluginDataEx)(modloader_plugin_t* data, struct modloader_plugin_ex_t* ex);
+
 /*
  *  GetVersion
  *      Get plugin version string (e.g. "1.4")
@@ -282,6 +351,18 @@ typedef int (*modloader_fUninstallFile)(modloader_plugin_t* data, const modloade
 typedef void (*modloader_fUpdate)(modloader_plugin_t* data);
 
 
+/*
+ * BatchFiles
+ *      Called instead of UninstallFile, ReinstallFile and InstallFile with all the files of a step of the update at once.
+ *      Apply the uninstalls first, then the reinstalls, then the installs, each in the order of their arrays.
+ *      A update may call this more than once (the displaced files get uninstalled before the files displacing them are installed),
+ *      and Update still gets called after it.
+ *      @data: The plugin data
+ *      @batch: The files, the plugin shall set the results on it
+ */
+typedef void (*modloader_fBatchFiles)(modloader_plugin_t* data, modloader_batch_t* batch);
+
+
 
 
 /* ---- Interface ---- Should be compatible with all versions of modloader.asi */
@@ -325,6 +406,32 @@ typedef struct modloader_plugin_t
 } modloader_plugin_t;
 
 
+/* ---- Extended Interface ---- Filled by the optional GetPluginDataEx */
+typedef struct modloader_plugin_ex_t
+{
+    uint32_t size;                      /* Size of this structure, set by Mod Loader */
+
+    /*
+     * Behaviour rules, Mod Loader compiles the rules of all plugins and uses them to find the behaviour of files.
+     * When a file matches more than one rule of a plugin the first one in the table is used.
+     * If 'rules_only' is non-zero, files matching no rule are taken as MODLOADER_BEHAVIOUR_NO without calling GetBehaviour.
+     */
+    const modloader_rule_t* rules;      /* Can be null if rules_len is equal to zero */
+    size_t rules_len;                   /* The length of the rules table */
+    uint32_t rules_only;
+
+    /*
+     * Batch callback, if set Mod Loader sends the files to this instead of the per file callbacks.
+     * The per file callbacks must still be set, they are used when a single file needs to be handled.
+     */
+    modloader_fBatchFiles BatchFiles;
+
+} modloader_plugin_ex_t;
+
+/* Checks if the field 'f' of the modloader_plugin_ex_t at 'ex' is known by Mod Loader */
+#define MODLOADER_EX_HAS(ex, f)  ((ex)->size >= offsetof(modloader_plugin_ex_t, f) + sizeof((ex)->f))
+
+
 
 
 
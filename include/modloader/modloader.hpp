@@ -56,16 +56,16 @@ namespace modloader
 
         // Gets the filebuffer that stores the underlying path
         const char* filebuffer(size_t idx = 0) const    { return &buffer[idx];      }
-        size_t filebuffer_len() const                   { return (size_t)(pos_eos); }
+        size_t filebuffer_len() const                   { return (size_t)(wpos_eos); }
 
         // Gets the filepath relative to the game dir
         const char* filepath() const  { return filebuffer(0);             }
         // Gets the filepath relative to the mod folder
-        const char* filedir() const   { return filebuffer(pos_filedir);  }
+        const char* filedir() const   { return filebuffer(wpos_filedir);  }
         // Gets the filename
-        const char* filename() const  { return filebuffer(pos_filename);  }
+        const char* filename() const  { return filebuffer(wpos_filename);  }
         // Gets the file extension
-        const char* filext() const    { return filebuffer(pos_filext);    }
+        const char* filext() const    { return filebuffer(wpos_filext);    }
         
         // Checks if this file changed compared to 'c'
         // Checks only for file size and file time, returns false for directories
@@ -111,6 +111,9 @@ namespace modloader
                 const char*  author;            // Plugin author
                 int          default_priority;  // Plugin default priority (or -1 for mod loader default)
                 const char** extable;           // Extension table of possible files this plugin can handle, to speed up lookup
+                const modloader_rule_t* rules;  // Behaviour rules table (ended by a rule with a zero result), may be null
+                bool         rules_only;        // Files matching no rule in the table aren't handled by this plugin
+                bool         batch;             // Files are sent to BatchFiles instead of the per file methods
             };
         
         public:
@@ -133,6 +136,18 @@ namespace modloader
             virtual bool ReinstallFile(const file&)=0;      // Reinstalls a file previosly installed
             virtual bool UninstallFile(const file&)=0;      // Uninstalls a file previosly installed
             virtual void Update() {}                        // Updates the state of the plugin after a serie of install/uninstall/reinstall
+
+            // Uninstalls, reinstalls and installs many files at once (only called if info::batch is set)
+            // The default implementation goes through the per file methods
+            virtual void BatchFiles(modloader_batch_t& batch)
+            {
+                for(size_t i = 0; i < batch.uninstall_len; ++i)
+                    batch.uninstall_result[i] = !UninstallFile(static_cast<const file&>(*batch.uninstall[i]));
+                for(size_t i = 0; i < batch.reinstall_len; ++i)
+                    batch.reinstall_result[i] = !ReinstallFile(static_cast<const file&>(*batch.reinstall[i]));
+                for(size_t i = 0; i < batch.install_len; ++i)
+                    batch.install_result[i] = !InstallFile(static_cast<const file&>(*batch.install[i]));
+            }
     };
     
 
@@ -194,6 +209,11 @@ namespace modloader
             return GetThis(data).Update();
         }
 
+        static void BatchFiles(modloader_plugin_t* data, modloader_batch_t* batch)
+        {
+            return GetThis(data).BatchFiles(*batch);
+        }
+
         // Attaches the 'interface' using the plugin 'data'
         static void RegisterPluginData(basic_plugin& interfc, modloader_plugin_t* data)
         {
@@ -239,6 +259,29 @@ namespace modloader
             interfc.Log     = interfc.loader->Log;
             interfc.vLog    = interfc.loader->vLog;
         }
+
+        // Fills the extended 'ex' data using the plugin 'interface'
+        static void RegisterPluginDataEx(basic_plugin& interfc, modloader_plugin_ex_t* ex)
+        {
+            // Get Behaviour Rules Table
+            if(MODLOADER_EX_HAS(ex, rules_only))
+            {
+                ex->rules = interfc.GetInfo().rules;
+                if(ex->rules)
+                {
+                    ex->rules_len = 0;
+                    for(const modloader_rule_t* rule = ex->rules; rule->result; ++rule)
+                        ++ex->rules_len;
+                    ex->rules_only = interfc.GetInfo().rules_only;
+                }
+            }
+
+            // Batch Callback
+            if(MODLOADER_EX_HAS(ex, BatchFiles) && interfc.GetInfo().batch)
+            {
+                ex->BatchFiles = &basic_plugin_wrapper::BatchFiles;
+            }
+        }
     };
 
     /*
@@ -275,6 +318,10 @@ namespace modloader
             {\
                 if(plugin_ptr) basic_plugin_wrapper::RegisterPluginData(*plugin_ptr, data);\
             }\
+            extern "C" __declspec(dllexport) void GetPluginDataEx(modloader_plugin_t* data, modloader_plugin_ex_t* ex)\
+            {\
+                if(plugin_ptr) basic_plugin_wrapper::RegisterPluginDataEx(*plugin_ptr, ex);\
+            }\
             extern "C" __declspec(dllexport) void GetLoaderVersion(uint8_t* major, uint8_t* minor, uint8_t* revision)\
             {\
                 *major = MODLOADER_VERSION_MAJOR;\
@@ -17,9 +17,12 @@
 #define	MODLOADER_UTIL_DETOUR_HPP
 #pragma once
 #include <string>
+#include <cstring>
 #include <modloader/modloader.hpp>
 #include <modloader/util/injector.hpp>
 #include <modloader/util/path.hpp>
+#include <modloader/util/hash.hpp>
+#include <modloader/util/detour_cache.hpp>
 #include <tuple>
 
 namespace modloader
@@ -149,16 +152,15 @@ namespace modloader
             std::function<std::string(std::string)> postransform;
             std::shared_ptr<printer_t> printer;
 
-            // The detoured function goes to here
-            Ret hook(func_type fun, Args&... args)
-            {
-                static const auto  pos  = Traits::arg - 1;
-                static const char* what = Traits::what();
+            // Cache of resolved paths, only used while 'use_cache' is true.
+            // Detours with transform functors don't use it by default, since the functors may depend on state unknown to us.
+            file_detour_cache cache;
+            bool use_cache = true;
 
-                auto& arg = std::get<pos>(std::forward_as_tuple(args...));
-                char fullpath[MAX_PATH];
-                const char* lpath = nullptr;
-                
+            // Resolves the file to load in place of @arg, outputting its absolute path into @fullpath (of MAX_PATH chars)
+            // Returns the path to print or null if the file isn't overriden
+            const char* resolve(const char* arg, char* fullpath)
+            {
                 auto& path = this->temp;
                 path.assign(this->path);
 
@@ -178,14 +180,41 @@ namespace modloader
                         else
                             strcpy(fullpath, path.c_str());
 
-                        // Make sure the file exists, if it does, change the parameter
+                        // Make sure the file exists
                         if(GetFileAttributesA(fullpath) != INVALID_FILE_ATTRIBUTES)
-                        {
-                            arg = fullpath;
-                            lpath = path.c_str();
-                        }
+                            return path.c_str();
+                    }
+                }
+                return nullptr;
+            }
+
+            // The detoured function goes to here
+            Ret hook(func_type fun, Args&... args)
+            {
+                static const auto  pos  = Traits::arg - 1;
+                static const char* what = Traits::what();
+
+                auto& arg = std::get<pos>(std::forward_as_tuple(args...));
+                char fullpath[MAX_PATH];
+                const char* lpath = nullptr;
+
+                if(this->use_cache && arg != nullptr)
+                {
+                    // The paths are copied out of the cache, which may be invalidated before the function is done with them
+                    if(this->cache.resolve_into<MAX_PATH>(arg, fullpath, this->temp, [this](const char* filename, char* fullpath)
+                    {
+                        return this->resolve(filename, fullpath);
+                    }))
+                    {
+                        arg   = fullpath;   // change the parameter
+                        lpath = this->temp.c_str();
                     }
                 }
+                else
+                {
+                    lpath = this->resolve(arg, fullpath);
+                    if(lpath) arg = fullpath;   // change the parameter
+                }
 
                 // Set ups the printer to print the next loading file
                 if(printer && !printer->print_next) // avoid double setuping
@@ -208,7 +237,8 @@ namespace modloader
             basic_file_detour(basic_file_detour&& rhs)
                 : MyHooker(std::move(rhs)), path(std::move(rhs.path)),
                 transform(std::move(rhs.transform)), postransform(rhs.postransform),
-                printer(rhs.printer)    // (dont move the printer)
+                printer(rhs.printer),    // (dont move the printer)
+                use_cache(rhs.use_cache)
             {}
             basic_file_detour& operator=(const basic_file_detour& rhs) = delete;
             basic_file_detour& operator=(basic_file_detour&& rhs)
@@ -218,6 +248,8 @@ namespace modloader
                 this->transform = std::move(rhs.transform);
                 this->postransform = std::move(rhs.postransform);
                 this->printer = rhs.printer; // (dont move the printer)
+                this->use_cache = rhs.use_cache;
+                this->cache.invalidate();
                 return *this;
             }
 
@@ -257,6 +289,28 @@ namespace modloader
             {
                 this->make_call();
                 this->path = std::move(path);
+                this->cache.invalidate();
+            }
+
+            // Enables or disables the resolved path cache
+            // Only enable it for detours with transform functors if the functors always give the same result for the same argument
+            // until the next invalidation.
+            void EnableCache(bool enable = true)
+            {
+                this->use_cache = enable;
+                this->cache.invalidate();
+            }
+
+            // Forgets the resolved paths (the file overrider does this on install, reinstall and uninstall)
+            void InvalidateCache()
+            {
+                this->cache.invalidate();
+            }
+
+            // Gets the resolved path cache, for its hit/miss counters
+            const file_detour_cache& GetCache() const
+            {
+                return this->cache;
             }
 
             
@@ -267,11 +321,13 @@ namespace modloader
             void OnTransform(std::function<std::string(std::string)> functor)
             {
                 this->transform = std::move(functor);
+                this->EnableCache(false);
             }
 
             void OnPosTransform(std::function<std::string(std::string)> functor)
             {
                 this->postransform = std::move(functor);
+                this->EnableCache(false);
             }
     };
 
@@ -299,6 +355,7 @@ namespace modloader
             std::function<void(const modloader::file*)> mOnChange;      // Called when the file changes
             std::function<void(const modloader::file*)> mInstallHook;   // Install (or reinstall, or uninstall if file is null) hook for file
             std::function<void()>                       mReload;        // Reload the file on the game
+            std::function<void()>                       mInvalidate;    // Invalidates the resolved paths cached by the detours
 
         public:
             file_overrider() = default;                 
@@ -385,6 +442,11 @@ namespace modloader
                 {
                     Hlp_SetFile<tuple_type>(std::integral_constant<size_t, 0>(), f);
                 });
+
+                this->mInvalidate = [this]
+                {
+                    Hlp_InvalidateCache<tuple_type>(std::integral_constant<size_t, 0>());
+                };
             }
 
             template<class ...Args> void SetFileDetour(Args&&... args)
@@ -461,6 +523,13 @@ namespace modloader
                 this->SetFileDetourTuple(detours);
             }
 
+            // Forgets the paths cached by the detours, for when the state their transform functors depend on changes
+            // (done automatically on install, reinstall and uninstall)
+            void InvalidateCache()
+            {
+                if(mInvalidate) mInvalidate();
+            }
+
             // Installs the necessary hooking to load the specified file
             // (done automatically but you can call it manually if you want to always have the hook in place)
             void InstallHook()
@@ -473,6 +542,7 @@ namespace modloader
             bool PerformInstall(const modloader::file* file)
             {
                 this->file = file;
+                this->InvalidateCache();        // the file on disk may have changed even if its path didn't
                 if(mOnChange) mOnChange(this->file);
                 InstallHook(); TryReload();
                 return true;
@@ -512,6 +582,19 @@ namespace modloader
                 return Hlp_SetFile<Tuple>(std::integral_constant<size_t, I+1>(), f); 
             }
 
+            template<class Tuple>
+            void Hlp_InvalidateCache(std::integral_constant<size_t, std::tuple_size<Tuple>::value>)
+            {}
+
+            template<class Tuple, size_t I>
+            void Hlp_InvalidateCache(std::integral_constant<size_t, I>)
+            {
+                using T = std::decay_t<typename std::tuple_element<I, Tuple>::type>;
+                T& detourer = static_cast<T&>(GetInjection(I));
+                detourer.InvalidateCache();
+                return Hlp_InvalidateCache<Tuple>(std::integral_constant<size_t, I+1>()); 
+            }
+
             template<class Tuple>
             void Hlp_MakeCall(std::integral_constant<size_t, std::tuple_size<Tuple>::value>)
             {}
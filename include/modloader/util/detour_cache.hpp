@@ -0,0 +1,116 @@
+/*
+ * Mod Loader Utilities Headers
+ * Created by LINK/2012 <dma_2012@hotmail.com>
+ *
+ *  This file provides helpful functions for plugins creators.
+ *
+ *  This source code is offered for use in the public domain. You may
+ *  use, modify or distribute it freely.
+ *
+ *  This code is distributed in the hope that it will be useful but
+ *  WITHOUT ANY WARRANTY. ALL WARRANTIES, EXPRESS OR IMPLIED ARE HEREBY
+ *  DISCLAIMED. This includes but is not limited to warranties of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ */
+#ifndef MODLOADER_UTIL_DETOUR_CACHE_HPP
+#define	MODLOADER_UTIL_DETOUR_CACHE_HPP
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <modloader/util/hash.hpp>
+
+namespace modloader
+{
+    /*
+     *  File detour cache
+     *      Remembers the resolved path (or the lack of an override) for each argument sent to a file detour,
+     *      so repeated loads of the same file don't need to transform the path and probe the filesystem again.
+     *      The entries must be invalidated whenever the state used to resolve them changes.
+     */
+    class file_detour_cache
+    {
+        public:
+            struct entry
+            {
+                std::string arg;        // The original argument
+                std::string fullpath;   // The absolute path to load instead (empty if not overriden)
+                std::string lpath;      // The path to print
+
+                bool overriden() const { return !fullpath.empty(); }
+            };
+
+            // Finds the entry for the argument @arg, returns null on a miss
+            const entry* find(const char* arg)
+            {
+                auto it = entries.find(modloader::hash(arg));
+                if(it != entries.end() && it->second.arg == arg)
+                {
+                    ++this->hits;
+                    return &it->second;
+                }
+                ++this->misses;
+                return nullptr;
+            }
+
+            // Stores the result of resolving the argument @arg, @fullpath and @lpath should be null if not overriden
+            const entry& store(const char* arg, const char* fullpath, const char* lpath)
+            {
+                auto& e = entries[modloader::hash(arg)];   // on a hash collision the older entry is replaced
+                e.arg.assign(arg);
+                e.fullpath.assign(fullpath? fullpath : "");
+                e.lpath.assign(lpath? lpath : "");
+                return e;
+            }
+
+            // Finds the entry for the argument @arg, resolving it on a miss with @resolver
+            // The resolver is called as 'const char* resolver(const char* arg, char* fullpath)', it outputs the absolute path into
+            // its fullpath buffer (of MaxPath chars) and returns the path to print, or null if the file isn't overriden.
+            template<size_t MaxPath, class Resolver>
+            const entry& resolve(const char* arg, Resolver resolver)
+            {
+                if(auto e = this->find(arg))
+                    return *e;
+
+                char fullpath[MaxPath];
+                const char* lpath = resolver(arg, fullpath);
+                return this->store(arg, lpath? fullpath : nullptr, lpath);
+            }
+
+            // Resolves the argument @arg as resolve does, but copies the absolute path into @fullpath (of MaxPath chars) and the
+            // path to print into @lpath, so they outlive an invalidation happening while the caller still uses them.
+            // Returns false if the file isn't overriden, leaving @fullpath and @lpath untouched.
+            template<size_t MaxPath, class Resolver>
+            bool resolve_into(const char* arg, char* fullpath, std::string& lpath, Resolver resolver)
+            {
+                auto& e = this->resolve<MaxPath>(arg, std::move(resolver));
+                if(!e.overriden())
+                    return false;
+
+                size_t len = (std::min)(e.fullpath.size(), MaxPath - 1);
+                memcpy(fullpath, e.fullpath.data(), len);
+                fullpath[len] = 0;
+                lpath.assign(e.lpath);
+                return true;
+            }
+
+            // Drops all entries
+            void invalidate()
+            {
+                entries.clear();
+            }
+
+            size_t size() const         { return entries.size(); }
+            uint32_t num_hits() const   { return hits; }
+            uint32_t num_misses() const { return misses; }
+
+        private:
+            std::unordered_map<size_t, entry> entries;
+            uint32_t hits = 0, misses = 0;
+    };
+}
+
+#endif
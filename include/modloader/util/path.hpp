@@ -22,11 +22,11 @@
 #include <windows.h>
 #include <modloader/modloader.hpp>
 #include <modloader/util/container.hpp>
+#include <modloader/util/path_string.hpp>
 
 namespace modloader
 {
     static const char* szNullFile = "NUL";          // "/dev/null" on POSIX systems
-    static const char cNormalizedSlash = '\\';      // The slash used in the normalized path
     
     // Information output by FilesWalk function
     struct FileWalkInfo
@@ -50,13 +50,6 @@ namespace modloader
         bool            recursive;
     };
     
-    // Gets all possible path separators in a null terminated string
-    template<class T> inline const T* GetPathSeparators()
-    {
-        static const T slash[] = { '/', '\\', 0 };
-        return slash;
-    }
-    
     // Gets a LONGLONG from a LARGEINTEGER
     inline LONGLONG GetLongFromLargeInteger(DWORD LowPart, DWORD HighPart)
     {
@@ -67,168 +60,6 @@ namespace modloader
     }
     
     
-    /*
-     *  IsAbsolutePath
-     *      Checks whether the path is absolute (e.g. C:/something/...)
-     */
-    inline bool IsAbsolutePath(const char* path)
-    {
-        char c = path[0];
-        if(c == '\\' || c == '/')
-            return true;
-        else if((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'))
-            return path[1] == ':' && (path[2] == '\\' || path[2] == '/');
-        return false;
-    }
-    inline bool IsAbsolutePath(const std::string& str)
-    { return IsAbsolutePath(str.c_str()); }
-
-
-    /*
-     *  MakeSureStringIsDirectory
-     *      Makes sure the string @dir is a directory path. If @touchEmpty is true,
-     *      dir will be made a directory even when the string is empty.
-     * 
-     *      A string is considered as a path when it ends with a slash
-     */
-    inline std::string& MakeSureStringIsDirectory(std::string& dir, bool touchEmpty = true)
-    {
-        if(dir.empty())
-        {
-            if(touchEmpty) dir = ".\\";
-        }
-        else if(dir.back() != cNormalizedSlash)
-        {
-            dir.push_back(cNormalizedSlash);
-        }
-        return dir;
-    }
-    
-    
-    /*
-     *  NormalizePath
-     *      Normalizates a path string, so for example:
-     *          "somefolder/something" will output "somefolder\\something"
-     *          "SOMEfoldER/something/" will output "somefolder\\something"
-     *          "somefolder\\something" will output "somefolder\\something"
-     *          etc
-     */
-    inline std::string NormalizePath(std::string path)
-    {
-        if(path.size())
-        {
-            std::replace(path.begin(), path.end(), '/', '\\');  // Replace all '/' with '\\'
-            tolower(path);                                      // tolower the strings (Windows paths are case insensitive)
-            while(path.back() == '/' || path.back() == '\\')    // We don't want a slash at the end of the folder path
-                path.pop_back();                                // ..
-            trim(path);                                         // Trim the string...
-        }
-        return path;
-    }
-    
-    /*
-     *  GetProperlyPath
-     *      This works exactly the same as NormalizePath (see above), except if @transform is not a null pointer
-     *      It will return the first time that @transform (probably a folder)  appears in the normalized path
-     * 
-     *      PS: @transform MUST be normalized!
-     */
-    inline std::string GetProperlyPath(std::string path, const char* transform)
-    {
-        path = NormalizePath(std::move(path));
-        if(transform)
-        {
-            size_t pos = path.find(transform);
-            if(pos != 0 && pos != path.npos) path.erase(0, pos);
-        }
-        return path;
-    }
-    
-
-    
-    /*
-     *  GetLastPathComponent
-     *      @path: Path to get the last component from
-     *      @return: Returns the last path component position in the string
-     */
-    template<class T>
-    inline size_t GetLastPathComponent(std::basic_string<T> path, size_t count = 1)
-    {
-        size_t pos = path.npos;
-        size_t x = path.npos;
-        
-        if(path.size())
-        {
-            // Remove any slash at the end of the string, so our finding can be safe
-            while(path.back() == '/' || path.back() == '\\') path.pop_back();
-        
-            // Do the search
-            for(size_t i = 0; i < count; ++i)
-            {
-                pos = path.find_last_of(GetPathSeparators<T>(), x);
-                x = pos - 1;
-                if(pos == 0 || pos == path.npos) break;
-            }
-        }
-
-        return (pos == path.npos? 0 : pos + 1);
-    }
-
-    template<class T>
-    inline std::basic_string<T> GetFileExtension(std::basic_string<T> filename)
-    {
-        auto extn = filename.rfind('.');
-        if(extn != filename.npos) 
-        {
-            ++extn;
-            return filename.substr(extn, filename.size() - extn);
-        }
-        return "";
-    }
-
-    template<class T>
-    inline std::basic_string<T> GetPathComponentBack(std::basic_string<T> path, size_t count = 1)
-    {
-        auto pos = GetLastPathComponent(path, count);
-        auto end = path.find_first_of(GetPathSeparators<T>(), pos);
-        auto len = end == path.npos? path.npos : end - pos;
-        return path.substr(pos, len);
-    }
-
-    template<class T>
-    inline std::basic_string<T> GetPathExtensionBack(std::basic_string<T> path, size_t count = 1)
-    {
-        auto comp = GetPathComponentBack(path, count);
-        return GetFileExtension(std::move(path));
-    }
-    
-    
-    /*
-     *      Checks if a file is inside an named folder, or just inside it
-     *      @file File path to check
-     *      @bJust  Returns true only if just right inside the folder
-     *      @folder Folder path
-     *
-     */
-    inline bool IsFileInsideFolder(std::string file, bool bJust, std::string folder)
-    {
-        file = NormalizePath(file);
-        folder= NormalizePath(folder);
-        
-        int numFolds = std::count(file.begin(), file.end(), cNormalizedSlash);
-
-        for(int i = 1; i <= numFolds; ++i)
-        {
-            if(GetPathComponentBack(file, i+1) == folder)
-                return true;
-            else if(bJust)
-                break;
-        }
-        
-        return false;
-    }
-
-    
     /*
      * FilesWalk
      *      Iterates on all files in a directory, files beggining with '.' will be ignored.
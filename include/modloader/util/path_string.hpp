@@ -0,0 +1,387 @@
+/*
+ * Mod Loader Utilities Headers
+ * Created by LINK/2012 <dma_2012@hotmail.com>
+ *
+ *  This file provides helpful functions for plugins creators.
+ *
+ *  This source code is offered for use in the public domain. You may
+ *  use, modify or distribute it freely.
+ *
+ *  This code is distributed in the hope that it will be useful but
+ *  WITHOUT ANY WARRANTY. ALL WARRANTIES, EXPRESS OR IMPLIED ARE HEREBY
+ *  DISCLAIMED. This includes but is not limited to warranties of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ */
+#ifndef MODLOADER_UTIL_PATH_STRING_HPP
+#define	MODLOADER_UTIL_PATH_STRING_HPP
+
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <modloader/util/container.hpp>
+
+/*
+ *  Manipulation of path strings, nothing in here touches the filesystem (see path.hpp for that)
+ */
+namespace modloader
+{
+    static const char cNormalizedSlash = '\\';      // The slash used in the normalized path
+
+    // Gets all possible path separators in a null terminated string
+    template<class T> inline const T* GetPathSeparators()
+    {
+        static const T slash[] = { '/', '\\', 0 };
+        return slash;
+    }
+    
+    /*
+     *  IsAbsolutePath
+     *      Checks whether the path is absolute (e.g. C:/something/...)
+     */
+    inline bool IsAbsolutePath(const char* path)
+    {
+        char c = path[0];
+        if(c == '\\' || c == '/')
+            return true;
+        else if((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'))
+            return path[1] == ':' && (path[2] == '\\' || path[2] == '/');
+        return false;
+    }
+    inline bool IsAbsolutePath(const std::string& str)
+    { return IsAbsolutePath(str.c_str()); }
+
+
+    /*
+     *  MakeSureStringIsDirectory
+     *      Makes sure the string @dir is a directory path. If @touchEmpty is true,
+     *      dir will be made a directory even when the string is empty.
+     * 
+     *      A string is considered as a path when it ends with a slash
+     */
+    inline std::string& MakeSureStringIsDirectory(std::string& dir, bool touchEmpty = true)
+    {
+        if(dir.empty())
+        {
+            if(touchEmpty) dir = ".\\";
+        }
+        else if(dir.back() != cNormalizedSlash)
+        {
+            dir.push_back(cNormalizedSlash);
+        }
+        return dir;
+    }
+    
+    
+    /*
+     *  NormalizePath
+     *      Normalizates a path string, so for example:
+     *          "somefolder/something" will output "somefolder\\something"
+     *          "SOMEfoldER/something/" will output "somefolder\\something"
+     *          "somefolder\\something" will output "somefolder\\something"
+     *          etc
+     */
+    inline std::string NormalizePath(std::string path)
+    {
+        if(path.size())
+        {
+            std::replace(path.begin(), path.end(), '/', '\\');  // Replace all '/' with '\\'
+            tolower(path);                                      // tolower the strings (Windows paths are case insensitive)
+            while(path.size() && (path.back() == '/' || path.back() == '\\'))  // We don't want a slash at the end of the folder path
+                path.pop_back();                                                // ..
+            trim(path);                                         // Trim the string...
+        }
+        return path;
+    }
+    
+    /*
+     *  GetProperlyPath
+     *      This works exactly the same as NormalizePath (see above), except if @transform is not a null pointer
+     *      It will return the first time that @transform (probably a folder)  appears in the normalized path
+     * 
+     *      PS: @transform MUST be normalized!
+     */
+    inline std::string GetProperlyPath(std::string path, const char* transform)
+    {
+        path = NormalizePath(std::move(path));
+        if(transform)
+        {
+            size_t pos = path.find(transform);
+            if(pos != 0 && pos != path.npos) path.erase(0, pos);
+        }
+        return path;
+    }
+    
+
+    
+    /*
+     *  GetLastPathComponent
+     *      @path: Path to get the last component from
+     *      @return: Returns the last path component position in the string
+     */
+    template<class T>
+    inline size_t GetLastPathComponent(std::basic_string<T> path, size_t count = 1)
+    {
+        size_t pos = path.npos;
+        size_t x = path.npos;
+        
+        if(path.size())
+        {
+            // Remove any slash at the end of the string, so our finding can be safe
+            while(path.size() && (path.back() == '/' || path.back() == '\\')) path.pop_back();
+        
+            // Do the search
+            for(size_t i = 0; i < count; ++i)
+            {
+                pos = path.find_last_of(GetPathSeparators<T>(), x);
+                x = pos - 1;
+                if(pos == 0 || pos == path.npos) break;
+            }
+        }
+
+        return (pos == path.npos? 0 : pos + 1);
+    }
+
+    template<class T>
+    inline std::basic_string<T> GetFileExtension(std::basic_string<T> filename)
+    {
+        auto extn = filename.rfind('.');
+        if(extn != filename.npos) 
+        {
+            ++extn;
+            return filename.substr(extn, filename.size() - extn);
+        }
+        return "";
+    }
+
+    template<class T>
+    inline std::basic_string<T> GetPathComponentBack(std::basic_string<T> path, size_t count = 1)
+    {
+        auto pos = GetLastPathComponent(path, count);
+        auto end = path.find_first_of(GetPathSeparators<T>(), pos);
+        auto len = end == path.npos? path.npos : end - pos;
+        return path.substr(pos, len);
+    }
+
+    template<class T>
+    inline std::basic_string<T> GetPathExtensionBack(std::basic_string<T> path, size_t count = 1)
+    {
+        auto comp = GetPathComponentBack(path, count);
+        return GetFileExtension(std::move(path));
+    }
+    
+    
+    /*
+     *  path_view
+     *      A non-owning view over a path string (pointer and length), used by the allocation-free path functions below.
+     *      Those work on the caller strings and stack buffers instead of returning new strings.
+     */
+    struct path_view
+    {
+        static const size_t npos = size_t(-1);
+
+        const char* data;
+        size_t      size;
+
+        path_view() : data(""), size(0)                                 {}
+        path_view(const char* str) : data(str), size(strlen(str))       {}
+        path_view(const char* str, size_t len) : data(str), size(len)   {}
+        path_view(const std::string& str) : data(str.data()), size(str.size()) {}
+
+        const char* begin() const   { return data; }
+        const char* end() const     { return data + size; }
+        bool empty() const          { return size == 0; }
+        char front() const          { return data[0]; }
+        char back() const           { return data[size - 1]; }
+        char operator[](size_t i) const { return data[i]; }
+
+        // Gets the view of @len characters starting at @pos
+        path_view substr(size_t pos, size_t len = npos) const
+        {
+            if(pos > size) pos = size;
+            return path_view(data + pos, (std::min)(len, size - pos));
+        }
+
+        // Makes a string out of this view
+        std::string str() const     { return std::string(data, size); }
+    };
+
+    // Checks if @c is a path separator
+    inline bool IsPathSeparator(char c)
+    {
+        return c == '/' || c == '\\';
+    }
+
+    // Checks if two path characters are the same after normalization
+    inline bool IsSamePathChar(char a, char b)
+    {
+        return a == b || (IsPathSeparator(a) && IsPathSeparator(b)) || ::tolower(a) == ::tolower(b);
+    }
+
+    /*
+     *  TrimPathView
+     *      Removes from @path the trailing slashes, the UTF-8 BOM and the surrounding spaces, the same way NormalizePath does
+     */
+    inline path_view TrimPathView(path_view path)
+    {
+        auto isspace = [](char c) { return (c == 0x20) || (c >= 0x09 && c <= 0x0D); };
+
+        while(path.size && IsPathSeparator(path.back()))    // NormalizePath removes the slashes before trimming
+            --path.size;
+        while(path.size >= 3 && path[0] == (char)(0xEF) && path[1] == (char)(0xBB) && path[2] == (char)(0xBF))
+            path.data += 3, path.size -= 3;
+        while(path.size && isspace(path.front()))
+            ++path.data, --path.size;
+        while(path.size && isspace(path.back()))
+            --path.size;
+        return path;
+    }
+
+    /*
+     *  NormalizePathInPlace
+     *      Same as NormalizePath but normalizes the @len characters at @path in place, returns the new length.
+     *      The result is null terminated if it got shorter than @len.
+     */
+    inline size_t NormalizePathInPlace(char* path, size_t len)
+    {
+        path_view view = TrimPathView(path_view(path, len));
+        if(view.data != path) memmove(path, view.data, view.size);
+        for(size_t i = 0; i < view.size; ++i)
+            path[i] = (path[i] == '/'? cNormalizedSlash : (char) ::tolower(path[i]));
+        if(view.size < len) path[view.size] = 0;
+        return view.size;
+    }
+
+    inline size_t NormalizePathInPlace(char* path)
+    { return NormalizePathInPlace(path, strlen(path)); }
+
+    /*
+     *  NormalizePath
+     *      Same as NormalizePath above but outputs the normalized (and null terminated) @path into @buf, which has @bufsize bytes.
+     *      Returns the length of the output or path_view::npos if it doesn't fit in the buffer.
+     */
+    inline size_t NormalizePath(path_view path, char* buf, size_t bufsize)
+    {
+        path = TrimPathView(path);
+        if(path.size >= bufsize)
+            return path_view::npos;
+        for(size_t i = 0; i < path.size; ++i)
+            buf[i] = (path[i] == '/'? cNormalizedSlash : (char) ::tolower(path[i]));
+        buf[path.size] = 0;
+        return path.size;
+    }
+
+    /*
+     *  ComparePathView
+     *      Checks if the paths @a and @b are the same, ignoring case and slash differences (but not trimming)
+     */
+    inline bool ComparePathView(path_view a, path_view b)
+    {
+        if(a.size != b.size) return false;
+        for(size_t i = 0; i < a.size; ++i)
+        {
+            if(!IsSamePathChar(a[i], b[i]))
+                return false;
+        }
+        return true;
+    }
+
+    /*
+     *  GetLastPathComponent
+     *      Same as the std::string version, but doesn't copy the path
+     */
+    inline size_t GetLastPathComponent(path_view path, size_t count = 1)
+    {
+        size_t pos = path_view::npos;
+        size_t limit;
+
+        // Ignore any slash at the end of the string
+        while(path.size && IsPathSeparator(path.back())) --path.size;
+
+        // Do the search, before the position 'limit' each time
+        limit = path.size;
+        for(size_t i = 0; i < count; ++i)
+        {
+            for(pos = limit; pos != 0 && !IsPathSeparator(path[pos - 1]); --pos) {}
+            if(pos == 0)
+                return 0;
+            limit = --pos;
+            if(pos == 0) break;
+        }
+
+        return (pos == path_view::npos? 0 : pos + 1);
+    }
+
+    /*
+     *  GetPathComponentBack
+     *      Same as the std::string version, but returns a view into @path
+     */
+    inline path_view GetPathComponentBack(path_view path, size_t count = 1)
+    {
+        size_t pos = GetLastPathComponent(path, count), end = pos;
+        while(end < path.size && !IsPathSeparator(path[end])) ++end;
+        return path.substr(pos, end - pos);
+    }
+
+    /*
+     *  GetFileExtension
+     *      Same as the std::string version, but returns a view into @filename
+     */
+    inline path_view GetFileExtension(path_view filename)
+    {
+        for(size_t i = filename.size; i != 0; --i)
+        {
+            if(filename[i - 1] == '.')
+                return filename.substr(i);
+        }
+        return path_view();
+    }
+
+    /*
+     *  NextPathComponent
+     *      Iterates on the components of @path, empty components (from repeated slashes) are skipped.
+     *      @pos should start at zero, the next @component is output and false is returned when there are no more components.
+     *
+     *          size_t pos = 0; path_view component;
+     *          while(NextPathComponent(path, pos, component)) { ... }
+     */
+    inline bool NextPathComponent(path_view path, size_t& pos, path_view& component)
+    {
+        while(pos < path.size && IsPathSeparator(path[pos])) ++pos;
+        if(pos >= path.size)
+            return false;
+
+        size_t begin = pos;
+        while(pos < path.size && !IsPathSeparator(path[pos])) ++pos;
+        component = path.substr(begin, pos - begin);
+        return true;
+    }
+
+    /*
+     *      Checks if a file is inside an named folder, or just inside it
+     *      @file File path to check
+     *      @bJust  Returns true only if just right inside the folder
+     *      @folder Folder path
+     *
+     *      Works on views of the paths, so no copies are made.
+     */
+    inline bool IsFileInsideFolder(path_view file, bool bJust, path_view folder)
+    {
+        file   = TrimPathView(file);
+        folder = TrimPathView(folder);
+        
+        size_t numFolds = std::count_if(file.begin(), file.end(), IsPathSeparator);
+
+        for(size_t i = 1; i <= numFolds; ++i)
+        {
+            if(ComparePathView(GetPathComponentBack(file, i+1), folder))
+                return true;
+            else if(bJust)
+                break;
+        }
+        
+        return false;
+    }
+}
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * Mod Loader Utilities Headers
+ * Created by LINK/2012 <dma_2012@hotmail.com>
+ *
+ *  This file provides helpful functions for plugins creators.
+ *
+ *  This source code is offered for use in the public domain. You may
+ *  use, modify or distribute it freely.
+ *
+ *  This code is distributed in the hope that it will be useful but
+ *  WITHOUT ANY WARRANTY. ALL WARRANTIES, EXPRESS OR IMPLIED ARE HEREBY
+ *  DISCLAIMED. This includes but is not limited to warranties of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ */
+#ifndef MODLOADER_UTIL_REDIRECT_HPP
+#define	MODLOADER_UTIL_REDIRECT_HPP
+
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <modloader/modloader.hpp>
+#include <modloader/util/hash.hpp>
+#include <modloader/util/path_string.hpp>
+
+namespace modloader
+{
+    /*
+     *  hashed_redirect_table
+     *      Maps filenames to the paths they should be redirected to, as done by hooks which replace the path the game is
+     *      about to open.
+     *
+     *      The filenames are keyed by their case folded hash (the same as modloader::file::hash for the lower case
+     *      filenames of the scanned files) and the redirect paths are built when a file gets inserted, so resolving a
+     *      filename only hashes it and compares it against the entries with the same hash, without any allocation.
+     */
+    class hashed_redirect_table
+    {
+        public:
+            struct entry
+            {
+                uint32_t                hash;       // Case folded hash of the filename
+                std::string             name;       // The filename
+                std::string             path;       // The path to redirect to
+                const modloader::file*  file;       // The file this redirects to (may be null)
+            };
+
+        public:
+            // Gets the case folded hash of @name, equivalent to modloader::hash of the lower case @name
+            static uint32_t hash(path_view name)
+            {
+                fnv1a<32> fnv;
+                auto h = fnv.init();
+                for(size_t i = 0; i < name.size; ++i)
+                    h = fnv.transform(h, (char) ::tolower(uint8_t(name[i])));
+                return fnv.final(h);
+            }
+
+            // Redirects the filename @name to @path, fails if @name is already present
+            bool insert(path_view name, std::string path, const modloader::file* file = nullptr)
+            {
+                uint32_t h = hash(name);
+                if(find(name, h))
+                    return false;
+
+                entry e = { h, name.str(), std::move(path), file };
+                map.emplace(h, std::move(e));
+                return true;
+            }
+
+            // Redirects the filename of @file to its full path (or to the path relative to the game directory if @fullpath is false)
+            bool insert(const modloader::file& file, bool fullpath = true)
+            {
+                return insert(file.filename(), fullpath? file.fullpath() : std::string(file.filepath()), &file);
+            }
+
+            // Removes the redirection of the filename @name, returns false if not present
+            bool erase(path_view name)
+            {
+                uint32_t h = hash(name);
+                auto range = map.equal_range(h);
+                for(auto it = range.first; it != range.second; ++it)
+                {
+                    if(ComparePathView(it->second.name, name))
+                    {
+                        map.erase(it);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // Removes the redirection of the filename of @file
+            bool erase(const modloader::file& file)
+            {
+                return erase(file.filename());
+            }
+
+            // Finds the redirection of the filename @name, returns null if not present
+            const entry* find(path_view name) const
+            {
+                return find(name, hash(name));
+            }
+
+            // Finds the redirection of the last component of the @path, returns null if not present
+            const entry* find_path(path_view path) const
+            {
+                return find(path.substr(GetLastPathComponent(path)));
+            }
+
+            // Gets the path the filename @name redirects to, returns null if not present
+            const char* redirect(path_view name) const
+            {
+                auto e = find(name);
+                return e? e->path.c_str() : nullptr;
+            }
+
+            size_t size() const     { return map.size(); }
+            bool empty() const      { return map.empty(); }
+            void clear()            { map.clear(); }
+
+        private:
+            const entry* find(path_view name, uint32_t h) const
+            {
+                auto range = map.equal_range(h);
+                for(auto it = range.first; it != range.second; ++it)
+                {
+                    if(ComparePathView(it->second.name, name))
+                        return &it->second;
+                }
+                return nullptr;
+            }
+
+        private:
+            std::unordered_multimap<uint32_t, entry> map;   // Case folded filename hash to entry
+    };
+}
+
+#endif	/* MODLOADER_UTIL_REDIRECT_HPP */
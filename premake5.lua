@@ -275,6 +275,26 @@ solution "modloader"
         configuration { "gmake" }
             includedirs { "src/shared/stdinc" } -- gmake compatibility since it'll compile the dummyproject
 
+    -- Replays the streaming traces recorded by std.stream, also builds on non-Windows systems
+    project "stream_replay"
+        language "C++"
+        kind "ConsoleApp"
+        flags { "NoPCH" }
+        binarydir "tools"
+        setupfiles "src/tools/stream_replay"
+        configuration { "gmake" }
+            links { "pthread" }
+
+    -- Tests and benchmarks of the headers that don't depend on the game, also builds on non-Windows systems
+    project "tests"
+        language "C++"
+        kind "ConsoleApp"
+        flags { "NoPCH" }
+        binarydir "tools"
+        setupfiles "src/tests"
+        configuration { "gmake" }
+            links { "pthread" }
+
 
     local gta3_plugins = {  -- ordered by time taken to compile
         "std.movies",
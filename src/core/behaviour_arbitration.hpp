@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+/*
+ *  behaviour_arbitration
+ *      Decides which file gets installed for each behaviour of each handler before anything is installed.
+ *
+ *      The files waiting to be installed are offered in install order (mods by ascending priority, then files in mod order),
+ *      the winner of a behaviour is the last file offered whose mod priority is not lower than the priority of the mod of
+ *      the file already installed with that behaviour (if any). That's the file which would remain installed if every
+ *      file was installed in order while displacing the previous, but without installing and uninstalling the others.
+ *
+ *      Handler and File are the plugin and file types, only pointers to them are stored.
+ */
+template<class Handler, class File>
+class behaviour_arbitration
+{
+    private:
+        using key_type = std::pair<const Handler*, uint64_t>;   // .first=handler, .second=behaviour
+
+        struct slot
+        {
+            File*   winner;             // The file to be installed, null if the installed file keeps the behaviour
+            bool    has_installed;      // Whether a file is already installed with this behaviour
+            int     installed_priority; // Priority of the mod of the file already installed
+        };
+
+        std::map<key_type, slot> slots;
+
+    public:
+        // Offers the @file from a mod with @priority to be installed by @handler with the @behaviour
+        // @installed_priority is the priority of the mod of the file currently installed with this behaviour, or null if none
+        void offer(const Handler& handler, uint64_t behaviour, File& file, int priority, const int* installed_priority)
+        {
+            auto key = key_type(&handler, behaviour);
+            auto it  = slots.find(key);
+            if(it == slots.end())
+            {
+                slot s = { nullptr, installed_priority != nullptr, installed_priority? *installed_priority : 0 };
+                it = slots.emplace(key, s).first;
+            }
+
+            if(!it->second.has_installed || priority >= it->second.installed_priority)
+                it->second.winner = &file;
+        }
+
+        // Gets the file which should be installed with the @behaviour by @handler, null if no offered file should
+        File* winner(const Handler& handler, uint64_t behaviour) const
+        {
+            auto it = slots.find(key_type(&handler, behaviour));
+            return it != slots.end()? it->second.winner : nullptr;
+        }
+
+        // Checks if @file should be installed with the @behaviour by @handler
+        bool is_winner(const Handler& handler, uint64_t behaviour, const File& file) const
+        {
+            return winner(handler, behaviour) == &file;
+        }
+
+        size_t size() const     { return slots.size(); }
+        bool empty() const      { return slots.empty(); }
+        void clear()            { slots.clear(); }
+};
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#pragma once
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <modloader/modloader.hpp>
+#include <modloader/util/hash.hpp>
+
+extern bool match_wildcard(const char* pattern, const char* string);
+
+/*
+ *  behaviour_classifier
+ *      The behaviour rules (modloader_rule_t) of all plugins compiled into a single lookup structure.
+ *
+ *      Each rule is indexed by its most selective condition (filename hash, then folder, then extension) so classifying a
+ *      file only visits the rules that may match it, instead of asking each plugin about it.
+ *      The paths of the classified files must be normalized (lower case), as they are during the scan.
+ *
+ *      Plugin is the type of the plugins owning the rules, only pointers to it are stored.
+ */
+template<class Plugin>
+class behaviour_classifier
+{
+    public:
+        // The rule of a plugin matching a file
+        struct match
+        {
+            const Plugin*           plugin;
+            const modloader_rule_t* rule;
+            size_t                  order;      // Position of the rule in the plugin table
+        };
+
+    private:
+        using bucket = std::vector<match>;
+        using bucket_map = std::unordered_map<uint32_t, bucket>;
+
+        bucket_map  by_hash;        // Rules with a filename hash, by the hash
+        bucket_map  by_folder;      // Rules with a folder, by the hash of the folder name
+        bucket_map  by_ext;         // Rules with a extension, by the hash of the extension
+        bucket      others;         // Rules with only a glob (or no condition at all)
+
+    public:
+        // Removes all the rules
+        void clear()
+        {
+            by_hash.clear();
+            by_folder.clear();
+            by_ext.clear();
+            others.clear();
+        }
+
+        // Checks if no rule is present
+        bool empty() const
+        {
+            return by_hash.empty() && by_folder.empty() && by_ext.empty() && others.empty();
+        }
+
+        // Adds the @count @rules of the @plugin
+        void add(const Plugin& plugin, const modloader_rule_t* rules, size_t count)
+        {
+            for(size_t i = 0; i < count; ++i)
+            {
+                const modloader_rule_t& rule = rules[i];
+                match m = { &plugin, &rule, i };
+
+                if(rule.result != MODLOADER_BEHAVIOUR_YES && rule.result != MODLOADER_BEHAVIOUR_CALLME)
+                    continue;
+
+                if(rule.hash)
+                    by_hash[rule.hash].emplace_back(m);
+                else if(rule.folder)
+                    by_folder[key(rule.folder, strlen(rule.folder))].emplace_back(m);
+                else if(rule.extension)
+                    by_ext[key(rule.extension, strlen(rule.extension))].emplace_back(m);
+                else
+                    others.emplace_back(m);
+            }
+        }
+
+        // Finds the first rule of each plugin matching the @file, outputs them into @out (which is cleared before)
+        void classify(const modloader::file& file, std::vector<match>& out) const
+        {
+            size_t folder_len = 0;
+            const char* folder = parent_folder(file, folder_len);
+
+            out.clear();
+            find_bucket(by_hash, file.hash, file, folder, folder_len, out);
+            if(folder) find_bucket(by_folder, key(folder, folder_len), file, folder, folder_len, out);
+            find_bucket(by_ext, key(file.filext(), strlen(file.filext())), file, folder, folder_len, out);
+            add_matches(others, file, folder, folder_len, out);
+        }
+
+        // Finds the match for the @plugin in the output of classify(), returns null if there's none
+        static const match* find(const std::vector<match>& matches, const Plugin& plugin)
+        {
+            for(auto& m : matches)
+            {
+                if(m.plugin == &plugin)
+                    return &m;
+            }
+            return nullptr;
+        }
+
+        // Applies the @rule into the @file, returning the behaviour result (MODLOADER_BEHAVIOUR_*)
+        static int apply(const modloader_rule_t& rule, modloader::file& file)
+        {
+            if(rule.result == MODLOADER_BEHAVIOUR_YES)
+                file.behaviour = (rule.flags & MODLOADER_RULE_ORHASH)? (rule.behaviour | file.hash) : rule.behaviour;
+            return rule.result;
+        }
+
+    private:
+        // Hash of the lower case @len characters at @s, used as key for folders and extensions
+        static uint32_t key(const char* s, size_t len)
+        {
+            uint32_t h = 2166136261u;   // FNV-1a
+            for(size_t i = 0; i < len; ++i)
+                h = (h ^ uint8_t(::tolower(uint8_t(s[i])))) * 16777619u;
+            return h;
+        }
+
+        // Compares the null terminated @a against the @len characters at @b, ignoring case
+        static bool same(const char* a, const char* b, size_t len)
+        {
+            for(size_t i = 0; i < len; ++i, ++a)
+            {
+                if(*a == 0 || ::tolower(uint8_t(*a)) != ::tolower(uint8_t(b[i])))
+                    return false;
+            }
+            return *a == 0;
+        }
+
+        // Gets the name of the folder the file is right inside (the mod folder for files in the mod root), returns null if none
+        static const char* parent_folder(const modloader::file& file, size_t& len)
+        {
+            const char* filepath = file.filepath();
+            const char* end = file.filename();
+
+            if(end == filepath) return nullptr;
+            while(end != filepath && (end[-1] == '\\' || end[-1] == '/')) --end;
+
+            const char* begin = end;
+            while(begin != filepath && begin[-1] != '\\' && begin[-1] != '/') --begin;
+
+            len = size_t(end - begin);
+            return begin;
+        }
+
+        // Checks if all the conditions of the @rule match the @file
+        static bool matches(const modloader_rule_t& rule, const modloader::file& file, const char* folder, size_t folder_len)
+        {
+            if((rule.flags & MODLOADER_RULE_NODIR) && file.is_dir())
+                return false;
+            if(rule.hash && rule.hash != file.hash)
+                return false;
+            if(rule.extension && !same(rule.extension, file.filext(), strlen(file.filext())))
+                return false;
+            if(rule.folder && !(folder && same(rule.folder, folder, folder_len)))
+                return false;
+            if(rule.glob && !match_wildcard(rule.glob, file.filedir()))
+                return false;
+            return true;
+        }
+
+        // Adds the matching rules of @b into @out, keeping only the first rule of each plugin
+        static void add_matches(const bucket& b, const modloader::file& file, const char* folder, size_t folder_len, std::vector<match>& out)
+        {
+            for(auto& m : b)
+            {
+                if(matches(*m.rule, file, folder, folder_len))
+                {
+                    auto it = out.begin();
+                    for(; it != out.end() && it->plugin != m.plugin; ++it) {}
+
+                    if(it == out.end())
+                        out.emplace_back(m);
+                    else if(m.order < it->order)
+                        *it = m;
+                }
+            }
+        }
+
+        static void find_bucket(const bucket_map& map, uint32_t k, const modloader::file& file, const char* folder, size_t folder_len, std::vector<match>& out)
+        {
+            auto it = map.find(k);
+            if(it != map.end()) add_matches(it->second, file, folder, folder_len, out);
+        }
+};
@@ -38,6 +38,10 @@ void Loader::ReadBasicConfig()
                 this->vkRefresh = std::stoi(pair.second.data(), 0, 0);
             else if(!compare(pair.first, "AutoRefresh", false))
                 this->bAutoRefresh = to_bool(pair.second);
+            else if(!compare(pair.first, "FastScan", false))
+                this->bFastScan = to_bool(pair.second);
+            else if(!compare(pair.first, "ValidateFastScan", false))
+                this->bValidateFastScan = to_bool(pair.second);
         }
     }
     else
@@ -60,6 +64,8 @@ void Loader::ReadBasicConfig()
      config["MaxLogSize"]           = std::to_string(maxBytesInLog);
      config["RefreshKey"]           = std::to_string(vkRefresh);
      config["AutoRefresh"]          = modloader::to_string(bAutoRefresh);
+     config["FastScan"]             = modloader::to_string(bFastScan);
+     config["ValidateFastScan"]     = modloader::to_string(bValidateFastScan);
 
      // Log only about failure since we'll be saving every time a entry on the menu changes
      if(!ini.write_file(gamePath + basicConfig))
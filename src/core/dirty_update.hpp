@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <set>
+#include <vector>
+
+/*
+ *  dirty_update
+ *      The steps of a folder update, which visit only the mods changed since the last update (the dirty mods of the folder)
+ *      and on each of them only the files changed or still waiting to be installed (the dirty files of the mod).
+ *      So an update costs as much as the number of changes, not as the number of files.
+ *
+ *      Mod, File and their handler are the loader types (which make this a friend), used through these members:
+ *          Mod     -> parent.dirty, files, dirty, status, priority, IsIgnored(), SetUnchanged()
+ *          File    -> parent, handler, behaviour, installed, waiting, status
+ *          Handler -> FindFileWithBehaviour(behaviour), AddWaiting(file), RemoveWaiting(file), WakeWaiting(behaviour)
+ *
+ *      The update() hooks provide the batch and arbitration types, the order of the mods and the logging, and commit the batches:
+ *          Hooks   -> batch_type, arbitration_type, less(mod, mod), extinguishing(mod, file, first), updating(mod),
+ *                     blocked(file), commit(batch)
+ */
+template<class Mod, class File>
+struct dirty_update
+{
+    using status = decltype(File::status);
+
+    // Finds the files the next update must visit (the ones changed by the last scan or waiting to be installed)
+    // and marks the @mod as dirty on its folder if there's anything to be done on it
+    // When the priority of the @mod changed (@reprioritized) the files waiting for the behaviours of its files get visited too
+    static void mark_dirty_files(Mod& mod, bool reprioritized)
+    {
+        mod.dirty.clear();
+        for(auto& file : mod.files)
+        {
+            if(file.status != status::Unchanged || (file.handler && !file.installed))
+            {
+                if(file.waiting) file.handler->RemoveWaiting(file);    // the update arbitrates it again
+                mod.dirty.emplace_back(&file);
+            }
+            else if(reprioritized && file.handler && file.installed)
+            {
+                file.handler->WakeWaiting(file.behaviour);  // they may win against the new priority
+            }
+        }
+
+        if(mod.status != status::Unchanged || !mod.dirty.empty())
+            mod.parent.dirty.insert(&mod);
+    }
+
+    // Marks the @file (which was not dirty) to be visited by the next update, as well as its @mod on the folder
+    static void mark_dirty_file(Mod& mod, File& file)
+    {
+        mod.dirty.emplace_back(&file);
+        mod.parent.dirty.insert(&mod);
+    }
+
+    // Adds the uninstall of anything that has the status Removed into the @batch, the files uninstalled by it are erased
+    // by collect_extinguished(), @hooks.extinguishing(mod, file, first) logs each of those files
+    template<class Batch, class Hooks>
+    static void extinguish(Mod& mod, Batch& batch, Hooks& hooks)
+    {
+        if(mod.status == status::Unchanged)
+            return;
+
+        bool first = true;
+        auto Extinguishing = [&](File& file)
+        {
+            hooks.extinguishing(mod, file, first);
+            first = false;
+        };
+
+        if(mod.status == status::Removed)
+        {
+            // Uninstall all files in this mod, the ones not installed can be erased from the mod right away
+            mod.dirty.clear();
+            for(auto it = mod.files.begin(); it != mod.files.end(); )
+            {
+                Extinguishing(*it);
+                if(it->installed)
+                {
+                    batch.add(it->handler, Batch::action::uninstall, *it);
+                    ++it;
+                }
+                else
+                {
+                    if(it->waiting) it->handler->RemoveWaiting(*it);
+                    it = mod.files.erase(it);
+                }
+            }
+        }
+        else
+        {
+            // Only the files changed by the last scan may have been removed, uninstall those
+            size_t kept = 0;
+            for(size_t i = 0; i < mod.dirty.size(); ++i)
+            {
+                File& file = *mod.dirty[i];
+                if(file.status == status::Removed)
+                {
+                    Extinguishing(file);
+                    if(!file.installed)
+                    {
+                        mod.files.erase(file);
+                        continue;
+                    }
+                    batch.add(file.handler, Batch::action::uninstall, file);
+                }
+                mod.dirty[kept++] = &file;
+            }
+            mod.dirty.resize(kept);
+        }
+    }
+
+    // Erases the files successfully uninstalled by the batch of extinguish() from the @mod
+    static void collect_extinguished(Mod& mod)
+    {
+        if(mod.status == status::Removed)
+        {
+            // The files which failed to uninstall keep this mod dirty, the next update tries again
+            for(auto it = mod.files.begin(); it != mod.files.end(); )
+            {
+                if(it->installed == false)
+                    it = mod.files.erase(it);
+                else
+                {
+                    mod.dirty.emplace_back(&*it);
+                    ++it;
+                }
+            }
+        }
+        else if(mod.status != status::Unchanged)
+        {
+            size_t kept = 0;
+            for(size_t i = 0; i < mod.dirty.size(); ++i)
+            {
+                File& file = *mod.dirty[i];
+                if(file.status == status::Removed)
+                {
+                    if(file.installed == false)
+                    {
+                        mod.files.erase(file);
+                        continue;
+                    }
+                    file.status = status::Unchanged;    // failed to uninstall, it stays there
+                }
+                mod.dirty[kept++] = &file;
+            }
+            mod.dirty.resize(kept);
+        }
+    }
+
+    // Offers the files of the @mod waiting to be installed to the behaviour arbitration @winners
+    // This must be called for every dirty mod (in priority order) before any install()
+    template<class Arbitration>
+    static void arbitrate(Mod& mod, Arbitration& winners)
+    {
+        if(mod.IsIgnored())
+            return;
+
+        for(File* pfile : mod.dirty)
+        {
+            File& file = *pfile;
+            if(file.handler && !file.installed
+            && (file.status == status::Added || file.status == status::Updated || file.status == status::Unchanged))
+            {
+                File* installed = file.handler->FindFileWithBehaviour(file.behaviour);
+                winners.offer(*file.handler, file.behaviour, file, mod.priority, installed? &installed->parent.priority : nullptr);
+            }
+        }
+    }
+
+    // Adds the uninstall of the files displaced by the files of the @mod which won the arbitration @winners into the @batch
+    // The batch must be commited before install()
+    template<class Arbitration, class Batch>
+    static void displace(Mod& mod, const Arbitration& winners, Batch& batch)
+    {
+        if(mod.IsIgnored())
+            return;
+
+        for(File* pfile : mod.dirty)
+        {
+            File& file = *pfile;
+            if(file.handler && !file.installed && winners.is_winner(*file.handler, file.behaviour, file))
+            {
+                // If any other file with the same behaviour present, uninstall it
+                if(File* old = file.handler->FindFileWithBehaviour(file.behaviour))
+                    batch.add(old->handler, Batch::action::uninstall, *old);
+            }
+        }
+    }
+
+    // Adds the install / reinstall of the files of the @mod which have the status Added or Updated (or failed to install)
+    // into the @batch, only the files which won the arbitration @winners get installed
+    // @hooks.updating(mod) logs the visit to the mod and @hooks.blocked(file) the file whose displaced file failed to uninstall
+    template<class Arbitration, class Batch, class Hooks>
+    static void install(Mod& mod, const Arbitration& winners, Batch& batch, Hooks& hooks)
+    {
+        if(mod.IsIgnored())
+            return;
+
+        hooks.updating(mod);
+
+        auto TryInstall = [&](File& file)
+        {
+            if(file.handler && !winners.is_winner(*file.handler, file.behaviour, file))
+            {
+                // Don't install, the currently installed file or another file to be installed has priority over this one
+            }
+            else if(file.handler && file.handler->FindFileWithBehaviour(file.behaviour))
+            {
+                // Don't install, the file displaced by this one failed to uninstall
+                hooks.blocked(file);
+                file.status = status::Unchanged;
+            }
+            else
+            {
+                // Install, this file has priority over any other file with this behaviour
+                batch.add(file.handler, Batch::action::install, file);
+            }
+        };
+
+        for(File* pfile : mod.dirty)
+        {
+            File& file = *pfile;
+
+            if(file.status == status::Added || file.status == status::Updated)
+            {
+                if(file.installed)
+                    batch.add(file.handler, Batch::action::reinstall, file);
+                else
+                    TryInstall(file);
+            }
+            else if(file.status == status::Unchanged)
+            {
+                if(file.handler && !file.installed)
+                    TryInstall(file);
+            }
+        }
+    }
+
+    // Leaves on the @mod only the files still waiting to be installed (or uninstalled, on a removed mod)
+    // The files which lost the arbitration to an installed file wait on their handler until that file gets uninstalled
+    static void prune(Mod& mod)
+    {
+        if(mod.status == status::Removed)
+            return;     // only the files which failed to uninstall are left
+
+        mod.dirty.erase(std::remove_if(mod.dirty.begin(), mod.dirty.end(), [&mod](File* pfile) {
+            File& file = *pfile;
+            if(!file.handler || file.installed || file.status == status::Removed || mod.IsIgnored())
+                return true;
+
+            if(file.handler->FindFileWithBehaviour(file.behaviour))
+            {
+                file.handler->AddWaiting(file);
+                return true;
+            }
+
+            return false;   // failed to install, try again
+        }), mod.dirty.end());
+    }
+
+    // Updates the mods in the @dirty set of a folder, which keeps only the mods with files still waiting to be installed
+    template<class Hooks>
+    static void update(std::set<Mod*>& dirty, Hooks& hooks)
+    {
+        using batch_type        = typename Hooks::batch_type;
+        using arbitration_type  = typename Hooks::arbitration_type;
+
+        auto DirtyModsByPriority = [&]
+        {
+            std::vector<std::reference_wrapper<Mod>> list;
+            list.reserve(dirty.size());
+            for(Mod* mod : dirty) list.emplace_back(*mod);
+            std::sort(list.begin(), list.end(), [&hooks](const Mod& a, const Mod& b) { return hooks.less(a, b); });
+            return list;
+        };
+
+        auto mods = DirtyModsByPriority();
+
+        // Uninstall all removed files since the last update...
+        batch_type batch;
+        for(Mod& mod : mods) extinguish(mod, batch, hooks);
+        hooks.commit(batch);
+
+        for(Mod& mod : mods) collect_extinguished(mod);
+
+        // The uninstalls may have woken up files waiting for their behaviour on other mods
+        mods = DirtyModsByPriority();
+
+        // Find out which file should be installed for each behaviour...
+        arbitration_type winners;
+        for(Mod& mod : mods) arbitrate(mod, winners);
+
+        // Uninstall the files displaced by the ones about to be installed...
+        batch.clear();
+        for(Mod& mod : mods) displace(mod, winners, batch);
+        hooks.commit(batch);
+
+        // The displaced files get visited by the pruning below, to wait for their behaviour to be vacated again
+        for(auto& op : batch)
+        {
+            if(!op.file->installed) mark_dirty_file(op.file->parent, *op.file);
+        }
+
+        // Install all updated and added files since the last update...
+        batch.clear();
+        for(Mod& mod : mods) install(mod, winners, batch, hooks);
+        hooks.commit(batch);
+
+        // Mods with files still waiting to be installed get visited again on the next update
+        for(auto it = dirty.begin(); it != dirty.end(); )
+        {
+            Mod& mod = **it;
+            prune(mod);
+            mod.SetUnchanged();
+            it = mod.dirty.empty()? dirty.erase(it) : std::next(it);
+        }
+    }
+};
@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2013-2014  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#pragma once
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <modloader/util/hash.hpp>
+
+/*
+ *  file_arena
+ *      Per-mod storage for file records (of type T) and their path bytes.
+ *
+ *      Path bytes are stored in big chunks and records in fixed-size blocks, so neither of them moves after being added
+ *      (plugins keep pointers to both) and scanning a mod doesn't allocate for each file found.
+ *      Records are indexed by their key string (which must live in the path chunks) and iterated in key order.
+ *
+ *      The path of an erased record is reused by the next path of the same size, and a chunk is freed as soon as no
+ *      path lives in it anymore, so adding and removing files over and over (hot refreshes) doesn't keep growing the arena.
+ *
+ *      T must provide a 'const char* key() const' method returning the string it is indexed by, and the
+ *      'const char* filebuffer() const' and 'size_t filebuffer_len() const' methods (as in modloader::file) giving
+ *      back the path stored by store_path().
+ */
+template<class T>
+class file_arena
+{
+    private:
+        enum : size_t
+        {
+            chunk_size = 64 * 1024,     // Bytes per path chunk (paths bigger than this get their own chunk)
+            block_size = 256,           // Records per block
+        };
+
+        // Storage for one record
+        struct slot
+        {
+            typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+        };
+
+        struct key_hash
+        {
+            size_t operator()(const char* key) const { return modloader::hash(key); }
+        };
+
+        struct key_equal
+        {
+            bool operator()(const char* a, const char* b) const { return strcmp(a, b) == 0; }
+        };
+
+        struct key_less
+        {
+            bool operator()(const T* a, const T* b) const { return strcmp(a->key(), b->key()) < 0; }
+        };
+
+        // Storage for paths
+        struct chunk
+        {
+            std::unique_ptr<char[]> data;
+            size_t                  capacity;
+            size_t                  live;       // Bytes used by paths still in use
+        };
+
+        using index_type = std::unordered_map<const char*, T*, key_hash, key_equal>;
+        using order_type = std::vector<T*>;
+        using chunk_map  = std::map<const char*, chunk>;                    // Chunks by their address
+        using free_paths = std::unordered_map<size_t, std::vector<char*>>;  // Released paths by their size (null included)
+
+    public:
+
+        //
+        //  Iterator over the records in key order
+        //  Erasing a record through erase(iterator) keeps other iterators valid.
+        //
+        class iterator : public std::iterator<std::forward_iterator_tag, T>
+        {
+            public:
+                iterator() = default;
+                iterator(typename order_type::iterator it, typename order_type::iterator end) : it(it), end(end)
+                { this->skip(); }
+
+                T& operator*() const  { return **it; }
+                T* operator->() const { return *it; }
+
+                iterator& operator++()   { ++it; skip(); return *this; }
+                iterator operator++(int) { iterator x(*this); ++(*this); return x; }
+
+                bool operator==(const iterator& rhs) const { return it == rhs.it; }
+                bool operator!=(const iterator& rhs) const { return it != rhs.it; }
+
+            private:
+                friend class file_arena;
+                void skip() { while(it != end && *it == nullptr) ++it; }   // skip erased records
+                typename order_type::iterator it, end;
+        };
+
+    public:
+        file_arena()
+        {}
+
+        file_arena(const file_arena&) = delete;
+        file_arena& operator=(const file_arena&) = delete;
+
+        ~file_arena()
+        {
+            this->clear();
+        }
+
+        // Number of live records
+        size_t size() const { return index.size(); }
+        bool empty() const  { return index.empty(); }
+
+        // Iterates in key order
+        iterator begin()
+        {
+            this->sort();
+            return iterator(order.begin(), order.end());
+        }
+
+        iterator end()
+        {
+            return iterator(order.end(), order.end());
+        }
+
+        // Finds the record indexed by 'key', returns null if not found
+        T* find(const char* key)
+        {
+            auto it = index.find(key);
+            return it != index.end()? it->second : nullptr;
+        }
+
+        // Stores a null terminated copy of the 'len' bytes at 'path' in the path chunks
+        char* store_path(const char* path, size_t len)
+        {
+            char* p = nullptr;
+            size_t size = len + 1;
+
+            auto it = released.find(size);
+            if(it != released.end() && !it->second.empty())
+            {
+                p = it->second.back();
+                it->second.pop_back();
+                this->find_chunk(p).live += size;
+                released_bytes -= size;
+            }
+            else
+            {
+                if(current == nullptr || chunk_used + size > current->capacity)
+                {
+                    size_t capacity = (std::max)(size_t(chunk_size), size);
+                    std::unique_ptr<char[]> data(new char[capacity]);
+                    const char* base = data.get();
+                    current = &chunks.emplace(base, chunk { std::move(data), capacity, 0 }).first->second;
+                    chunk_used = 0;
+                }
+
+                p = current->data.get() + chunk_used;
+                chunk_used += size;
+                current->live += size;
+            }
+
+            std::memcpy(p, path, len);
+            p[len] = '\0';
+            return p;
+        }
+
+        // Bytes allocated for paths, and how many of those are released for reuse
+        size_t path_capacity() const
+        {
+            size_t bytes = 0;
+            for(auto& pair : chunks) bytes += pair.second.capacity;
+            return bytes;
+        }
+
+        size_t path_released() const
+        {
+            return released_bytes;
+        }
+
+        // Constructs a new record from 'args' and indexes it by its key
+        // The key must not be in the arena already (use find() first)
+        template<class... Args>
+        T& emplace(Args&&... args)
+        {
+            T* record = new (this->alloc()) T(std::forward<Args>(args)...);
+            index.emplace(record->key(), record);
+
+            if(!order.empty() && (!order.back() || !graveyard.empty()))
+                this->unsorted = true;      // the last record in 'order' may have been erased, can't compare with it
+            else if(!order.empty() && !key_less()(order.back(), record))
+                this->unsorted = true;      // the walker usually gives us sorted keys, avoid sorting when possible
+            order.emplace_back(record);
+            return *record;
+        }
+
+        // Erases the record at 'it', returning an iterator to the next record
+        iterator erase(iterator it)
+        {
+            T* record = *it.it;
+            index.erase(record->key());
+            *it.it = nullptr;
+            ++this->holes;
+
+            this->release_path(record->filebuffer(), record->filebuffer_len() + 1);
+            record->~T();
+            freelist.emplace_back(reinterpret_cast<slot*>(record));
+
+            if(index.empty())
+                this->release_paths();  // nothing refers to the path chunks anymore
+
+            return ++it;
+        }
+
+        // Erases the 'record', without looking for it in the iteration order
+        // Iterators (other than end()) are invalidated
+        void erase(T& record)
+        {
+            index.erase(record.key());
+            this->release_path(record.filebuffer(), record.filebuffer_len() + 1);
+            record.~T();
+            graveyard.emplace_back(reinterpret_cast<slot*>(&record));   // reused only after leaving 'order'
+
+            if(index.empty())
+                this->release_paths();
+        }
+
+        // Erases all the records
+        void clear()
+        {
+            this->compact();
+            for(T* record : order)
+                if(record) record->~T();
+            index.clear();
+            order.clear();
+            freelist.clear();
+            graveyard.clear();
+            blocks.clear();
+            block_used = 0;
+            holes = 0;
+            unsorted = false;
+            this->release_paths();
+        }
+
+    private:
+        // Gets memory for a new record
+        void* alloc()
+        {
+            if(!freelist.empty())
+            {
+                slot* s = freelist.back();
+                freelist.pop_back();
+                return s;
+            }
+
+            if(blocks.empty() || block_used == block_size)
+            {
+                blocks.emplace_back(new slot[block_size]);
+                block_used = 0;
+            }
+            return &blocks.back()[block_used++];
+        }
+
+        // Removes the erased records from the iteration order
+        void compact()
+        {
+            if(!graveyard.empty())
+            {
+                std::sort(graveyard.begin(), graveyard.end());
+                order.erase(std::remove_if(order.begin(), order.end(), [this](T* record) {
+                    return record == nullptr || std::binary_search(graveyard.begin(), graveyard.end(), reinterpret_cast<slot*>(record));
+                }), order.end());
+                freelist.insert(freelist.end(), graveyard.begin(), graveyard.end());
+                graveyard.clear();
+                holes = 0;
+            }
+            else if(holes)
+            {
+                order.erase(std::remove(order.begin(), order.end(), nullptr), order.end());
+                holes = 0;
+            }
+        }
+
+        // Compacts and sorts the iteration order, if needed
+        void sort()
+        {
+            this->compact();
+
+            if(unsorted)
+            {
+                std::sort(order.begin(), order.end(), key_less());
+                unsorted = false;
+            }
+        }
+
+        // Finds the chunk the path at 'p' lives in
+        chunk& find_chunk(const char* p)
+        {
+            return std::prev(chunks.upper_bound(p))->second;
+        }
+
+        // Releases the 'size' bytes at 'path' (given by store_path) for reuse
+        void release_path(const char* path, size_t size)
+        {
+            auto it = std::prev(chunks.upper_bound(path));
+            auto& c = it->second;
+            c.live -= size;
+
+            if(c.live == 0 && &c != current)
+            {
+                // No path lives in this chunk anymore, forget the released paths in it and free it
+                const char* begin = c.data.get();
+                const char* end   = begin + c.capacity;
+                for(auto& pair : released)
+                {
+                    auto& list = pair.second;
+                    auto new_end = std::remove_if(list.begin(), list.end(), [&](const char* p) { return p >= begin && p < end; });
+                    released_bytes -= (list.end() - new_end) * pair.first;
+                    list.erase(new_end, list.end());
+                }
+                chunks.erase(it);
+            }
+            else
+            {
+                released[size].emplace_back(const_cast<char*>(path));
+                released_bytes += size;
+            }
+        }
+
+        void release_paths()
+        {
+            chunks.clear();
+            released.clear();
+            current = nullptr;
+            chunk_used = 0;
+            released_bytes = 0;
+        }
+
+    private:
+        chunk_map                               chunks;                 // Path bytes
+        chunk*                                  current = nullptr;      // Chunk new paths are stored at the end of
+        size_t                                  chunk_used = 0;         // Bytes used in the current chunk
+        free_paths                              released;               // Paths free for reuse
+        size_t                                  released_bytes = 0;     // Bytes in 'released'
+
+        std::vector<std::unique_ptr<slot[]>>    blocks;                 // Records
+        size_t                                  block_used = 0;         // Records used in the last block
+        std::vector<slot*>                      freelist;               // Records free for reuse
+        std::vector<slot*>                      graveyard;              // Records erased by erase(T&) still in 'order'
+
+        index_type                              index;                  // Key to record
+        order_type                              order;                  // Records in key order (null for erased records)
+        size_t                                  holes = 0;              // Number of null entries in 'order'
+        bool                                    unsorted = false;       // Whether 'order' needs sorting
+};
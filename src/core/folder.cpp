@@ -14,6 +14,7 @@ using namespace modloader;
 void Loader::FolderInformation::Clear()
 {
     mods.clear();
+    dirty.clear();
     profiles.clear();
     current_profile = nullptr;
 }
@@ -262,6 +263,13 @@ void Loader::FolderInformation::Scan()
             return true;
         });
     }
+
+    // Mods not found anymore must be extinguished on the next update
+    for(auto& pair : this->mods)
+    {
+        if(pair.second.status == Status::Removed)
+            this->dirty.insert(&pair.second);
+    }
     
     // Find the underlying status of this folder
     UpdateStatus(*this, this->mods, fine);
@@ -283,7 +291,11 @@ void Loader::FolderInformation::Scan(const Journal& journal)
             if(change.second == Status::Removed)
             {
                 auto it = this->mods.find(change.first);
-                if(it != this->mods.end()) it->second.status = Status::Removed;
+                if(it != this->mods.end())
+                {
+                    it->second.status = Status::Removed;
+                    this->dirty.insert(&it->second);
+                }
             }
             else if(change.second == Status::Added
                  || change.second == Status::Updated)
@@ -309,20 +321,9 @@ void Loader::FolderInformation::Update()
         Updating xup;
         Log("\nUpdating mods for \"%s\"...", this->path.c_str());
 
-        auto mods = this->GetModsByPriority();
-
-        // Uninstall all removed files since the last update...
-        for(ModInformation& mod : mods)
-        {
-            mod.ExtinguishNecessaryFiles();
-        }
-
-        // Install all updated and added files since the last update...
-        for(ModInformation& mod : mods)
-        {
-            mod.InstallNecessaryFiles();
-            mod.SetUnchanged();
-        }
+        // Only the mods changed since the last update (or with files waiting to be installed) need to be visited
+        UpdateHooks hooks;
+        dirty_update<ModInformation, FileInformation>::update(this->dirty, hooks);
 
         // Collect garbaged data (mods and childs that are unused atm)
         CollectInformation(this->mods);
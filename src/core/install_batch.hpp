@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <unordered_map>
+#include <modloader/modloader.h>
+
+/*
+ *  install_batch
+ *      The installs, reinstalls and uninstalls of a step of the update, grouped by plugin when sent to them.
+ *
+ *      Each plugin supporting batches (modloader_plugin_ex_t::BatchFiles) receives all its operations in a single call,
+ *      the others receive them one by one in the order they were added.
+ *
+ *      Plugin is the plugin type and File the file type (derived from modloader_file_t), only pointers to them are stored.
+ */
+template<class Plugin, class File>
+class install_batch
+{
+    public:
+        // The operations, in the order a batch applies them
+        enum class action { uninstall, reinstall, install };
+
+        struct op
+        {
+            Plugin* plugin;     // The plugin to send the file to (null if none, then it always succeeds)
+            File*   file;
+            action  act;
+            bool    result;     // Whether the operation succeeded, set by dispatch()
+        };
+
+    private:
+        std::vector<op> ops;
+
+    public:
+        // Adds the operation @act on @file by @plugin
+        void add(Plugin* plugin, action act, File& file)
+        {
+            op o = { plugin, &file, act, plugin == nullptr };
+            ops.emplace_back(o);
+        }
+
+        // Sends the operations to their plugins, setting their results
+        // @has_batch(Plugin&) checks if a plugin supports batches and @call_batch(Plugin&, modloader_batch_t&) sends one to it,
+        // @call_file(Plugin&, action, File&) sends a single operation to a plugin without batch support, returning its result
+        template<class HasBatch, class CallBatch, class CallFile>
+        void dispatch(HasBatch has_batch, CallBatch call_batch, CallFile call_file)
+        {
+            // The operations of each plugin, plugins in the order of their first operation
+            std::unordered_map<Plugin*, size_t> index;
+            std::vector<std::pair<Plugin*, std::vector<op*>>> plugins;
+            for(auto& o : ops)
+            {
+                if(o.plugin)
+                {
+                    auto it = index.emplace(o.plugin, plugins.size());
+                    if(it.second) plugins.emplace_back(o.plugin, std::vector<op*>());
+                    plugins[it.first->second].second.emplace_back(&o);
+                }
+            }
+
+            for(auto& pair : plugins)
+            {
+                Plugin& plugin = *pair.first;
+                if(has_batch(plugin))
+                {
+                    dispatch_batch(plugin, pair.second, call_batch);
+                }
+                else
+                {
+                    for(op* o : pair.second)
+                        o->result = call_file(plugin, o->act, *o->file);
+                }
+            }
+        }
+
+        typename std::vector<op>::iterator begin()  { return ops.begin(); }
+        typename std::vector<op>::iterator end()    { return ops.end(); }
+        size_t size() const     { return ops.size(); }
+        bool empty() const      { return ops.empty(); }
+        void clear()            { ops.clear(); }
+
+    private:
+        template<class CallBatch>
+        void dispatch_batch(Plugin& plugin, const std::vector<op*>& plugin_ops, CallBatch& call_batch)
+        {
+            std::vector<const modloader_file_t*> files[3];  // By action
+            std::vector<int>                     results[3];
+            std::vector<op*>                     owners[3];
+
+            for(op* o : plugin_ops)
+            {
+                files[size_t(o->act)].emplace_back(o->file);
+                owners[size_t(o->act)].emplace_back(o);
+            }
+
+            for(size_t i = 0; i < 3; ++i)
+                results[i].assign(files[i].size(), 1);
+
+            modloader_batch_t batch;
+            batch.uninstall         = files[size_t(action::uninstall)].data();
+            batch.reinstall         = files[size_t(action::reinstall)].data();
+            batch.install           = files[size_t(action::install)].data();
+            batch.uninstall_result  = results[size_t(action::uninstall)].data();
+            batch.reinstall_result  = results[size_t(action::reinstall)].data();
+            batch.install_result    = results[size_t(action::install)].data();
+            batch.uninstall_len     = files[size_t(action::uninstall)].size();
+            batch.reinstall_len     = files[size_t(action::reinstall)].size();
+            batch.install_len       = files[size_t(action::install)].size();
+            call_batch(plugin, batch);
+
+            for(size_t i = 0; i < 3; ++i)
+            {
+                for(size_t k = 0; k < owners[i].size(); ++k)
+                    owners[i][k]->result = (results[i][k] == 0);
+            }
+        }
+};
@@ -154,6 +154,9 @@ void Loader::Startup()
         this->bEnableMenu    = true;
         this->bEnableLog     = true;
         this->bEnablePlugins = true;
+        this->bFastScan      = false;
+        this->bValidateFastScan = false;
+        this->bWarmStart     = false;
         this->maxBytesInLog  = 5242880;     // 5 MiB
         this->currentModId   = 0;
         this->currentFileId  = 0x8000000000000000;  // File id should have the hibit set
@@ -363,6 +366,8 @@ void Loader::BeforeFirstScan()
         }
     }
 
+    // Load the directories found by the scans of the last launch
+    this->LoadScanSnapshot();
 }
 
 /*
@@ -374,6 +379,7 @@ void Loader::ScanAndUpdate()
     Updating xup;
     mods.Scan();
     mods.Update();
+    this->SaveScanSnapshot();
 }
 
 /*
@@ -385,6 +391,7 @@ void Loader::UpdateFromJournal(const Journal& journal)
     Updating xup;
     mods.Scan(journal);
     mods.Update();
+    this->SaveScanSnapshot();
 }
 
 /*
@@ -407,11 +414,14 @@ void Loader::NotifyUpdateForPlugins()
 auto Loader::FindHandlerForFile(modloader::file& m, ref_list<PluginInformation>& callme) -> PluginInformation*
 {
     PluginInformation* handler = nullptr;
+
+    // Find the behaviour rules matching this file, the plugins with a rule for it won't be asked about it
+    this->classifier.classify(m, this->rule_matches);
     
     // Iterate on the plugins to find a handler for it
     for(PluginInformation& plugin : this->GetPluginsBy(m.filext()))
     {
-        auto state = plugin.FindBehaviour(m);
+        auto state = plugin.FindBehaviour(m, this->rule_matches);
         
         if(state == BehaviourType::Yes)
         {
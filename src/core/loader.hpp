@@ -13,6 +13,12 @@
 #include <modloader/util/path.hpp>
 #include <modloader/util/container.hpp>
 #include <ini_parser/ini_parser.hpp>
+#include "file_arena.hpp"
+#include "behaviour_rules.hpp"
+#include "behaviour_arbitration.hpp"
+#include "install_batch.hpp"
+#include "dirty_update.hpp"
+#include "scan_snapshot.hpp"
 #include <string>
 #include <vector>
 #include <list>
@@ -61,7 +67,7 @@ struct ModLoaderIniSectionPred
 {
     bool operator()(const std::string& a, const std::string& b) const;
 };
-using modloader_ini_map_key  = std::map<std::string, std::string>;
+using modloader_ini_map_key  = linb::ordered_hash_map<std::string, std::string>;    // profiles may have thousands of keys
 using modloader_ini_map_sect = std::map<std::string, modloader_ini_map_key, ModLoaderIniSectionPred>;
 using modloader_ini = linb::basic_ini<char, std::string, modloader_ini_map_key, modloader_ini_map_sect>;
 
@@ -108,6 +114,18 @@ class Loader : public modloader_t
         using ExtMap = std::map<std::string, ref_list<PluginInformation>>;
         using Journal = std::map<std::string, Loader::Status>;  // [{".", Status::Updated}] means refresh all
         using BehvSet = std::set<std::pair<PluginInformation*, uint64_t>>;  // .first=handler, .second=behaviour; list of behaviours
+        using BehvArbitration = behaviour_arbitration<PluginInformation, FileInformation>;  // file to install for each behaviour
+        using InstallBatch = install_batch<PluginInformation, FileInformation>;             // files to install in a step of the update
+
+        // The filesystem as seen by the mods scan, paths relative to the current directory
+        class ScanFilesystem : public scan_filesystem
+        {
+            public:
+                bool list(const std::string& dir, std::vector<entry>& out);
+                bool time(const std::string& dir, uint64_t& out);
+                bool read(const std::string& path, std::string& out);
+                bool write(const std::string& path, const std::string& data);
+        };
 
         
         // Information about a Mod Loader plugin
@@ -115,6 +133,7 @@ class Loader : public modloader_t
         {
             protected:
                 friend class Loader;
+                template<class, class> friend struct dirty_update;
                 typedef modloader::plugin base;
                 
                 // Plugin identifier (i.e. "gta/std/fx.dll" -> "gta.std.fx")
@@ -122,20 +141,30 @@ class Loader : public modloader_t
 
                 // All the behaviours being handled by this plugin
                 std::map<uint64_t, FileInformation*> behv;
+
+                // Files which lost the behaviour arbitration to an installed file, waiting for it to be uninstalled
+                std::multimap<uint64_t, FileInformation*> waiting;
+
+                // Extended plugin data
+                modloader_plugin_ex_t ex;
                 
             public:
-                PluginInformation(void* module, const char* modulename, modloader_fGetPluginData GetPluginData)
+                PluginInformation(void* module, const char* modulename, modloader_fGetPluginData GetPluginData,
+                                  modloader_fGetPluginDataEx GetPluginDataEx)
                 {
                     using namespace modloader;
 
                     // Fill basic information
                     std::memset(this, 0, sizeof(modloader::plugin));
+                    std::memset(&this->ex, 0, sizeof(ex));
                     this->pModule   = module;
                     this->loader    = &::loader;
                     this->priority  = default_priority;
+                    this->ex.size   = sizeof(ex);
                     
                     // Fill the plugin structure with the rest of the informations
                     if(GetPluginData) GetPluginData(this);
+                    if(GetPluginDataEx) GetPluginDataEx(this, &this->ex);
 
                     //
                     this->identifier = NormalizePath(modulename);
@@ -160,12 +189,22 @@ class Loader : public modloader_t
                 bool Reinstall(FileInformation& file);
                 bool Uninstall(FileInformation& file);
                 void Update();
+
+                // Methods to install and uninstall many files at once
+                static void Dispatch(InstallBatch& batch);
+                bool Complete(InstallBatch::action action, FileInformation& file, bool result);
                 
                 
             protected:
                 // Methods to deal with file behaviour
                 BehaviourType FindBehaviour(modloader::file& m);
+                BehaviourType FindBehaviour(modloader::file& m, const std::vector<behaviour_classifier<PluginInformation>::match>& matches);
                 FileInformation* FindFileWithBehaviour(uint64_t behaviour);
+
+                // Methods to deal with files waiting for a behaviour to be vacated
+                void AddWaiting(FileInformation& file);
+                void RemoveWaiting(FileInformation& file);
+                void WakeWaiting(uint64_t behaviour);
                 
             private:
                 // Methods mapping straight to the raw methods at modloader_file_t
@@ -188,20 +227,21 @@ class Loader : public modloader_t
         {
             protected:
                 friend class Loader;
+                template<class, class> friend struct dirty_update;
                 ModInformation&                 parent;         // The mod this file belongs to
                 PluginInformation*              handler;        // The plugin that will handle this file (may be null)
-                std::string                     pathbuf;        // Path buffer (as used in base.buffer)
                 ref_list<PluginInformation>     callme;         // Those plugins should receive this file, but they won't handle it
                 bool                            installed;      // Is the mod installed?
+                bool                            waiting;        // Is this file in the handler waiting list?
                 Status                          status;         // File status
                 
             public:
-                // Initializer
-                FileInformation(ModInformation& parent, std::string xpathbuf, const modloader::file& m,
+                // Initializer, the path buffer at m.buffer must outlive this object (it's usually in the parent files arena)
+                FileInformation(ModInformation& parent, const modloader::file& m,
                                 PluginInformation* xhandler, ref_list<PluginInformation>&& xcallme)
                 
-                    : parent(parent), handler(xhandler), pathbuf(std::move(xpathbuf)), callme(std::move(xcallme)),
-                      installed(false), status(Status::Unchanged)
+                    : parent(parent), handler(xhandler), callme(std::move(xcallme)),
+                      installed(false), waiting(false), status(Status::Unchanged)
                 {
                     std::memcpy(this, &m, sizeof(modloader::file));
                     modloader::file::parent = &parent;
@@ -209,12 +249,18 @@ class Loader : public modloader_t
                 
                 // Checks if this file is installed
                 bool IsInstalled() const { return installed; }
+
+                // Key of this file in the parent files arena
+                const char* key() const { return filedir(); }
                     
                 // Installs or uninstalls this file
                 bool Install();
                 bool Reinstall();
                 bool Uninstall();
 
+                // Installs, reinstalls or uninstalls all the files in the @batch at once
+                static void Commit(InstallBatch& batch);
+
                 // Updates the current file state based on another new state
                 bool Update(const modloader::file& m);
         };
@@ -226,10 +272,12 @@ class Loader : public modloader_t
             protected:
                 friend class Loader;
                 friend struct PriorityPred<ModInformation>;
+                template<class, class> friend struct dirty_update;
                 FolderInformation&          parent;         // Owner of this mod
                 std::string                 path;           // Path for this mod (relative to game dir), normalized
                 std::string                 name;           // Name for this mod, this is the filename in path (normalized)
-                std::map<std::string, FileInformation>  files; // Files inside this mod
+                file_arena<FileInformation> files;          // Files inside this mod, indexed by filedir()
+                std::vector<FileInformation*> dirty;        // Files the next update must visit (changed or waiting to be installed)
                 Status                      status;         // Mod status
                 bool                        ignored;
 
@@ -246,9 +294,8 @@ class Loader : public modloader_t
                 // Scans this mod for new, updated or removed files
                 void Scan();
                 
-                // Uninstall / Install files after scanning and finding out the status of mods
-                void ExtinguishNecessaryFiles();
-                void InstallNecessaryFiles();
+                // Marks a file to be visited by the next update (the update itself is in dirty_update.hpp)
+                void MarkDirtyFile(FileInformation& file);
                 
                 FolderInformation& Parent()  { return this->parent; }
                 const std::string& GetPath() const { return this->path; }
@@ -261,6 +308,8 @@ class Loader : public modloader_t
 
                 ModInformation& UpdateIgnoreStatus();
                 bool UpdatePriority();
+                void MarkDirtyFiles(bool reprioritized);
+                bool Walk(const scan_walker::callback& cb);
         };
         
         // Information about a profile (mods to load, files to ignore, etc)
@@ -441,6 +490,7 @@ class Loader : public modloader_t
 
             protected:
                 friend class Loader;
+                template<class, class> friend struct dirty_update;
                 Status status;                      // Folder status
                 
             private:
@@ -448,6 +498,7 @@ class Loader : public modloader_t
                 FolderInformation* parent;          // Parent folder
                 
                 ModInformationList       mods;      // All mods on this folder
+                std::set<ModInformation*> dirty;    // Mods the next update must visit (changed or with files waiting to be installed)
                 
                 // Profiles
                 std::list<Loader::Profile>  profiles;       // List of available profiles
@@ -459,7 +510,20 @@ class Loader : public modloader_t
                 void SetUnchanged() { if(status != Status::Removed) status = Status::Unchanged; }
         };
 
-        
+        // Logging and commits of the steps of a folder update (see dirty_update.hpp)
+        struct UpdateHooks
+        {
+            using batch_type       = InstallBatch;
+            using arbitration_type = BehvArbitration;
+
+            bool less(const ModInformation& a, const ModInformation& b) const;
+            void extinguishing(ModInformation& mod, FileInformation& file, bool first);
+            void updating(ModInformation& mod);
+            void blocked(FileInformation& file);
+            void commit(InstallBatch& batch);
+        };
+
+
     protected:
         friend struct Updating;
         friend struct scoped_gdir;
@@ -477,6 +541,8 @@ class Loader : public modloader_t
         bool            bEnablePlugins;         // Enable the loading of ML plugins
         bool            bEnableMenu;            // Enable the menu system
         bool            bAutoRefresh;           // Enables automatic refreshing of mods
+        bool            bFastScan;              // Skips the directories unchanged since the last launch on the first scan
+        bool            bValidateFastScan;      // Checks the skipped directories against a full scan of them (for debugging)
 
         // Unique ids
         uint64_t        currentModId;           // Current id for the unique mod id
@@ -500,8 +566,15 @@ class Loader : public modloader_t
         // Modifications and Plugins
         FolderInformation               mods;               // All mods are contained on this folder
         ExtMap                          extMap;             // List of extensions and the plugins that takes care of it
+        behaviour_classifier<PluginInformation> classifier; // Behaviour rules of all plugins
+        std::vector<behaviour_classifier<PluginInformation>::match> rule_matches;  // Reused by FindHandlerForFile
         std::map<std::string, int>      plugins_priority;   // List of priorities to be applied to plugins
         std::list<PluginInformation>    plugins;            // List of plugins
+
+        // Scan Snapshot
+        ScanFilesystem                  scanfs;             // Filesystem used to scan the mods
+        scan_snapshot                   snapshot;           // Directory trees of the mods as found by their last scan
+        bool                            bWarmStart;         // The scans may reuse the snapshot from the last launch
         
         // Mod Profiles
         std::string modprof_cmd;    // -modprof <modname> received from command line (modname content)
@@ -528,7 +601,7 @@ class Loader : public modloader_t
 
         void NotifyUpdateForPlugins();
 
-        // Rebuilds the extMap object
+        // Rebuilds the extMap and classifier objects
         void RebuildExtensionMap();
         ref_list<PluginInformation> GetPluginsBy(const std::string& extension);
         
@@ -541,6 +614,8 @@ class Loader : public modloader_t
         void TestHotkeys();
         void ParseCommandLine();
         void BeforeFirstScan();
+        void LoadScanSnapshot();
+        void SaveScanSnapshot();
         void Tick();
 
     public:
@@ -600,11 +675,16 @@ class Loader : public modloader_t
             this->ShutdownWatcher();
         }
         
+        // Gets the information object from an element of a information container (either a map or a file_arena)
+        template<class P>
+        static auto MappedValue(P& pair) -> decltype((pair.second)) { return pair.second; }
+        static FileInformation& MappedValue(FileInformation& file)  { return file; }
+
         // Marks all status at the specified @map to @status
         template<class M>
         static void MarkStatus(M& map, Loader::Status status)
         {
-            for(auto& pair : map) pair.second.status = status;
+            for(auto& pair : map) MappedValue(pair).status = status;
         }
 
 
@@ -624,7 +704,7 @@ class Loader : public modloader_t
                 
                 for(auto& pair : map)
                 {
-                    if(pair.second.status != Status::Unchanged)   // status is Updated, Removed or so?
+                    if(MappedValue(pair).status != Status::Unchanged)   // status is Updated, Removed or so?
                     {
                         // Something changed here on this scan
                         info.status = Status::Updated;
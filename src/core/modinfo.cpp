@@ -51,15 +51,27 @@ void Loader::ModInformation::Scan()
     // Mark all current files as removed
     MarkStatus(this->files, Status::Removed);
 
-    // Scan the directory checking out all files
-    bool fine = this->IsIgnored()? true : FilesWalk("", "*.*", true, [this](FileWalkInfo& file)
+    // Path buffers reused for all the files found, the ones we keep get copied into the files arena
+    std::string filepath, filedir;
+    filepath.reserve(MAX_PATH);
+    filedir.reserve(MAX_PATH);
+
+    // The record of the file being scanned in the snapshot tree
+    scan_snapshot::record* record = nullptr;
+
+    // Checks out a file found in the directory
+    auto OnFile = [this, &filepath, &filedir, &record](FileWalkInfo& file)
     {
-        auto filename = NormalizePath(file.filename);
-        auto filedir  = NormalizePath(file.filebuf);
-        auto filepath = this->path + filedir;
+        filedir.assign(file.filebuf, file.length);
+        filedir.resize(NormalizePathInPlace(&filedir[0], filedir.length()));
+        filepath.assign(this->path).append(filedir);
 
+        if(filepath.length() > UINT16_MAX)
+        {
+            Log("Warning: Ignoring file \"%s\", its path is too long.", file.filebuf);
+        }
         // Nested Mod Loader folder...
-        if(!parent.Profile().IsFilePathIgnored(filedir))
+        else if(!parent.Profile().IsFilePathIgnored(filedir))
         {
             uint64_t uid;
             modloader::file m;
@@ -68,11 +80,17 @@ void Loader::ModInformation::Scan()
 
             // This buffer setup is tricky but should work fine
             m.buffer       = filepath.data();
-            m.pos_eos      = (uint8_t)(filepath.length());   // TODO make sure (len <= 255)?
-            m.pos_filedir  = (uint8_t)(this->path.length()); // ^ 
-            m.pos_filename = m.pos_filedir + (file.filename - file.filebuf);
-            m.pos_filext   = m.pos_filedir + (file.filext - file.filebuf);
-            m.hash         = modloader::hash(filepath.data() + m.pos_filename);
+            m.wpos_eos      = (uint16_t)(filepath.length());
+            m.wpos_filedir  = (uint16_t)(this->path.length());
+            m.wpos_filename = (uint16_t)(m.wpos_filedir + (file.filename - file.filebuf));
+            m.wpos_filext   = (uint16_t)(m.wpos_filedir + (file.filext - file.filebuf));
+            m.hash          = modloader::hash(filepath.data() + m.wpos_filename);
+
+            // The 8 bits positions of plugins built before 0.3.8 (not sent files whose path doesn't fit)
+            m.pos_eos      = (uint8_t)(m.wpos_eos);
+            m.pos_filedir  = (uint8_t)(m.wpos_filedir);
+            m.pos_filename = (uint8_t)(m.wpos_filename);
+            m.pos_filext   = (uint8_t)(m.wpos_filext);
             
             // Setup other information
             m._rsv1   = 0;
@@ -88,21 +106,28 @@ void Loader::ModInformation::Scan()
             {
                 file.recursive = false;     // Avoid FilesWalk recursion
                 
-                // Push the new file into our list
-                auto ipair = files.emplace( std::piecewise_construct,
-                                            std::forward_as_tuple(std::string(m.filedir())), 
-                                            std::forward_as_tuple(*this, std::move(filepath), m, handler, std::move(callme)));
-                
-                auto& n = ipair.first->second;
+                FileInformation* pn = files.find(m.filedir());
 
-                if(!ipair.second)
+                if(pn != nullptr)
                 {
                     // Update status checking if file changed
-                    n.status = n.Update(m)? Status::Updated : Status::Unchanged;
+                    pn->status = pn->Update(m)? Status::Updated : Status::Unchanged;
                 }
                 else
-                    n.status = Status::Added;
+                {
+                    // Push the new file into our list, with its path living in the files arena
+                    m.buffer = files.store_path(filepath.data(), filepath.length());
+                    pn = &files.emplace(*this, m, handler, std::move(callme));
+                    pn->status = Status::Added;
+                }
                 
+                auto& n = *pn;
+                if(n.handler)
+                {
+                    record->behaviour = n.behaviour;
+                    record->flags |= scan_snapshot::handled;
+                }
+
                 Log("Found file [0x%.16" PRIX64 "] \"%s\" with handler \"%s\"",
                         n.behaviour,
                         file.filebuf,
@@ -120,111 +145,144 @@ void Loader::ModInformation::Scan()
         }
         
         return true;
+    };
+
+    // Scan the directory checking out all files
+    bool fine = this->IsIgnored()? true : this->Walk([&record, &OnFile](scan_snapshot::record& r, bool& recursive)
+    {
+        FileWalkInfo file;
+        file.filebuf    = r.path.c_str();
+        file.filepath   = file.filebuf;
+        file.length     = r.path.length();
+        file.filename   = &file.filebuf[GetLastPathComponent(r.path)];
+        file.filext     = strrchr(file.filename, '.');
+        file.filext     = file.filext? file.filext + 1 : &file.filebuf[file.length];
+        file.is_dir     = (r.flags & scan_snapshot::is_dir) != 0;
+        file.size       = r.size;
+        file.time       = r.time;
+        file.recursive  = recursive;
+
+        record = &r;
+        r.flags &= ~scan_snapshot::handled;
+
+        bool result = OnFile(file);
+        recursive = file.recursive;
+        return result;
     });
     
     
     // Find the underlying status of this mod
     UpdateStatus(*this, this->files, fine);
-    if(this->UpdatePriority() && this->status == Status::Unchanged)
+    bool reprioritized = this->UpdatePriority();
+    if(reprioritized && this->status == Status::Unchanged)
         this->status = Status::Updated;
-}
 
+    // Remember what the next update must visit
+    this->MarkDirtyFiles(reprioritized);
+}
 
 /*
- *  ModInformation::ExtinguishingNecessaryFiles
- *      Uninstall anything that has the status Removed
- *      This is usually called after a Scan
- *      Returns the behaviours successfully UNINSTALLED by this call
+ *  ModInformation::Walk
+ *      Walks the directory tree of this mod (it must be the current directory), calling @cb for each file in it
+ *      On the first scan after the game launch the directories unchanged since the last launch may be taken from the snapshot
  */
-void Loader::ModInformation::ExtinguishNecessaryFiles()
+bool Loader::ModInformation::Walk(const scan_walker::callback& cb)
 {
-    if(this->status != Status::Unchanged)
+    bool enabled = (loader.bFastScan || loader.bValidateFastScan);
+
+    // The tree of the last scan of this mod, the new tree replaces it
+    scan_snapshot::tree prev, local;
+    auto it = loader.snapshot.trees.find(this->path);
+    if(it != loader.snapshot.trees.end())
     {
-        Updating xup;
-        bool logged_ex = false;
+        if(loader.bWarmStart) prev = std::move(it->second);
+        if(!enabled) loader.snapshot.trees.erase(it);
+    }
+
+    scan_snapshot::tree& next = enabled? loader.snapshot.trees[this->path] : local;
+    bool has_prev = !prev.records.empty();
+
+    scan_walker walker(loader.scanfs, loader.bFastScan && !loader.bValidateFastScan);
+    bool fine = walker.walk("", has_prev? &prev : nullptr, next, cb);
 
-        auto LogExtinguishing = [&](const char* filepath)
+    if(has_prev && walker.num_pruned())
+        Log("Reused %u unchanged directories from the last launch", (unsigned)(walker.num_pruned()));
+
+    // Check the fast scan against the full scan we just did
+    if(fine && has_prev && loader.bValidateFastScan)
+    {
+        std::unordered_map<std::string, uint32_t> flags;    // Flags of the records of the full scan, by path
+        for(auto& r : next.records) flags.emplace(r.path, r.flags);
+
+        scan_snapshot::tree warm;
+        scan_walker checker(loader.scanfs, true);
+        checker.walk("", &prev, warm, [&flags](scan_snapshot::record& r, bool& recursive)
         {
-            if(!logged_ex) Log("Extinguishing some files from \"%s\"...", this->path.c_str());
-            Log("Extinguishing file \"%s\"", filepath);
-            logged_ex = true;
-        };
+            auto it = flags.find(r.path);
+            if(it != flags.end()) recursive = (it->second & scan_snapshot::descended) != 0;
+            return true;
+        });
 
-        // Remove all files if this mod has been removed
-        bool bRemoveAll = (this->status == Status::Removed);
-        
-        // Finds all removed files in this mod and uninstall them
-        for (auto it = this->files.begin(); it != this->files.end(); )
+        size_t diffs = scan_walker::compare(next, warm, [](const std::string& path, const char* what)
         {
-            FileInformation& file = it->second;
-            BehvSet::value_type file_behv = { file.handler, file.behaviour };
-            bool was_installed = file.IsInstalled();
+            Log("Warning: Fast scan mismatch (%s) at \"%s\"", what, path.c_str());
+        });
 
-            if(bRemoveAll || file.status == Status::Removed)
-            {
-                // File was removed from the filesystem, uninstall and erase from our internal list
-                LogExtinguishing(file.filepath());
-                if(file.Uninstall())
-                {
-                    it = this->files.erase(it);
-                }
-                else
-                    ++it;
-            }
-            else
-                ++it;
-        }
+        Log("Fast scan validation: %u directories would be reused, %u mismatches", (unsigned)(checker.num_pruned()), (unsigned)(diffs));
     }
+
+    return fine;
 }
 
 /*
- *  ModInformation::InstallNecessaryFiles
- *      Installs / Reinstalls anything that has the status Added or Updated
- *      This is usually called after a Scan and an UninstallNecessaryFiles
+ *  ModInformation::MarkDirtyFiles
+ *      Finds the files the next update must visit (the ones changed by the last scan or waiting to be installed)
+ *      and marks this mod as dirty on the parent folder if there's anything to be done on it.
+ *      When this mod got another priority (@reprioritized) the files which lost to its files must be arbitrated again.
  */
-void Loader::ModInformation::InstallNecessaryFiles()
+void Loader::ModInformation::MarkDirtyFiles(bool reprioritized)
 {
-    if(this->IsIgnored() == false)
-    {
-        Updating xup;
-        Log(this->files.size()? "Updating state for \"%s\"..." : "No files in \"%s\"...", this->path.c_str());
+    dirty_update<ModInformation, FileInformation>::mark_dirty_files(*this, reprioritized);
+}
 
-        // Helper closure... Installs taking care of other installed priorities.
-        auto TryInstall = [](FileInformation& file)
-        {
-            FileInformation* installed;
-            if(file.handler
-            && (installed = file.handler->FindFileWithBehaviour(file.behaviour))
-            && (SimplePriorityPred<ModInformation>()(file.parent, installed->parent) == true))
-            {
-                // Don't install, the currently installed file has priority over this one
-            }
-            else
-            {
-                // Install, either there's no file installed with this behaviour or this file has
-                // priority over the installed one
-                file.Install();
-            }
-        };
+/*
+ *  ModInformation::MarkDirtyFile
+ *      Marks the @file (which was not dirty) to be visited by the next update, as well as this mod on the parent folder
+ */
+void Loader::ModInformation::MarkDirtyFile(FileInformation& file)
+{
+    dirty_update<ModInformation, FileInformation>::mark_dirty_file(*this, file);
+}
 
-        for (auto it = this->files.begin(); it != this->files.end(); ++it)
-        {
-            FileInformation& file = it->second;
 
-            if(file.status == Status::Added || file.status == Status::Updated)
-            {
-                if(file.installed)
-                    file.Reinstall();
-                else
-                    TryInstall(file);
-            }
-            else if(file.status == Status::Unchanged)
-            {
-                if(file.handler && !file.installed)
-                    TryInstall(file);
-            }
-        }
-    }
+/*
+ *  UpdateHooks
+ *      Logging and commits of the steps of a folder update
+ */
+bool Loader::UpdateHooks::less(const ModInformation& a, const ModInformation& b) const
+{
+    return PriorityPred<ModInformation>()(a, b);
+}
+
+void Loader::UpdateHooks::extinguishing(ModInformation& mod, FileInformation& file, bool first)
+{
+    if(first) Log("Extinguishing some files from \"%s\"...", mod.path.c_str());
+    Log("Extinguishing file \"%s\"", file.filepath());
+}
+
+void Loader::UpdateHooks::updating(ModInformation& mod)
+{
+    Log(mod.files.size()? "Updating state for \"%s\"..." : "No files in \"%s\"...", mod.path.c_str());
+}
+
+void Loader::UpdateHooks::blocked(FileInformation& file)
+{
+    FileInstallLog xlog(file, "Install");
+}
+
+void Loader::UpdateHooks::commit(InstallBatch& batch)
+{
+    FileInformation::Commit(batch);
 }
 
 /*
@@ -357,3 +415,55 @@ bool Loader::FileInformation::Uninstall()
     this->status = Status::Unchanged;
     return !this->installed;
 }
+
+/*
+ *  FileInformation::Commit
+ *      Installs, reinstalls or uninstalls all the files in the @batch, whose plugins must be the main handlers of the files.
+ *      Each main handler receives all its files at once, then the callme handlers receive the files their main handler took.
+ */
+void Loader::FileInformation::Commit(InstallBatch& batch)
+{
+    if(batch.empty())
+        return;
+
+    Updating xup;
+    InstallBatch callme;
+    static const char* actions[] = { "Uninstall", "Reinstall", "Install" };   // by InstallBatch::action
+
+    for(auto& op : batch)
+    {
+        FileInformation& file = *op.file;
+        Log("%sing file \"%s\"", actions[size_t(op.act)], file.filepath());
+
+        // Make sure file is in the right state, otherwise something is very wrong
+        if(file.installed != (op.act != InstallBatch::action::install))
+            FatalError("%s failed because file is %s installed", actions[size_t(op.act)], file.installed? "already" : "not");
+        if(op.plugin && op.act != InstallBatch::action::install)
+            op.plugin->EnsureBehaviourPresent(file);
+    }
+
+    // Install with the main handlers...
+    PluginInformation::Dispatch(batch);
+
+    for(auto& op : batch)
+    {
+        FileInformation& file = *op.file;
+        bool done = op.plugin? op.plugin->Complete(op.act, file, op.result) : true;
+        file.installed = (op.act == InstallBatch::action::uninstall)? !done : done;
+
+        if(done)
+        {
+            for(auto& p : file.callme) callme.add(&p.get(), op.act, file);
+        }
+
+        if(file.installed == (op.act == InstallBatch::action::uninstall))
+            Log("Failed to %s file \"%s\"", actions[size_t(op.act)], file.filepath());
+
+        // Refresh state (removed files keep their status until collected)
+        if(file.status != Status::Removed)
+            file.status = Status::Unchanged;
+    }
+
+    // ...then with callme handlers
+    PluginInformation::Dispatch(callme);
+}
@@ -121,11 +121,12 @@ bool Loader::LoadPlugin(std::string filename)
         Log("Loading plugin module \"%s\"", modulename);
         auto GetLoaderVersion = (modloader_fGetLoaderVersion) GetProcAddress(module, "GetLoaderVersion");
         auto GetPluginData = (modloader_fGetPluginData) GetProcAddress(module, "GetPluginData");
+        auto GetPluginDataEx = (modloader_fGetPluginDataEx) GetProcAddress(module, "GetPluginDataEx");
 
         if(ValidateVersion(GetLoaderVersion))
         {
             // Allocate a new plugin information structure
-            this->plugins.emplace_back(module, modulename, GetPluginData);
+            this->plugins.emplace_back(module, modulename, GetPluginData, GetPluginDataEx);
             PluginInformation& data = this->plugins.back();
 
             // Validate plugin to make sure it' ok to run it
@@ -200,12 +201,13 @@ bool Loader::StartupPlugin(PluginInformation& plugin)
 
 /*
  * Loader::RebuildExtensionMap
- *      Builds the extension optimization table
+ *      Builds the extension optimization table and compiles the plugins behaviour rules
  */
 void Loader::RebuildExtensionMap()
 {
     // Clear the map and rebuild it
     extMap.clear();
+    classifier.clear();
     
     for(auto& plugin : this->plugins)
     {
@@ -214,6 +216,9 @@ void Loader::RebuildExtensionMap()
             for(auto i = 0u; i < plugin.extable_len; ++i)
                 extMap[plugin.extable[i]].emplace_back(plugin);
         }
+
+        if(plugin.ex.rules)
+            classifier.add(plugin, plugin.ex.rules, plugin.ex.rules_len);
     }
 }
 
@@ -242,9 +247,21 @@ bool Loader::PluginInformation::Shutdown()
 
 Loader::BehaviourType Loader::PluginInformation::FindBehaviour(modloader::file& m)
 {
+    // Plugins built before 0.3.8 only know the 8 bits path positions, which can't address longer paths
+    if(m.wpos_eos > UINT8_MAX && this->major == 0 && (this->minor < 3 || (this->minor == 3 && this->revision < 8)))
+        return BehaviourType::No;
     return GetBehaviour? (BehaviourType) (GetBehaviour(this, &m)) : BehaviourType::No;
 }
 
+Loader::BehaviourType Loader::PluginInformation::FindBehaviour(modloader::file& m, const std::vector<behaviour_classifier<PluginInformation>::match>& matches)
+{
+    if(auto match = behaviour_classifier<PluginInformation>::find(matches, *this))
+        return (BehaviourType) behaviour_classifier<PluginInformation>::apply(*match->rule, m);
+    else if(this->ex.rules_only && this->ex.rules)
+        return BehaviourType::No;
+    return this->FindBehaviour(m);
+}
+
 bool Loader::PluginInformation::InstallFile(const modloader::file& m)
 {
     return base::InstallFile? !base::InstallFile(this, &m) : false;
@@ -276,6 +293,56 @@ Loader::FileInformation* Loader::PluginInformation::FindFileWithBehaviour(uint64
     return it != behv.end() ? it->second : nullptr;
 }
 
+/*
+ *  PluginInformation::AddWaiting
+ *      Puts the @file, which lost the arbitration for it's behaviour to an installed file, to wait for the behaviour to be vacated
+ */
+void Loader::PluginInformation::AddWaiting(FileInformation& file)
+{
+    if(!file.waiting)
+    {
+        waiting.emplace(file.behaviour, &file);
+        file.waiting = true;
+    }
+}
+
+/*
+ *  PluginInformation::RemoveWaiting
+ *      Stops the @file from waiting for it's behaviour to be vacated
+ */
+void Loader::PluginInformation::RemoveWaiting(FileInformation& file)
+{
+    if(file.waiting)
+    {
+        auto range = waiting.equal_range(file.behaviour);
+        for(auto it = range.first; it != range.second; ++it)
+        {
+            if(it->second == &file)
+            {
+                waiting.erase(it);
+                break;
+            }
+        }
+        file.waiting = false;
+    }
+}
+
+/*
+ *  PluginInformation::WakeWaiting
+ *      The file installed with the @behaviour went away, the files waiting for it must be visited by the next update
+ */
+void Loader::PluginInformation::WakeWaiting(uint64_t behaviour)
+{
+    auto range = waiting.equal_range(behaviour);
+    for(auto it = range.first; it != range.second; )
+    {
+        FileInformation& file = *it->second;
+        it = waiting.erase(it);
+        file.waiting = false;
+        file.parent.MarkDirtyFile(file);
+    }
+}
+
 
 /*
  *  PluginInformation::Install 
@@ -291,19 +358,9 @@ bool Loader::PluginInformation::Install(FileInformation& file)
             if(!old->Uninstall())
                 return false;
         }
-
-        if(this->InstallFile(file))
-        {
-            // Assign this file to it's behaviour
-            if(!behv.emplace(file.behaviour, &file).second)
-                FatalError("Behaviour emplace didn't took place at Install");
-            return true;
-        }
     }
-    else // not main handler but a callme
-        return this->InstallFile(file);
 
-    return false;
+    return this->Complete(InstallBatch::action::install, file, this->InstallFile(file));
 }
 
 /*
@@ -313,18 +370,8 @@ bool Loader::PluginInformation::Install(FileInformation& file)
 bool Loader::PluginInformation::Uninstall(FileInformation& file)
 {
     if(this->IsMainHandlerFor(file))
-    {
-        if(this->EnsureBehaviourPresent(file) && this->UninstallFile(file))
-        {
-            behv.erase(file.behaviour);
-            return true;
-        }
-        return false;
-    }
-    else // not main handler but a callme
-        return this->UninstallFile(file);
-
-    return false;
+        this->EnsureBehaviourPresent(file);
+    return this->Complete(InstallBatch::action::uninstall, file, this->UninstallFile(file));
 }
 
 /*
@@ -332,22 +379,81 @@ bool Loader::PluginInformation::Uninstall(FileInformation& file)
  *      Reinstalls the specified @file using this plugin.
  */
 bool Loader::PluginInformation::Reinstall(FileInformation& file)
+{
+    if(this->IsMainHandlerFor(file))
+        this->EnsureBehaviourPresent(file);
+    return this->Complete(InstallBatch::action::reinstall, file, this->ReinstallFile(file));
+}
+
+/*
+ *  PluginInformation::Complete 
+ *      Updates the behaviours handled by this plugin after the @action on the @file, which gave the @result.
+ *      Returns whether the action took place.
+ */
+bool Loader::PluginInformation::Complete(InstallBatch::action action, FileInformation& file, bool result)
 {
     if(this->IsMainHandlerFor(file))
     {
-        if(this->EnsureBehaviourPresent(file) && this->ReinstallFile(file))
-            return true;
+        switch(action)
+        {
+            case InstallBatch::action::install:
+                // Assign this file to it's behaviour
+                if(result && !behv.emplace(file.behaviour, &file).second)
+                    FatalError("Behaviour emplace didn't took place at Install");
+                return result;
+
+            case InstallBatch::action::uninstall:
+                if(result)
+                {
+                    behv.erase(file.behaviour);
+                    this->WakeWaiting(file.behaviour);
+                }
+                return result;
 
-        // Somehow we failed to Reinstall, so Uninstall it instead.
-        ::loader.Log("Warning: Failed to reinstall file '%s', uninstalling it instead...", file.filepath());
-        if(file.Uninstall())
-            return false;   // not installed anymore
-        return true;    // still installed
+            case InstallBatch::action::reinstall:
+                if(result) return true;
+
+                // Somehow we failed to Reinstall, so Uninstall it instead.
+                ::loader.Log("Warning: Failed to reinstall file '%s', uninstalling it instead...", file.filepath());
+                if(file.Uninstall())
+                    return false;   // not installed anymore
+                return true;    // still installed
+        }
+        return false;
     }
     else // not main handler but a callme
-        return this->ReinstallFile(file);
+        return result;
+}
 
-    return false;
+/*
+ *  PluginInformation::Dispatch 
+ *      Sends the files in the @batch to their plugins.
+ *      Plugins with a BatchFiles callback receive all their files in a single call, the others receive them one by one.
+ */
+void Loader::PluginInformation::Dispatch(InstallBatch& batch)
+{
+    auto HasBatch = [](PluginInformation& plugin)
+    {
+        return plugin.ex.BatchFiles != nullptr;
+    };
+
+    auto CallBatch = [](PluginInformation& plugin, modloader_batch_t& files)
+    {
+        plugin.ex.BatchFiles(&plugin, &files);
+    };
+
+    auto CallFile = [](PluginInformation& plugin, InstallBatch::action action, FileInformation& file) -> bool
+    {
+        switch(action)
+        {
+            case InstallBatch::action::install:     return plugin.InstallFile(file);
+            case InstallBatch::action::reinstall:   return plugin.ReinstallFile(file);
+            case InstallBatch::action::uninstall:   return plugin.UninstallFile(file);
+        }
+        return false;
+    };
+
+    batch.dispatch(HasBatch, CallBatch, CallFile);
 }
 
 /*
@@ -238,7 +238,7 @@ bool Loader::Profile::IsExcluded(const std::string& name) const
  */
 bool Loader::Profile::IsFilePathIgnored(const std::string& path) const
 {
-    const char* filename = &path[GetLastPathComponent(path)];
+    const char* filename = &path[GetLastPathComponent(path_view(path))];
     return this->CallHierarchy(true, [&filename, &path](const Profile& profile) {
         if(MatchWildcards(filename, profile.ignore_files)
         || MatchWildcards(path, profile.ignore_files))
@@ -431,7 +431,7 @@ std::vector<std::string> Loader::Profile::GetProfileComps(const std::string& ini
 void Loader::Profile::LoadConfigFromINI(const modloader_ini& ini)
 {
     // Reads the top [Profiles.ProfileName.Config] section
-    auto ReadConfig = [this](const linb::ini::key_container& kv)
+    auto ReadConfig = [this](const modloader_ini::key_container& kv)
     {
         // NOTE: Assumes Profile object is clear!!!!!!!!!!!!!!!!!!!!!!
         for(auto& pair : kv)
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#include <stdinc.hpp>
+#include "loader.hpp"
+using namespace modloader;
+
+/*
+ *  ScanFilesystem::list
+ *      Lists the entries in the directory @dir, the same way FilesWalk does
+ */
+bool Loader::ScanFilesystem::list(const std::string& dir, std::vector<entry>& out)
+{
+    WIN32_FIND_DATAA fd;
+    HANDLE hSearch;
+
+    if((hSearch = FindFirstFileA((dir + "*.*").c_str(), &fd)) == INVALID_HANDLE_VALUE)
+        return false;
+
+    do
+    {
+        //  Ignore files beggining with '.' (including "." & "..")
+        if(fd.cFileName[0] != '.' && fd.cFileName[0] != '*')
+        {
+            entry e;
+            e.name   = fd.cFileName;
+            e.is_dir = (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+            e.size   = GetLongFromLargeInteger(fd.nFileSizeLow, fd.nFileSizeHigh);
+            e.time   = GetLongFromLargeInteger(fd.ftLastWriteTime.dwLowDateTime, fd.ftLastWriteTime.dwHighDateTime);
+            out.emplace_back(std::move(e));
+        }
+    }
+    while(FindNextFileA(hSearch, &fd));
+
+    FindClose(hSearch);
+    return true;
+}
+
+/*
+ *  ScanFilesystem::time
+ *      Gets the modification time of the directory @dir, the same way list gives it
+ */
+bool Loader::ScanFilesystem::time(const std::string& dir, uint64_t& out)
+{
+    WIN32_FILE_ATTRIBUTE_DATA fa;
+    if(!GetFileAttributesExA(dir.substr(0, dir.size() - 1).c_str(), GetFileExInfoStandard, &fa)
+    || !(fa.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+        return false;
+
+    out = GetLongFromLargeInteger(fa.ftLastWriteTime.dwLowDateTime, fa.ftLastWriteTime.dwHighDateTime);
+    return true;
+}
+
+/*
+ *  ScanFilesystem::read
+ *      Reads the entire file at @path into @out
+ */
+bool Loader::ScanFilesystem::read(const std::string& path, std::string& out)
+{
+    bool result = false;
+    if(FILE* f = fopen(path.c_str(), "rb"))
+    {
+        char buffer[4096];
+        size_t n;
+
+        out.clear();
+        while((n = fread(buffer, 1, sizeof(buffer), f)) != 0)
+            out.append(buffer, n);
+
+        result = !ferror(f);
+        fclose(f);
+    }
+    return result;
+}
+
+/*
+ *  ScanFilesystem::write
+ *      Writes @data into the file at @path, replacing its content
+ */
+bool Loader::ScanFilesystem::write(const std::string& path, const std::string& data)
+{
+    bool result = false;
+    if(FILE* f = fopen(path.c_str(), "wb"))
+    {
+        result = (fwrite(data.data(), 1, data.size(), f) == data.size());
+        result = (fclose(f) == 0) && result;
+    }
+    return result;
+}
+
+
+/*
+ *  Loader::LoadScanSnapshot
+ *       Loads the directory trees found by the scans of the last launch
+ */
+void Loader::LoadScanSnapshot()
+{
+    this->bWarmStart = false;
+    if(this->bFastScan || this->bValidateFastScan)
+    {
+        if(this->snapshot.load(this->scanfs, gamePath + dataPath + "scan.snapshot"))
+        {
+            Log("Loaded scan snapshot with %u mods", (unsigned)(this->snapshot.trees.size()));
+            this->bWarmStart = true;
+        }
+        else
+            Log("No scan snapshot from the last launch, doing a full scan");
+    }
+}
+
+/*
+ *  Loader::SaveScanSnapshot
+ *       Saves the directory trees found by the last scans, for use on the next launch
+ */
+void Loader::SaveScanSnapshot()
+{
+    if(this->bFastScan || this->bValidateFastScan)
+    {
+        // Forget the mods that aren't there anymore
+        std::set<std::string> present;
+        for(auto& mod : this->mods.mods)
+        {
+            if(mod.second.status != Status::Removed && !mod.second.IsIgnored())
+                present.emplace(mod.second.GetPath());
+        }
+
+        for(auto it = this->snapshot.trees.begin(); it != this->snapshot.trees.end(); )
+        {
+            if(present.count(it->first)) ++it;
+            else it = this->snapshot.trees.erase(it);
+        }
+
+        if(!this->snapshot.save(this->scanfs, gamePath + dataPath + "scan.snapshot"))
+            Log("Warning: Failed to save the scan snapshot");
+    }
+
+    // The directories may change while the game runs, so don't trust the snapshot anymore
+    this->bWarmStart = false;
+}
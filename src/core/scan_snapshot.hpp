@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#pragma once
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <functional>
+
+/*
+ *  scan_filesystem
+ *      The filesystem as seen by the mods scan.
+ *      Paths are relative to whatever the implementation wants, directories are separated and ended by a backslash.
+ */
+class scan_filesystem
+{
+    public:
+        struct entry
+        {
+            std::string name;       // Filename, without the directory
+            bool        is_dir;
+            uint64_t    size;       // Size in bytes (zero for directories)
+            uint64_t    time;       // Modification time
+        };
+
+        virtual ~scan_filesystem() {}
+
+        // Lists the entries in the directory @dir (the ones beggining with '.' are ignored), returns false on failure
+        virtual bool list(const std::string& dir, std::vector<entry>& out) = 0;
+
+        // Gets the modification time of the directory @dir (ended by a backslash), returns false on failure
+        virtual bool time(const std::string& dir, uint64_t& out) = 0;
+
+        // Reads the entire file at @path into @out
+        virtual bool read(const std::string& path, std::string& out) = 0;
+
+        // Writes @data into the file at @path, replacing its content
+        virtual bool write(const std::string& path, const std::string& data) = 0;
+};
+
+
+/*
+ *  scan_snapshot
+ *      The directory trees found by the last scan of each mod, persisted between game launches.
+ *
+ *      Each tree is a list of records in depth first order (a directory is followed by the records inside it),
+ *      so the records inside a directory are a contiguous range and can be skipped or reused at once.
+ *      On disk only the names are stored, the paths are rebuilt from the tree structure.
+ */
+class scan_snapshot
+{
+    public:
+        enum : uint32_t
+        {
+            is_dir      = 1,        // The record is a directory
+            descended   = 2,        // The records inside this directory are present (it wasn't handled as a file)
+            handled     = 4,        // The record has a handler, 'behaviour' is its behaviour
+        };
+
+        struct record
+        {
+            std::string path;           // Path relative to the root of the tree
+            uint64_t    size;
+            uint64_t    time;
+            uint64_t    behaviour;      // Behaviour given to the file by the scan (if handled)
+            uint32_t    flags;
+            uint32_t    children;       // Directories only: number of entries listed in it
+            uint32_t    descendants;    // Directories only: number of records after this one which are inside it
+        };
+
+        struct tree
+        {
+            uint32_t            children = 0;   // Number of entries listed in the root
+            std::vector<record> records;
+        };
+
+        std::map<std::string, tree> trees;      // By the root path
+
+    private:
+        std::string stored;                     // Binary representation last loaded from or saved into the disk
+
+    public:
+        // Builds the binary representation of this snapshot
+        std::string serialize() const
+        {
+            std::string out;
+            out.append(magic(), magic_size);
+            put(out, uint32_t(version));
+            put(out, uint32_t(trees.size()));
+            for(auto& pair : trees)
+            {
+                put(out, pair.first);
+                put(out, pair.second.children);
+                put(out, uint32_t(pair.second.records.size()));
+                for(auto& r : pair.second.records)
+                {
+                    size_t slash = r.path.find_last_of('\\', r.path.size() - 1);
+                    put(out, slash == r.path.npos? r.path : r.path.substr(slash + 1));
+                    put(out, r.size);
+                    put(out, r.time);
+                    put(out, r.behaviour);
+                    put(out, r.flags);
+                    put(out, r.children);
+                    put(out, r.descendants);
+                }
+            }
+            return out;
+        }
+
+        // Loads this snapshot from the binary @data built by serialize(), returns false if it is malformed or outdated
+        bool deserialize(const std::string& data)
+        {
+            const char* p   = data.data();
+            const char* end = p + data.size();
+            uint32_t ver, ntrees;
+
+            this->trees.clear();
+            if(data.size() < magic_size || memcmp(p, magic(), magic_size))
+                return false;
+            p += magic_size;
+
+            if(!get(p, end, ver) || ver != version || !get(p, end, ntrees))
+                return false;
+
+            for(uint32_t t = 0; t < ntrees; ++t)
+            {
+                std::string root;
+                uint32_t nrecords;
+                tree tr;
+
+                if(!get(p, end, root) || !get(p, end, tr.children) || !get(p, end, nrecords))
+                    return false;
+                if(nrecords > size_t(end - p))  // each record takes more than a byte, so don't trust a huge count
+                    return false;
+
+                // Directories whose records are still being read, by the index of their last record
+                std::vector<std::pair<size_t, const record*>> dirs;
+
+                tr.records.resize(nrecords);
+                for(uint32_t i = 0; i < nrecords; ++i)
+                {
+                    record& r = tr.records[i];
+                    std::string name;
+                    if(!get(p, end, name) || !get(p, end, r.size) || !get(p, end, r.time) || !get(p, end, r.behaviour)
+                    || !get(p, end, r.flags) || !get(p, end, r.children) || !get(p, end, r.descendants))
+                        return false;
+
+                    while(!dirs.empty() && dirs.back().first < i)
+                        dirs.pop_back();
+
+                    r.path = dirs.empty()? std::move(name) : dirs.back().second->path + '\\' + name;
+
+                    if(r.descendants)
+                    {
+                        if(!(r.flags & is_dir) || r.descendants > nrecords - i - 1
+                        || (!dirs.empty() && i + r.descendants > dirs.back().first))
+                            return false;
+                        dirs.emplace_back(i + r.descendants, &r);
+                    }
+                }
+
+                this->trees.emplace(std::move(root), std::move(tr));
+            }
+
+            return p == end;
+        }
+
+        // Loads this snapshot from the file at @path in the filesystem @fs
+        bool load(scan_filesystem& fs, const std::string& path)
+        {
+            std::string data;
+            if(fs.read(path, data) && deserialize(data))
+            {
+                this->stored = std::move(data);
+                return true;
+            }
+            this->trees.clear();
+            this->stored.clear();
+            return false;
+        }
+
+        // Saves this snapshot into the file at @path in the filesystem @fs
+        // The file is written only if the snapshot changed since it was last loaded from or saved into it
+        bool save(scan_filesystem& fs, const std::string& path)
+        {
+            std::string data = serialize();
+            if(data == this->stored)
+                return true;
+            if(!fs.write(path, data))
+                return false;
+            this->stored = std::move(data);
+            return true;
+        }
+
+    private:
+        static const char* magic()  { return "MLSCAN\0\0"; }
+        static const size_t magic_size = 8;
+        static const uint32_t version = 1;
+
+        template<class T>
+        static void put(std::string& out, T value)
+        {
+            out.append((const char*)(&value), sizeof(value));
+        }
+
+        static void put(std::string& out, const std::string& s)
+        {
+            put(out, uint32_t(s.size()));
+            out.append(s);
+        }
+
+        template<class T>
+        static bool get(const char*& p, const char* end, T& value)
+        {
+            if(size_t(end - p) < sizeof(value)) return false;
+            memcpy(&value, p, sizeof(value));
+            p += sizeof(value);
+            return true;
+        }
+
+        static bool get(const char*& p, const char* end, std::string& s)
+        {
+            uint32_t len;
+            if(!get(p, end, len) || size_t(end - p) < len) return false;
+            s.assign(p, len);
+            p += len;
+            return true;
+        }
+};
+
+/*
+ *  scan_walker
+ *      Walks a directory tree building its scan_snapshot::tree, reusing the tree from the previous scan when possible.
+ *
+ *      When pruning is enabled, a directory whose modification time didn't change since the previous scan isn't listed,
+ *      its records are taken from the previous tree instead. The times of the directories inside it are asked one by one,
+ *      since a change deep in the tree touches only the time of the directory right above it.
+ *      Files changed in place inside such directories can't be noticed, since that doesn't touch the directory time.
+ *      The number of entries of the listed directories is checked against the previous tree as well, if a directory
+ *      changed its entries but not its time the filesystem doesn't keep track of directory times, so pruning gets disabled.
+ */
+class scan_walker
+{
+    public:
+        // Called for each record with the record and whether to walk into it (for directories), returns false to stop
+        using callback = std::function<bool(scan_snapshot::record&, bool& recursive)>;
+
+        scan_walker(scan_filesystem& fs, bool prune)
+            : fs(fs), prune(prune), pruned(0), listed(0)
+        {}
+
+        // Walks the directory @root (ended by a backslash) into @next, using the @prev tree from the previous scan (may be null)
+        // Returns false if the root couldn't be listed or the callback stopped the walk
+        bool walk(const std::string& root, const scan_snapshot::tree* prev, scan_snapshot::tree& next, const callback& cb)
+        {
+            const scan_snapshot::record* first = prev? prev->records.data() : nullptr;
+            const scan_snapshot::record* last  = prev? prev->records.data() + prev->records.size() : nullptr;
+
+            this->root = root;
+            next.records.clear();
+            next.children = 0;
+            return walk_dir(std::string(), first, last, false, prev? &prev->children : nullptr, next, cb, next.children);
+        }
+
+        // Compares the @full tree against the @warm tree, calling @diff(path, what) for each difference found
+        // The records must have the same paths (in the same order), sizes, times, types and behaviours
+        static size_t compare(const scan_snapshot::tree& full, const scan_snapshot::tree& warm,
+                              const std::function<void(const std::string&, const char*)>& diff)
+        {
+            std::unordered_map<std::string, const scan_snapshot::record*> index;
+            size_t count = 0;
+
+            for(auto& r : warm.records)
+                index.emplace(lower(r.path), &r);
+
+            for(auto& r : full.records)
+            {
+                auto it = index.find(lower(r.path));
+                const char* what = nullptr;
+
+                if(it == index.end())
+                    what = "missing";
+                else if((it->second->flags & scan_snapshot::is_dir) != (r.flags & scan_snapshot::is_dir))
+                    what = "type";
+                else if(it->second->size != r.size || it->second->time != r.time)
+                    what = "changed";
+                else if((it->second->flags & scan_snapshot::handled) != (r.flags & scan_snapshot::handled)
+                     || ((r.flags & scan_snapshot::handled) && it->second->behaviour != r.behaviour))
+                    what = "behaviour";
+
+                if(it != index.end()) index.erase(it);
+                if(what) diff(r.path, what), ++count;
+            }
+
+            for(auto& r : warm.records)
+            {
+                if(index.count(lower(r.path)))
+                    diff(r.path, "stale"), ++count;
+            }
+
+            return count;
+        }
+
+        size_t num_pruned() const { return pruned; }    // Number of directories not listed by the walks
+        size_t num_listed() const { return listed; }    // Number of directories listed by the walks
+
+    private:
+        using record = scan_snapshot::record;
+
+        // Walks the directory @dir (relative to the root, empty or ended by a backslash), whose records on the previous scan are
+        // the ones in [@first, @last), taking its entries from those records if @reuse is true
+        // @expect is the number of entries of this directory on the previous scan if its time didn't change (may be null)
+        bool walk_dir(const std::string& dir, const record* first, const record* last, bool reuse, const uint32_t* expect,
+                      scan_snapshot::tree& next, const callback& cb, uint32_t& children)
+        {
+            std::vector<scan_filesystem::entry> entries;
+            std::unordered_map<std::string, const record*> old;     // Records right inside this directory, by lower case name
+
+            for(const record* r = first; r != last; r += 1 + r->descendants)
+            {
+                if(reuse)
+                {
+                    scan_filesystem::entry e = { r->path.substr(dir.size()), (r->flags & scan_snapshot::is_dir) != 0, r->size, r->time };
+                    entries.emplace_back(std::move(e));
+                }
+                old.emplace(lower(r->path.substr(dir.size())), r);
+            }
+
+            if(reuse)
+            {
+                // The times of the directories inside aren't known without listing, ask for them
+                for(auto& e : entries)
+                {
+                    if(e.is_dir && !fs.time(this->root + dir + e.name + '\\', e.time))
+                    {
+                        reuse = false;      // gone, list it after all
+                        entries.clear();
+                        break;
+                    }
+                }
+            }
+
+            if(reuse)
+            {
+                ++this->pruned;
+            }
+            else
+            {
+                ++this->listed;
+                if(!fs.list(this->root + dir, entries))
+                    return false;
+
+                if(expect && *expect != entries.size() && this->prune)
+                {
+                    this->prune = false;    // Directory times can't be trusted, its entries changed but its time didn't
+                }
+            }
+
+            children = uint32_t(entries.size());
+            for(auto& e : entries)
+            {
+                size_t index = next.records.size();
+                record r = { dir + e.name, e.size, e.time, 0, e.is_dir? uint32_t(scan_snapshot::is_dir) : 0, 0, 0 };
+                bool recursive = e.is_dir;
+
+                auto it = old.find(lower(e.name));
+                const record* prev = (it != old.end() && (it->second->flags & scan_snapshot::is_dir) == r.flags)? it->second : nullptr;
+
+                if(prev)
+                {
+                    // Keep what the previous scan found about it, in case the callback doesn't find it out again
+                    r.behaviour = prev->behaviour;
+                    r.flags    |= prev->flags & scan_snapshot::handled;
+                }
+
+                next.records.emplace_back(std::move(r));
+                if(!cb(next.records[index], recursive))
+                    return false;
+
+                if(e.is_dir && recursive)
+                {
+                    bool same = prev && prev->time == e.time;
+                    bool has_childs = prev && (prev->flags & scan_snapshot::descended);
+                    uint32_t subchildren;
+
+                    if(!walk_dir(next.records[index].path + '\\',
+                                 has_childs? prev + 1 : nullptr, has_childs? prev + 1 + prev->descendants : nullptr,
+                                 this->prune && same && has_childs, (same && has_childs)? &prev->children : nullptr,
+                                 next, cb, subchildren))
+                        return false;
+
+                    next.records[index].flags      |= scan_snapshot::descended;
+                    next.records[index].children    = subchildren;
+                    next.records[index].descendants = uint32_t(next.records.size() - index - 1);
+                }
+            }
+
+            return true;
+        }
+
+        static std::string lower(std::string s)
+        {
+            for(auto& c : s) c = char(::tolower(uint8_t(c)));
+            return s;
+        }
+
+    private:
+        scan_filesystem&    fs;
+        std::string         root;
+        bool                prune;
+        size_t              pruned;
+        size_t              listed;
+};
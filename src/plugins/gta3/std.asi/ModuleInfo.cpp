@@ -9,6 +9,8 @@
 #include <stdinc.hpp>
 #include "asi.h"
 #include "args_translator/translator.hpp"
+#include "args_translator/translator_registry.hpp"
+#include "pe_imports.hpp"
 #include <tlhelp32.h>
 
 using namespace modloader;
@@ -268,28 +270,36 @@ path_translator_base* ThePlugin::ModuleInfo::FindTranslatorFrom(const char* symb
 
 
 /*
- *  Get the singletoned arg translators list
+ *  Get the singletoned arg translators registry
  */
-static path_translator_base::list_type& GetTranslators()
+static translator_registry<path_translator_base>& GetTranslators()
 {
+    static translator_registry<path_translator_base> registry;
+
     // Initialization time is done...
     if(path_translator_base::InitializationDone() == false)
     {
         // Mark as done
         path_translator_base::InitializationDone() = true;
 
-        // Sort the list by library/symbol
-        auto& list = path_translator_base::List();
-        std::sort(list.begin(), list.end(), [](path_translator_base* a, path_translator_base* b)
+        // Index the list by library/symbol
+        registry.build(path_translator_base::List());
+    }
+
+    // We need the address of the translated functions since some linkers (the Borland Linker)
+    // doesn't produce a ILT
+    if(registry.has_addresses() == false)
+    {
+        registry.build_addresses([](path_translator_base* x) -> uintptr_t
         {
-            int x = strcmp(a->GetLibName(), b->GetLibName(), false);
-            if(x == 0) x = strcmp(a->GetSymbol(), b->GetSymbol());
-            return x < 0;
+            if(auto module = GetModuleHandleA(x->GetLibName()))
+                return (uintptr_t) GetProcAddress(module, x->GetSymbol());
+            return 0;
         });
     }
-    
+
     //
-    return path_translator_base::List();
+    return registry;
 }
 
 
@@ -299,114 +309,38 @@ static path_translator_base::list_type& GetTranslators()
  */
 void ThePlugin::ModuleInfo::PatchImports()
 {
-    // Converts a rva pointer to a actual pointer in the process space from this ASI
-    auto rva_to_ptr = [this](long rva)
-    { return auto_pointer((void*)((char*)(this->module) + rva)); };
-    
-    // Used to find translators lowerbound at a sorted list of translators by library name
-    auto fn_compare_translator_with_lib_lb = [](path_translator_base* a, const char* b)
-    {
-        return strcmp(a->GetLibName(), b, false) < 0;
-    };
-
-    // Used to find translators upperbound at a sorted list of translators by library name
-    auto fn_compare_translator_with_lib_ub = [](const char* a, path_translator_base* b)
-    {
-        return strcmp(a, b->GetLibName(), false) < 0;
-    };
+    // Get the singletoned translators
+    auto& registry = GetTranslators();
 
-    // Used to find translators lowerbound by symbol name
-    auto fn_compare_translator_with_symbol = [](path_translator_base* a, const char* b)
-    {
-        return strcmp(a->GetSymbol(), b) < 0;
-    };
-    
-    static std::map<uintptr_t, std::string> iat_cache;
-    
-    // We need a list of pointers to some functions since some linkers (the Borland Linker)
-    // doesn't produce a ILT
-    if(iat_cache.empty())
-    {
-        for(auto& x : GetTranslators())
-        {
-            if(auto module = GetModuleHandleA(x->GetLibName()))
-            {
-                if(auto sym = GetProcAddress(module, x->GetSymbol()))
-                    iat_cache[(uintptr_t)sym] = x->GetSymbol();
-            }
-        }
-    }
-    
-    // Get list of singletoned translators
-    auto& list = GetTranslators();
-    
     // Setup pointers to headers in PE module
-    IMAGE_THUNK_DATA32 *fname, *faddr;
-    IMAGE_DOS_HEADER*  dos      = rva_to_ptr(0);
-    IMAGE_NT_HEADERS*  nt       = rva_to_ptr(dos->e_lfanew);
-    IMAGE_FILE_HEADER* pe       = &nt->FileHeader;
-    IMAGE_OPTIONAL_HEADER* opt  = &nt->OptionalHeader;
-    IMAGE_DATA_DIRECTORY* data  = &opt->DataDirectory[0];
-    
-    // Get address to import table
-    if(data[IMAGE_DIRECTORY_ENTRY_IMPORT].Size == 0) return;
-    IMAGE_IMPORT_DESCRIPTOR* imp = rva_to_ptr(data[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress);
+    IMAGE_DOS_HEADER*  dos      = (IMAGE_DOS_HEADER*)(this->module);
+    IMAGE_NT_HEADERS*  nt       = (IMAGE_NT_HEADERS*)((char*)(this->module) + dos->e_lfanew);
+
+    // The translators for the library being walked
+    const char* libname = nullptr;
+    translator_registry<path_translator_base>::library lib;
 
-    // Iterate on each imported library...
-    for(auto* lib = imp; lib->Name != 0; ++lib)
+    // Iterate on each imported symbol to see if we should patch it
+    walk_pe_imports(this->module, nt->OptionalHeader.SizeOfImage, [&](const pe_import& imp)
     {
-        // Get library name...
-        const char* libname = rva_to_ptr(lib->Name);
-        
-        // Check out if we have any translator for this library...
-        auto it_lib = std::lower_bound(list.begin(), list.end(), libname, fn_compare_translator_with_lib_lb);
-        if((it_lib != list.end() && !strcmp((*it_lib)->GetLibName(), libname, false)) == false)
-        {
-            // ...we don't, get 'almost any library' lower bound
-            it_lib = std::lower_bound(list.begin(), list.end(), "", fn_compare_translator_with_lib_lb);
-        }
-        
-        // If we have a lower bound to start searching symbols from, get into symbols searching!
-        if(it_lib != list.end())
-        {
-            // Find upper bound for this library
-            auto it_lib_end = std::upper_bound(it_lib, list.end(),  (*it_lib)->GetLibName(), fn_compare_translator_with_lib_ub);
+        // Check out the translators for this library once for all of its symbols
+        if(imp.libname != libname)
+            lib = registry.find_library(libname = imp.libname);
 
-            // Get pointer to thunks aka function names and function address tables
-            bool bHasILT = lib->OriginalFirstThunk != 0;
-            fname = rva_to_ptr(lib->OriginalFirstThunk);
-            faddr = rva_to_ptr(lib->FirstThunk);
+        // Is this just a ordinal import? Skip it, we don't have a symbol name!
+        if(imp.by_ordinal) return;
 
-            // Iterate on each name to see if we should patch it
-            for(; faddr->u1.Function; ++fname, ++faddr)
-            {
-                const char* symbolName;
-                
-                if(bHasILT)
-                {
-                    // Is this just a ordinal import? Skip it, we don't have a symbol name!
-                    if(fname->u1.Ordinal & IMAGE_ORDINAL_FLAG) continue;
+        // Get the symbol name, by the imported address if there's no ILT
+        const char* symbolName = imp.symbol? imp.symbol : registry.find_symbol(*imp.slot);
+        if(symbolName == nullptr) return;
 
-                    // Get the symbol name
-                    symbolName = (char*)(((IMAGE_IMPORT_BY_NAME*)(rva_to_ptr(fname->u1.AddressOfData)))->Name);
-                }
-                else
-                {
-                    auto sym = iat_cache.find(faddr->u1.Function);
-                    if(sym == iat_cache.end()) continue;
-                    symbolName = sym->second.c_str();
-                }
-                
-                // Find arg translator from symbol...
-                auto it_sym = std::lower_bound(it_lib, it_lib_end, symbolName, fn_compare_translator_with_symbol);
-                if(it_sym != list.end() && !strcmp((*it_sym)->GetSymbol(), symbolName))
-                {
-                    // Add this translator and patch this import pointer into our translator...
-                    (*this->translators.emplace(translators.end(), (*it_sym)->clone()))->Patch(&faddr->u1.Function);
-                }
-            }
+        // Find arg translator from symbol...
+        if(auto* t = registry.find(lib, symbolName))
+        {
+            // Add this translator and patch this import pointer into our translator...
+            (*this->translators.emplace(translators.end(), t->clone()))->Patch(imp.slot);
         }
-    }
+    });
 }
 
 /*
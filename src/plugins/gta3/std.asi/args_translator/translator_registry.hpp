@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2014  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ * Arguments Translation System
+ *      Lookup table of the translators by library and symbol
+ *
+ */
+
+#ifndef ARGS_TRANSLATOR_REGISTRY_HPP
+#define	ARGS_TRANSLATOR_REGISTRY_HPP
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <modloader/util/hash.hpp>
+
+/*
+ *  translator_registry
+ *      The singleton translators indexed by the hashes of their library (case insensitive) and symbol (case sensitive).
+ *
+ *      The translators of a library are used for the symbols imported from it; when no translator exists for a library,
+ *      the translators for any library (empty library name) are used instead.
+ *      It also keeps the addresses of the translated symbols, to find the symbols of import tables with no names in it.
+ *
+ *      Translator is the translator type, only pointers to it are stored. It must have GetLibName() and GetSymbol().
+ */
+template<class Translator>
+class translator_registry
+{
+    public:
+        // Indexes the translators in @list, replacing any previous index
+        template<class List>
+        void build(const List& list)
+        {
+            this->translators.clear();
+            this->libraries.clear();
+            for(auto* t : list)
+            {
+                uint32_t lib = lib_hash(t->GetLibName());
+                this->translators.emplace_back(key(lib, sym_hash(t->GetSymbol())), t);
+                this->libraries.emplace_back(lib, t->GetLibName());
+            }
+            std::stable_sort(translators.begin(), translators.end(), pair_less());
+            std::stable_sort(libraries.begin(), libraries.end(), pair_less());
+            this->any_library = lib_hash("");
+        }
+
+        // The translators for the symbols imported from a library, see find_library()
+        class library
+        {
+            friend class translator_registry;
+            typename std::vector<std::pair<uint64_t, Translator*>>::const_iterator begin, end;
+            const char* libname;
+        };
+
+        // Finds the translators for the symbols imported from the library @libname, to be used with find(library, symbol)
+        // Import tables group the symbols by library, so this is done once for all the symbols imported from it
+        library find_library(const char* libname) const
+        {
+            library lib;
+            uint32_t h = lib_hash(libname);
+            if(!has_library(h, libname))
+                h = this->any_library, libname = "";
+
+            lib.begin   = std::lower_bound(translators.begin(), translators.end(), key(h, 0), pair_key_less());
+            lib.end     = std::upper_bound(lib.begin, translators.end(), key(h, 0xFFFFFFFF), key_pair_less());
+            lib.libname = libname;
+            return lib;
+        }
+
+        // Finds the translator for the @symbol imported from the library @lib, returns null if none
+        Translator* find(const library& lib, const char* symbol) const
+        {
+            if(lib.begin == lib.end)
+                return nullptr;
+
+            uint64_t k = key(uint32_t(lib.begin->first >> 32), sym_hash(symbol));
+            auto it = std::lower_bound(lib.begin, lib.end, k, pair_key_less());
+            for(; it != lib.end && it->first == k; ++it)
+            {
+                if(!strcmp(it->second->GetSymbol(), symbol) && same_lib(it->second->GetLibName(), lib.libname))
+                    return it->second;
+            }
+            return nullptr;
+        }
+
+        // Finds the translator for the @symbol imported from the library @libname, returns null if none
+        Translator* find(const char* libname, const char* symbol) const
+        {
+            return find(find_library(libname), symbol);
+        }
+
+        // Checks if any symbol address is known
+        bool has_addresses() const
+        {
+            return !this->addresses.empty();
+        }
+
+        // Stores the address of each translated symbol, @resolve(Translator*) gets the address of it (zero if unknown)
+        template<class F>
+        void build_addresses(F resolve)
+        {
+            this->addresses.clear();
+            for(auto& pair : this->translators)
+            {
+                if(uintptr_t addr = resolve(pair.second))
+                    this->addresses.emplace_back(addr, pair.second->GetSymbol());
+            }
+            std::stable_sort(addresses.begin(), addresses.end(), pair_less());
+        }
+
+        // Finds the symbol at the @address, returns null if unknown
+        // If many symbols share the address the last one indexed is used
+        const char* find_symbol(uintptr_t address) const
+        {
+            auto it = std::upper_bound(addresses.begin(), addresses.end(), address, key_pair_less());
+            return (it != addresses.begin() && (--it)->first == address)? it->second : nullptr;
+        }
+
+    private:
+        static uint64_t key(uint32_t lib, uint32_t sym)
+        {
+            return (uint64_t(lib) << 32) | sym;
+        }
+
+        static uint32_t lib_hash(const char* libname)
+        {
+            return uint32_t(modloader::hash(libname, [](char c) { return char(::tolower(uint8_t(c))); }));
+        }
+
+        static uint32_t sym_hash(const char* symbol)
+        {
+            return uint32_t(modloader::hash(symbol));
+        }
+
+        static bool same_lib(const char* a, const char* b)
+        {
+            for(; *a && ::tolower(uint8_t(*a)) == ::tolower(uint8_t(*b)); ++a, ++b) {}
+            return ::tolower(uint8_t(*a)) == ::tolower(uint8_t(*b));
+        }
+
+        bool has_library(uint32_t lib, const char* libname) const
+        {
+            auto it = std::lower_bound(libraries.begin(), libraries.end(), lib, pair_key_less());
+            for(; it != libraries.end() && it->first == lib; ++it)
+            {
+                if(same_lib(it->second, libname))
+                    return true;
+            }
+            return false;
+        }
+
+        struct pair_less
+        {
+            template<class Pair>
+            bool operator()(const Pair& a, const Pair& b) const { return a.first < b.first; }
+        };
+
+        struct pair_key_less
+        {
+            template<class Pair, class Key>
+            bool operator()(const Pair& a, const Key& k) const  { return a.first < k; }
+        };
+
+        struct key_pair_less
+        {
+            template<class Key, class Pair>
+            bool operator()(const Key& k, const Pair& a) const  { return k < a.first; }
+        };
+
+    private:
+        std::vector<std::pair<uint64_t, Translator*>>   translators;    // By (library hash, symbol hash)
+        std::vector<std::pair<uint32_t, const char*>>   libraries;      // Libraries with translators, by hash
+        std::vector<std::pair<uintptr_t, const char*>>  addresses;      // Symbols, by their address
+        uint32_t                                        any_library = 0;// Hash of the 'any library' name
+};
+
+#endif
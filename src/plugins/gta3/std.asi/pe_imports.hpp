@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2014  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  Portable walker for the import table of 32 bits PE images
+ *      Doesn't depend on the Windows headers, so it works on any in-memory image buffer.
+ *
+ */
+
+#ifndef PE_IMPORTS_HPP
+#define	PE_IMPORTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ *  pe_import
+ *      A symbol imported by a PE image
+ */
+struct pe_import
+{
+    const char* libname;        // Name of the library the symbol is imported from
+    const char* symbol;         // Name of the symbol, null if imported by ordinal or if the image has no lookup table (ILT)
+    uint16_t    ordinal;        // Ordinal of the symbol, if imported by ordinal
+    bool        by_ordinal;     // Whether the symbol is imported by ordinal
+    uint32_t*   slot;           // Entry of the import address table (IAT) for this symbol
+};
+
+/*
+ *  walk_pe_imports
+ *      Calls @cb(const pe_import&) for each symbol imported by the 32 bits PE @image, which has @size bytes.
+ *      The image must be in its mapped layout (as loaded by the system), where a RVA is the offset from the image base.
+ *      Every offset is checked against @size, so a malformed image stops the walk instead of being read out of bounds.
+ *      Returns false if @image isn't a (well formed) 32 bits PE image.
+ */
+template<class F>
+inline bool walk_pe_imports(void* image, size_t size, F cb)
+{
+    enum : uint32_t
+    {
+        dos_lfanew          = 0x3C,         // IMAGE_DOS_HEADER::e_lfanew
+        nt_optional         = 24,           // IMAGE_NT_HEADERS32::OptionalHeader
+        opt_num_dirs        = 92,           // IMAGE_OPTIONAL_HEADER32::NumberOfRvaAndSizes
+        opt_dirs            = 96,           // IMAGE_OPTIONAL_HEADER32::DataDirectory
+        dir_import          = 1,            // IMAGE_DIRECTORY_ENTRY_IMPORT
+        import_desc_size    = 20,           // sizeof(IMAGE_IMPORT_DESCRIPTOR)
+        ordinal_flag        = 0x80000000,   // IMAGE_ORDINAL_FLAG32
+    };
+
+    char* base = (char*)(image);
+
+    // Checks if @n bytes at @off are inside the image
+    auto in_image = [&](uint64_t off, uint64_t n)
+    { return off <= size && n <= size - off; };
+
+    // Reads the @n (up to 4) bytes integer at @off into @out, fails if it isn't inside the image
+    auto read = [&](uint64_t off, uint32_t& out, size_t n) -> bool
+    {
+        if(!in_image(off, n)) return false;
+        out = 0; memcpy(&out, base + off, n);   // little endian, as the PE format
+        return true;
+    };
+
+    // Gets the null terminated string at @off, null if it isn't terminated inside the image
+    auto cstr = [&](uint64_t off) -> const char*
+    {
+        if(!in_image(off, 1)) return nullptr;
+        return memchr(base + off, 0, size_t(size - off))? base + off : nullptr;
+    };
+
+    uint32_t magic, lfanew, signature, num_dirs, imp_rva, imp_size;
+
+    // DOS and NT headers
+    if(!read(0, magic, 2) || magic != 0x5A4D)                                   // "MZ"
+        return false;
+    if(!read(dos_lfanew, lfanew, 4) || !read(lfanew, signature, 4) || signature != 0x00004550) // "PE\0\0"
+        return false;
+    if(!read(uint64_t(lfanew) + nt_optional, magic, 2) || magic != 0x10B)      // IMAGE_NT_OPTIONAL_HDR32_MAGIC
+        return false;
+
+    // Import directory
+    uint64_t opt = uint64_t(lfanew) + nt_optional;
+    if(!read(opt + opt_num_dirs, num_dirs, 4))
+        return false;
+    if(num_dirs <= dir_import)
+        return true;
+    if(!read(opt + opt_dirs + dir_import * 8, imp_rva, 4) || !read(opt + opt_dirs + dir_import * 8 + 4, imp_size, 4))
+        return false;
+    if(imp_size == 0)
+        return true;
+
+    // Iterate on each imported library...
+    for(uint64_t desc = imp_rva; ; desc += import_desc_size)
+    {
+        uint32_t ilt, name, iat;
+        if(!read(desc + 0, ilt, 4) || !read(desc + 12, name, 4) || !read(desc + 16, iat, 4))
+            return false;
+        if(name == 0)
+            break;
+
+        pe_import imp;
+        if((imp.libname = cstr(name)) == nullptr)
+            return false;
+
+        // ...and on each symbol imported from it
+        for(uint64_t i = 0; ; ++i)
+        {
+            uint32_t function, thunk;
+            uint64_t slot = iat + i * 4;
+            if(!read(slot, function, 4))
+                return false;
+            if(function == 0)
+                break;
+
+            imp.symbol     = nullptr;
+            imp.ordinal    = 0;
+            imp.by_ordinal = false;
+            imp.slot       = (uint32_t*)(base + slot);
+
+            if(ilt)     // Some linkers (the Borland Linker) don't produce a ILT
+            {
+                if(!read(ilt + i * 4, thunk, 4))
+                    return false;
+
+                if(thunk & ordinal_flag)
+                {
+                    imp.by_ordinal = true;
+                    imp.ordinal = uint16_t(thunk & 0xFFFF);
+                }
+                else if((imp.symbol = cstr(uint64_t(thunk) + 2)) == nullptr)  // IMAGE_IMPORT_BY_NAME::Name
+                    return false;
+            }
+
+            cb(imp);
+        }
+    }
+
+    return true;
+}
+
+#endif
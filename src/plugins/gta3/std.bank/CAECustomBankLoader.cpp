@@ -28,12 +28,12 @@ enum
     REQUEST_STATUS_BEGIN        = 1,
     REQUEST_STATUS_CUSTOM       = 100,
     REQUEST_STATUS_IN_PROGRESS,
-    REQUEST_STATUS_DONE
+    REQUEST_STATUS_DONE,
+    REQUEST_STATUS_DONE_JOINED,                     // Done by an identical request, the bankslot is already there
 };
 
 // Bank loading thread
-static Queue queue;                                 // Request queue
-static HANDLE hSemaphore;                           // Thread semaphore
+static request_scheduler scheduler;                 // Requests to the thread
 static HANDLE hThread;                              // Thread handle
 static DWORD __stdcall BankLoadingThread(void*);    // Thread body
 
@@ -50,6 +50,12 @@ static bool IsValidHandle(HANDLE hFile)
     return hFile != 0 && hFile != INVALID_HANDLE_VALUE;
 }
 
+// Identifies what a request loads, requests with the same key load the same thing
+static uint64_t GetRequestKey(const CAESoundRequest& r)
+{
+    return (uint64_t(r.m_usBankSlot) << 32) | (uint64_t(r.m_usBank) << 16) | uint64_t(r.m_usSound);
+}
+
 /*
  *  CAEBankHeader
  *      Information about a bank, without virtual information, actual information, really
@@ -291,28 +297,16 @@ bool CAECustomBankLoader::PostInitialise()
 bool CAECustomBankLoader::InitialiseThread()
 {
     // Initialise bank loading thread
-    if(hSemaphore = CreateSemaphoreA(nullptr, 0, 50 + 1, "BankLoaderSem"))
+    hThread = CreateThread(nullptr, 0, BankLoadingThread, this, CREATE_SUSPENDED, nullptr);
+    if(hThread)
     {
-        hThread = CreateThread(nullptr, 0, BankLoadingThread, this, CREATE_SUSPENDED, nullptr);
-        if(hThread)
-        {
-            // Make the loading thread have the same priority as the main thread
-            // This is necessary mainly because of the WinXP behaviour on the Sleep function
-            SetThreadPriority(hThread, GetThreadPriority(GetCurrentThread()));
-            ResumeThread(hThread);
-        }
-        else
-        {
-            CloseHandle(hSemaphore);
-            return false;
-        }
+        // Make the loading thread have the same priority as the main thread
+        // This is necessary mainly because of the WinXP behaviour on the Sleep function
+        SetThreadPriority(hThread, GetThreadPriority(GetCurrentThread()));
+        ResumeThread(hThread);
+        return true;
     }
-    else
-        return false;
-
-    // Initialise bank loading queue
-    InitialiseQueue(&queue, 50 + 1);
-    return true;
+    return false;
 }
 
 /*
@@ -347,10 +341,12 @@ void CAECustomBankLoader::InitialiseBankInfo()
  */
 void CAECustomBankLoader::Finalize()
 {
+    // Stop the loading thread, it finishes the request it's loading, if any
+    scheduler.stop();
+    WaitForSingleObject(hThread, INFINITE);
+
     // Cleanup resources
     CloseHandle(hThread);
-    CloseHandle(hSemaphore);
-    FinalizeQueue(&queue);
     delete[] pBankInfo;
 
     // Destroy any sound buffer still allocated
@@ -421,8 +417,6 @@ bool CAEBankInfo::FetchBankFile(CAEBankLookupItem* pLookup, short usBankId, shor
  */
 void CAEBankInfo::ProcessVirtualBank()
 {
-    static std::string fbuffer;
-
     // Headers
     CAEBankHeader& oh = this->m_OriginalHeader;
     CAEBankHeader& h = this->m_VirtualHeader;
@@ -449,16 +443,14 @@ void CAEBankInfo::ProcessVirtualBank()
             accumulator_bef = accumulator;
 
             // Check if there's a wav for this sound id
+            // The wave was checked when installed, and a removed wave is uninstalled, so don't touch the disk here
             if(auto* pSound = banker.FindSound(*pSounds, i))
             {
-                if(GetFileAttributesA(pSound->file->fullpath(fbuffer).data()) != INVALID_FILE_ATTRIBUTES)
-                {
-                    // Accumulate the difference in size between the wave and the original sound
-                    accumulator += int(pSound->sound_size - h.GetSoundSize(i));
+                // Accumulate the difference in size between the wave and the original sound
+                accumulator += int(pSound->sound_size - h.GetSoundSize(i));
 
-                    // Setup the wave information on the virtual header
-                    v.m_usSampleRate = pSound->sample_rate;
-                }
+                // Setup the wave information on the virtual header
+                v.m_usSampleRate = pSound->sample_rate;
             }
 
             // Add accumulator into offset
@@ -481,8 +473,11 @@ void CAECustomBankLoader::Flush()
 {
     while(this->m_nRequestsToLoad)
     {
+        // Send the new requests and finish the done ones, then sleep until the thread completes the rest
+        // Once the thread is stopped the requests left will never complete, so give up on them
         this->Service();
-        Sleep(0);
+        if(this->m_nRequestsToLoad && !scheduler.wait_all())
+            break;
     }
 }
 
@@ -513,9 +508,10 @@ void CAECustomBankLoader::Service()
                 this->m_aBankSlotSound[bankslot] = 0xFFFF;
                 
                 // Request the sound to the bank loading thread
+                // Single sounds are needed right now, while whole banks are usually loaded ahead of time
                 r.m_iLoadingStatus = REQUEST_STATUS_IN_PROGRESS;
-                AddToQueue(&queue, i);
-                ReleaseSemaphore(hSemaphore, 1, nullptr);
+                scheduler.submit(i, GetRequestKey(r), bankslot,
+                    r.m_usSound != 0xFFFF? request_scheduler::priority::immediate : request_scheduler::priority::background);
                 
                 break;
             }
@@ -548,6 +544,20 @@ void CAECustomBankLoader::Service()
                 
                 break;
             }
+
+            // The request has been completed by an identical request, which already filled the bankslot
+            case REQUEST_STATUS_DONE_JOINED:
+            {
+                // Cleanup request object
+                r.m_iLoadingStatus = REQUEST_STATUS_NULL;
+                r.m_usBankSlot = 0xFFFF;
+                r.m_usBank = 0xFFFF;
+                r.m_usSound = 0xFFFF;
+                r.m_pBuffer = r.m_pBufferData = nullptr;
+                --this->m_nRequestsToLoad;
+
+                break;
+            }
         }
     }
 }
@@ -564,19 +574,19 @@ void CAECustomBankLoader::Service()
 DWORD __stdcall BankLoadingThread(void* arg)
 {
     CAECustomBankLoader& AEBankLoader = *(CAECustomBankLoader*)(arg);
+    int i;
     
-    while(true)
+    // Wait for a request...
+    while(scheduler.take(i))
     {
-        // Wait for a request...
-        WaitForSingleObject(hSemaphore, INFINITE);
-        int i = GetFirstInQueue(&queue);
-        
         // Load the request
         AEBankLoader.LoadRequest(i);
 
-        // Done!
-        RemoveFirstInQueue(&queue);
-        AEBankLoader.m_aSoundRequests[i].m_iLoadingStatus = REQUEST_STATUS_DONE;
+        // Done! Along with any identical request sent meanwhile
+        scheduler.complete(i, [&](int k, bool joined)
+        {
+            AEBankLoader.m_aSoundRequests[k].m_iLoadingStatus = joined? REQUEST_STATUS_DONE_JOINED : REQUEST_STATUS_DONE;
+        });
     }
     return 0;
 }
@@ -655,7 +665,9 @@ void CAECustomBankLoader::LoadRequestSplit(int i)
             }
             else
             {
+                // Play silence instead of garbage
                 plugin_ptr->Log("Failed to open wave file for reading: \"%s\"", fbuffer.data());
+                memset(block.pBuffer, 0, block.dwSize);
             }
         }
     }
@@ -673,8 +685,6 @@ auto CAECustomBankLoader::GetRequestPlan(CAESoundRequest& r) -> SPlan**
     // Planning arrays
     static SPlan  aPlan[400];
     static SPlan* aSortedPlan[400];
-    
-    static std::string fbuffer;
 
     unsigned short usBank       = r.m_usBank;
     unsigned short usBankSlot   = r.m_usBankSlot;
@@ -727,7 +737,7 @@ auto CAECustomBankLoader::GetRequestPlan(CAESoundRequest& r) -> SPlan**
                 item.dwSize     = vh.GetSoundSize(i);
 
                 auto pSound = banker.FindSound(*pSounds, i);
-                if(pSound && GetFileAttributesA(pSound->file->fullpath(fbuffer).data()) != INVALID_FILE_ATTRIBUTES) // Has wave for this sound?
+                if(pSound) // Has wave for this sound?
                 {
                     // Start reading after the wave header
                     item.dwOffset   = pSound->sound_offset;
@@ -878,6 +888,9 @@ void CAbstractBankLoader::Initialise(CAECustomBankLoader& AEBankLoader)
         }
         else ++it;
     }
+
+    // The waves installed at startup are all known by now, keep them for the next launch
+    this->SaveWaveCache();
 }
 
 /*
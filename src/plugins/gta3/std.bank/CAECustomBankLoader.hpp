@@ -8,6 +8,7 @@
 #pragma once
 #include <stdinc.hpp>
 #include "CWavePCM.hpp"
+#include "CWaveCache.hpp"
 
 class CAECustomBankLoader;
 
@@ -110,6 +111,8 @@ class CAbstractBankLoader
         bool                    m_bHasInitialized = false;          // Whether the CAECustomBankLoader has initialized
         PakHash_t               m_GENRL;                            // Hash to tolower("GENRL") sfxpak
         WavMap_t                m_Waves;                            // Wave files map, notice the key contains all sfxpaks
+        CWaveCache              m_WaveCache;                        // Wave headers from previous launches
+        std::string             m_WaveCachePath;                    // Where the wave cache is saved, empty if none
 
         std::map<std::string, const modloader::file*> sfxpak;       // SFX Pak for replacement
         std::map<SoundTarget, const modloader::file*> to_import;    // To import during Update()
@@ -130,6 +133,31 @@ class CAbstractBankLoader
         static void Patch();// Patches the game to work with this loader
 
 
+        // Loads the wave cache file at the specified path, and saves the wave cache there later
+        void LoadWaveCache(std::string path)
+        {
+            if(!m_WaveCache.Load(path))
+                modloader::plugin_ptr->Log("No wave cache from previous launches");
+            this->m_WaveCachePath = std::move(path);
+        }
+
+        // Saves the wave cache, if changed
+        void SaveWaveCache()
+        {
+            if(!m_WaveCachePath.empty() && !m_WaveCache.Save(m_WaveCachePath))
+                modloader::plugin_ptr->Log("Warning: Failed to save the wave cache");
+        }
+
+        // Gets the header information of the wave file 'f', only opening the file if it changed since it got cached
+        CWaveCache::WaveInfo PeekWave(const modloader::file& f)
+        {
+            return m_WaveCache.Peek(modloader::hash(f.filepath()), f.size, f.time, f.fullpath().c_str());
+        }
+
+        // Gets the wave cache hits and misses
+        uint32_t GetWaveCacheHits()   { return m_WaveCache.GetHits(); }
+        uint32_t GetWaveCacheMisses() { return m_WaveCache.GetMisses(); }
+
         // Gets the full path to the specified sfxpak, overriders will be returned if necessary
         std::string GetSfxPakFullPath(std::string filename)
         {
@@ -303,14 +331,14 @@ class CAbstractBankLoader
         // Notice it overrides any previous wave with the same sound target
         bool AddWave(const modloader::file& f)
         {
-            CWavePCM wave(f.fullpath().data());
-            if(wave.HasChunks())
+            auto wave = this->PeekWave(f);
+            if(wave.valid)
             {
                 auto target  = GetWaveTarget(f);
                 auto pakhash = std::get<pak_target>(target);
                 auto bank    = std::get<bnk_target>(target);
                 auto sound   = std::get<snd_target>(target);
-                m_Waves[pakhash][bank][sound-1] = {&f, wave.GetSoundBufferOffset(), wave.GetSoundBufferSize(), wave.GetSampleRate()};
+                m_Waves[pakhash][bank][sound-1] = {&f, wave.sound_offset, wave.sound_size, uint16_t(wave.sample_rate)};
                 return true;
             }
             return false;
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2014  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#ifndef CWAVECACHE_HPP
+#define	CWAVECACHE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include "CWavePCM.hpp"
+
+/*
+ *  CWaveCache
+ *      Remembers the wave header information of the wave files across launches, so unchanged waves don't need to be opened.
+ *      The waves are known by the hash of their path, and the information is valid only for the same file size and time.
+ *      Only valid waves are remembered.
+ *
+ *      The cache file is the magic and version followed by the entries (integers are little endian):
+ *          u32 path hash, u64 size, u64 time, u8 valid, u16 format, u16 channels, u16 bps, u32 sample rate,
+ *          u32 sound offset, u32 sound size
+ */
+class CWaveCache
+{
+    public:
+        struct WaveInfo     // Information taken from the wave header
+        {
+            bool        valid;          // Has the fmt and data chunks (as in CWavePCM::HasChunks)
+            uint16_t    audio_format;
+            uint16_t    num_channels;
+            uint16_t    bps;
+            uint32_t    sample_rate;
+            uint32_t    sound_offset;   // Offset of the sound buffer in the file
+            uint32_t    sound_size;     // Size of the sound buffer
+        };
+
+    private:
+        struct Entry
+        {
+            uint64_t    size;
+            uint64_t    time;
+            WaveInfo    info;
+            bool        used;           // Looked up in this session, only those are saved
+        };
+
+        static const uint32_t version    = 1;
+        static const size_t   entry_size = 4+8+8+1+2+2+2+4+4+4;
+
+        std::unordered_map<uint32_t, Entry> entries;
+        bool dirty = false;             // Something to save
+        uint32_t hits = 0, misses = 0;
+
+    public:
+        // Gets the information of the wave at @fullpath, with @path_hash, @size and @time as in its modloader::file
+        // The wave is only opened if the cache doesn't know about it yet
+        WaveInfo Peek(uint32_t path_hash, uint64_t size, uint64_t time, const char* fullpath)
+        {
+            auto it = entries.find(path_hash);
+            if(it != entries.end() && it->second.size == size && it->second.time == time)
+            {
+                it->second.used = true;
+                ++this->hits;
+                return it->second.info;
+            }
+
+            CWavePCM wave(fullpath);
+            Entry e;
+            e.size = size;
+            e.time = time;
+            e.info = GetWaveInfo(wave);
+            e.used = true;
+
+            // Invalid waves aren't remembered, they may be unreadable just for now (e.g. in use)
+            if(e.info.valid)
+            {
+                entries[path_hash] = e;
+                this->dirty = true;
+            }
+            ++this->misses;
+            return e.info;
+        }
+
+        // Gets the information of the already read @wave
+        static WaveInfo GetWaveInfo(CWavePCM& wave)
+        {
+            WaveInfo info;
+            info.valid          = wave.HasChunks();
+            info.audio_format   = info.valid && wave.CheckPCM()? 1 : 0;
+            info.num_channels   = info.valid? wave.GetNumChannels() : 0;
+            info.bps            = info.valid? wave.GetBPS() : 0;
+            info.sample_rate    = info.valid? wave.GetSampleRate() : 0;
+            info.sound_offset   = info.valid? wave.GetSoundBufferOffset() : 0;
+            info.sound_size     = info.valid? wave.GetSoundBufferSize() : 0;
+            return info;
+        }
+
+        uint32_t GetHits()   { return this->hits; }
+        uint32_t GetMisses() { return this->misses; }
+
+        // Reads the cache file at @path, returns false if there's no (valid) cache file
+        bool Load(const std::string& path)
+        {
+            std::string buf;
+            entries.clear();
+
+            if(FILE* f = fopen(path.c_str(), "rb"))
+            {
+                char chunk[4096];
+                size_t n;
+                while((n = fread(chunk, 1, sizeof(chunk), f)) != 0)
+                    buf.append(chunk, n);
+                fclose(f);
+            }
+
+            const char* p   = buf.data();
+            const char* end = buf.data() + buf.size();
+            if(buf.size() < 12 || memcmp(p, magic(), 8))
+                return false;
+            p += 8;
+            if(Get<uint32_t>(p) != version)
+                return false;
+
+            while(size_t(end - p) >= entry_size)
+            {
+                Entry e;
+                uint32_t hash       = Get<uint32_t>(p);
+                e.size              = Get<uint64_t>(p);
+                e.time              = Get<uint64_t>(p);
+                e.info.valid        = Get<uint8_t>(p) != 0;
+                e.info.audio_format = Get<uint16_t>(p);
+                e.info.num_channels = Get<uint16_t>(p);
+                e.info.bps          = Get<uint16_t>(p);
+                e.info.sample_rate  = Get<uint32_t>(p);
+                e.info.sound_offset = Get<uint32_t>(p);
+                e.info.sound_size   = Get<uint32_t>(p);
+                e.used              = false;
+                entries[hash] = e;
+            }
+
+            this->dirty = false;
+            if(p != end)
+            {
+                entries.clear();    // Cut short or garbage at the end, don't trust any of it
+                return false;
+            }
+            return true;
+        }
+
+        // Writes the waves looked up in this session into the cache file at @path, if anything changed
+        bool Save(const std::string& path)
+        {
+            // Waves not looked up anymore (e.g. removed) are forgotten
+            for(auto it = entries.begin(); it != entries.end(); )
+            {
+                if(it->second.used) ++it;
+                else it = entries.erase(it), this->dirty = true;
+            }
+
+            if(this->dirty == false)
+                return true;
+
+            std::string buf(magic(), 8);
+            Put<uint32_t>(buf, version);
+            for(auto& pair : entries)
+            {
+                auto& e = pair.second;
+                Put<uint32_t>(buf, pair.first);
+                Put<uint64_t>(buf, e.size);
+                Put<uint64_t>(buf, e.time);
+                Put<uint8_t>(buf, e.info.valid);
+                Put<uint16_t>(buf, e.info.audio_format);
+                Put<uint16_t>(buf, e.info.num_channels);
+                Put<uint16_t>(buf, e.info.bps);
+                Put<uint32_t>(buf, e.info.sample_rate);
+                Put<uint32_t>(buf, e.info.sound_offset);
+                Put<uint32_t>(buf, e.info.sound_size);
+            }
+
+            bool result = false;
+            if(FILE* f = fopen(path.c_str(), "wb"))
+            {
+                result = (fwrite(buf.data(), 1, buf.size(), f) == buf.size());
+                result = (fclose(f) == 0) && result;
+            }
+
+            if(result) this->dirty = false;
+            return result;
+        }
+
+    private:
+        static const char* magic()
+        {
+            return "MLWAVEC\0";
+        }
+
+        template<class T>
+        static void Put(std::string& out, T value)
+        {
+            for(size_t i = 0; i < sizeof(T); ++i)
+                out.push_back(char(uint8_t(uint64_t(value) >> (i * 8))));
+        }
+
+        template<class T>
+        static T Get(const char*& p)
+        {
+            uint64_t value = 0;
+            for(size_t i = 0; i < sizeof(T); ++i)
+                value |= uint64_t(uint8_t(*p++)) << (i * 8);
+            return T(value);
+        }
+};
+
+#endif
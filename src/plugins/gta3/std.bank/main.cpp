@@ -19,6 +19,11 @@ class ThePlugin : public modloader::basic_plugin
         modloader::file_overrider ov_pakfiles;    // PakFiles.dat overrider
         modloader::file_overrider ov_eventvol;    // EventVol.dat overrider
 
+        struct bank_cache : modloader::basic_cache
+        {
+            bool Startup() { return basic_cache::Startup(location::localappdata); }
+        } cache;                                  // Where the wave cache lives
+
     public:
         const info& GetInfo();
 
@@ -41,8 +46,30 @@ REGISTER_ML_PLUGIN(::plugin);
 const ThePlugin::info& ThePlugin::GetInfo()
 {
     using namespace modloader;
+    // The default SFXPaks and the data files as in GetBehaviour, lets Mod Loader find out their behaviour without calling it
+    // Files in a SFX folder and waves are still sent to GetBehaviour
+    static const uint32_t flags  = MODLOADER_RULE_NODIR | MODLOADER_RULE_ORHASH;
+    static const uint64_t pak    = SetType(0, Type::SFXPak);
+    static const modloader_rule_t rules[] =
+    {
+        { modloader::hash("feet"),      flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("genrl"),     flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("pain_a"),    flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("script"),    flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("spc_ea"),    flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("spc_fa"),    flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("spc_ga"),    flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("spc_na"),    flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("spc_pa"),    flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("banklkup.dat"), flags, "dat", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, SetType(0, Type::BankLookUp) },
+        { modloader::hash("bankslot.dat"), flags, "dat", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, SetType(0, Type::BankSlot) },
+        { modloader::hash("eventvol.dat"), flags, "dat", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, SetType(0, Type::EventVol) },
+        { modloader::hash("pakfiles.dat"), flags, "dat", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, SetType(0, Type::PakFiles) },
+        { 0 }
+    };
+
     static const char* extable[] = { "", "dat", "wav", 0 };
-    static const info xinfo      = { "std.bank", get_version_by_date(), "LINK/2012", -1, extable };
+    static const info xinfo      = { "std.bank", get_version_by_date(), "LINK/2012", -1, extable, rules, false };
     return xinfo;
 }
 
@@ -73,6 +100,10 @@ bool ThePlugin::OnStartup()
         // Patch the bank loader
         CAbstractBankLoader::Patch();
 
+        // Wave headers from the previous launches, so the unchanged waves don't need to be opened
+        if(cache.Startup())
+            banker.LoadWaveCache(cache.GetCachePath("waves.wc"));
+
         return true;
     }
     return false;
@@ -84,6 +115,9 @@ bool ThePlugin::OnStartup()
  */
 bool ThePlugin::OnShutdown()
 {
+    banker.SaveWaveCache();
+    Log("Wave cache: %u hits, %u misses", banker.GetWaveCacheHits(), banker.GetWaveCacheMisses());
+    cache.Shutdown();
     return true;
 }
 
@@ -135,12 +169,12 @@ int ThePlugin::GetBehaviour(modloader::file& file)
         else if(file.is_ext("wav"))
         {
             // Cool, this is a wave file, let's check if it's compatible with San Andreas
-            CWavePCM wave(file.fullpath().c_str());
+            auto wave = banker.PeekWave(file);
         
-            if(wave.HasChunks())
+            if(wave.valid)
             {
                 // San Andreas accept only mono PCM 16 wave files.....
-                if(wave.GetNumChannels() == 1 && wave.GetBPS() == 16)
+                if(wave.num_channels == 1 && wave.bps == 16)
                 {
                     using modloader::GetLastPathComponent;
                     using modloader::NormalizePath;
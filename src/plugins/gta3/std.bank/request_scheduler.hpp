@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2014  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#ifndef REQUEST_SCHEDULER_HPP
+#define	REQUEST_SCHEDULER_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+/*
+ *  request_scheduler
+ *      Hands the requests from the game thread to the loading thread (no Windows dependency).
+ *
+ *      Requests are known by an id (the index in the request array) and taken by priority, then by submission order.
+ *      Requests of the same group (the bank slot) are always taken in submission order, as they write into the same place.
+ *      A request identical (same key) to the last request of its group still not completed joins it instead of being
+ *      loaded again, and is completed together with it.
+ *
+ *      Thread-safe.
+ */
+class request_scheduler
+{
+    public:
+        enum class priority
+        {
+            immediate,      // Something is waiting to play it (e.g. a single sound)
+            background,     // Preloading (e.g. a whole bank)
+        };
+
+        request_scheduler() : pending(0), stopped(false)
+        {}
+
+        // Submits the request @id, returns false if it joined an identical request in progress
+        bool submit(int id, uint64_t key, int group, priority prio)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto last = std::find_if(jobs.rbegin(), jobs.rend(), [&](const job& j) { return j.group == group; });
+            if(last != jobs.rend() && last->key == key)
+            {
+                last->joined.push_back(id);
+                last->prio = std::min(last->prio, prio);
+                ++pending;
+                return false;
+            }
+
+            job j;
+            j.id = id; j.key = key; j.group = group; j.prio = prio;
+            j.taken = false;
+            jobs.emplace_back(std::move(j));
+            ++pending;
+            cv_work.notify_one();
+            return true;
+        }
+
+        // Waits for the next request to load, returns false once stopped
+        bool take(int& id)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job* next = nullptr;
+            cv_work.wait(lock, [&] { return stopped || (next = find_next()) != nullptr; });
+            if(stopped) return false;
+
+            next->taken = true;
+            id = next->id;
+            return true;
+        }
+
+        // Tells the taken request @id has been loaded, @on_complete(id, joined) is called for it and each request joined to it
+        template<class F>
+        void complete(int id, F on_complete)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = std::find_if(jobs.begin(), jobs.end(), [&](const job& j) { return j.id == id; });
+                if(it != jobs.end())
+                {
+                    on_complete(it->id, false);
+                    for(int k : it->joined)
+                        on_complete(k, true);
+                    pending -= 1 + it->joined.size();
+                    jobs.erase(it);
+                }
+            }
+            cv_done.notify_all();
+            cv_work.notify_one();   // The next request of the group may be taken now
+        }
+
+        // Waits until every submitted request is completed, returns false if stopped meanwhile (they never will be)
+        bool wait_all()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv_done.wait(lock, [&] { return stopped || pending == 0; });
+            return !stopped;
+        }
+
+        // Makes take() return false and wakes up everyone waiting
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                this->stopped = true;
+            }
+            cv_work.notify_all();
+            cv_done.notify_all();
+        }
+
+    private:
+        struct job
+        {
+            int                 id;
+            uint64_t            key;
+            int                 group;
+            priority            prio;
+            bool                taken;      // Being loaded
+            std::vector<int>    joined;     // Identical requests completed with this one
+        };
+
+        std::vector<job>        jobs;       // Not completed, in submission order
+        size_t                  pending;    // Number of requests not completed (including the joined ones)
+        bool                    stopped;
+        std::mutex              mutex;
+        std::condition_variable cv_work;    // A request may be taken
+        std::condition_variable cv_done;    // A request has been completed
+
+        // Finds the request to be taken next, if any
+        job* find_next()
+        {
+            job* best = nullptr;
+            for(size_t i = 0; i < jobs.size(); ++i)
+            {
+                auto& j = jobs[i];
+                if(j.taken || (best && best->prio <= j.prio))
+                    continue;
+
+                // The previous requests of the group must complete first
+                auto first = std::find_if(jobs.begin(), jobs.begin() + i, [&](const job& o) { return o.group == j.group; });
+                if(first == jobs.begin() + i)
+                    best = &j;
+            }
+            return best;
+        }
+};
+
+#endif
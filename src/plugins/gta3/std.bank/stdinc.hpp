@@ -7,4 +7,4 @@
 #include <stdinc/gta3/stdinc.hpp>
 #include "CWavePCM.hpp"
 #include "CAEBankLoader.h"
-#include "Queue.h"
+#include "request_scheduler.hpp"
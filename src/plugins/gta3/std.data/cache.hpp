@@ -14,6 +14,7 @@
 #include <file_block.hpp>
 #include "vfs.hpp"
 #include "datalib.hpp"
+#include <datalib/flat_rows.hpp>
 
 // Serialization
 #include <cereal/archives/binary.hpp>
@@ -296,7 +297,7 @@ class data_cache : public modloader::basic_cache
                 for(size_t i = 0; i < readme_point; ++i)
                 {
                     block_writer xblock(ss);
-                    archive(store[i]);
+                    SaveStoreRows(archive, store[i]);
                 }
             });
         }
@@ -322,11 +323,43 @@ class data_cache : public modloader::basic_cache
                     if(k == -1) // no association with the current store, skip this element
                         xblock.skip();
                     else
-                        archive(store[k]);
+                        LoadStoreRows(archive, store[k]);
                 }
             });
         }
 
+        // Saves a data store as flat rows (see datalib/flat_rows.hpp), which load faster than cereal does,
+        // or through cereal when some of its content has no flat form (e.g. the shared pointers in udata)
+        template<class StoreType>
+        static void SaveStoreRows(cereal::BinaryOutputArchive& archive, StoreType& store)
+        {
+            std::string rows;
+            bool is_flat = datalib::save_flat_rows(rows, store);
+            archive(is_flat);
+            if(is_flat)
+                archive(rows);
+            else
+                archive(store);
+        }
+
+        // Loads a data store saved by SaveStoreRows
+        // Malformed flat rows leave the store not ready, so it's built from its data file instead
+        template<class StoreType>
+        static void LoadStoreRows(cereal::BinaryInputArchive& archive, StoreType& store)
+        {
+            bool is_flat;
+            archive(is_flat);
+            if(is_flat)
+            {
+                std::string rows;
+                archive(rows);
+                if(!datalib::load_flat_rows(rows.data(), rows.size(), store))
+                    store.clear();
+            }
+            else
+                archive(store);
+        }
+
         // Serializes a listing of files into archive.
         // Readme point is how many normal files there is until we reach the readme files in the listing.
         template<class ListingList, class ArchiveType>
@@ -8,6 +8,7 @@
 
 #include "vfs.hpp"
 #include "cache.hpp"
+#include "readme_cache.hpp"
 using boost::optional;
 
 // Type of config file identifier (see files_behv_t)
@@ -154,9 +155,7 @@ class DataPlugin : public modloader::basic_plugin
         };
 
 
-        using readme_file_info      = cached_file_info;
-        using readme_data_store     = std::vector<std::vector<line_data_base>>;
-        using readme_listing_type   = std::vector<readme_file_info>;
+        using readme_entry_type     = std::vector<line_data_base>;     // The data of a readme, as in its cache entry
 
         // Stores a virtual file system which contains the list of data files we got
         vfs<const modloader::file*> fs;
@@ -188,6 +187,13 @@ class DataPlugin : public modloader::basic_plugin
         linear_map<const modloader::file*, std::list<line_data>> maybe_readme;
         using maybe_readme_type = decltype(maybe_readme);
 
+        // Content digest of each readme in maybe_readme, and the readmes whose cache entry needs to be (re)written
+        linear_map<const modloader::file*, std::string> readme_digests;
+        std::set<const modloader::file*> changed_readmes;
+
+        // Per readme cache entries
+        readme_cache readme_entries;
+
         std::map<std::type_index, const char*> storetype2what;
 
         bool had_cached_readme = false;
@@ -204,7 +210,8 @@ class DataPlugin : public modloader::basic_plugin
         void InstallReadme(const std::set<size_t>&);
         void UninstallReadme(const modloader::file&);
 
-        std::set<size_t> ParseReadme(const modloader::file&);
+        bool ReadReadme(const modloader::file&, std::pair<const char* /*begin*/, const char* /*end*/>&);
+        std::pair<const char*, const char*> DecodeReadme(std::pair<const char* /*begin*/, const char* /*end*/>);
         std::set<size_t> ParseReadme(const modloader::file&, std::pair<const char* /*begin*/, const char* /*end*/>);
         
         // Before the game startups we shouldn't write a readme cache, because during the loading screen it's the time
@@ -213,8 +220,8 @@ class DataPlugin : public modloader::basic_plugin
 
         // Cached readme I/O
         bool VerifyCachedReadme(std::ifstream& ss, cereal::BinaryInputArchive& archive);
-        readme_listing_type ReadCachedReadmeListing();
-        readme_data_store   ReadCachedReadmeStore();
+        bool ReadCachedReadme(const std::string& digest, readme_entry_type& entry);
+        bool WriteCachedReadme(const std::string& digest, const std::list<line_data>& lines);
         void WriteReadmeCache();
 
     public:
@@ -350,8 +357,10 @@ class DataPlugin : public modloader::basic_plugin
             for(size_t i = 0; i < ov.NumInjections(); ++i)
             {
                 // Merges data whenever necessary to open this file. Caching can happen.
+                // GetIplFile depends only on the virtual filesystem, the cache gets invalidated whenever it changes.
                 auto& d = static_cast<detour_type&>(ov.GetInjection(i));
                 d.OnTransform(std::bind(&DataPlugin::GetIplFile, this, _1, fsfile, unique, samefile, complete_path));
+                d.EnableCache();
             }
 
             // Replaces standard OnHook with this one, which just makes the call no setfile (since many files)
@@ -384,10 +393,17 @@ class DataPlugin : public modloader::basic_plugin
         }
 
 
+        // Tells the data of the readme 'file' changed, so its cache entry needs to be written
+        void MarkReadmeChanged(const modloader::file& file)
+        {
+            this->changed_readme_data = true;
+            this->changed_readmes.emplace(&file);
+        }
+
         // Adds a readme data which contains no line data at all
         void AddDummyReadme(const modloader::file& file)
         {
-            this->changed_readme_data = true;
+            this->MarkReadmeChanged(file);
             maybe_readme[&file];
         }
 
@@ -395,7 +411,7 @@ class DataPlugin : public modloader::basic_plugin
         void AddReadmeData(const modloader::file& file, maybe<size_t> merger_hash, either<std::string, boost::any> data,
             size_t line_number, std::type_index owner)
         {
-            this->changed_readme_data = true;
+            this->MarkReadmeChanged(file);
             maybe_readme[&file].emplace_back(file, merger_hash, std::move(data), line_number, owner);
         }
 
@@ -430,6 +446,8 @@ class DataPlugin : public modloader::basic_plugin
         {
             this->changed_readme_data = true;
             this->maybe_readme.erase(&file);
+            this->readme_digests.erase(&file);
+            this->changed_readmes.erase(&file);
         }
         
 
@@ -477,7 +495,7 @@ class DataPlugin : public modloader::basic_plugin
                             (*refx)->merger_hash = merger_hash;
                             (*refx)->owner = typeid(StoreType);
                             (*refx)->data = boost::any(std::move(maybe_store.get()));
-                            this->changed_readme_data = true;
+                            this->MarkReadmeChanged(file);
                         }
                         else
                             assert(false);
@@ -101,7 +101,7 @@ struct carcols_traits : public data_traits
 };
 
 //
-using carcols_store = gta3::data_store<carcols_traits, std::map<
+using carcols_store = gta3::data_store<carcols_traits, flat_sorted_map<
                         carcols_traits::key_type, carcols_traits::value_type
                         >>;
 
@@ -291,7 +291,7 @@ struct gtadat_traits : public data_traits
 };
 
 //
-using gtadat_store = gta3::data_store<gtadat_traits, std::map<
+using gtadat_store = gta3::data_store<gtadat_traits, flat_sorted_map<
                         gtadat_traits::key_type, gtadat_traits::value_type
                         >>;
 
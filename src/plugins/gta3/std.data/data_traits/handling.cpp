@@ -323,7 +323,7 @@ namespace std
 
 
 //
-using handling_store = gta3::data_store<handling_traits, std::map<
+using handling_store = gta3::data_store<handling_traits, flat_sorted_map<
                         handling_traits::key_type, handling_traits::value_type
                         >>;
 
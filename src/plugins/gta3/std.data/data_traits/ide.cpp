@@ -257,7 +257,7 @@ struct ide_traits : public data_traits
             for(auto it = list.begin(); it != list.end(); )
             {
                 auto& container = it->second.second.get().container();
-                if(std::any_of(container.begin(), container.end(), [&](const std::pair<const key_type, value_type>& kv) {
+                if(std::any_of(container.begin(), container.end(), [&](const typename StoreType::pair_type& kv) {
                     auto the_section = StoreType::section_by_kv(kv.first, kv.second);
                     return !the_section
                         || !(std::find(std::begin(sections), std::end(sections), the_section) != std::end(sections));
@@ -290,7 +290,7 @@ public:
 };
 
 //
-using ide_store = gta3::data_store<ide_traits, std::map<
+using ide_store = gta3::data_store<ide_traits, flat_sorted_map<
                         ide_traits::key_type, ide_traits::value_type
                         >>;
 
@@ -570,11 +570,14 @@ static std::function<void()> MakeIdeReloader()
 
 
         // Perform the refreshing
+        // Every changed line is a refresh of its own, but no entity comes or goes while the IDEs are read, so batch them
         void(*LoadObjectTypes)(const char*) = ReadRelativeOffset(0x5B9206 + 1).get();
+        refresher->BeginBatch();
         for(auto& ide : ide_files)
         {
             LoadObjectTypes(ide.c_str());
         }
+        refresher->EndBatch();
 
         refresher->Release();
     };
@@ -18,6 +18,7 @@
 
 // additional types
 #include <datalib/detail/linear_map.hpp>
+#include <datalib/detail/flat_sorted_map.hpp>
 #include <type_wrapper/floating_point.hpp>
 #include <type_wrapper/datalib/io/floating_point.hpp>
 
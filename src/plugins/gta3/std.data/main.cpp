@@ -90,8 +90,13 @@ bool DataPlugin::OnStartup()
             }
         });
 
+        // Readme cache entries live in their own directory, the single file cache from older builds isn't used anymore
+        std::string readme_dir = cache.GetCachePath("readme");
+        readme_dir.push_back(cNormalizedSlash);
+        DeleteFileA(cache.GetCachePath("readme.ld").data());
+
         // When there's no cache present mark changed_readme_data as true because we'll need to generate a cache
-        this->had_cached_readme   = IsPathA(cache.GetCachePath("readme.ld").data()) != 0;
+        this->had_cached_readme   = cache.CreateDir("readme") && readme_entries.open(readme_dir);
         this->changed_readme_data = !had_cached_readme;
 
         return true;
@@ -317,7 +322,7 @@ void DataPlugin::Update()
     }
     this->ovrefresh.clear();
 
-    // Free up the temporary readme_buffer that may have been allocated in ParseReadme()
+    // Free up the temporary readme_buffer that may have been allocated in ReadReadme()
     this->readme_buffer.reset();
     this->readme_buffer_utf8.clear();
     this->readme_buffer_utf8.shrink_to_fit();
@@ -355,7 +360,10 @@ bool DataPlugin::InstallFile(const modloader::file& file, size_t merger_hash, st
         if(m->CanInstall())
         {
             if(!isreinstall)
+            {
                 fs.add_file(std::move(fspath), std::move(fullpath), &file);
+                m->InvalidateCache();   // paths resolved through the virtual filesystem may have changed
+            }
 
             // Delay in-game installs to go through DataPlugin::Update()
             ovrefresh.emplace(m);
@@ -397,6 +405,7 @@ bool DataPlugin::UninstallFile(const modloader::file& file, size_t merger_hash,
             // Removing it from our virtual filesystem and possibily refreshing should do it
             if(fs.rem_file(std::move(fspath), &file))
             {
+                m->InvalidateCache();
                 ovrefresh.emplace(m);
                 return true;
             }
@@ -456,51 +465,47 @@ void DataPlugin::UpdateReadmeState()
     for(auto& r : this->readme_touninstall)
         this->UninstallReadme(*r.first);
 
-    if(readme_toinstall.size())
+    // Installs the pending readmes, either by parsing the readme file again or by fetching the data from its cache entry
+    for(auto& r : this->readme_toinstall)
     {
-        readme_listing_type cached_readme_listing = this->ReadCachedReadmeListing();
-        readme_listing_type installing_listing;
-        readme_data_store   cached_readme_store;
-        
-        // Builds the listing about the readmes going to be installed...
-        installing_listing.reserve(this->readme_toinstall.size());
-        std::transform(readme_toinstall.begin(), readme_toinstall.end(), std::back_inserter(installing_listing),
-            [](const std::pair<const modloader::file*, int>& file) -> const modloader::file& {
-                return *file.first;
-        });
-
-        if(cached_readme_listing.size())    // Do we have any cached readme?
+        auto& file = *r.first;
+        readme_cache::key key = { uint32_t(modloader::hash(file.filepath())), file.size, file.time };
+        std::pair<const char*, const char*> raw;
+        readme_entry_type entry;
+        std::string digest;
+
+        // Unchanged readmes know their digest from the index, the others need to be read to find it
+        bool has_raw = false;
+        if(!readme_entries.find(key, digest))
         {
-            // Yeah, we do have cached readmes!!! Read the cached readmes content, i.e. lines itself and their data
-            cached_readme_store = this->ReadCachedReadmeStore();
-            if(cached_readme_store.size() != cached_readme_listing.size())
-            {
-                plugin_ptr->Log("Warning: Cached readme listing seems to not match the cached store, something is really wrong here!");
-                cached_readme_listing.clear();  // problems with the cache, so no cached readme ;)
-                cached_readme_store.clear();    // ^^
-            }
+            if(!this->ReadReadme(file, raw))
+                continue;
+            has_raw = true;
+            digest  = readme_cache::digest(raw.first, raw.second);
         }
 
-        // Installs the pending readmes, either by parsing the readme file again or by fetching the data from the cache
-        auto install_it = readme_toinstall.begin();
-        for(size_t i = 0; i < readme_toinstall.size(); ++i, ++install_it)
+        if(this->ReadCachedReadme(digest, entry))
         {
-            auto& file = *install_it->first;
-            auto it = std::find(cached_readme_listing.begin(), cached_readme_listing.end(), installing_listing[i]);
-            if(it == cached_readme_listing.end())
-            {
-                this->Log("Parsing readme file \"%s\"", file.filepath());
-                this->InstallReadme(ParseReadme(file));
-            }
-            else
+            auto old_state = this->changed_readme_data; // AddReadmeData changes this, but we are over cache
+            this->Log("Parsing cached readme data for \"%s\"", file.filepath());
+            this->InstallReadme(AddReadmeData(file, std::move(entry)));
+            this->changed_readme_data = old_state || has_raw;  // a readme new to the index (touched, moved or copied) needs it rewritten
+        }
+        else
+        {
+            if(!has_raw)
             {
-                auto old_state = this->changed_readme_data; // AddReadmeData changes this, but we are over cache
-                this->Log("Parsing cached readme data for \"%s\"", file.filepath());
-                auto index = std::distance(cached_readme_listing.begin(), it);
-                this->InstallReadme(AddReadmeData(file, std::move(cached_readme_store[index])));
-                this->changed_readme_data = old_state;
+                // The index knew the readme but not its entry, so read it after all
+                if(!this->ReadReadme(file, raw))
+                    continue;
+                digest = readme_cache::digest(raw.first, raw.second);
             }
+
+            this->Log("Parsing readme file \"%s\"", file.filepath());
+            this->InstallReadme(ParseReadme(file, DecodeReadme(raw)));
         }
+
+        this->readme_digests[&file] = std::move(digest);
     }
 
     // Clear the update lists
@@ -510,10 +515,10 @@ void DataPlugin::UpdateReadmeState()
 
 
 /*
- *  DataPlugin::ParseReadme
- *      Parses the specified readme file and returns a list of mergers that are related to data found in this file
+ *  DataPlugin::ReadReadme
+ *      Reads the content of the specified readme file into a temporary buffer, outputting its begin and end into 'raw'
  */
-std::set<size_t> DataPlugin::ParseReadme(const modloader::file& file)
+bool DataPlugin::ReadReadme(const modloader::file& file, std::pair<const char*, const char*>& raw)
 {
     static const size_t max_readme_size = 60000; // ~60KB, don't increase too much to avoid reading too big files.
                                                  // Plus we may have two buffers with this size while readmes are being read.
@@ -530,31 +535,9 @@ std::set<size_t> DataPlugin::ParseReadme(const modloader::file& file)
 
             if(stream.read(&readme_buffer[0], file.size))
             {
-                const char* start = &readme_buffer[0];
-                const char* end   = &readme_buffer[(size_t)(file.size)];
-
-                // If the text is not in UTF-8, convert it to UTF-8!!!!!!
-                auto encoding = unicode::detect_encoding(start, end);
-                if(encoding != unicode::encoding::utf8)
-                {
-                    // Ensure emptyness and capacity for UTF-8 intermediary buffer.
-                    // This buffer will be later freed at Update() time.
-                    readme_buffer_utf8.clear();
-                    readme_buffer_utf8.reserve(max_readme_size);
-
-                    // Convert from the detected encoding to UTF-8 by ignoring any invalid code point (unchecked).
-                    unicode::unchecked::any_to_utf8(encoding, start, end, std::back_inserter(readme_buffer_utf8));
-
-                    // Resetup start and end of text pointers.
-                    start = (const char*)(readme_buffer_utf8.data() + 0);
-                    end   = (const char*)(readme_buffer_utf8.data() + readme_buffer_utf8.size());
-                }
-
-                // Skip BOM
-                if(std::distance(start, end) >= 3 && utf8::is_bom(start))
-                    start = start + 3;
-
-                return this->ParseReadme(file, std::make_pair(start, end));
+                raw.first  = &readme_buffer[0];
+                raw.second = &readme_buffer[(size_t)(file.size)];
+                return true;
             }
             else
                 this->Log("Warning: Failed to read from \"%s\".", file.filepath());
@@ -565,7 +548,40 @@ std::set<size_t> DataPlugin::ParseReadme(const modloader::file& file)
     else
         this->Log("Ignoring text file \"%s\" because it's too big.", file.filepath());
 
-    return std::set<size_t>();
+    return false;
+}
+
+/*
+ *  DataPlugin::DecodeReadme
+ *      Converts the readme content read by ReadReadme into UTF-8 text without BOM, returning the text begin and end
+ */
+std::pair<const char*, const char*> DataPlugin::DecodeReadme(std::pair<const char*, const char*> raw)
+{
+    const char* start = raw.first;
+    const char* end   = raw.second;
+
+    // If the text is not in UTF-8, convert it to UTF-8!!!!!!
+    auto encoding = unicode::detect_encoding(start, end);
+    if(encoding != unicode::encoding::utf8)
+    {
+        // Ensure emptyness and capacity for UTF-8 intermediary buffer.
+        // This buffer will be later freed at Update() time.
+        readme_buffer_utf8.clear();
+        readme_buffer_utf8.reserve(std::distance(start, end) * 2);
+
+        // Convert from the detected encoding to UTF-8 by ignoring any invalid code point (unchecked).
+        unicode::unchecked::any_to_utf8(encoding, start, end, std::back_inserter(readme_buffer_utf8));
+
+        // Resetup start and end of text pointers.
+        start = (const char*)(readme_buffer_utf8.data() + 0);
+        end   = (const char*)(readme_buffer_utf8.data() + readme_buffer_utf8.size());
+    }
+
+    // Skip BOM
+    if(std::distance(start, end) >= 3 && utf8::is_bom(start))
+        start = start + 3;
+
+    return std::make_pair(start, end);
 }
 
 /*
@@ -631,55 +647,37 @@ bool DataPlugin::VerifyCachedReadme(std::ifstream& ss, cereal::BinaryInputArchiv
 }
 
 /*
- *  DataPlugin::ReadCachedReadmeListing
- *      Reads and outputs the readme cache file listing.
+ *  DataPlugin::ReadCachedReadme
+ *      Reads the data_line objects stored in the readme cache entry with the specified content digest
  */
-auto DataPlugin::ReadCachedReadmeListing() -> readme_listing_type
+bool DataPlugin::ReadCachedReadme(const std::string& digest, readme_entry_type& entry)
 {
-    readme_listing_type cached_readme_listing;
-
-    std::ifstream ss(cache.GetCachePath("readme.ld"), std::ios::binary);
+    std::ifstream ss(readme_entries.path(digest), std::ios::binary);
     if(ss.is_open())
     {
-        cereal::BinaryInputArchive archive(ss);
-        if(VerifyCachedReadme(ss, archive))
-        {
-            block_reader listing_block(ss);
-            archive(cached_readme_listing);
-        }
-    }
-    return cached_readme_listing;
-}
-
-/*
- *  DataPlugin::ReadCachedReadmeStore
- *      Reads and outputs the data_line objects stored in the readme cache
- */
-auto DataPlugin::ReadCachedReadmeStore() -> readme_data_store
-{
-    readme_data_store store_lines;
-
-    std::ifstream ss(cache.GetCachePath("readme.ld"), std::ios::binary);
-    if(ss.is_open())
-    {
-        cereal::BinaryInputArchive archive(ss);
-        if(VerifyCachedReadme(ss, archive))
-        {
-            block_reader::skip(ss); // skip listing block
-            block_reader lines_block(ss);
-            archive(store_lines);
+        try {
+            cereal::BinaryInputArchive archive(ss);
+            if(VerifyCachedReadme(ss, archive))
+            {
+                block_reader lines_block(ss);
+                archive(entry);
+                return true;
+            }
+        } catch(const cereal::Exception&) {
+            // Truncated or corrupted entry, parse the readme again
         }
     }
-    return store_lines;
+    entry.clear();
+    return false;
 }
 
 /*
- *  DataPlugin::WriteReadmeCache
- *      Writes the 'this->maybe_readme' object into a readme cache
+ *  DataPlugin::WriteCachedReadme
+ *      Writes the data_line objects of a readme into the readme cache entry with the specified content digest
  */
-void DataPlugin::WriteReadmeCache()
+bool DataPlugin::WriteCachedReadme(const std::string& digest, const std::list<line_data>& lines)
 {
-    std::ofstream ss(cache.GetCachePath("readme.ld"), std::ios::binary);
+    std::ofstream ss(readme_entries.path(digest), std::ios::binary);
     if(ss.is_open())
     {
         cereal::BinaryOutputArchive archive(ss);
@@ -692,39 +690,54 @@ void DataPlugin::WriteReadmeCache()
             archive(this->readme_magics);
         }
 
-        // readmes listing
+        // readme data_line store
         {
-            readme_listing_type files;
-            files.reserve(maybe_readme.size());
-
-            std::transform(maybe_readme.begin(), maybe_readme.end(), std::back_inserter(files),
-                [](const maybe_readme_type::value_type& pair) -> const modloader::file&
-                { return *pair.first; });
+            readme_entry_type entry;
+            entry.reserve(lines.size());
+            std::transform(lines.begin(), lines.end(), std::back_inserter(entry), [](const line_data& line) {
+                return line.base();
+            });
 
-            block_writer listing_block(ss);
-            archive(files);
+            block_writer store_block(ss);
+            archive(entry);
         }
 
-        // readme data_line stores
-        {
-            readme_data_store stores;
-            stores.reserve(maybe_readme.size());
+        return true;
+    }
+    return false;
+}
 
-            // each item in 'stores' stores a list of data from lines in files
-            for(auto& m : this->maybe_readme)
-            {
-                stores.emplace_back();
-                stores.back().reserve(m.second.size());
-                std::transform(m.second.begin(), m.second.end(), std::back_inserter(stores.back()), [](const line_data& line) {
-                    return line.base();
-                });
-            }
+/*
+ *  DataPlugin::WriteReadmeCache
+ *      Writes the cache entries of the readmes whose data changed, and the index of the readmes in 'this->maybe_readme'
+ */
+void DataPlugin::WriteReadmeCache()
+{
+    readme_cache::index_type index;
+    bool result = true;
 
-            block_writer store_block(ss);
-            archive(stores);
-        }
+    // Readmes with the same content share the entry, so it's written once
+    for(auto* file : this->changed_readmes)
+    {
+        auto m = this->maybe_readme.find(file);
+        auto d = this->readme_digests.find(file);
+        if(m != this->maybe_readme.end() && d != this->readme_digests.end())
+            result = this->WriteCachedReadme(d->second, m->second) && result;
+    }
 
+    for(auto& pair : this->readme_digests)
+    {
+        auto& file = *pair.first;
+        readme_cache::key key = { uint32_t(modloader::hash(file.filepath())), file.size, file.time };
+        index[key] = pair.second;
+    }
+
+    if(result && this->readme_entries.save(std::move(index)))
+    {
+        this->changed_readmes.clear();
         this->changed_readme_data = false;
         this->had_cached_readme = true;
     }
+    else
+        this->Log("Warning: Failed to write the readme cache.");
 }
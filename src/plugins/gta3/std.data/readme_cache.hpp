@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2014  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+
+/*
+ *  readme_cache
+ *      Content addressed cache of the data found in readme files.
+ *
+ *      The data of each readme is in its own entry file, named by the digest of the readme content, so readmes with the same
+ *      content (touched, moved or copied into another mod) share the entry and only new content needs to be parsed.
+ *      An index remembers the digest of each readme file by its path hash, size and time, so unchanged readmes don't
+ *      need to be read to find their entry. The content of the entries is up to the user.
+ *
+ *      The index file is the magic and version followed by the records (integers are little endian):
+ *          u32 path hash, u64 size, u64 time, u8 digest length, digest
+ */
+class readme_cache
+{
+    public:
+        struct key
+        {
+            uint32_t path_hash;
+            uint64_t size;
+            uint64_t time;
+
+            bool operator<(const key& rhs) const
+            {
+                if(path_hash != rhs.path_hash) return path_hash < rhs.path_hash;
+                if(size != rhs.size) return size < rhs.size;
+                return time < rhs.time;
+            }
+        };
+
+        using index_type = std::map<key, std::string>;  // Digests by readme
+
+    private:
+        static const uint32_t version = 1;
+
+        std::string dir;            // Directory of the index and entries, with a trailing slash
+        index_type  index;          // As in the index file
+
+    public:
+        // Gets the digest of the readme content in the range [@begin, @end)
+        static std::string digest(const char* begin, const char* end)
+        {
+            // Two FNV-1a 64 with different offset basis, plus the size
+            uint64_t a = 14695981039346656037ULL, b = 0x6C62272E07BB0142ULL;
+            for(const char* p = begin; p != end; ++p)
+            {
+                a = (a ^ uint8_t(*p)) * 1099511628211ULL;
+                b = (b ^ uint8_t(*p)) * 1099511628211ULL;
+            }
+
+            char buf[64];
+            sprintf(buf, "%016llx%016llx%llx", (unsigned long long)(a), (unsigned long long)(b), (unsigned long long)(end - begin));
+            return buf;
+        }
+
+        // Uses the directory @dir (with a trailing slash) for the cache, and reads its index
+        // Returns false if there's no (valid) index in there
+        bool open(std::string dir)
+        {
+            this->dir = std::move(dir);
+            this->index.clear();
+
+            std::string buf;
+            if(!read_file(index_path(), buf))
+                return false;
+
+            const char* p   = buf.data();
+            const char* end = buf.data() + buf.size();
+            if(buf.size() < 12 || memcmp(p, magic(), 8))
+                return false;
+            p += 8;
+            if(get<uint32_t>(p) != version)
+                return false;
+
+            while(end - p >= 21)
+            {
+                key k;
+                k.path_hash = get<uint32_t>(p);
+                k.size      = get<uint64_t>(p);
+                k.time      = get<uint64_t>(p);
+                uint8_t len = get<uint8_t>(p);
+                if(end - p < len) break;
+                index[k].assign(p, len);
+                p += len;
+            }
+
+            if(p != end)
+            {
+                this->index.clear();
+                return false;
+            }
+            return true;
+        }
+
+        // Finds the digest of the readme @k in the index
+        bool find(const key& k, std::string& digest) const
+        {
+            auto it = index.find(k);
+            if(it != index.end())
+            {
+                digest = it->second;
+                return true;
+            }
+            return false;
+        }
+
+        // Gets the path to the entry file with the @digest
+        std::string path(const std::string& digest) const
+        {
+            return dir + digest + ".ld";
+        }
+
+        // Gets the path to the index file
+        std::string index_path() const
+        {
+            return dir + "index";
+        }
+
+        // Replaces the index with @index, then deletes the entries no readme uses anymore
+        bool save(index_type new_index)
+        {
+            std::string buf(magic(), 8);
+            put<uint32_t>(buf, version);
+            for(auto& pair : new_index)
+            {
+                put<uint32_t>(buf, pair.first.path_hash);
+                put<uint64_t>(buf, pair.first.size);
+                put<uint64_t>(buf, pair.first.time);
+                put<uint8_t>(buf, uint8_t(pair.second.size()));
+                buf.append(pair.second);
+            }
+
+            bool result = false;
+            if(FILE* f = fopen(index_path().c_str(), "wb"))
+            {
+                result = (fwrite(buf.data(), 1, buf.size(), f) == buf.size());
+                result = (fclose(f) == 0) && result;
+            }
+
+            if(result)
+            {
+                std::set<std::string> used;
+                for(auto& pair : new_index)
+                    used.emplace(pair.second);
+
+                for(auto& pair : this->index)
+                {
+                    if(!used.count(pair.second))
+                        std::remove(path(pair.second).c_str());
+                }
+
+                this->index = std::move(new_index);
+            }
+            return result;
+        }
+
+    private:
+        static const char* magic()
+        {
+            return "MLREADME";
+        }
+
+        static bool read_file(const std::string& path, std::string& out)
+        {
+            if(FILE* f = fopen(path.c_str(), "rb"))
+            {
+                char buf[4096];
+                size_t n;
+                while((n = fread(buf, 1, sizeof(buf), f)) != 0)
+                    out.append(buf, n);
+                fclose(f);
+                return true;
+            }
+            return false;
+        }
+
+        template<class T>
+        static void put(std::string& out, T value)
+        {
+            for(size_t i = 0; i < sizeof(T); ++i)
+                out.push_back(char(uint8_t(uint64_t(value) >> (i * 8))));
+        }
+
+        template<class T>
+        static T get(const char*& p)
+        {
+            uint64_t value = 0;
+            for(size_t i = 0; i < sizeof(T); ++i)
+                value |= uint64_t(uint8_t(*p++)) << (i * 8);
+            return T(value);
+        }
+};
@@ -432,6 +432,44 @@ namespace datalib
         }
         return is;
     }
+
+    /*
+    *  Fast Input
+    */
+    template<size_t GameFlag, class T> inline
+        datalib::line_scanner& operator>>(datalib::line_scanner& is, only_game<GameFlag, T>& og)
+    {
+        if(og.check_game())
+        {
+            T obj;
+            if(is >> obj)
+            {
+                og.data.emplace(std::move(obj));
+            }
+        }
+        else if(GameFlag & GAMEFLAG_FAIL_IF_NOT_GAME)
+        {
+            is.failed();
+        }
+        return is;
+    }
+
+    /*
+    *  Fast Output
+    */
+    template<size_t GameFlag, class T> inline
+        datalib::line_printer& operator<<(datalib::line_printer& os, const only_game<GameFlag, T>& og)
+    {
+        if(og.check_game())
+        {
+            ((os << og.data.get()) && print_separator<T>(os));
+        }
+        else if(GameFlag & GAMEFLAG_FAIL_IF_NOT_GAME)
+        {
+            os.failed();
+        }
+        return os;
+    }
 }
 
 namespace std
@@ -37,7 +37,7 @@ struct grass_dff_detour : RwStreamOpenDetour<addr>
             int i, j;
 
             // Get d grazz
-            if(sscanf(&fpath[GetLastPathComponent(std::string(fpath))], "grass%d_%d.dff", &i, &j) >= 2)
+            if(sscanf(&fpath[GetLastPathComponent(fpath)], "grass%d_%d.dff", &i, &j) >= 2)
                 this->path = grass(i,j);
             else
                 this->path.clear();
@@ -68,6 +68,7 @@ struct grass_dff_detour : RwStreamOpenDetour<addr>
         {
             make_call();
             grass(i, j) = std::move(path);
+            this->InvalidateCache();       // the cache is keyed by the grass filename, which maps to grass(i,j)
         }
 };
 
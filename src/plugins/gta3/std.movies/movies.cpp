@@ -40,8 +40,20 @@ REGISTER_ML_PLUGIN(::mpg_plugin);
  */
 const MediaPlugin::info& MediaPlugin::GetInfo()
 {
+    // Same as GetBehaviour, lets Mod Loader find out the behaviour of files without calling it
+    static const uint32_t flags     = MODLOADER_RULE_NODIR;
+    static const uint32_t logo      = modloader::hash("logo.mpg");
+    static const uint32_t GTAtitles = modloader::hash("gtatitles.mpg");
+    static const modloader_rule_t rules[] =
+    {
+        { logo,                                flags, "mpg", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, logo },
+        { GTAtitles,                           flags, "mpg", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, GTAtitles },
+        { modloader::hash("gtatitlesger.mpg"), flags, "mpg", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, GTAtitles },
+        { 0 }
+    };
+
     static const char* extable[] = { "mpg", 0 };
-    static const info xinfo      = { "std.movies", get_version_by_date(), "LINK/2012", -1, extable };
+    static const info xinfo      = { "std.movies", get_version_by_date(), "LINK/2012", -1, extable, rules, true };
     return xinfo;
 }
 
@@ -35,8 +35,16 @@ REGISTER_ML_PLUGIN(::scm_plugin);
  */
 const ScmPlugin::info& ScmPlugin::GetInfo()
 {
+    // Same as GetBehaviour, lets Mod Loader find out the behaviour of files without calling it
+    static const uint32_t flags  = MODLOADER_RULE_NODIR | MODLOADER_RULE_ORHASH;
+    static const modloader_rule_t rules[] =
+    {
+        { modloader::hash("main.scm"), flags, "scm", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, 0 },
+        { 0 }
+    };
+
     static const char* extable[] = { "scm", 0 };
-    static const info xinfo      = { "std.scm", get_version_by_date(), "LINK/2012", -1, extable };
+    static const info xinfo      = { "std.scm", get_version_by_date(), "LINK/2012", -1, extable, rules, true };
     return xinfo;
 }
 
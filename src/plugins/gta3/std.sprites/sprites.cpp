@@ -21,8 +21,8 @@ static const uint64_t is_splash_mask = 0x0000000200000000;  // Mask for is_splas
 class ScriptSpritesPlugin : public modloader::basic_plugin
 {
     private:
-        std::map<std::string, const modloader::file*> script_dicts;
-        std::map<std::string, const modloader::file*> splash_dicts;
+        hashed_redirect_table script_dicts;     // Redirects to the path relative to the game directory
+        hashed_redirect_table splash_dicts;     // Redirects to the full path
 
     public:
         const info& GetInfo();
@@ -67,11 +67,8 @@ bool ScriptSpritesPlugin::OnStartup()
         // Hooks the CTxdStore::LoadTxd at the script engine
         make_static_hook<schooker>([this](schooker::func_type LoadTxd, int& index, const char*& filepath)
         {
-            std::string filename = filepath;
-            filename = &filepath[GetLastPathComponent(filename)];
-
-            auto it = script_dicts.find(tolower(filename));
-            if(it != script_dicts.end()) filepath = it->second->filepath();
+            if(auto entry = script_dicts.find_path(filepath))
+                filepath = entry->path.c_str();
 
             Log("Loading script sprite \"%s\"", filepath);
             return LoadTxd(index, filepath);
@@ -82,15 +79,8 @@ bool ScriptSpritesPlugin::OnStartup()
             // Hooks the CTxdStore::LoadTxd at the splash loader.
             make_static_hook<sphooker>([this](sphooker::func_type LoadTxd, int& index, const char*& filepath)
             {
-                std::string filename = filepath;
-                filename = &filepath[GetLastPathComponent(filename)];
-
-                auto it = splash_dicts.find(tolower(filename));
-                if(it != splash_dicts.end())
-                {
-                    filename = it->second->fullpath();
-                    filepath = filename.c_str();
-                }
+                if(auto entry = splash_dicts.find_path(filepath))
+                    filepath = entry->path.c_str();
 
                 Log("Loading splash sprite \"%s\"", filepath);
                 return LoadTxd(index, filepath);
@@ -138,9 +128,9 @@ int ScriptSpritesPlugin::GetBehaviour(modloader::file& file)
 bool ScriptSpritesPlugin::InstallFile(const modloader::file& file)
 {
     if(file.behaviour & is_script_mask)
-        script_dicts.emplace(file.filename(), &file);
+        script_dicts.insert(file, false);
     else if(file.behaviour & is_splash_mask)
-        splash_dicts.emplace(file.filename(), &file);
+        splash_dicts.insert(file);
     return true;
 }
 
@@ -161,8 +151,8 @@ bool ScriptSpritesPlugin::ReinstallFile(const modloader::file& file)
 bool ScriptSpritesPlugin::UninstallFile(const modloader::file& file)
 {
     if(file.behaviour & is_script_mask)
-        script_dicts.erase(file.filename());
+        script_dicts.erase(file);
     else if(file.behaviour & is_splash_mask)
-        splash_dicts.erase(file.filename());
+        splash_dicts.erase(file);
     return true;
 }
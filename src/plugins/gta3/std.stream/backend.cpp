@@ -51,6 +51,7 @@ extern "C"
             plugin_ptr->Log("Resource id %d has been deleted from disk, falling back to stock model.", id);
             streaming->FallbackResource(id, true);   // forceful but safe since we are before info setup in RequestModelStream
         }
+        if(streaming->readahead) streaming->ReadAhead(id);
     }
 
     static HANDLE __stdcall CreateFileForCdStream(
@@ -60,9 +61,11 @@ extern "C"
     {
         LPCSTR lpActualFileName = streaming->GetCdStreamPath(lpFileName);
         plugin_ptr->Log("Opening file for streaming \"%s\"", lpActualFileName);
-        return CreateFileA(
+        HANDLE hFile = CreateFileA(
             lpActualFileName, dwDesiredAccess, dwShareMode,
             lpSecurityAttributes, dwCreationDisposition, dwFlagsAndAttributes, hTemplateFile);
+        if(streaming->tracer) streaming->tracer->RegisterCdFile(hFile, lpActualFileName);
+        return hFile;
     }
 
     
@@ -175,6 +178,7 @@ int __stdcall CdStreamThread()
             HANDLE hFile    = (HANDLE) cd->hFile;
             bool bResult    = false;
             const char* filename = nullptr; int index = -1; // When abstract those fields are valid
+            uint64_t tBegin = 0;
             
             // Try to find abstract file from hFile
             if(true)
@@ -201,6 +205,8 @@ int __stdcall CdStreamThread()
                                                                                 offset, size);                                                       
 #endif
 
+            if(streaming->tracer) tBegin = streaming->tracer->Now();
+
             // Setup overlapped structure
             LARGE_INTEGER offset_li;
             DWORD nBytesReaden;
@@ -208,8 +214,13 @@ int __stdcall CdStreamThread()
             cd->overlapped.Offset     = offset_li.LowPart;
             cd->overlapped.OffsetHigh = offset_li.HighPart;
             
-            // Read the stream
-            if(ReadFile(hFile, cd->lpBuffer, size, &nBytesReaden, &cd->overlapped))
+            // Read the stream, abstract files may have been read ahead already
+            if(bIsAbstract && streaming->readahead
+            && streaming->readahead->take(index, sfile->info.file->fullpath(), size, cd->lpBuffer))
+            {
+                bResult = true;
+            }
+            else if(ReadFile(hFile, cd->lpBuffer, size, &nBytesReaden, &cd->overlapped))
             {
                 bResult = true;
             }
@@ -228,6 +239,15 @@ int __stdcall CdStreamThread()
             // There's some real problem if we can't load a abstract model
             if(bIsAbstract && !bResult)
                 plugin_ptr->Log("Warning: Failed to load abstract model file %s; error code: 0x%X", filename, GetLastError());
+
+            // Record the request if tracing the streaming
+            if(streaming->tracer)
+            {
+                auto& tracer = *streaming->tracer;
+                int id       = bIsAbstract? index : tracer.QueuedId(i);
+                auto type    = bIsAbstract? GetResType(*sfile->info.file) : id != -1? streaming->GetIdType(id) : ResType::None;
+                tracer.Record(i, id, uint8_t(type), hFile, filename, offset, size, tBegin, tracer.Now(), bResult);
+            }
             
 
             // Set the cdstream status, 0 for "okay" and 254 for "failed to read"
@@ -390,6 +410,60 @@ void CAbstractStreaming::CloseModel(AbctFileHandle* file)
     this->stm_files.remove(*file);
 }
 
+/*
+ *  CAbstractStreaming::StartTrace
+ *      Starts recording the requests served by CdStreamThread into the trace file at path (relative to the game directory)
+ */
+void CAbstractStreaming::StartTrace(const std::string& path)
+{
+    std::string fullpath = IsAbsolutePath(path)? path : std::string(plugin_ptr->loader->gamepath).append(path);
+    std::unique_ptr<CStreamTracer> t(new CStreamTracer());
+
+    if(t->Open(fullpath.c_str()))
+    {
+        plugin_ptr->Log("Recording streaming trace into \"%s\"", fullpath.c_str());
+        this->tracer = std::move(t);
+    }
+    else
+        plugin_ptr->Log("Warning: Failed to open streaming trace file \"%s\"", fullpath.c_str());
+}
+
+/*
+ *  CAbstractStreaming::StartReadAhead
+ *      Starts reading ahead the abstract files likely to be requested soon, keeping up to budget bytes in memory
+ */
+void CAbstractStreaming::StartReadAhead(size_t budget)
+{
+    plugin_ptr->Log("Reading ahead abstract files with a %u KiB cache", unsigned(budget / 1024));
+    this->readahead.reset(new stream_readahead::cache(budget));
+}
+
+/*
+ *  CAbstractStreaming::ReadAhead
+ *      Called when the resource id is about to be read, reads ahead the abstract files likely to be requested next.
+ *      That is, the texture dictionary of the model and the resources that followed it on previous requests.
+ */
+void CAbstractStreaming::ReadAhead(id_t id)
+{
+    std::vector<uint32_t> next;
+    id_t txd = -1;
+
+    this->predictor.observe(id);
+    this->predictor.predict(id, next);
+
+    if(gvm.IsSA())       txd = FindModelTxd<TraitsSA>(id);
+    else if(gvm.IsVC())  txd = FindModelTxd<TraitsVC>(id);
+    else if(gvm.IsIII()) txd = FindModelTxd<TraitsIII>(id);
+    if(txd != -1) next.insert(next.begin(), txd);
+
+    for(auto nid : next)
+    {
+        auto it = this->imports.find(nid);
+        if(it != this->imports.end() && !it->second.isFallingBack && !this->IsModelAvailable(nid))
+            readahead->prefetch(nid, it->second.file->fullpath(fbuffer), size_t(it->second.file->size));
+    }
+}
+
 /*
  *  CAbstractStreaming::DoesModelNeedsFallback
  *      If the specified model id is under our control, make entirely sure it's present on disk.
@@ -575,6 +649,7 @@ void CAbstractStreaming::Patch()
             auto f = [](cdread_hook::func_type CdStreamRead, int& streamNum, void*& buf, int& sectorOffset, int& sectorCount)
             {
                 iModelBeingLoaded = iNextModelBeingLoaded;
+                if(streaming->tracer) streaming->tracer->Queue(streamNum, iModelBeingLoaded);
                 auto result = CdStreamRead(streamNum, buf, sectorOffset, sectorCount);
                 iModelBeingLoaded = iNextModelBeingLoaded = -1;
                 return result;
@@ -661,12 +736,12 @@ void CAbstractStreaming::Patch()
         {
             // Check if we have a overrider for this clothing item (based on directory offset)
             DirectoryInfo* entry;
-            auto it = this->clothes.find(InfoForModel(index)->GetOffset());
-            if(it != clothes.end() && (entry = this->FindClothEntry(it->second->hash)))
+            auto item = this->clothes.find(InfoForModel(index)->GetOffset());
+            if(item && (entry = this->FindClothEntry(item->hash)))
             {
                 // Yep, we have a overrider, save stock entry and quickly import our abstract model
-                this->RegisterStockEntry(it->second->filename(), *entry, index, InfoForModel(index)->GetImgId());
-                this->QuickImport(index, it->second, false, true);
+                this->RegisterStockEntry(item->file->filename(), *entry, index, InfoForModel(index)->GetImgId());
+                this->QuickImport(index, item->file, false, true);
             }
             else
             {
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2014  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#ifndef CLOTH_REGISTRY_HPP
+#define	CLOTH_REGISTRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+/*
+ *  cloth_registry
+ *      Association between the imported clothing items and the files overriding them.
+ *
+ *      An item is known by its offset in the clothing directory, its model (filename) hash and the file bound to it,
+ *      any of those finds the item in constant time and insertions/removals keep all the directions consistent.
+ *      T is the file type, only pointers to it are stored.
+ */
+template<class T>
+class cloth_registry
+{
+    public:
+        using offset_type = uint32_t;
+        using hash_type   = uint32_t;
+
+        // A imported clothing item
+        struct item
+        {
+            offset_type offset;     // Offset of the item in the clothing directory
+            hash_type   hash;       // Model hash of the item
+            const T*    file;       // File overriding the item
+
+            item(offset_type offset, hash_type hash, const T* file)
+                : offset(offset), hash(hash), file(file)
+            {}
+        };
+
+    public:
+        // Binds @file to the item at @offset with the model @hash
+        // Fails if any of those is already bound to another item
+        bool insert(offset_type offset, hash_type hash, const T* file)
+        {
+            if(by_offset.count(offset) || by_hash.count(hash) || by_file.count(file))
+                return false;
+
+            by_offset.emplace(offset, item(offset, hash, file));
+            by_hash.emplace(hash, offset);
+            by_file.emplace(file, offset);
+            return true;
+        }
+
+        // Finds the item at the directory @offset, returns null if not found
+        const item* find(offset_type offset) const
+        {
+            auto it = by_offset.find(offset);
+            return it != by_offset.end()? &it->second : nullptr;
+        }
+
+        // Finds the item with the model @hash, returns null if not found
+        const item* find_hash(hash_type hash) const
+        {
+            auto it = by_hash.find(hash);
+            return it != by_hash.end()? find(it->second) : nullptr;
+        }
+
+        // Finds the item bound to @file, returns null if not found
+        const item* find_file(const T* file) const
+        {
+            auto it = by_file.find(file);
+            return it != by_file.end()? find(it->second) : nullptr;
+        }
+
+        // Removes the item at the directory @offset, returns false if there's no such item
+        bool erase(offset_type offset)
+        {
+            auto it = by_offset.find(offset);
+            if(it != by_offset.end())
+            {
+                by_hash.erase(it->second.hash);
+                by_file.erase(it->second.file);
+                by_offset.erase(it);
+                return true;
+            }
+            return false;
+        }
+
+        // Removes the item bound to @file, returns false if there's no such item
+        bool erase_file(const T* file)
+        {
+            auto it = by_file.find(file);
+            return it != by_file.end()? erase(it->second) : false;
+        }
+
+        size_t size() const     { return by_offset.size(); }
+        bool empty() const      { return by_offset.empty(); }
+
+        void clear()
+        {
+            by_offset.clear();
+            by_hash.clear();
+            by_file.clear();
+        }
+
+    private:
+        std::unordered_map<offset_type, item>           by_offset;  // Directory offset to item
+        std::unordered_map<hash_type, offset_type>      by_hash;    // Model hash to directory offset
+        std::unordered_map<const T*, offset_type>       by_file;    // File to directory offset
+};
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#ifndef ENTITY_INDEX_HPP
+#define	ENTITY_INDEX_HPP
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/*
+ *  entity_model_index
+ *      Index of the entities in the game pools by their model id.
+ *
+ *      It's built in a single pass over the pools and then finds the entities using a set of models without sweeping
+ *      the pools again, so many refreshes done at once (e.g. one for each changed IDE line) share the same pass.
+ *      The index is only valid while no entity gets added to or removed from the pools, clear() it after that.
+ *
+ *      T is the game traits (see traits/gta3), used to get the model of the entities.
+ */
+template<class T>
+class entity_model_index
+{
+    public:
+        using id_t  = typename T::id_t;
+        using entry = std::pair<id_t, void*>;       // <model, entity>
+
+    public:
+        // Checks if any pool has been indexed since the last clear()
+        bool ready() const  { return this->indexed; }
+
+        // Drops the index
+        void clear()
+        {
+            this->entries.clear();
+            this->indexed  = false;
+            this->unsorted = false;
+        }
+
+        // Indexes the entities in the @pool (a CPool)
+        // Entities of the same model are kept in the order their pools and slots were indexed
+        template<class PoolType>
+        void add_pool(PoolType* pool)
+        {
+            this->indexed = true;
+            this->entries.reserve(entries.size() + pool->m_Size);
+            for(int i = 0; i < pool->m_Size; ++i)
+            {
+                if(auto* entity = pool->GetAt(i))
+                {
+                    id_t id = T::GetEntityModel(entity);
+                    if(!entries.empty() && id < entries.back().first) this->unsorted = true;
+                    entries.emplace_back(id, (void*)(entity));
+                }
+            }
+        }
+
+        // Calls @cb(id, entity) for each indexed entity using the model @id
+        template<class F>
+        void find(id_t id, F cb) const
+        {
+            this->sort();
+            auto it = std::lower_bound(entries.begin(), entries.end(), id, entry_less());
+            for(; it != entries.end() && it->first == id; ++it)
+                cb(it->first, it->second);
+        }
+
+        // Calls @cb(id, entity) for each indexed entity using any of the models in the keys of the associative container @models
+        template<class Map, class F>
+        void find_all(const Map& models, F cb) const
+        {
+            for(auto& pair : models)
+                this->find(pair.first, cb);
+        }
+
+    private:
+        struct entry_less
+        {
+            bool operator()(const entry& a, id_t id) const { return a.first < id; }
+        };
+
+        struct entry_model_less
+        {
+            bool operator()(const entry& a, const entry& b) const { return a.first < b.first; }
+        };
+
+        void sort() const
+        {
+            if(this->unsorted)
+            {
+                std::stable_sort(entries.begin(), entries.end(), entry_model_less());
+                this->unsorted = false;
+            }
+        }
+
+    private:
+        mutable std::vector<entry>  entries;            // Entities sorted by model (once 'unsorted' is false)
+        mutable bool                unsorted = false;   // Whether 'entries' needs sorting
+        bool                        indexed  = false;   // Whether any pool has been indexed
+};
+
+#endif
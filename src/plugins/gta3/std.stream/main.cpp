@@ -6,11 +6,13 @@
  */
 #include <stdinc.hpp>
 #include "streaming.hpp"
+#include <shellapi.h>
 //using namespace modloader;
 
 static const size_t ped_ifp = modloader::hash("ped.ifp");
 
 static bool ShouldIgnoreFile(const modloader::file&);
+static std::string GetCommandLineValue(const wchar_t* name);
 
 /*
  *  The plugin object
@@ -62,6 +64,14 @@ bool ThePlugin::OnStartup()
         streaming->Patch();
         streaming->InitRefreshInterface(); // TODO move to ctor?
 
+        // Record the streaming requests if asked to (-streamtrace <file>)
+        auto tracepath = GetCommandLineValue(L"streamtrace");
+        if(!tracepath.empty()) streaming->StartTrace(tracepath);
+
+        // Read ahead abstract files if asked to (-streamreadahead <MiB>)
+        auto readahead = std::strtoul(GetCommandLineValue(L"streamreadahead").c_str(), 0, 0);
+        if(readahead) streaming->StartReadAhead(size_t(readahead) * 1024 * 1024);
+
         // Setup ped.ifp overrider
         if(gvm.IsIII())
         {
@@ -87,6 +97,13 @@ bool ThePlugin::OnShutdown()
 {
     if(streaming)
     {
+        if(streaming->readahead)
+        {
+            auto stats = streaming->readahead->get_statistics();
+            plugin_ptr->Log("Read ahead statistics: %u hits, %u misses, %u files read ahead, %u evicted unused, %u dropped",
+                unsigned(stats.hits), unsigned(stats.misses), unsigned(stats.loaded), unsigned(stats.evicted), unsigned(stats.dropped));
+        }
+
         streaming->ShutRefreshInterface(); // TODO move to dtor?
         delete streaming;
         streaming = nullptr;
@@ -285,4 +302,30 @@ bool ShouldIgnoreFile(const modloader::file& file)
     }
 
     return false;
-}
\ No newline at end of file
+}
+
+/*
+*  GetCommandLineValue
+*      Gets the argument after the -name command line, empty if the command line isn't there
+*/
+std::string GetCommandLineValue(const wchar_t* name)
+{
+    std::string result;
+    int argc;
+
+    if(wchar_t** argv = CommandLineToArgvW(GetCommandLineW(), &argc))
+    {
+        for(int i = 0; i + 1 < argc; ++i)
+        {
+            if(argv[i][0] == '-' && !_wcsicmp(&argv[i][1], name))
+            {
+                char buf[MAX_PATH];
+                if(WideCharToMultiByte(CP_ACP, 0, argv[i+1], -1, buf, sizeof(buf), NULL, NULL))
+                    result = buf;
+                break;
+            }
+        }
+        LocalFree(argv);
+    }
+    return result;
+}
@@ -7,6 +7,7 @@
 #include <stdinc.hpp>
 #include <interfaces/gta3/std.stream.hpp>
 #include "streaming.hpp"
+#include "entity_index.hpp"
 using namespace modloader;
 
 
@@ -84,6 +85,8 @@ class Refresher : public IStreamRefresher, private T
         std::map<id_t,  std::vector<id_t>>  mTxdAssoc;      // Map of association between a txd and many dffs
         std::map<EntityType, EntityEvent>   mEntityEvents;  // Map of association between type of entities and their refreshing events
         std::map<id_t, RefreshInfo>         mToRefresh;     // List of resources that needs to be refreshed (dff/txd/col/ifp/ipl/etc)
+        entity_model_index<T>               mEntityIndex;   // Entities in the pools by model, kept between the refreshes of a batch
+        bool                                mInBatch = false; // Whether between BeginBatch and EndBatch
 
         // List populated by the user
         std::vector<id_t>                   mRefreshRequests; // Resources asked to be refreshed
@@ -95,6 +98,10 @@ class Refresher : public IStreamRefresher, private T
         // Initialization
         void RebuildTxdAssociationMap() override;
 
+        // Batches
+        void BeginBatch() override;
+        void EndBatch() override;
+
         // Actual refreshing
         void DestroyEntities() override;
         void RemoveModels() override;
@@ -139,29 +146,11 @@ class Refresher : public IStreamRefresher, private T
         // This should be ran only after the txd association map is already built
         const std::vector<id_t>& GetModelsUsingTxdIndex(id_t index);
 
-        // Adds entities from the pool at @addr where the type of pool is @PoolType into the entities association map
-        // This should be ran after the refresh map is already built
+        // Adds entities from the pool at @addr where the type of pool is @PoolType into the entity index
         template<uintptr_t addr, class PoolType>
-        void BuildEntitiesAssociationForPool()
+        void IndexEntitiesForPool()
         {
-            auto* pEntityPool = lazy_object<addr, PoolType*>::get();
-            for(int i = 0; i < pEntityPool->m_Size; ++i)
-            {
-                if(auto* pEntity = pEntityPool->GetAt(i))
-                {
-                    if(GetEntityRwObject(pEntity))  // Has a RwObject attached to it?
-                    {
-                        // If this entity id is on the refresh list, place it on the entity association map
-                        auto id = GetEntityModel(pEntity);
-                        auto it = mToRefresh.find(id);
-                        if(it != mToRefresh.end())
-                        {
-                            if(!it->second.bShallLoadBack) it->second.bShallLoadBack = ShallLoadBackEntity(pEntity);
-                            this->mEntityAssoc[id].emplace_back((void*)(pEntity));
-                        }
-                    }
-                }
-            }
+            this->mEntityIndex.add_pool(lazy_object<addr, PoolType*>::get());
         }
 
         // Checks if a specific entity should have it's RwObject loaded back after it gets unloaded
@@ -376,10 +365,28 @@ template<class T> void Refresher<T>::BuildRefreshMap()
  */
 template<class T> void Refresher<T>::BuildEntitiesAssociationMap()
 {
-    BuildEntitiesAssociationForPool<0xB74490, PedPool_t>();         // Ped entities
-    BuildEntitiesAssociationForPool<0xB74494, VehiclePool_t>();     // Vehicle entities
-    BuildEntitiesAssociationForPool<0xB74498, BuildingPool_t>();    // Static entities
-    BuildEntitiesAssociationForPool<0xB7449C, ObjectPool_t>();      // Dynamic entities
+    // Sweep the pools only once for all the refreshes of a batch, entities do not come and go during those
+    if(!this->mInBatch)
+        this->mEntityIndex.clear();
+
+    if(!this->mEntityIndex.ready())
+    {
+        IndexEntitiesForPool<0xB74490, PedPool_t>();         // Ped entities
+        IndexEntitiesForPool<0xB74494, VehiclePool_t>();     // Vehicle entities
+        IndexEntitiesForPool<0xB74498, BuildingPool_t>();    // Static entities
+        IndexEntitiesForPool<0xB7449C, ObjectPool_t>();      // Dynamic entities
+    }
+
+    // Place the entities using the models on the refresh list on the entity association map
+    this->mEntityIndex.find_all(this->mToRefresh, [this](id_t id, void* entity)
+    {
+        if(GetEntityRwObject(entity))  // Has a RwObject attached to it?
+        {
+            auto& info = this->mToRefresh[id];
+            if(!info.bShallLoadBack) info.bShallLoadBack = ShallLoadBackEntity(entity);
+            this->mEntityAssoc[id].emplace_back(entity);
+        }
+    });
 }
 
 
@@ -601,6 +608,27 @@ template<class T> void Refresher<T>::Clear()
     this->mToRefresh.clear();
     this->mEntityAssoc.clear();
     this->mSavedEntityData.clear();
+    if(!this->mInBatch) this->mEntityIndex.clear();
+}
+
+/*
+ *  Refresher::BeginBatch
+ *      Starts a batch of refreshes, the entity index built by the first refresh is kept until EndBatch
+ */
+template<class T> void Refresher<T>::BeginBatch()
+{
+    this->mInBatch = true;
+    this->mEntityIndex.clear();
+}
+
+/*
+ *  Refresher::EndBatch
+ *      Ends the batch of refreshes, dropping the entity index
+ */
+template<class T> void Refresher<T>::EndBatch()
+{
+    this->mInBatch = false;
+    this->mEntityIndex.clear();
 }
 
 
@@ -646,5 +674,6 @@ void CAbstractStreaming::ShutRefreshInterface()
 
 template<class T> void Refresher<T>::Release()
 {
+    this->EndBatch();
     delete this;
 }
@@ -427,7 +427,7 @@ bool CAbstractStreaming::ImportCloth(const modloader::file* file)
             // The else condition calls this function again so it goes by this path
 
             // Allow import only if we don't have any clothing like that installed
-            return this->clothes.emplace(entry->m_dwFileOffset, file).second;
+            return this->clothes.insert(entry->m_dwFileOffset, file->hash, file);
         }
         else if(true)
         {
@@ -452,19 +452,13 @@ bool CAbstractStreaming::ImportCloth(const modloader::file* file)
  */
 bool CAbstractStreaming::UnimportCloth(const modloader::file* file)
 {
-    // Right, since the index is a file offset we need to iterate on the map until we find this file
-    for(auto it = this->clothes.begin(); it != clothes.end(); ++it)
+    if(auto item = this->clothes.find_file(file))
     {
-        if(it->second == file)
+        // We cannot unimport added clothing items during runtime!!!
+        if(this->IsClothSparseOffset(item->offset) == false)
         {
-            // We cannot unimport added clothing items during runtime!!!
-            if(this->IsClothSparseOffset(it->first) == false)
-            {
-                // Fine, let's unimport
-                this->clothes.erase(it);
-                return true;
-            }
-            return false;
+            // Fine, let's unimport
+            return this->clothes.erase(item->offset);
         }
     }
     return false;
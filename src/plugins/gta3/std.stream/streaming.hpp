@@ -8,6 +8,7 @@
 
 #include <list>
 #include <map>
+#include <unordered_map>
 
 #include <modloader/modloader.hpp>
 #include <modloader/util/hash.hpp>
@@ -21,6 +22,9 @@
 #include <traits/gta3/iii.hpp>
 
 #include "cdstreamsync.hpp"
+#include "cloth_registry.hpp"
+#include "tracer.hpp"
+#include <stream_readahead.hpp>
 
 using namespace modloader;
 
@@ -221,7 +225,7 @@ class CAbstractStreaming
 
         // Information maps, those maps are here to help the abstract streaming with some main streaming information
         std::map<hash_t, id_t>      indices;            // Association between all game resources name hashes and indices
-        std::map<hash_t, uint32_t>  clothes_map;        // Association between all clothes name hashes and it's item offset
+        std::unordered_map<hash_t, uint32_t> clothes_map; // Association between all clothes name hashes and it's item offset
         std::map<id_t, struct CdDirectoryItem> cd_dir;  // Important information about all resource files in the game
         std::map<id_t, id_t> prev_on_cd;                // Original InfoForModel next on cd information, <next, prev>
 
@@ -229,7 +233,7 @@ class CAbstractStreaming
         std::map<std::string, const modloader::file*>   raw_models; // Models installed before the streaming initialization ---- (sorted by name!!)
         std::map<id_t, ModelInfo>                       imports;    // Imported abstract models
         std::map<hash_t, const modloader::file*>        special;    // Abstract special models ---- (imported by me) (hashed filename has no extension)
-        std::map<uint32_t, const modloader::file*>      clothes;    // Imported abstract clothes --- (key is offset)
+        cloth_registry<modloader::file>                 clothes;    // Imported abstract clothes --- (by offset, model hash or file)
         std::map<hash_t, NonStreamedInfo_t>             non_stream; // Non streamed resources (requested by default.dat/gta.dat) (.second.first may be nullptr)
 
         // Information for refreshing
@@ -243,6 +247,13 @@ class CAbstractStreaming
         // Dynamic cross-game structures caching
         size_t sizeof_CStreamingInfo;                               // The size of the CStreamingInfo structure
 
+        // Recording of the streaming requests (null if not recording)
+        std::unique_ptr<CStreamTracer> tracer;
+
+        // Read ahead of the imported files (null if disabled), the predictor is used from the game thread only
+        std::unique_ptr<stream_readahead::cache> readahead;
+        stream_readahead::predictor              predictor;
+
     public:
         CAbstractStreaming();
         ~CAbstractStreaming();
@@ -252,6 +263,8 @@ class CAbstractStreaming
         void DataPatch();
         void InitRefreshInterface();
         void ShutRefreshInterface();
+        void StartTrace(const std::string& path);
+        void StartReadAhead(size_t budget);
 
         // Some analogues to the game CStreaming (may perform some additional work)
         void RequestModel(id_t id, uint32_t flags);
@@ -298,6 +311,7 @@ class CAbstractStreaming
         const char* GetCdDirectoryPath(const char* filepath);
         bool DoesModelNeedsFallback(id_t id);
         static HANDLE TryOpenAbstractHandle(int index, HANDLE hFile);
+        void ReadAhead(id_t id);
 
     private:
         // Fetching and loading of cd directories
@@ -444,6 +458,19 @@ class CAbstractStreaming
             return it != cd_dir.end()? it->second.type : ResType::None;
         }
 
+        // Finds the resource id of the texture dictionary used by a model id, returns -1 if none
+        template<class T>   // T = Traits (see traits/gta3)
+        static id_t FindModelTxd(id_t id)
+        {
+            T traits;
+            if(id < traits.dff_end)
+            {
+                id_t txd = traits.GetModelTxdIndex(id);
+                if(txd != -1 && txd < 0xFFFF) return traits.txd_start + txd;
+            }
+            return -1;
+        }
+
 
     private: // Abstract clothes managing
         void BuildClothesMap();
@@ -470,6 +497,7 @@ class CAbstractStreaming
             {
                 this->FlushChannels();      // Bus must be empty before we can install/uninstall stuff
                 this->bIsUpdating = true;
+                if(this->readahead) this->readahead->clear();   // Files are going to change
             }
         }
 
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2014  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#ifndef TRACER_HPP
+#define	TRACER_HPP
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <windows.h>
+#include <modloader/util/path.hpp>
+#include <stream_trace.hpp>
+
+/*
+ *  CStreamTracer
+ *      Records the requests served by CdStreamThread into a stream trace (see stream_trace.hpp).
+ *      Only exists when the game is started with the -streamtrace command line.
+ */
+class CStreamTracer
+{
+    private:
+        CRITICAL_SECTION cs;                    // The cd handles are registered from the game thread
+        stream_trace::writer trace;
+        std::map<HANDLE, std::string> cdfiles;  // Paths of the cd stream files by their handle
+        LARGE_INTEGER freq, start;
+
+        struct pending_t
+        {
+            bool     valid;
+            int      id;        // Resource being loaded into the channel
+            uint64_t queued;    // Time it was queued
+        };
+
+        pending_t pending[64];  // By channel
+
+    public:
+        CStreamTracer()
+        {
+            InitializeCriticalSection(&cs);
+            QueryPerformanceFrequency(&freq);
+            QueryPerformanceCounter(&start);
+            memset(pending, 0, sizeof(pending));
+        }
+
+        ~CStreamTracer()
+        {
+            trace.close();
+            DeleteCriticalSection(&cs);
+        }
+
+        // Starts the trace at @path
+        bool Open(const char* path)
+        {
+            modloader::scoped_lock xlock(this->cs);
+            return trace.open(path);
+        }
+
+        // Microseconds since the tracer creation
+        uint64_t Now()
+        {
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+            uint64_t ticks = uint64_t(now.QuadPart - start.QuadPart);
+            return (ticks / freq.QuadPart) * 1000000 + (ticks % freq.QuadPart) * 1000000 / freq.QuadPart;
+        }
+
+        // Tells the cd stream file at @path has been opened as @hFile
+        void RegisterCdFile(HANDLE hFile, const char* path)
+        {
+            modloader::scoped_lock xlock(this->cs);
+            if(hFile != INVALID_HANDLE_VALUE) cdfiles[hFile] = path;
+        }
+
+        // Tells the resource @id is about to be queued on the @channel (-1 if unknown)
+        void Queue(int channel, int id)
+        {
+            if(channel >= 0 && size_t(channel) < std::extent<decltype(pending)>::value)
+            {
+                pending[channel].valid  = true;
+                pending[channel].id     = id;
+                pending[channel].queued = Now();
+            }
+        }
+
+        // Records a read of the resource @id (-1 if unknown) with the @type by CdStreamThread on the @channel
+        // @loosepath is the path of the file when reading a loose file, otherwise @hFile is the cd stream file
+        // @begin and @end are the times (as in Now) the read started and finished
+        void Record(int channel, int id, uint8_t type, HANDLE hFile, const char* loosepath,
+                    uint64_t offset, uint32_t size, uint64_t begin, uint64_t end, bool result)
+        {
+            stream_trace::record r;
+            pending_t p = { false, -1, begin };
+
+            if(channel >= 0 && size_t(channel) < std::extent<decltype(pending)>::value && pending[channel].valid)
+            {
+                p = pending[channel];
+                pending[channel].valid = false;
+            }
+
+            r.id            = id;
+            r.type          = type;
+            r.flags         = (loosepath? stream_trace::flag_loose : 0) | (result? 0 : stream_trace::flag_failed);
+            r.channel       = uint8_t(channel);
+            r.offset        = offset;
+            r.size          = size;
+            r.queued        = std::min(p.queued, begin);
+            r.queue_time    = uint32_t(begin - r.queued);
+            r.service_time  = uint32_t(end - begin);
+
+            modloader::scoped_lock xlock(this->cs);
+            if(loosepath)
+                r.file = trace.file(loosepath);
+            else
+            {
+                auto it = cdfiles.find(hFile);
+                r.file = trace.file(it != cdfiles.end()? it->second : std::string());
+            }
+            trace.add(r);
+        }
+
+        // Gets the resource id queued on the @channel, -1 if unknown
+        int QueuedId(int channel)
+        {
+            if(channel >= 0 && size_t(channel) < std::extent<decltype(pending)>::value && pending[channel].valid)
+                return pending[channel].id;
+            return -1;
+        }
+};
+
+#endif
@@ -8,6 +8,7 @@
  */
 #include <stdinc.hpp>
 #include <modloader/gta3/fxt.hpp>
+#include <gxt_parser/gxt_parser.hpp>
 using namespace modloader;
 
 static const uint64_t hash_mask   = 0x00000000FFFFFFFF;     // Mask for the hash on the behaviour
@@ -20,13 +21,17 @@ class TextPlugin : public modloader::basic_plugin
 {
     private:
         std::map<uint32_t, const modloader::file*> gxt; // GXT Files Map<hash, file>
+        std::map<uint32_t, injector::gxt_index> gxt_idx;// GXT Tables Index Map<hash, index>
         modloader::fxt_manager fxt;                     // FXT Files Manager
+        uint32_t mission_gxt = 0;                       // Hash of the GXT file the loaded mission text table was read from
 
         LoadFileDetour<0x6A0228> gxt_d1_gta3;           // CText::Load detour for GTA III
         OpenFileDetour<0x6A0228> gxt_d1;                // CText::Load detour
         OpenFileDetour<0x69FD5A> gxt_d2;                // CText::LoadMissionText detour
 
         void ReloadGXT();                               // Reload current language file
+        void InvalidateGXTPaths();                      // Forgets the GXT paths resolved by the detours
+        bool UpdateGXTIndex(const modloader::file&);    // Updates the table index of a GXT file, returns whether a reload is needed
 
     public:
          // Standard plugin methods
@@ -48,8 +53,17 @@ REGISTER_ML_PLUGIN(::text_plugin);
  */
 const TextPlugin::info& TextPlugin::GetInfo()
 {
+    // Same as GetBehaviour, lets Mod Loader find out the behaviour of files without calling it
+    static const uint32_t flags  = MODLOADER_RULE_NODIR | MODLOADER_RULE_ORHASH;
+    static const modloader_rule_t rules[] =
+    {
+        { 0, flags, "fxt", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, is_fxt_mask },
+        { 0, flags, "gxt", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, 0 },
+        { 0 }
+    };
+
     static const char* extable[] = { "gxt", "fxt", 0 };
-    static const info xinfo      = { "std.text", get_version_by_date(), "LINK/2012", -1, extable };
+    static const info xinfo      = { "std.text", get_version_by_date(), "LINK/2012", -1, extable, rules, true };
     return xinfo;
 }
 
@@ -64,6 +78,7 @@ bool TextPlugin::OnStartup()
         this->fxt.make_samp_compatible();
 
         // Returns the overriden gxt file path (relative to gamedir)
+        // It depends only on the gxt map, so the detours may cache its results until the map changes (see InvalidateGXTPaths)
         auto transformer = [this](std::string filename)
         {
             auto it = gxt.find(modloader::hash(filename, ::tolower));
@@ -75,13 +90,21 @@ bool TextPlugin::OnStartup()
         {
             gxt_d1_gta3.make_call();
             gxt_d1_gta3.OnTransform(transformer);
+            gxt_d1_gta3.EnableCache();
         }
         else
         {
             gxt_d1.make_call();
             gxt_d1.OnTransform(transformer);
+            gxt_d1.EnableCache();
             gxt_d2.make_call();
-            gxt_d2.OnTransform(transformer);
+            // Not cached, its transformer must see every load to know where the mission text comes from
+            gxt_d2.OnTransform([this, transformer](std::string filename)
+            {
+                // Remember where the mission text comes from, so changes to its tables can be brought in
+                this->mission_gxt = modloader::hash(filename, ::tolower);
+                return transformer(std::move(filename));
+            });
         }
         return true;
     }
@@ -131,9 +154,8 @@ bool TextPlugin::InstallFile(const modloader::file& file)
     {
         auto table = (uint32_t)(file.behaviour & hash_mask);
 
-        // Remove the previous table related to this FXT then load it again
-        this->fxt.remove_table(table);
-        if(ParseFXT(this->fxt, file.fullpath().c_str(), table))
+        // Load the FXT into its table, touching only the keys that changed since the previous load
+        if(ReloadFXT(this->fxt, file.fullpath().c_str(), table))
             return true;
 
         Log("Failed to inject FXT file \"%s\"", file.filepath());
@@ -141,7 +163,9 @@ bool TextPlugin::InstallFile(const modloader::file& file)
     else // Is GXT
     {
         this->gxt[file.hash] = &file;
-        this->ReloadGXT();
+        this->InvalidateGXTPaths();
+        if(this->UpdateGXTIndex(file))
+            this->ReloadGXT();
         return true;
     }
     return false;
@@ -172,12 +196,55 @@ bool TextPlugin::UninstallFile(const modloader::file& file)
     {
         //  Erase from our gxt map and reload the current gxt
         this->gxt.erase(file.hash);
+        this->gxt_idx.erase(file.hash);
+        this->InvalidateGXTPaths();
         this->ReloadGXT();
         return true;
     }
     return false;
 }
 
+/*
+ *  TextPlugin::UpdateGXTIndex
+ *      Indexes the tables of the specified GXT file and compares with its previous index.
+ *      Returns whether the whole language needs to be reloaded.
+ */
+bool TextPlugin::UpdateGXTIndex(const modloader::file& file)
+{
+    injector::gxt_index index;
+    if(!injector::ParseGXTIndex(file.fullpath().c_str(), index))
+    {
+        this->gxt_idx.erase(file.hash);
+        return true;
+    }
+
+    auto& previous = this->gxt_idx[file.hash];
+    auto diff = injector::DiffGXTIndex(previous, index);
+    previous = std::move(index);
+
+    if(diff.full)
+        return true;
+
+    // Only mission tables changed in place, the game reads those from the file whenever a mission text gets loaded
+    // (through our CText::LoadMissionText detour), so there's no need to reload the entire language...
+    for(auto& name : diff.changed)
+        Log("Mission text table \"%s\" changed in \"%s\", it will be read again on its next load.", name.c_str(), file.filepath());
+
+    // ...unless the loaded mission text table has been read from this file, as it may be one of the changed tables.
+    // Reloading the language loads the current mission table back from the file.
+    return !diff.changed.empty() && file.hash == this->mission_gxt;
+}
+
+/*
+ *  TextPlugin::InvalidateGXTPaths
+ *      Forgets the GXT paths cached by the detours, must be called whenever the gxt map changes
+ */
+void TextPlugin::InvalidateGXTPaths()
+{
+    gxt_d1_gta3.InvalidateCache();
+    gxt_d1.InvalidateCache();
+}
+
 /*
  *  TextPlugin::ReloadGXT
  *      Reloads the current GXT file
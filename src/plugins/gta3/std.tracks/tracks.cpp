@@ -41,7 +41,7 @@ class ThePlugin : public modloader::basic_plugin
     private:
         modloader::file_overrider ov_strmpaks;                  // StrmPaks.dat overrider
         modloader::file_overrider ov_traklkup;                  // TrakLkUp.dat overrider
-        std::map<std::string, const modloader::file*> streams;  // Stream paks
+        hashed_redirect_table streams;                          // Stream paks
 
     public:
         const info& GetInfo();
@@ -74,8 +74,35 @@ using namespace modloader;
  */
 const ThePlugin::info& ThePlugin::GetInfo()
 {
+    // Same as GetBehaviour, lets Mod Loader find out the behaviour of files without calling it
+    static const uint32_t flags  = MODLOADER_RULE_NODIR | MODLOADER_RULE_ORHASH;
+    static const uint64_t pak    = SetType(0, Type::StreamPak);
+    static const modloader_rule_t rules[] =
+    {
+        { 0,                            flags, "", "streams", nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("aa"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("tk"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("adverts"),   flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("ambience"),  flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("cutscene"),  flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("beats"),     flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("ch"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("co"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("cr"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("ds"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("hc"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("mh"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("mr"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("nj"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("re"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("rg"),        flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, pak },
+        { modloader::hash("traklkup.dat"), flags, "dat", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, SetType(0, Type::StreamLookUp) },
+        { modloader::hash("strmpaks.dat"), flags, "dat", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, SetType(0, Type::PakFiles) },
+        { 0 }
+    };
+
     static const char* extable[] = { "", "ogg", "ini", "dat", 0 };
-    static const info xinfo      = { "std.tracks", get_version_by_date(), "LINK/2012", -1, extable };
+    static const info xinfo      = { "std.tracks", get_version_by_date(), "LINK/2012", -1, extable, rules, true };
     return xinfo;
 }
 
@@ -180,7 +207,7 @@ bool ThePlugin::InstallFile(const modloader::file& file)
     switch(GetType(file.behaviour))
     {
         case Type::Ogg:             return false;
-        case Type::StreamPak:       this->streams.emplace(file.filename(), &file); return true;
+        case Type::StreamPak:       this->streams.insert(file); return true;
         case Type::StreamLookUp:    return ov_traklkup.InstallFile(file);
         case Type::PakFiles:        return ov_strmpaks.InstallFile(file);
     }
@@ -217,7 +244,7 @@ bool ThePlugin::UninstallFile(const modloader::file& file)
         case Type::StreamPak:
                                     if(!this->loader->has_game_started) 
                                     {
-                                        this->streams.erase(file.filename());
+                                        this->streams.erase(file);
                                         return true;
                                     }
                                     return false;
@@ -255,9 +282,8 @@ void ThePlugin::PatchStreamCat()
     auto mycat = [](LPTSTR dest, LPTSTR cat) -> LPTSTR
     {
         auto& plugin = plugin_ptr->cast<ThePlugin>();
-        auto it = plugin.streams.find(NormalizePath(cat));
-        if(it != plugin.streams.end())
-            return strcpy(dest, it->second->fullpath().c_str());
+        if(auto path = plugin.streams.redirect(TrimPathView(cat)))
+            return strcpy(dest, path);
         else
             return strcat(dest, cat);
     };
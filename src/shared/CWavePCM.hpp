@@ -46,6 +46,13 @@ class CWavePCM
         {
             SubChunkHead    head;
         };
+
+        enum class ParseResult  // Result of ParseChunks
+        {
+            Found,          // Found the fmt and data chunks
+            More,           // Needs more of the file
+            Invalid,        // Not a (valid) wave file
+        };
         
         
     private:
@@ -54,15 +61,16 @@ class CWavePCM
         DATAHeader  data;               // DATAHeader
         uint32_t    fmt_offset;         // Offset for FMTHeader on the file
         uint32_t    data_offset;        // Offset for DATAHeader on the file
+        uint64_t    riff_end;           // Offset of the end of the RIFF chunk
         
     public:
         
         // Construct
-        CWavePCM() : f(0), fmt_offset(0), data_offset(0)
+        CWavePCM() : f(0), fmt_offset(0), data_offset(0), riff_end(0)
         {}
         
         // Construct with open
-        CWavePCM(const char* filename) : f(0), fmt_offset(0), data_offset(0)
+        CWavePCM(const char* filename) : f(0), fmt_offset(0), data_offset(0), riff_end(0)
         {
             this->Peek(filename);
         }
@@ -74,6 +82,7 @@ class CWavePCM
             this->data = rhs.data;
             this->fmt_offset = rhs.fmt_offset;
             this->data_offset = rhs.data_offset;
+            this->riff_end = rhs.riff_end;
 
             rhs.f = nullptr;
             rhs.fmt_offset = rhs.data_offset = 0;
@@ -132,6 +141,14 @@ class CWavePCM
             }
             return false;
         }
+
+        // Reads the header and basic chunks from the wave file content in @buf with @size bytes
+        // The buffer doesn't need to have the entire file, only up to the data chunk header
+        bool Parse(const void* buf, size_t size)
+        {
+            uint32_t next;
+            return this->ParseChunks(buf, size, 0, next) == ParseResult::Found && this->CheckPCM();
+        }
         
         
         
@@ -151,92 +168,101 @@ class CWavePCM
             chunk.head = head;
         }
 
-        // Skips the chunk @head
-        // File pointer must be after @head
-        // Returns the @head offset or 0 on failure
-        uint32_t ReadChunk(const SubChunkHead& head)
-        {
-            size_t offset = ftell(f) - sizeof(head);
-            if(fseek(f, head.size, SEEK_CUR)) return 0;
-            return offset;
-        }
-        
-        // Reads the chunk @head to @chunk
-        // File pointer must be after @head
-        // Returns the @head offset or 0 on failure
-        template<class T>
-        uint32_t ReadChunk(const SubChunkHead& head, T& chunk)
+        // Walks the chunks of the file content in @buf with @size bytes, which begins at the file offset @base
+        // Call it first with @base as zero, and on ParseResult::More call it again with the content starting at @next
+        ParseResult ParseChunks(const void* buf, size_t size, uint32_t base, uint32_t& next)
         {
-            size_t chunk_size = sizeof(chunk) - sizeof(head);
-            if(head.size >= chunk_size) // Check if head size suffices chunk size
+            const char* p   = (const char*)(buf);
+            uint64_t offset = base;
+
+            if(base == 0)
             {
-                size_t offset = ftell(f) - sizeof(head);    // Find head offset
-                size_t read_size = head.size > chunk_size? chunk_size : head.size;  // Find ammount of bytes to read
-                
-                // Finally, read the chunk
-                if(fread((char*)(&chunk) + sizeof(chunk.head), read_size, 1, f))
+                RIFFHeader header;
+                this->data_offset = this->fmt_offset = 0;
+
+                // Read the RIFF header and check if it's WAVE format
+                if(size < sizeof(header)) return ParseResult::Invalid;
+                memcpy(&header, p, sizeof(header));
+                if(strncmp(header.RIFF, "RIFF", 4) || strncmp(header.WAVE, "WAVE", 4))
+                    return ParseResult::Invalid;
+
+                // Some writers leave the RIFF size unset, so walk until the chunks are found in that case
+                this->riff_end = header.chunk_size >= 4? uint64_t(header.chunk_size) + 8 : UINT64_MAX;
+                offset = sizeof(header);
+            }
+
+            // Keep reading chunks until we found data and fmt
+            while(!this->data_offset || !this->fmt_offset)
+            {
+                SubChunkHead sub;
+                uint64_t pos = offset - base;   // Position of the chunk in the buffer
+
+                // Reached the end of the WAVE (or of 32 bits offsets) without the chunks?
+                if(offset + sizeof(sub) > this->riff_end || offset > UINT32_MAX)
+                    return ParseResult::Invalid;
+
+                // Chunk header not in the buffer? Ask for it
+                if(pos + sizeof(sub) > size)
                 {
-                    // If there's more data on this chunk, skip it
-                    if(head.size <= read_size || !fseek(f, head.size - read_size, SEEK_CUR))
-                        return offset;
+                    next = uint32_t(offset);
+                    return ParseResult::More;
                 }
+
+                memcpy(&sub, p + pos, sizeof(sub));
+                if(IsChunk(sub, "data"))
+                {
+                    // Data chunk, we need to take care of it
+                    CopyHead(sub, this->data);
+                    this->data_offset = uint32_t(offset);
+                }
+                else if(IsChunk(sub, "fmt "))
+                {
+                    // Fmt chunk, we need to take care of it
+                    if(sub.size < sizeof(this->fmt) - sizeof(sub))
+                        return ParseResult::Invalid;
+
+                    if(pos + sizeof(this->fmt) > size)
+                    {
+                        next = uint32_t(offset);
+                        return ParseResult::More;
+                    }
+
+                    memcpy(&this->fmt, p + pos, sizeof(this->fmt));
+                    this->fmt_offset = uint32_t(offset);
+                }
+
+                // Go to the next chunk, chunks are word aligned
+                offset += sizeof(sub) + uint64_t(sub.size) + (sub.size & 1);
             }
-            return 0;
+
+            return ParseResult::Found;
         }
         
         // Reads the RIFF header
         bool ReadHeader()
         {
-            RIFFHeader header;
-            SubChunkHead sub;
-            size_t offset;
-            this->data_offset = this->fmt_offset = 0;
-            
-            // Read the RIFF header
-            if(fread(&header, sizeof(header), 1, f))
+            char buffer[512];
+            uint32_t offset = 0, next;
+            size_t size;
+
+            // Read the file by pieces until the chunks are found, usually they're all in the first piece
+            while(!fseek(f, offset, SEEK_SET) && (size = fread(buffer, 1, sizeof(buffer), f)) != 0)
             {
-                // Check if it's WAVE format
-                if(!strncmp(header.RIFF, "RIFF", 4) && !strncmp(header.WAVE, "WAVE", 4))
+                switch(this->ParseChunks(buffer, size, offset, next))
                 {
-                    // Keep reading chunks until the end of the WAVE
-                    while(uint32_t(ftell(f)) < (header.chunk_size - 8))
-                    {
-                        // We don't need to continue iterating if we already found data and fmt
-                        if(this->data_offset && this->fmt_offset)
-                            break;
-                        
-                        // Read chunk
-                        if(fread(&sub, sizeof(sub), 1, f))
-                        {
-                            if(IsChunk(sub, "data"))
-                            {
-                                // Data chunk, we need to take care of it
-                                CopyHead(sub, this->data);
-                                this->data_offset = offset = ReadChunk(sub);
-                            }
-                            else if(IsChunk(sub, "fmt "))
-                            {
-                                // Fmt chunk, we need to take care of it
-                                CopyHead(sub, this->fmt);
-                                this->fmt_offset = offset = ReadChunk(sub, this->fmt);
-                            }
-                            else
-                            {
-                                // Another chunk, ignore
-                                offset = ReadChunk(sub);
-                            }
-                            
-                            // Couldn't read the chunk? Ow, that's bad
-                            if(offset == 0) break;
-                        }
-                    }
-                    
-                    // Check if we found data and fmt
-                    if(this->data_offset && this->fmt_offset)
+                    case ParseResult::Found:
                         return true;
+
+                    case ParseResult::More:
+                        if(next == offset) return false;    // End of file in the middle of a chunk header
+                        offset = next;
+                        break;
+
+                    default:
+                        return false;
                 }
             }
-            
+
             return false;
         }
         
@@ -10,6 +10,8 @@
 #include <type_traits>
 #include <datalib/detail/stream/memstream.hpp>
 #include <datalib/detail/stream/kstream.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 #include <datalib/detail/mpl/seqeach.hpp>
 #include <datalib/detail/mpl/type_complexity_sort.hpp>
 #include <datalib/data_info.hpp>
@@ -23,6 +25,9 @@ namespace datalib {
 #   endif
 #endif
 
+// Define DATALIB_DATASLICE_NOFASTSCAN to make data_slice::parse() use check() followed by set() instead of the line_scanner
+
+
 /*
  *  data_slice_base
  *      Allows polymorphic behaviour on a data_slice object
@@ -41,7 +46,8 @@ inline data_slice_base::~data_slice_base() { }
  *      The piece of data stored is specified by the 'Types' variadic template argument.
  *
  *      [*] Each type needs a data_info<> specialization (see data_info.hpp) and should be able to I/O in icheckstream/imemstream/ostream
- *          using the overloaded shifting operators.
+ *          using the overloaded shifting operators. An overload for line_scanner is optional but makes parse() faster,
+ *          likewise an overload for line_printer is optional but makes get() faster.
  *      [*] The type delimopt determines that the types following it are optional (i.e. the line might or might not contain them)
  */
 template<typename ...Types>
@@ -151,6 +157,17 @@ class data_slice : public data_slice_base
             return this_->check_on_tuple(line) >= min_count();
         }
 
+        // Same as 'this->check(line) && this->set(line)' but validates and interprets the line in a single pass
+        // Returns false on failure, in which case the content of this data storer is undefined
+        bool parse(const std::string& line)
+        {
+        #if !defined(DATALIB_DATASLICE_NOFASTSCAN)
+            return parse_to_tuple(line) >= min_count();
+        #else
+            return check(line) && set(line);
+        #endif
+        }
+
         // Gets an element from the data tuple
         template<size_t I>
         auto get() -> decltype(std::get<I>(std::declval<tuple_type&>()))
@@ -253,7 +270,7 @@ class data_slice : public data_slice_base
         static bool ignores()
         {
             static_assert(I < tuple_size, "Invalid slice element index");
-            return data_info<std::tuple_element<I, tuple_type>::type>::ignore;
+            return data_info<typename std::tuple_element<I, tuple_type>::type>::ignore;
         }
 
         void private_set(std::integral_constant<size_t, tuple_size>)
@@ -281,13 +298,23 @@ class data_slice : public data_slice_base
             return (this->used_count = scanner.counter);    // Re-set the counter
         }
 
+        // Scans and validates the content of 'line' to 'this->tuple' in a single pass and returns the amount of types successfully scanned
+        int parse_to_tuple(const std::string& line)
+        {
+            line_scanner stream(line);
+            scany_to_tuple<false, line_scanner> scanner(*this, stream);
+            this->reset();
+            foreach_in_tuple(tuple, scanner);
+            return (this->used_count = scanner.counter);
+        }
+
         // Prints the content of 'this->tuple' to the 'line' and returns the amount of types successfully printed
         int print_from_tuple(std::string& line) const
         {
-            std::ostringstream stream(std::ios::out);
-            printy_from_tuple printer(*this, stream);       // Priter functor
+            line.clear();                                   // Reuse the line capacity
+            line_printer stream(line);
+            printy_from_tuple<> printer(*this, stream);     // Priter functor
             foreach_in_tuple(const_cast<tuple_type&>(tuple), printer);
-            line = stream.str();
             return printer.counter;
         }
 
@@ -356,10 +383,11 @@ class data_slice : public data_slice_base
         // CXX14 HELP-ME
 
         // Scans to tuple
-        template<bool checker>  // checker is whether it's actual scanning or just checking
+        template<bool checker,  // checker is whether it's actual scanning or just checking
+                 class StreamType = typename std::conditional<checker, icheckstream, imemstream>::type>
         struct scany_to_tuple
         {
-            using stream_type = typename std::conditional<checker, icheckstream, imemstream>::type;
+            using stream_type = StreamType;
 
             data_slice&   self;
             stream_type& stream;
@@ -397,13 +425,16 @@ class data_slice : public data_slice_base
         };
 
         // Prints from tuple
+        template<class StreamType = line_printer>
         struct printy_from_tuple
         {
+            using stream_type = StreamType;
+
             const data_slice&    self;
-            std::ostringstream&  stream;
+            stream_type&         stream;
             int                  counter;
             
-            printy_from_tuple(const data_slice& self, std::ostringstream& stream)
+            printy_from_tuple(const data_slice& self, stream_type& stream)
                 : self(self), stream(stream), counter(0)
             {}
 
@@ -413,7 +444,7 @@ class data_slice : public data_slice_base
             {
                 if(self.used[Integral::value])
                 {
-                    perform_print<Integral::value, TypeWr::type>(value);
+                    perform_print<Integral::value, typename TypeWr::type>(value);
                 }
                 return !!stream;
             }
@@ -523,9 +554,9 @@ class data_slice : public data_slice_base
 // CXX14 HELP-ME
 
 template<size_t I, class ...Types> inline
-auto get(data_slice<Types...>& data) -> decltype(std::declval<data_slice<Types...>&>().get<I>())
+auto get(data_slice<Types...>& data) -> decltype(std::declval<data_slice<Types...>&>().template get<I>())
 {
-    return data.get<I>();
+    return data.template get<I>();
 }
 
 template<size_t I, class ...Types> inline
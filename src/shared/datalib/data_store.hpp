@@ -110,7 +110,7 @@ class data_store
 
         // Checks the state of this object
         bool ready() const   { return this->is_ready; }
-        bool default() const { return this->is_default; }
+        bool is_default_store() const { return this->is_default; }
 
 
     public: // not to be used directly
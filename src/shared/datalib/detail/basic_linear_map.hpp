@@ -5,6 +5,8 @@
  */
 #pragma once
 #include <algorithm>
+#include <stdexcept>
+#include <tuple>
 
 namespace datalib {
 
@@ -132,7 +134,7 @@ class basic_linear_map
         mapped_type& at(const key_type& k)
         {
             auto it = this->find(k);
-            if(it == this->end()) throw std::out_of_range();
+            if(it == this->end()) throw std::out_of_range("basic_linear_map::at");
             return it->second;
         }
 
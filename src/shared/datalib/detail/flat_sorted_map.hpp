@@ -0,0 +1,262 @@
+/*
+ *  Copyright (C) 2014 Denilson das Mercs Amorim (aka LINK/2012)
+ *  Licensed under the Boost Software License v1.0 (http://opensource.org/licenses/BSL-1.0)
+ *
+ */
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <datalib/detail/mpl/is_sorted_container.hpp>
+
+namespace datalib {
+
+/*
+ *  flat_sorted_map
+ *      An std::map like container which stores its elements sorted in a contiguous vector.
+ *
+ *      Insertions (emplace/insert) append to the end of the vector, the elements get sorted (and duplicated keys removed, keeping
+ *      the first inserted, as std::map would) only when the container is searched or iterated afterwards. This way a data set
+ *      is bulk-appended while being parsed and sorted once when it's first used.
+ *
+ *      The boolean returned by emplace/insert is only meaningful while the keys are inserted in increasing order.
+ *      Iterators, pointers and references are invalidated by insertions and by the first search/iteration after an insertion.
+ *
+ *      The interface is still incomplete but the most used methods are present.
+ *
+ */
+template<typename Key, typename Value, class Compare = std::less<Key>, class Allocator = std::allocator<std::pair<Key, Value>>>
+class flat_sorted_map
+{
+    public:
+        // Member types
+        using container_type            = std::vector<std::pair<Key, Value>, Allocator>;
+        using key_compare               = Compare;
+        using allocator_type            = typename container_type::allocator_type;
+        using value_type                = typename container_type::value_type;
+        using difference_type           = typename container_type::difference_type;
+        using size_type                 = typename container_type::size_type;
+        using reference                 = typename container_type::reference;
+        using const_reference           = typename container_type::const_reference;
+        using pointer                   = typename container_type::pointer;
+        using const_pointer             = typename container_type::const_pointer;
+        using iterator                  = typename container_type::iterator;
+        using const_iterator            = typename container_type::const_iterator;
+        using reverse_iterator          = typename container_type::reverse_iterator;
+        using const_reverse_iterator    = typename container_type::const_reverse_iterator;
+        using key_type                  = Key;                  // notice: non-const
+        using mapped_type               = Value;
+
+        // Compares the keys of two elements
+        struct value_compare
+        {
+            bool operator()(const value_type& a, const value_type& b) const
+            { return key_compare()(a.first, b.first); }
+        };
+
+    private:
+        using result_pair = std::pair<iterator, bool>;
+
+        mutable container_type  list;
+        mutable bool            unsorted = false;    // Whether 'list' needs to be sorted and have its duplicates removed
+
+    public:
+
+        //
+        //  Constructors
+        //
+
+        flat_sorted_map() = default;
+
+        flat_sorted_map(const flat_sorted_map& rhs)
+            : list(rhs.list), unsorted(rhs.unsorted) {}
+
+        flat_sorted_map(flat_sorted_map&& rhs)
+            : list(std::move(rhs.list)), unsorted(rhs.unsorted) { rhs.unsorted = false; }
+
+        //
+        //  Assigment Operators
+        //
+
+        flat_sorted_map& operator=(const flat_sorted_map& rhs)
+        { this->list = rhs.list; this->unsorted = rhs.unsorted; return *this; }
+
+        flat_sorted_map& operator=(flat_sorted_map&& rhs)
+        { this->list = std::move(rhs.list); this->unsorted = rhs.unsorted; rhs.unsorted = false; return *this; }
+
+
+        //
+        // Observers
+        //
+        key_compare key_comp() const            { return key_compare(); }
+        value_compare value_comp() const        { return value_compare(); }
+        allocator_type get_allocator() const    { return list.get_allocator(); }
+
+        //
+        // Iterators
+        //
+        iterator begin()                        { return normalize(), list.begin(); }
+        iterator end()                          { return normalize(), list.end();   }
+        const_iterator begin() const            { return normalize(), list.begin(); }
+        const_iterator end() const              { return normalize(), list.end();   }
+
+        //
+        // Capacity
+        //
+        size_t size() const                     { return normalize(), list.size();  }
+        bool empty() const                      { return list.empty(); }
+        size_type max_size() const              { return list.max_size(); }
+        void reserve(size_type n)               { list.reserve(n); }
+        void shrink_to_fit()                    { list.shrink_to_fit(); }
+
+        //
+        // Modifiers
+        //
+
+        void clear()
+        { list.clear(); unsorted = false; }
+
+        // Finds an element with key equivalent to key.
+        iterator find(const key_type& k)
+        {
+            auto it = this->lower_bound(k);
+            return (it != list.end() && !key_compare()(k, it->first))? it : list.end();
+        }
+
+        const_iterator find(const key_type& k) const
+        {
+            auto it = this->lower_bound(k);
+            return (it != list.end() && !key_compare()(k, it->first))? it : list.cend();
+        }
+
+        // Returns an iterator pointing to the first element that is not less than key.
+        iterator lower_bound(const key_type& k)
+        {
+            normalize();
+            return std::lower_bound(list.begin(), list.end(), k, key_value_compare());
+        }
+
+        const_iterator lower_bound(const key_type& k) const
+        {
+            normalize();
+            return std::lower_bound(list.cbegin(), list.cend(), k, key_value_compare());
+        }
+
+        // Returns the number of elements with key key, which is either 1 or 0 since this container does not allow duplicates
+        size_type count(const key_type& k) const
+        {
+            auto it = this->find(k);    // sorts the list first, taking its end before would give a stale iterator
+            return (it == list.cend()? 0 : 1);
+        }
+
+        // Returns a reference to the value that is mapped to a key equivalent to key, performing an insertion if such key does not already exist.
+        mapped_type& operator[](const key_type& k)
+        {
+            auto it = this->lower_bound(k);
+            if(it == list.end() || key_compare()(k, it->first))
+                it = list.emplace(it, std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple());
+            return it->second;
+        }
+
+        // Returns a reference to the mapped value of the element with key equivalent to key.
+        // If no such element exists, an exception of type std::out_of_range is thrown
+        mapped_type& at(const key_type& k)
+        {
+            auto it = this->find(k);
+            if(it == list.end()) throw std::out_of_range("flat_sorted_map::at");
+            return it->second;
+        }
+
+        std::pair<iterator, bool> insert(const value_type& pair)
+        {
+            return this->emplace(pair);
+        }
+
+        // Appends a new element constructed in-place with the given args, see the notes at the top about duplicated keys.
+        template<class... Args>
+        std::pair<iterator, bool> emplace(Args&&... args)
+        {
+            list.emplace_back(std::forward<Args>(args)...);
+            if(!unsorted && list.size() > 1)
+            {
+                auto& prev = list[list.size() - 2];
+                if(!key_compare()(prev.first, list.back().first))
+                {
+                    if(!key_compare()(list.back().first, prev.first))   // same key as the last element, keep the first one
+                    {
+                        list.pop_back();
+                        return result_pair(list.end() - 1, false);
+                    }
+                    unsorted = true;
+                }
+            }
+            return result_pair(list.end() - 1, true);
+        }
+
+        void erase(const key_type& key)
+        {
+            auto it = this->find(key);
+            if(it != list.end()) this->list.erase(it);
+        }
+
+        iterator erase(const_iterator it)
+        {
+            return list.erase(it);
+        }
+
+
+        //
+        //  Comparision
+        //
+        bool operator==(const flat_sorted_map& rhs) const
+        { return normalize(), rhs.normalize(), this->list == rhs.list; }
+        bool operator!=(const flat_sorted_map& rhs) const
+        { return !(*this == rhs); }
+        bool operator<(const flat_sorted_map& rhs) const
+        { return normalize(), rhs.normalize(), this->list < rhs.list; }
+        bool operator<=(const flat_sorted_map& rhs) const
+        { return !(rhs < *this); }
+        bool operator>(const flat_sorted_map& rhs) const
+        { return (rhs < *this); }
+        bool operator>=(const flat_sorted_map& rhs) const
+        { return !(*this < rhs); }
+
+    public:
+        template<class Archive>
+        void serialize(Archive& ar)
+        {
+            normalize();
+            ar(this->list);
+            this->unsorted = !std::is_sorted(list.begin(), list.end(), value_compare());
+        }
+
+    private:
+        // Compares a key with the key of an element
+        struct key_value_compare
+        {
+            bool operator()(const value_type& a, const key_type& k) const
+            { return key_compare()(a.first, k); }
+        };
+
+        // Sorts the elements and removes the duplicated keys (keeping the first inserted) if there were out of order insertions
+        void normalize() const
+        {
+            if(unsorted)
+            {
+                auto key_equal = [](const value_type& a, const value_type& b) {
+                    return !key_compare()(a.first, b.first) && !key_compare()(b.first, a.first);
+                };
+                std::stable_sort(list.begin(), list.end(), value_compare());
+                list.erase(std::unique(list.begin(), list.end(), key_equal), list.end());
+                unsorted = false;
+            }
+        }
+};
+
+
+template<class Key, class Value, class Compare, class Alloc>
+struct is_sorted_container<flat_sorted_map<Key, Value, Compare, Alloc>> : std::true_type {};
+
+} // namespace datalib
@@ -22,6 +22,12 @@ namespace detail
         using type = T;
     };
 
+    // The ends of the recursions come first so the recursive calls find them
+    template<int N, class Functor>
+    inline void foreach_type_asfunc(Functor& functor)
+    {
+    }
+
     template<int N, class Functor, typename Type, typename... Types>
     inline void foreach_type_asfunc(Functor& functor)
     {
@@ -29,8 +35,8 @@ namespace detail
             return foreach_type_asfunc<N+1, Functor, Types...>(functor);
     }
 
-    template<int N, class Functor>
-    inline void foreach_type_asfunc(Functor& functor)
+    template<int N, class Functor, class Tuple>
+    inline void foreach_in_tuple(Tuple& tuple, Functor& functor)
     {
     }
 
@@ -42,11 +48,6 @@ namespace detail
             return foreach_in_tuple<N+1, Functor, Tuple, Types...>(tuple, functor);
     }
 
-    template<int N, class Functor, class Tuple>
-    inline void foreach_in_tuple(Tuple& tuple, Functor& functor)
-    {
-    }
-
     template<size_t Max, class Functor, size_t N>
     inline void foreach_index(std::integral_constant<size_t, Max>, std::integral_constant<size_t, N>, Functor& functor)
     {
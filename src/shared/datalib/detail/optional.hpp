@@ -23,7 +23,7 @@ namespace std
     {
         std::size_t operator()(const datalib::optional<T>& opt)
         {
-            return boost::hash<datalib::optional<T>()(opt);
+            return boost::hash<datalib::optional<T>>()(opt);
         }
     };
 }
@@ -19,6 +19,13 @@ class basic_imemstream;
 template<typename CharT, typename Traits = std::char_traits<CharT>>
 class basic_icheckstream;
 
+// from scanner.hpp
+class line_scanner;
+
+// from printer.hpp
+class line_printer;
+class buffered_writer;
+
 
 // Alias the icheckstream object
 using icheckstream = basic_icheckstream<char, std::char_traits<char>>;
@@ -26,6 +33,14 @@ using icheckstream = basic_icheckstream<char, std::char_traits<char>>;
 // Alias the imemstream object
 using imemstream = basic_imemstream<char, std::char_traits<char>>;
 
+// Object to give to a basic_icheckstream when there's no object at hand (it never writes into what it checks)
+template<class T>
+inline const T& check_dummy()
+{
+    static const T dummy = T();
+    return dummy;
+}
+
 
 
 } // namespace datalib
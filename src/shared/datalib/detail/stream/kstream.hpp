@@ -645,7 +645,7 @@ basic_icheckstream<CharT, Traits>& basic_icheckstream<CharT, Traits>::read_strin
     typename icheckstream::sentry  xsentry(is);
     if(xsentry)
     {
-        std::ios_base::iostate state = 0;               // State of the stream after the operation
+        std::ios_base::iostate state = std::ios_base::goodbit;               // State of the stream after the operation
         auto n = count; // no need to (count-1) because std::string does not need a null terminator
         if(sideff) str.erase(); // optional side effect
 
@@ -706,7 +706,7 @@ basic_icheckstream<CharT, Traits>& operator>>(basic_icheckstream<CharT, Traits>&
     typename icheckstream::sentry  xsentry(is);
     if(xsentry)
     {
-        std::ios_base::iostate state = 0;               // State of the stream after the operation
+        std::ios_base::iostate state = std::ios_base::goodbit;               // State of the stream after the operation
         auto n = count - 1;
 
         if(count > 1)   // If has space only for one character, extract nothing but puts a null terminator on 's'
@@ -0,0 +1,282 @@
+/*
+ *  Copyright (C) 2014 Denilson das Mercs Amorim (aka LINK/2012)
+ *  Licensed under the Boost Software License v1.0 (http://opensource.org/licenses/BSL-1.0)
+ *
+ */
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <memory>
+#include <sstream>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <datalib/detail/stream/fwd.hpp>
+#include <datalib/data_info.hpp>
+
+namespace datalib {
+
+/*
+ *  line_printer
+ *
+ *      Formats values at the end of a string, the non-iostream counterpart of the ostringstream used to build data lines.
+ *      The produced text is the same as the one produced by an ostream with the same base and precision settings
+ *      (floating points are formated as in the default floatfield, i.e. "%.*g").
+ *
+ *      Use the 'operator<<' to print a value. Types with no 'operator<<' overload for this printer are handled by a fallback
+ *      which goes through an ostringstream for that single value.
+ */
+class line_printer
+{
+    public:
+        using char_type = char;
+
+        // Appends to 'out'
+        explicit line_printer(std::string& out) :
+            m_out(out), m_base(10), m_precision(6), m_fail(false)
+        {}
+
+        // Cannot copy
+        line_printer(const line_printer&) = delete;
+        line_printer& operator=(const line_printer&) = delete;
+
+        // Checks if no error has occurred
+        explicit operator bool() const
+        { return !m_fail; }
+
+        // Checks if any error has occurred
+        bool operator!() const
+        { return m_fail; }
+
+        bool fail() const
+        { return m_fail; }
+
+        // Sets the failure state
+        line_printer& failed()
+        { m_fail = true; return *this; }
+
+        // Gets the output string
+        std::string& str()
+        { return m_out; }
+
+        // Gets and sets the integer base (either 10 or 16)
+        int base() const                    { return m_base; }
+        int base(int b)                     { std::swap(m_base, b); return b; }
+
+        // Gets and sets the floating point precision
+        int precision() const               { return m_precision; }
+        int precision(int p)                { std::swap(m_precision, p); return p; }
+
+        // Appends 'size' characters from 'data'
+        line_printer& write(const char* data, size_t size)
+        {
+            m_out.append(data, size);
+            return *this;
+        }
+
+    public:
+        // Integer Printers
+        line_printer& operator<<(short value)               { return print_integer(value); }
+        line_printer& operator<<(unsigned short value)      { return print_integer(value); }
+        line_printer& operator<<(int value)                 { return print_integer(value); }
+        line_printer& operator<<(unsigned int value)        { return print_integer(value); }
+        line_printer& operator<<(long value)                { return print_integer(value); }
+        line_printer& operator<<(unsigned long value)       { return print_integer(value); }
+        line_printer& operator<<(long long value)           { return print_integer(value); }
+        line_printer& operator<<(unsigned long long value)  { return print_integer(value); }
+
+        // Floating Point Printers
+        line_printer& operator<<(float value)               { return print_real("%.*g", double(value)); }
+        line_printer& operator<<(double value)              { return print_real("%.*g", value); }
+        line_printer& operator<<(long double value)         { return print_real("%.*Lg", value); }
+
+        // Boolean Printer ('0' or '1')
+        line_printer& operator<<(bool value)
+        {
+            m_out.push_back(value? '1' : '0');
+            return *this;
+        }
+
+        // Character Printers
+        line_printer& operator<<(char value)                { m_out.push_back(value); return *this; }
+        line_printer& operator<<(signed char value)         { return (*this << char(value)); }
+        line_printer& operator<<(unsigned char value)       { return (*this << char(value)); }
+
+        // String Printers
+        line_printer& operator<<(const char* value)         { m_out.append(value); return *this; }
+        line_printer& operator<<(const std::string& value)  { m_out.append(value); return *this; }
+
+    private:
+
+        // Prints a integer of type T in the current base
+        template<class T>
+        line_printer& print_integer(T value)
+        {
+            using utype = typename std::make_unsigned<T>::type;
+            char buffer[24], *end = buffer + sizeof(buffer), *p = end;
+            utype magnitude = utype(value);
+            bool negative = false;
+
+            if(m_base == 16)    // as ostream does, negative values are printed as their unsigned representation
+            {
+                do { *--p = "0123456789abcdef"[magnitude % 16]; } while(magnitude /= 16);
+            }
+            else
+            {
+                if(std::is_signed<T>::value && value < 0)
+                {
+                    negative = true;
+                    magnitude = utype(0) - magnitude;
+                }
+                do { *--p = char('0' + magnitude % 10); } while(magnitude /= 10);
+                if(negative) *--p = '-';
+            }
+
+            m_out.append(p, end);
+            return *this;
+        }
+
+        // Prints a floating point using the printf 'format', which should have a precision and value parameters
+        template<class T>
+        line_printer& print_real(const char* format, T value)
+        {
+            char buffer[64];
+            int precision = (std::min)(m_precision, 40);    // keeps the output under the buffer size
+            int len = sprintf(buffer, format, precision, value);
+            if(len > 0)
+                m_out.append(buffer, size_t(len));
+            else
+                this->failed();
+            return *this;
+        }
+
+    private:
+        std::string&    m_out;          // Output string
+        int             m_base;         // Base of integers
+        int             m_precision;    // Precision of floating points
+        bool            m_fail;         // Failure state
+};
+
+
+/*
+ *  Fallback for types with no overload for the line_printer
+ *  Prints the value using an ostringstream.
+ */
+template<class T> inline
+typename std::enable_if<!std::is_enum<T>::value, line_printer&>::type
+/* line_printer& */ operator<<(line_printer& os, const T& value)
+{
+    std::ostringstream stream;
+    stream.precision(os.precision());
+    if(os.base() == 16) stream.setf(std::ios::hex, std::ios::basefield);
+
+    if(stream << value)
+    {
+        auto str = stream.str();
+        os.precision(int(stream.precision()));  // the value may have changed it, keep it for the next values as an ostream would
+        return os.write(str.data(), str.size());
+    }
+    return os.failed();
+}
+
+/*
+ *  Prints the separator which should come after the type T
+ */
+template<class T>
+inline line_printer& print_separator(line_printer& os)
+{
+    auto separator = data_info<T>::separator;
+    if(separator) os << separator;
+    return os;
+}
+
+
+/*
+ *  buffered_writer
+ *
+ *      Writes text to a file in big blocks instead of line per line.
+ *      The file is opened in text mode, so line endings are translated as in an ofstream.
+ */
+class buffered_writer
+{
+    public:
+        static const size_t buffer_size = 64 * 1024;
+
+        explicit buffered_writer(const char* filename) :
+            m_file(fopen(filename, "w")), m_buffer(new char[buffer_size]), m_used(0), m_fail(m_file == nullptr)
+        {}
+
+        ~buffered_writer()
+        {
+            this->close();
+        }
+
+        // Cannot copy
+        buffered_writer(const buffered_writer&) = delete;
+        buffered_writer& operator=(const buffered_writer&) = delete;
+
+        // Checks if no error has occurred
+        explicit operator bool() const
+        { return !m_fail; }
+
+        // Checks if any error has occurred
+        bool operator!() const
+        { return m_fail; }
+
+        // Appends 'size' characters from 'data'
+        buffered_writer& write(const char* data, size_t size)
+        {
+            if(m_used + size > buffer_size)
+            {
+                this->flush();
+                if(size > buffer_size)  // too big to be buffered
+                {
+                    if(m_file && fwrite(data, 1, size, m_file) != size)
+                        m_fail = true;
+                    return *this;
+                }
+            }
+
+            std::memcpy(&m_buffer[m_used], data, size);
+            m_used += size;
+            return *this;
+        }
+
+        buffered_writer& operator<<(char c)                     { return write(&c, 1); }
+        buffered_writer& operator<<(const char* str)            { return write(str, strlen(str)); }
+        buffered_writer& operator<<(const std::string& str)     { return write(str.data(), str.size()); }
+
+        // Sends the buffered content to the file
+        buffered_writer& flush()
+        {
+            if(m_used)
+            {
+                if(m_file && fwrite(&m_buffer[0], 1, m_used, m_file) != m_used)
+                    m_fail = true;
+                m_used = 0;
+            }
+            return *this;
+        }
+
+        // Flushes and closes the file, returns false if any error has occurred
+        bool close()
+        {
+            if(m_file)
+            {
+                this->flush();
+                if(fclose(m_file) != 0) m_fail = true;
+                m_file = nullptr;
+            }
+            return !m_fail;
+        }
+
+    private:
+        FILE*                       m_file;
+        std::unique_ptr<char[]>     m_buffer;
+        size_t                      m_used;     // Number of characters in the buffer
+        bool                        m_fail;     // Failure state
+};
+
+
+} // namespace datalib
@@ -0,0 +1,396 @@
+/*
+ *  Copyright (C) 2014 Denilson das Mercs Amorim (aka LINK/2012)
+ *  Licensed under the Boost Software License v1.0 (http://opensource.org/licenses/BSL-1.0)
+ *
+ */
+#pragma once
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <limits>
+#include <utility>
+#include <type_traits>
+#include <datalib/detail/stream/fwd.hpp>
+#include <datalib/detail/stream/kstream.hpp>
+#include <datalib/detail/stream/memstream.hpp>
+
+namespace datalib {
+
+/*
+ *  line_scanner
+ *
+ *      A cursor over a line of text which validates and converts the values in it in a single pass.
+ *      This is the non-iostream counterpart of the icheckstream+imemstream pair, the accepted text is the same as the one
+ *      accepted by icheckstream (i.e. every value must be followed by a blank space or the end of the line) and the converted
+ *      values are the same as the ones from imemstream.
+ *
+ *      Use the 'operator>>' to scan a value. On failure the cursor stays where it was before the operation and the failure
+ *      state is set, as in a stream. Types with no 'operator>>' overload for this scanner are handled by a fallback which
+ *      goes through icheckstream and imemstream for that single value.
+ */
+class line_scanner
+{
+    public:
+        using char_type = char;
+
+        line_scanner(const char* begin, const char* end) :
+            m_cur(begin), m_end(end), m_base(10), m_fail(false)
+        {}
+
+        line_scanner(const std::string& str) :
+            line_scanner(str.data(), str.data() + str.length())
+        {}
+
+        // Cannot work with a temporary string
+        line_scanner(std::string&& str) = delete;
+
+        // Cannot copy
+        line_scanner(const line_scanner&) = delete;
+        line_scanner& operator=(const line_scanner&) = delete;
+
+        // Checks if no error has occurred
+        explicit operator bool() const
+        { return !m_fail; }
+
+        // Checks if any error has occurred
+        bool operator!() const
+        { return m_fail; }
+
+        bool fail() const
+        { return m_fail; }
+
+        // Clears the failure state
+        void clear()
+        { m_fail = false; }
+
+        // Sets the failure state
+        line_scanner& failed()
+        { m_fail = true; return *this; }
+
+        // Gets and sets the cursor position
+        const char* tell() const        { return m_cur; }
+        void seek(const char* pos)      { m_cur = pos; }
+
+        // Gets the end of the line
+        const char* end() const         { return m_end; }
+
+        // Gets and sets the integer base (either 10 or 16)
+        int base() const                { return m_base; }
+        int base(int b)                 { std::swap(m_base, b); return b; }
+
+        // Skips the blank spaces at the cursor, fails if the end of the line is reached.
+        // Same as the sentry of a stream.
+        bool sentry()
+        {
+            if(!m_fail)
+            {
+                while(m_cur != m_end && isspace(*m_cur)) ++m_cur;
+                if(m_cur != m_end) return true;
+            }
+            m_fail = true;
+            return false;
+        }
+
+        /*
+         *  Rolls back the cursor to the position it had during construction, unless norepos() gets called.
+         */
+        class reposer
+        {
+            public:
+                reposer(line_scanner& is) : is(is), pos(is.tell()), dorepos(true)
+                {}
+
+                ~reposer()
+                { if(dorepos) is.seek(pos); }
+
+                reposer(const reposer&) = delete;
+                reposer& operator=(const reposer&) = delete;
+
+                // Rolls back to the position of construction time
+                line_scanner& repos()
+                { is.seek(pos); return is; }
+
+                // Avoid roll back during destruction
+                line_scanner& norepos(bool noreposx = true)
+                { dorepos = !noreposx; return is; }
+
+                // Same as calling 'norepos(noreposx)'
+                line_scanner& operator()(bool noreposx)
+                { return norepos(noreposx); }
+
+            private:
+                line_scanner& is;
+                const char* pos;
+                bool dorepos;
+        };
+
+    public:
+        // Integer Scanners
+        line_scanner& operator>>(short& value)              { return scan_integer(value); }
+        line_scanner& operator>>(unsigned short& value)     { return scan_integer(value); }
+        line_scanner& operator>>(int& value)                { return scan_integer(value); }
+        line_scanner& operator>>(unsigned int& value)       { return scan_integer(value); }
+        line_scanner& operator>>(long& value)               { return scan_integer(value); }
+        line_scanner& operator>>(unsigned long& value)      { return scan_integer(value); }
+        line_scanner& operator>>(long long& value)          { return scan_integer(value); }
+        line_scanner& operator>>(unsigned long long& value) { return scan_integer(value); }
+
+        // Floating Point Scanners
+        line_scanner& operator>>(float& value)              { return scan_real(value); }
+        line_scanner& operator>>(double& value)             { return scan_real(value); }
+        line_scanner& operator>>(long double& value)        { return scan_real(value); }
+
+        // Boolean Scanner ('0' or '1')
+        line_scanner& operator>>(bool& value)
+        {
+            reposer xrepos(*this);
+            if(sentry())
+            {
+                char c = *m_cur++;
+                if((c == '0' || c == '1') && match_end())
+                {
+                    value = (c == '1');
+                    return xrepos(true);
+                }
+            }
+            return failed();
+        }
+
+        // Character Scanners
+        line_scanner& operator>>(char& value)
+        {
+            reposer xrepos(*this);
+            if(sentry())
+            {
+                char c = *m_cur++;
+                if(match_end())
+                {
+                    value = c;
+                    return xrepos(true);
+                }
+            }
+            return failed();
+        }
+
+        line_scanner& operator>>(signed char& value)    { return (*this >> reinterpret_cast<char&>(value)); }
+        line_scanner& operator>>(unsigned char& value)  { return (*this >> reinterpret_cast<char&>(value)); }
+
+        // String Scanner
+        line_scanner& operator>>(std::string& value)
+        {
+            if(sentry())
+            {
+                const char* begin = m_cur;
+                while(m_cur != m_end && !isspace(*m_cur)) ++m_cur;
+                value.assign(begin, m_cur);
+            }
+            return *this;
+        }
+
+    public:
+        // Fast check for space characters
+        static bool isspace(int c)
+        { return icheckstream::isspace(c); }
+
+        // Fast check for integral digits
+        static bool isdigit(int c)
+        { return icheckstream::isdigit(c); }
+
+    private:
+
+        // Finishes a match by checking if the current character is a blank space (or the end of the line)
+        bool match_end()
+        {
+            return (m_cur == m_end || isspace(*m_cur));
+        }
+
+        // Gets the value of the digit 'c' in the current base or -1 if it isn't a digit
+        int digit(char c) const
+        {
+            if(c >= '0' && c <= '9') return c - '0';
+            if(m_base == 16)
+            {
+                if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+                if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+            }
+            return -1;
+        }
+
+        // Matches the digits of a integer at the cursor (at least one), outputs the magnitude
+        // Returns false if no digit is present or the magnitude overflows
+        bool match_magnitude(unsigned long long& magnitude)
+        {
+            const unsigned long long max = (std::numeric_limits<unsigned long long>::max)();
+            bool overflow = false;
+            int d;
+
+            if(m_cur == m_end || (d = digit(*m_cur)) < 0)
+                return false;
+
+            for(magnitude = 0; m_cur != m_end && (d = digit(*m_cur)) >= 0; ++m_cur)
+            {
+                if(magnitude > (max - d) / m_base) overflow = true;
+                magnitude = magnitude * m_base + d;
+            }
+            return !overflow;
+        }
+
+        // Scans a integer of type T
+        template<class T>
+        line_scanner& scan_integer(T& value)
+        {
+            using limits = std::numeric_limits<T>;
+            unsigned long long magnitude;
+
+            reposer xrepos(*this);
+            if(sentry())
+            {
+                bool negative = (*m_cur == '-');
+                if(*m_cur == '+' || *m_cur == '-') ++m_cur;
+
+                if(m_base == 16 && m_end - m_cur >= 2 && m_cur[0] == '0' && (m_cur[1] == 'x' || m_cur[1] == 'X'))
+                    m_cur += 2;
+
+                if(match_magnitude(magnitude) && match_end())
+                {
+                    if(limits::is_signed)
+                    {
+                        auto max = (unsigned long long)((limits::max)());
+                        if(magnitude <= max + (negative? 1 : 0))
+                        {
+                            value = negative? T(0 - magnitude) : T(magnitude);
+                            return xrepos(true);
+                        }
+                    }
+                    else if(magnitude <= (unsigned long long)((limits::max)()))
+                    {
+                        value = negative? T(0 - T(magnitude)) : T(magnitude);   // as strtoul does
+                        return xrepos(true);
+                    }
+                }
+            }
+            return failed();
+        }
+
+        // Scans a floating point of type T
+        template<class T>
+        line_scanner& scan_real(T& value)
+        {
+            reposer xrepos(*this);
+            if(sentry())
+            {
+                const char* begin = m_cur;
+                if(match_real() && match_end())
+                {
+                    // The converter stops at the separator, but it needs a null terminator after the last token
+                    char buffer[64];
+                    const char* token = begin;
+                    size_t len = size_t(m_cur - begin);
+                    std::string longtoken;
+
+                    if(m_cur == m_end)
+                    {
+                        if(len < sizeof(buffer))
+                        {
+                            std::memcpy(buffer, begin, len);
+                            buffer[len] = 0;
+                            token = buffer;
+                        }
+                        else
+                            token = (longtoken.assign(begin, len)).c_str();
+                    }
+
+                    // Values out of the range of T fail, as they do in the stream
+                    char* endp;
+                    T result = to_real<T>(token, &endp);
+                    T huge   = std::numeric_limits<T>::infinity();
+                    if(endp == token + len && result != huge && result != -huge)
+                    {
+                        value = result;
+                        return xrepos(true);
+                    }
+                }
+            }
+            return failed();
+        }
+
+        // Matches a real number (supports exponents), same grammar as in icheckstream
+        bool match_real()
+        {
+            auto match_digits = [this]() -> bool
+            {
+                if(m_cur == m_end || !isdigit(*m_cur)) return false;
+                while(m_cur != m_end && isdigit(*m_cur)) ++m_cur;
+                return true;
+            };
+
+            if(*m_cur == '+' || *m_cur == '-') ++m_cur;
+            if(!match_digits())
+                return false;
+
+            if(m_cur != m_end && *m_cur == '.')
+            {
+                ++m_cur;
+                if(m_cur != m_end && isdigit(*m_cur)) match_digits();
+            }
+
+            if(m_cur != m_end && (*m_cur == 'e' || *m_cur == 'E'))
+            {
+                ++m_cur;
+                if(m_cur != m_end && (*m_cur == '+' || *m_cur == '-')) ++m_cur;
+                return match_digits();
+            }
+
+            return true;
+        }
+
+        template<class T>
+        static typename std::enable_if<std::is_same<T, float>::value, T>::type to_real(const char* s, char** endp)
+        { return std::strtof(s, endp); }
+
+        template<class T>
+        static typename std::enable_if<!std::is_same<T, float>::value, T>::type to_real(const char* s, char** endp)
+        { return T(std::strtod(s, endp)); }
+
+    private:
+        const char* m_cur;      // Cursor
+        const char* m_end;      // End of the line
+        int         m_base;     // Base of integers
+        bool        m_fail;     // Failure state
+};
+
+
+/*
+ *  Fallback for types with no overload for the line_scanner
+ *  Checks and reads the value at the cursor using icheckstream and imemstream.
+ */
+template<class T> inline
+typename std::enable_if<!std::is_enum<T>::value, line_scanner&>::type
+/* line_scanner& */ operator>>(line_scanner& is, T& value)
+{
+    line_scanner::reposer xrepos(is);
+    if(is.sentry())
+    {
+        auto size = size_t(is.end() - is.tell());
+
+        icheckstream checker(is.tell(), size);
+        if(is.base() == 16) checker.setf(std::ios::hex, std::ios::basefield);
+
+        if(checker >> static_cast<const T&>(value))
+        {
+            imemstream stream(is.tell(), size);
+            if(is.base() == 16) stream.setf(std::ios::hex, std::ios::basefield);
+
+            if(stream >> value)
+            {
+                auto pos = std::streamoff(stream.rdbuf()->pubseekoff(0, std::ios::cur, std::ios::in));
+                is.seek(pos >= 0? is.tell() + pos : is.end());
+                return xrepos(true);
+            }
+        }
+    }
+    return is.failed();
+}
+
+
+} // namespace datalib
@@ -5,6 +5,8 @@
  */
 #pragma once
 #include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <datalib/detail/flat_linear_map.hpp>
 
 namespace datalib {
@@ -78,7 +80,7 @@ auto find_dominant_data(ForwardIterator first, ForwardIterator last, const Key&
 
     for(auto st = first; st != last; ++st)
     {
-        bool is_default = st->default();
+        bool is_default = st->is_default_store();
 
         if(st->ready())
         {
@@ -118,7 +120,7 @@ auto find_dominant_data(ForwardIterator first, ForwardIterator last, const Key&
 
         // Find the dominant based on the information gathered in the iteration over there
         // Remember the 'if all elements are dominant, the first one is returned'? well, std::min_element has this rule too :)
-        auto dom = std::min_element(counter.begin(), counter.end(), [](const map_counter_type::value_type& a, const map_counter_type::value_type& b)
+        auto dom = std::min_element(counter.begin(), counter.end(), [](const typename map_counter_type::value_type& a, const typename map_counter_type::value_type& b)
         {
             // Because the dominant element cannot be the default one, returns 'a' if 'b' is default and returns 'b' if 'a' is the default.
             // Otherwise returns the less commmon element, which should be the dominant.
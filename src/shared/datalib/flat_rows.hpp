@@ -0,0 +1,618 @@
+/*
+ *  Copyright (C) 2014 Denilson das Mercs Amorim (aka LINK/2012)
+ *  Licensed under the Boost Software License v1.0 (http://opensource.org/licenses/BSL-1.0)
+ *
+ */
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <boost/mpl/at.hpp>
+#include <boost/mpl/size.hpp>
+#include <boost/optional.hpp>
+#include <boost/variant.hpp>
+#include <type_wrapper/type_wrapper.hpp>
+
+namespace datalib {
+
+/*
+ *  Flat rows
+ *      Binary form of the content of a data store which doesn't go through cereal.
+ *
+ *      Arithmetic values (and arrays of them) are copied as they're in memory, strings and containers are their size followed
+ *      by their elements, either and optional objects are their state followed by their value, and any other class is written
+ *      by the same serialize(Archive&) or save(Archive&)/load(Archive&) methods cereal would call, so data_store, data_slice,
+ *      flat_sorted_map and the store traits need nothing else.
+ *
+ *      Reading it back is a walk over a memory buffer, without a stream or an archive in between each value.
+ *      The form depends on the build (sizes and endianess), so it's only meant for caches checked against the build identifier.
+ *
+ *      Values with none of the above (e.g. shared pointers, which cereal tracks) make the writer fail, the caller should then
+ *      use cereal for that object.
+ */
+template<class T, class = void>
+struct flat_io;
+
+/*
+ *  flat_row_writer
+ *      Appends the flat form of values into a string
+ */
+class flat_row_writer
+{
+    public:
+        explicit flat_row_writer(std::string& out) : out(out)
+        {}
+
+        // Whether every value written so far had a flat form
+        bool good() const { return this->is_good; }
+
+        // Writes the values in order, this is what serialize(Archive&) methods call
+        template<class... Args>
+        flat_row_writer& operator()(Args&&... args)
+        {
+            int dummy[] = { 0, (flat_io<typename std::decay<Args>::type>::save(*this, args), 0)... };
+            (void)(dummy);
+            return *this;
+        }
+
+        void write(const void* data, size_t size)
+        {
+            out.append(static_cast<const char*>(data), size);
+        }
+
+        void write_size(size_t size)
+        {
+            uint32_t value = uint32_t(size);
+            this->write(&value, sizeof(value));
+        }
+
+        void fail()
+        {
+            this->is_good = false;
+        }
+
+    private:
+        std::string& out;
+        bool is_good = true;
+};
+
+/*
+ *  flat_row_reader
+ *      Reads values from their flat form in a memory buffer
+ *      Reading past the end of the buffer fails the reader, and every read after it fails too.
+ */
+class flat_row_reader
+{
+    public:
+        flat_row_reader(const char* data, size_t size) : p(data), end(data + size)
+        {}
+
+        // Whether every value read so far was well formed
+        bool good() const { return this->is_good; }
+
+        // Whether the whole buffer has been read
+        bool eof() const  { return this->p == this->end; }
+
+        // Number of bytes not read yet
+        size_t remaining() const { return size_t(end - p); }
+
+        // Reads the values in order, this is what serialize(Archive&) methods call
+        template<class... Args>
+        flat_row_reader& operator()(Args&&... args)
+        {
+            int dummy[] = { 0, (flat_io<typename std::decay<Args>::type>::load(*this, args), 0)... };
+            (void)(dummy);
+            return *this;
+        }
+
+        // Takes the next @size bytes of the buffer, returns null if there isn't enough of them
+        const char* take(size_t size)
+        {
+            if(!this->is_good || size_t(end - p) < size)
+            {
+                this->fail();
+                return nullptr;
+            }
+            const char* data = p;
+            p += size;
+            return data;
+        }
+
+        bool read(void* data, size_t size)
+        {
+            if(const char* src = this->take(size))
+            {
+                std::memcpy(data, src, size);
+                return true;
+            }
+            return false;
+        }
+
+        bool read_size(size_t& size)
+        {
+            uint32_t value = 0;
+            bool result = this->read(&value, sizeof(value));
+            size = value;
+            return result;
+        }
+
+        void fail()
+        {
+            this->is_good = false;
+        }
+
+    private:
+        const char* p;
+        const char* end;
+        bool is_good = true;
+};
+
+
+// Writes @value (usually a data store) as flat rows at the end of @out
+// Returns false if any part of it has no flat form, in which case what has been appended into @out is meaningless
+template<class T>
+inline bool save_flat_rows(std::string& out, const T& value)
+{
+    flat_row_writer ar(out);
+    ar(value);
+    return ar.good();
+}
+
+// Reads @value back from the flat rows at @data
+// Returns false if they're malformed or if they don't take all the @size bytes
+template<class T>
+inline bool load_flat_rows(const char* data, size_t size, T& value)
+{
+    flat_row_reader ar(data, size);
+    ar(value);
+    return ar.good() && ar.eof();
+}
+
+
+
+// Internal stuff
+namespace detail
+{
+    template<class T, class = void>
+    struct has_flat_serialize : std::false_type {};
+    template<class T>
+    struct has_flat_serialize<T, decltype(std::declval<T&>().serialize(std::declval<flat_row_writer&>()), void())> : std::true_type {};
+
+    template<class T, class = void>
+    struct has_flat_save_load : std::false_type {};
+    template<class T>
+    struct has_flat_save_load<T, decltype(std::declval<const T&>().save(std::declval<flat_row_writer&>()),
+                                          std::declval<T&>().load(std::declval<flat_row_reader&>()), void())> : std::true_type {};
+
+    // How the primary flat_io handles the type T
+    enum class flat_kind { raw, empty, serialize, save_load, none };
+
+    template<class T>
+    struct flat_kind_of : std::integral_constant<flat_kind,
+        (std::is_arithmetic<T>::value || std::is_enum<T>::value)? flat_kind::raw :
+        std::is_empty<T>::value?                                    flat_kind::empty :
+        has_flat_serialize<T>::value?                               flat_kind::serialize :
+        has_flat_save_load<T>::value?                               flat_kind::save_load :
+                                                                    flat_kind::none>
+    {};
+
+    // Sequences, their size followed by their elements, which are read in place at the end of the container
+    template<class Container, class ValueType = typename Container::value_type>
+    struct flat_sequence_io
+    {
+        static const bool is_raw = false;
+
+        static void save(flat_row_writer& ar, const Container& c)
+        {
+            ar.write_size(c.size());
+            for(auto& x : c) flat_io<ValueType>::save(ar, x);
+        }
+
+        static void load(flat_row_reader& ar, Container& c)
+        {
+            size_t size;
+            c.clear();
+            if(ar.read_size(size))
+            {
+                for(size_t i = 0; i < size && ar.good(); ++i)
+                {
+                    c.emplace_back();
+                    flat_io<ValueType>::load(ar, c.back());
+                }
+            }
+        }
+    };
+
+    // Sets, their size followed by their elements, which are inserted at the end when read back
+    template<class Container, class ValueType = typename Container::value_type>
+    struct flat_set_io : flat_sequence_io<Container, ValueType>
+    {
+        static void load(flat_row_reader& ar, Container& c)
+        {
+            size_t size;
+            c.clear();
+            if(ar.read_size(size))
+            {
+                for(size_t i = 0; i < size && ar.good(); ++i)
+                {
+                    ValueType x;
+                    flat_io<ValueType>::load(ar, x);
+                    c.emplace_hint(c.end(), std::move(x));
+                }
+            }
+        }
+    };
+
+    // Maps, the const of the key doesn't let the element be read in place
+    template<class Map>
+    struct flat_map_io
+    {
+        using key_type    = typename Map::key_type;
+        using mapped_type = typename Map::mapped_type;
+
+        static const bool is_raw = false;
+
+        static void save(flat_row_writer& ar, const Map& map)
+        {
+            ar.write_size(map.size());
+            for(auto& kv : map)
+            {
+                flat_io<key_type>::save(ar, kv.first);
+                flat_io<mapped_type>::save(ar, kv.second);
+            }
+        }
+
+        static void load(flat_row_reader& ar, Map& map)
+        {
+            size_t size;
+            map.clear();
+            if(ar.read_size(size))
+            {
+                for(size_t i = 0; i < size && ar.good(); ++i)
+                {
+                    std::pair<key_type, mapped_type> kv;
+                    flat_io<key_type>::load(ar, kv.first);
+                    flat_io<mapped_type>::load(ar, kv.second);
+                    map.emplace_hint(map.end(), std::move(kv));
+                }
+            }
+        }
+    };
+}
+
+
+/*
+ *  flat_io<T>
+ *      Writes and reads a T in its flat form
+ *      is_raw tells whether the flat form of T is its bytes in memory, so arrays and vectors of it are copied at once.
+ */
+template<class T, class>
+struct flat_io
+{
+    using kind = detail::flat_kind_of<T>;
+    static const bool is_raw = (kind::value == detail::flat_kind::raw);
+
+    static void save(flat_row_writer& ar, const T& value)
+    {
+        save(ar, value, kind());
+    }
+
+    static void load(flat_row_reader& ar, T& value)
+    {
+        load(ar, value, kind());
+    }
+
+    private:
+        using raw       = std::integral_constant<detail::flat_kind, detail::flat_kind::raw>;
+        using empty     = std::integral_constant<detail::flat_kind, detail::flat_kind::empty>;
+        using serialize = std::integral_constant<detail::flat_kind, detail::flat_kind::serialize>;
+        using save_load = std::integral_constant<detail::flat_kind, detail::flat_kind::save_load>;
+        using none      = std::integral_constant<detail::flat_kind, detail::flat_kind::none>;
+
+        static void save(flat_row_writer& ar, const T& value, raw)          { ar.write(&value, sizeof(value)); }
+        static void load(flat_row_reader& ar, T& value, raw)                { ar.read(&value, sizeof(value)); }
+
+        static void save(flat_row_writer& ar, const T& value, empty)        {}
+        static void load(flat_row_reader& ar, T& value, empty)              {}
+
+        // serialize() isn't const, as with cereal the object isn't changed when writing
+        static void save(flat_row_writer& ar, const T& value, serialize)    { const_cast<T&>(value).serialize(ar); }
+        static void load(flat_row_reader& ar, T& value, serialize)          { value.serialize(ar); }
+
+        static void save(flat_row_writer& ar, const T& value, save_load)    { value.save(ar); }
+        static void load(flat_row_reader& ar, T& value, save_load)          { value.load(ar); }
+
+        static void save(flat_row_writer& ar, const T& value, none)         { ar.fail(); }
+        static void load(flat_row_reader& ar, T& value, none)               { ar.fail(); }
+};
+
+template<class Traits, class Allocator>
+struct flat_io<std::basic_string<char, Traits, Allocator>>
+{
+    using string_type = std::basic_string<char, Traits, Allocator>;
+    static const bool is_raw = false;
+
+    static void save(flat_row_writer& ar, const string_type& s)
+    {
+        ar.write_size(s.size());
+        ar.write(s.data(), s.size());
+    }
+
+    static void load(flat_row_reader& ar, string_type& s)
+    {
+        size_t size;
+        const char* data;
+        if(ar.read_size(size) && (data = ar.take(size)) != nullptr)
+            s.assign(data, size);
+    }
+};
+
+template<class T, class Base>
+struct flat_io<type_wrapper<T, Base>>
+{
+    static const bool is_raw = flat_io<T>::is_raw && sizeof(type_wrapper<T, Base>) == sizeof(T);
+
+    static void save(flat_row_writer& ar, const type_wrapper<T, Base>& tw)  { flat_io<T>::save(ar, tw.get_()); }
+    static void load(flat_row_reader& ar, type_wrapper<T, Base>& tw)        { flat_io<T>::load(ar, tw.get_()); }
+};
+
+template<class T1, class T2>
+struct flat_io<std::pair<T1, T2>>
+{
+    static const bool is_raw = false;
+
+    static void save(flat_row_writer& ar, const std::pair<T1, T2>& pair)
+    {
+        flat_io<T1>::save(ar, pair.first);
+        flat_io<T2>::save(ar, pair.second);
+    }
+
+    static void load(flat_row_reader& ar, std::pair<T1, T2>& pair)
+    {
+        flat_io<T1>::load(ar, pair.first);
+        flat_io<T2>::load(ar, pair.second);
+    }
+};
+
+template<class... Types>
+struct flat_io<std::tuple<Types...>>
+{
+    using tuple_type = std::tuple<Types...>;
+    static const bool is_raw = false;
+
+    static void save(flat_row_writer& ar, const tuple_type& tuple)  { save(ar, tuple, std::integral_constant<size_t, 0>()); }
+    static void load(flat_row_reader& ar, tuple_type& tuple)        { load(ar, tuple, std::integral_constant<size_t, 0>()); }
+
+    private:
+        using end = std::integral_constant<size_t, sizeof...(Types)>;
+
+        static void save(flat_row_writer&, const tuple_type&, end)  {}
+        static void load(flat_row_reader&, tuple_type&, end)        {}
+
+        template<size_t I>
+        static void save(flat_row_writer& ar, const tuple_type& tuple, std::integral_constant<size_t, I>)
+        {
+            flat_io<typename std::tuple_element<I, tuple_type>::type>::save(ar, std::get<I>(tuple));
+            save(ar, tuple, std::integral_constant<size_t, I+1>());
+        }
+
+        template<size_t I>
+        static void load(flat_row_reader& ar, tuple_type& tuple, std::integral_constant<size_t, I>)
+        {
+            flat_io<typename std::tuple_element<I, tuple_type>::type>::load(ar, std::get<I>(tuple));
+            load(ar, tuple, std::integral_constant<size_t, I+1>());
+        }
+};
+
+template<class T, std::size_t N>
+struct flat_io<std::array<T, N>>
+{
+    using array_type = std::array<T, N>;
+    static const bool is_raw = flat_io<T>::is_raw && sizeof(array_type) == sizeof(T) * N;
+
+    static void save(flat_row_writer& ar, const array_type& array)
+    {
+        save(ar, array, std::integral_constant<bool, flat_io<T>::is_raw>());
+    }
+
+    static void load(flat_row_reader& ar, array_type& array)
+    {
+        load(ar, array, std::integral_constant<bool, flat_io<T>::is_raw>());
+    }
+
+    private:
+        static void save(flat_row_writer& ar, const array_type& array, std::true_type)  { ar.write(array.data(), sizeof(T) * N); }
+        static void load(flat_row_reader& ar, array_type& array, std::true_type)        { ar.read(array.data(), sizeof(T) * N); }
+
+        static void save(flat_row_writer& ar, const array_type& array, std::false_type)
+        {
+            for(auto& x : array) flat_io<T>::save(ar, x);
+        }
+
+        static void load(flat_row_reader& ar, array_type& array, std::false_type)
+        {
+            for(auto& x : array) flat_io<T>::load(ar, x);
+        }
+};
+
+template<std::size_t N>
+struct flat_io<std::bitset<N>>
+{
+    static const bool is_raw = false;
+
+    static void save(flat_row_writer& ar, const std::bitset<N>& bits)
+    {
+        uint8_t bytes[(N + 7) / 8] = {};
+        for(size_t i = 0; i < N; ++i)
+            bytes[i / 8] |= uint8_t(bits.test(i)) << (i % 8);
+        ar.write(bytes, sizeof(bytes));
+    }
+
+    static void load(flat_row_reader& ar, std::bitset<N>& bits)
+    {
+        uint8_t bytes[(N + 7) / 8];
+        bits.reset();
+        if(ar.read(bytes, sizeof(bytes)))
+        {
+            for(size_t i = 0; i < N; ++i)
+                bits.set(i, ((bytes[i / 8] >> (i % 8)) & 1) != 0);
+        }
+    }
+};
+
+// Used by either<>, its state index followed by the value in that state
+template<class... Types>
+struct flat_io<boost::variant<Types...>>
+{
+    using variant_type = boost::variant<Types...>;
+    using types        = typename variant_type::types;
+    static const bool is_raw = false;
+
+    static void save(flat_row_writer& ar, const variant_type& variant)
+    {
+        uint32_t which = uint32_t(variant.which());
+        ar.write(&which, sizeof(which));
+        saver visitor(ar);
+        boost::apply_visitor(visitor, variant);
+    }
+
+    static void load(flat_row_reader& ar, variant_type& variant)
+    {
+        uint32_t which;
+        if(ar.read(&which, sizeof(which)))
+            load(ar, variant, which, std::integral_constant<int, 0>());
+    }
+
+    private:
+        struct saver : boost::static_visitor<>
+        {
+            flat_row_writer& ar;
+            explicit saver(flat_row_writer& ar) : ar(ar) {}
+
+            template<class U>
+            void operator()(const U& value) const { flat_io<U>::save(ar, value); }
+        };
+
+        static void load(flat_row_reader& ar, variant_type&, uint32_t, std::integral_constant<int, boost::mpl::size<types>::value>)
+        {
+            ar.fail();
+        }
+
+        template<int I>
+        static void load(flat_row_reader& ar, variant_type& variant, uint32_t which, std::integral_constant<int, I>)
+        {
+            if(which == I)
+            {
+                typename boost::mpl::at_c<types, I>::type value;
+                flat_io<decltype(value)>::load(ar, value);
+                variant = std::move(value);
+            }
+            else
+                load(ar, variant, which, std::integral_constant<int, I+1>());
+        }
+};
+
+// Used by optional<>, whether it's set followed by the value
+template<class T>
+struct flat_io<boost::optional<T>>
+{
+    static const bool is_raw = false;
+
+    static void save(flat_row_writer& ar, const boost::optional<T>& opt)
+    {
+        bool has_value = !!opt;
+        ar.write(&has_value, sizeof(has_value));
+        if(has_value) flat_io<T>::save(ar, *opt);
+    }
+
+    static void load(flat_row_reader& ar, boost::optional<T>& opt)
+    {
+        bool has_value = false;
+        opt = boost::none;
+        if(ar.read(&has_value, sizeof(has_value)) && has_value)
+        {
+            T value;
+            flat_io<T>::load(ar, value);
+            opt = std::move(value);
+        }
+    }
+};
+
+// Vectors of raw values are copied at once
+template<class T, class Allocator>
+struct flat_io<std::vector<T, Allocator>> : detail::flat_sequence_io<std::vector<T, Allocator>>
+{
+    using vector_type = std::vector<T, Allocator>;
+    using base        = detail::flat_sequence_io<vector_type>;
+
+    static void save(flat_row_writer& ar, const vector_type& v)
+    {
+        save(ar, v, std::integral_constant<bool, flat_io<T>::is_raw>());
+    }
+
+    static void load(flat_row_reader& ar, vector_type& v)
+    {
+        load(ar, v, std::integral_constant<bool, flat_io<T>::is_raw>());
+    }
+
+    private:
+        static void save(flat_row_writer& ar, const vector_type& v, std::false_type)    { base::save(ar, v); }
+
+        static void load(flat_row_reader& ar, vector_type& v, std::false_type)
+        {
+            // Reserve for what the rows could hold, so a broken size doesn't take all the memory
+            size_t size;
+            flat_row_reader peek = ar;
+            if(peek.read_size(size))
+            {
+                v.clear();
+                v.reserve((std::min)(size, peek.remaining()));
+            }
+            base::load(ar, v);
+        }
+
+        static void save(flat_row_writer& ar, const vector_type& v, std::true_type)
+        {
+            ar.write_size(v.size());
+            ar.write(v.data(), v.size() * sizeof(T));
+        }
+
+        static void load(flat_row_reader& ar, vector_type& v, std::true_type)
+        {
+            size_t size;
+            const char* data;
+            v.clear();
+            if(ar.read_size(size) && size <= size_t(-1) / sizeof(T) && (data = ar.take(size * sizeof(T))) != nullptr && size != 0)
+            {
+                v.resize(size);
+                std::memcpy(v.data(), data, size * sizeof(T));
+            }
+        }
+};
+
+template<class T, class Allocator>
+struct flat_io<std::list<T, Allocator>> : detail::flat_sequence_io<std::list<T, Allocator>> {};
+template<class T, class Allocator>
+struct flat_io<std::deque<T, Allocator>> : detail::flat_sequence_io<std::deque<T, Allocator>> {};
+template<class T, class Compare, class Allocator>
+struct flat_io<std::set<T, Compare, Allocator>> : detail::flat_set_io<std::set<T, Compare, Allocator>> {};
+template<class T, class Compare, class Allocator>
+struct flat_io<std::multiset<T, Compare, Allocator>> : detail::flat_set_io<std::multiset<T, Compare, Allocator>> {};
+template<class Key, class T, class Compare, class Allocator>
+struct flat_io<std::map<Key, T, Compare, Allocator>> : detail::flat_map_io<std::map<Key, T, Compare, Allocator>> {};
+template<class Key, class T, class Compare, class Allocator>
+struct flat_io<std::multimap<Key, T, Compare, Allocator>> : detail::flat_map_io<std::multimap<Key, T, Compare, Allocator>> {};
+
+
+} // namespace datalib
@@ -8,86 +8,11 @@
 #include <string>
 #include <array>
 #include <datalib/detail/either.hpp>
+#include <datalib/gta3/section_info.hpp>
 
 namespace datalib {
 namespace gta3 {
 
-/*
- *  section_info
- *      Represents a gta3 section
- *      Construct a list of section infos by calling gta3::make_section_info(...), (e.g. gta3::make_section_info("objs", "cars", ...))
- */
-// NOTE SECTIONS MUST BE SENT IN THE SAME ORDER AS DATA DECLARED IN gta3::data_section !!!!!!!!!!!!!!!!!!!!!!!
-struct section_info
-{
-    const char* name;   // The name of this section. How it will be indentified in the sectioned file
-    int         id;     // The index of this section in the sections array
-    size_t      len;    // The length of the name
-
-    section_info() : section_info(nullptr) {}
-    section_info(const char* name) : name(name), id(-1), len(name? strlen(name) : 0) {}
-
-    // Finds the a section_info object in the 'sections' array based on the specified name.
-    static const section_info* by_name(const section_info* sections, const char* line)
-    {
-        for(auto s = sections; s->name != nullptr; ++s)
-        {
-            if(s->name[0])
-            {
-                if(!strcmp(line, s->name))
-                    return s;
-            }
-        }
-        return nullptr;
-    }
-
-    // Finds the a section_info object in the 'sections' array based on the specified name.
-    // This version looks only for the first 'n' characters from the line, or if -1 based on the strlen of the section name
-    static const section_info* by_name(const section_info* sections, const char* line, size_t line_strlen, int n)
-    {
-        for(auto s = sections; s->name != nullptr; ++s)
-        {
-            if(s->name[0])
-            {
-                size_t len = (n == -1? s->len : n);
-                if(line_strlen >= len && !strncmp(line, s->name, len))
-                    return s;
-            }
-        }
-        return nullptr;
-    }
-
-    // Finds the a section_info object in the 'sections' array based on the specified name.
-    static const section_info* by_name(const section_info* sections, const std::string& line)
-    {
-        return by_name(sections, line.data());
-    }
-
-    // Finds the a section_info object in the 'sections' array based on the specified name.
-    // This version looks only for the first 'n' characters from the line, or if -1 based on the strlen of the section name
-    static const section_info* by_name(const section_info* sections, const std::string& line, int n)
-    {
-        return by_name(sections, line.data(), line.length(), n);
-    }
-
-
-};
-
-template<class... Args>
-using section_array = std::array<section_info, sizeof...(Args) + 1>;
-
-// Builds a array of section info objects, putting a null terminator and setting up the indices correctly
-// NOTE SECTIONS MUST BE SENT IN THE SAME ORDER AS DATA DECLARED IN gta3::data_section !!!!!!!!!!!!!!!!!!!!!!!
-template<class... Args> inline
-static section_array<Args...> make_section_info(Args&&... a)
-{
-    auto array = section_array<Args...>( { a..., (const char*)(nullptr) } );
-    for(int i = 0; i < (int(array.size()) - 1); ++i)    // last element should have a -1 id, others it's respective index
-        array[i].id = i;
-    return array;
-}
-
-
 /*
  *  data_section
  *      An set of data_slice<> objects, each one represents one of the possible sections.
@@ -192,6 +117,17 @@ class data_section
             return has_section();
         }
 
+        // Sets the working section for this object and interprets the line on it in a single pass.
+        // Same as 'this->as_section(tsection, line) && this->set(line)' but faster.
+        bool parse_as_section(const section_info* tsection, const std::string& line)
+        {
+            if(tsection) assert(tsection->id < num_sections);
+            as_section_fn fn(*this, tsection);
+            foreach_type_variadic<Sections...>()(fn);
+            this->tsection = (this->parse(line)? tsection : nullptr);
+            return has_section();
+        }
+
         // Forces the current section specifier to be 'tsection'
         // Be very careful when using this function
         void force_section(const section_info* tsection)
@@ -230,6 +166,13 @@ class data_section
             return ::apply_visitor(visitor, this->data);
         }
 
+        // Same as 'this->check(line) && this->set(line)' but validates and interprets the line in a single pass
+        bool parse(const std::string& line)
+        {
+            parse_visitor visitor(line);
+            return ::apply_visitor(visitor, this->data);
+        }
+
         // Gets the content of this data storer into the line (by disassembling it)
         bool get(std::string& line)  const
         {
@@ -352,6 +295,23 @@ class data_section
             }
         };
 
+        struct parse_visitor : either_static_visitor<bool>
+        {
+            const std::string& line;
+            parse_visitor(const std::string& line) : line(line) {}
+
+            template<class T>
+            bool operator()(T& value) const
+            {
+                return value.parse(line);
+            }
+
+            bool operator()(either_blank) const
+            {
+                return false;
+            }
+        };
+
         struct get_visitor : either_static_visitor<bool>
         {
             std::string& line;
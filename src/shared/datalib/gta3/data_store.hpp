@@ -336,13 +336,13 @@ struct data_traits
     typename std::enable_if<StoreType::traits_type::has_sections, bool>::type
     static /* bool */ setbyline(StoreType& store, TData& data, const section_info* section, const std::string& line)
     {
-        return (data.as_section(section, line) && data.set(line));
+        return data.parse_as_section(section, line);
     }
     template<class StoreType, typename TData>
     typename std::enable_if<!StoreType::traits_type::has_sections, bool>::type
     static /* bool */ setbyline(StoreType& store, TData& data, const section_info* section, const std::string& line)
     {
-        return (data.check(line) && data.set(line));
+        return data.parse(line);
     }
 
 
@@ -10,6 +10,7 @@
 #include <string>
 #include <functional>
 #include <datalib/gta3/data_section.hpp>
+#include <datalib/detail/stream/printer.hpp>
 
 namespace datalib {
 namespace gta3 {
@@ -266,14 +267,14 @@ struct store_merger
         template<class StoreType, class ForwardIterator, class DomFlags>
         bool operator()(const char* outfilename, ForwardIterator st_begin, ForwardIterator st_end, DomFlags domflags)
         {
-            std::ofstream stream(outfilename);
+            buffered_writer stream(outfilename);
             if(stream)
             {
                 std::for_each(st_begin, st_end, [](StoreType& store) { store.premerge(); });
                 auto result = do_merge<StoreType>(stream, st_begin, st_end, domflags);
                 std::for_each(st_begin, st_end, [](StoreType& store) { store.posmerge(); });
                 write_eof<StoreType>(stream);
-                return result;
+                return stream.close() && result;    // the buffered content only reaches the disk here
             }
             return false;
         }
@@ -431,7 +432,7 @@ struct store_merger
         template<class StoreType>
         struct fn_dowrite
         {
-            fn_dowrite(store_merger& merger, std::ofstream& stream) :
+            fn_dowrite(store_merger& merger, buffered_writer& stream) :
                 merger(merger), stream(stream)
             {}
 
@@ -445,24 +446,24 @@ struct store_merger
 
             private:
             store_merger& merger;
-            std::ofstream& stream;
+            buffered_writer& stream;
         };
 
         template<class StoreType, class ForwardIterator, class DomFlags>
-        bool do_merge(std::false_type, std::ofstream& stream, ForwardIterator st_begin, ForwardIterator st_end, DomFlags domflags)
+        bool do_merge(std::false_type, buffered_writer& stream, ForwardIterator st_begin, ForwardIterator st_end, DomFlags domflags)
         {
             return StoreType::prewrite(merge(st_begin, st_end, domflags), fn_dowrite<StoreType>(*this, stream));
         }
 
         template<class StoreType, class ForwardIterator, class DomFlags>
-        bool do_merge(std::true_type, std::ofstream& stream, ForwardIterator st_begin, ForwardIterator st_end, DomFlags domflags)
+        bool do_merge(std::true_type, buffered_writer& stream, ForwardIterator st_begin, ForwardIterator st_end, DomFlags domflags)
         {
             auto xc = StoreType::traits_type::process_stlist<StoreType>(st_begin, st_end);
             return StoreType::prewrite(merge(xc.begin(), xc.end(), domflags), fn_dowrite<StoreType>(*this, stream));
         }
 
         template<class StoreType, class ForwardIterator, class DomFlags>
-        bool do_merge(std::ofstream& stream, ForwardIterator st_begin, ForwardIterator st_end, DomFlags domflags)
+        bool do_merge(buffered_writer& stream, ForwardIterator st_begin, ForwardIterator st_end, DomFlags domflags)
         {
             return do_merge<StoreType>(std::integral_constant<bool, StoreType::traits_type::do_stlist>(),
                                               stream, st_begin, st_end, domflags);
@@ -470,20 +471,20 @@ struct store_merger
 
 
         template<class StoreType>
-        bool write_eof(std::false_type, std::ofstream& stream) const
+        bool write_eof(std::false_type, buffered_writer& stream) const
         {
             return true;
         }
 
         template<class StoreType>
-        bool write_eof(std::true_type, std::ofstream& stream) const
+        bool write_eof(std::true_type, buffered_writer& stream) const
         {
             stream << StoreType::traits_type::eof_string() << '\n';
             return true;
         }
 
         template<class StoreType>
-        bool write_eof(std::ofstream& stream) const
+        bool write_eof(buffered_writer& stream) const
         {
             return write_eof<StoreType>(std::integral_constant<bool, StoreType::traits_type::has_eof_string>(), stream);
         }
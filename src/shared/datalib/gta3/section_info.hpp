@@ -0,0 +1,200 @@
+/*
+ *  Copyright (C) 2014 Denilson das Mercs Amorim (aka LINK/2012)
+ *  Licensed under the Boost Software License v1.0 (http://opensource.org/licenses/BSL-1.0)
+ *
+ */
+#pragma once
+#include <string>
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+
+namespace datalib {
+namespace gta3 {
+
+/*
+ *  section_table
+ *      Lookup table for the names of a list of sections, the names are bucketed by their first character.
+ *      Lookups return the index of the section in the list or -1 if not found.
+ *      When many sections match (in the prefix modes), the one with the lowest index is returned, as in a linear search.
+ */
+class section_table
+{
+    public:
+        // Adds the section name 'name' of length 'len' at the specified index (indices must be added in increasing order)
+        void add(const char* name, size_t len, int index)
+        {
+            buckets[uint8_t(name[0])].push_back(entry { name, len, index });
+            entries.push_back(entry { name, len, index });
+        }
+
+        // Finds the section named exactly as 'line'
+        int find(const char* line, size_t line_strlen) const
+        {
+            if(line_strlen)
+            {
+                for(auto& e : buckets[uint8_t(line[0])])
+                {
+                    if(e.len == line_strlen && !memcmp(line, e.name, e.len))
+                        return e.index;
+                }
+            }
+            return -1;
+        }
+
+        // Finds the first section whose name is a prefix of 'line'
+        int find_prefix(const char* line, size_t line_strlen) const
+        {
+            if(line_strlen)
+            {
+                for(auto& e : buckets[uint8_t(line[0])])
+                {
+                    if(e.len <= line_strlen && !memcmp(line, e.name, e.len))
+                        return e.index;
+                }
+            }
+            return -1;
+        }
+
+        // Finds the first section whose first 'n' characters are the same as the first 'n' characters of 'line'
+        int find_prefix(const char* line, size_t line_strlen, size_t n) const
+        {
+            if(line_strlen >= n)
+            {
+                for(auto& e : (n? buckets[uint8_t(line[0])] : entries))
+                {
+                    if(e.len >= n && !memcmp(line, e.name, n))
+                        return e.index;
+                }
+            }
+            return -1;
+        }
+
+    private:
+        struct entry
+        {
+            const char* name;
+            size_t      len;
+            int         index;
+        };
+
+        std::array<std::vector<entry>, 256> buckets;    // Entries by the first character of the name, in index order
+        std::vector<entry>                  entries;    // All entries by index
+};
+
+
+/*
+ *  section_info
+ *      Represents a gta3 section
+ *      Construct a list of section infos by calling gta3::make_section_info(...), (e.g. gta3::make_section_info("objs", "cars", ...))
+ *      Lists built by gta3::make_section_info carry a section_table, making by_name() lookups cheap; other lists are searched linearly.
+ */
+// NOTE SECTIONS MUST BE SENT IN THE SAME ORDER AS DATA DECLARED IN gta3::data_section !!!!!!!!!!!!!!!!!!!!!!!
+struct section_info
+{
+    const char* name;   // The name of this section. How it will be indentified in the sectioned file
+    int         id;     // The index of this section in the sections array
+    size_t      len;    // The length of the name
+    std::shared_ptr<const section_table> table; // Lookup table for the list this section is in (may be null)
+
+    section_info() : section_info(nullptr) {}
+    section_info(const char* name) : name(name), id(-1), len(name? strlen(name) : 0) {}
+
+    // Finds the a section_info object in the 'sections' array based on the specified name.
+    static const section_info* by_name(const section_info* sections, const char* line)
+    {
+        return by_exact_name(sections, line, strlen(line));
+    }
+
+    // Finds the a section_info object in the 'sections' array based on the specified name.
+    // This version looks only for the first 'n' characters from the line, or if -1 based on the strlen of the section name
+    static const section_info* by_name(const section_info* sections, const char* line, size_t line_strlen, int n)
+    {
+        if(sections->table)
+        {
+            if(n == -1) return from_index(sections, sections->table->find_prefix(line, line_strlen));
+            return from_index(sections, sections->table->find_prefix(line, line_strlen, size_t(n)));
+        }
+
+        for(auto s = sections; s->name != nullptr; ++s)
+        {
+            if(s->name[0])
+            {
+                size_t len = (n == -1? s->len : n);
+                if(line_strlen >= len && !strncmp(line, s->name, len))
+                    return s;
+            }
+        }
+        return nullptr;
+    }
+
+    // Finds the a section_info object in the 'sections' array based on the specified name.
+    static const section_info* by_name(const section_info* sections, const std::string& line)
+    {
+        return by_exact_name(sections, line.data(), line.length());
+    }
+
+    // Finds the a section_info object in the 'sections' array based on the specified name.
+    // This version looks only for the first 'n' characters from the line, or if -1 based on the strlen of the section name
+    static const section_info* by_name(const section_info* sections, const std::string& line, int n)
+    {
+        return by_name(sections, line.data(), line.length(), n);
+    }
+
+    // Builds the lookup table for the null terminated 'sections' array
+    static std::shared_ptr<const section_table> make_table(const section_info* sections)
+    {
+        auto table = std::make_shared<section_table>();
+        for(auto s = sections; s->name != nullptr; ++s)
+        {
+            if(s->name[0]) table->add(s->name, s->len, int(s - sections));
+        }
+        return table;
+    }
+
+private:
+    // Finds the a section_info object in the 'sections' array named exactly as the 'line_strlen' characters of 'line'
+    static const section_info* by_exact_name(const section_info* sections, const char* line, size_t line_strlen)
+    {
+        if(sections->table)
+            return from_index(sections, sections->table->find(line, line_strlen));
+
+        for(auto s = sections; s->name != nullptr; ++s)
+        {
+            if(s->name[0])
+            {
+                if(s->len == line_strlen && !memcmp(line, s->name, line_strlen))
+                    return s;
+            }
+        }
+        return nullptr;
+    }
+
+    static const section_info* from_index(const section_info* sections, int index)
+    {
+        return index != -1? &sections[index] : nullptr;
+    }
+};
+
+template<class... Args>
+using section_array = std::array<section_info, sizeof...(Args) + 1>;
+
+// Builds a array of section info objects, putting a null terminator and setting up the indices correctly
+// NOTE SECTIONS MUST BE SENT IN THE SAME ORDER AS DATA DECLARED IN gta3::data_section !!!!!!!!!!!!!!!!!!!!!!!
+template<class... Args> inline
+static section_array<Args...> make_section_info(Args&&... a)
+{
+    auto array = section_array<Args...>( { a..., (const char*)(nullptr) } );
+    for(int i = 0; i < (int(array.size()) - 1); ++i)    // last element should have a -1 id, others it's respective index
+        array[i].id = i;
+
+    auto table = section_info::make_table(array.data());
+    for(auto& s : array) s.table = table;               // the table is shared by every copy of the array
+    return array;
+}
+
+} // namespace gta3
+} // namespace datalib
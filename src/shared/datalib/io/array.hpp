@@ -7,6 +7,8 @@
 #include <array>
 #include <datalib/data_info/array.hpp>
 #include <datalib/detail/stream/fwd.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 
 namespace datalib {
 
@@ -16,8 +18,8 @@ namespace datalib {
 template<class CharT, class Traits, class T, std::size_t N> inline
 datalib::basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstream<CharT, Traits>& is, const std::array<T, N>& array)
 {
-    datalib::basic_icheckstream<CharT, Traits>::reposer xrepos(is, true);
-    datalib::basic_icheckstream<CharT, Traits>::sentry  xsentry(is);
+    typename datalib::basic_icheckstream<CharT, Traits>::reposer xrepos(is, true);
+    typename datalib::basic_icheckstream<CharT, Traits>::sentry  xsentry(is);
     if(xsentry)
     {
         for(std::size_t i = 0; i < N; ++i)
@@ -26,6 +28,39 @@ datalib::basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstre
     return is;
 }
 
+/*
+ *  Fast Input
+ */
+template<class T, std::size_t N> inline
+datalib::line_scanner& operator>>(datalib::line_scanner& is, std::array<T, N>& array)
+{
+    datalib::line_scanner::reposer xrepos(is);
+    if(is.sentry())
+    {
+        for(std::size_t i = 0; i < N; ++i)
+            if((is >> array[i]).fail()) break;
+    }
+    return xrepos(!!is);
+}
+
+/*
+ *  Fast Output
+ */
+template<class T, std::size_t N> inline
+datalib::line_printer& operator<<(datalib::line_printer& os, const std::array<T, N>& array)
+{
+    for(std::size_t i = 0; i < N; ++i)
+    {
+        if(os << array[i])
+        {
+            if(print_separator<T>(os).fail())
+                break;
+        }
+        else break;
+    }
+    return os;
+}
+
 }
 
 namespace std {
@@ -36,7 +71,7 @@ namespace std {
 template<class CharT, class Traits, class T, std::size_t N> inline
 std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>& is, std::array<T, N>& array)
 {
-    std::basic_istream<CharT, Traits>::sentry xsentry(is);
+    typename std::basic_istream<CharT, Traits>::sentry xsentry(is);
     if(xsentry)
     {
         for(std::size_t i = 0; i < N; ++i)
@@ -51,14 +86,14 @@ std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>&
 template<class CharT, class Traits, class T, std::size_t N> inline
 std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const std::array<T, N>& array)
 {
-    std::basic_ostream<CharT, Traits>::sentry xsentry(os);
+    typename std::basic_ostream<CharT, Traits>::sentry xsentry(os);
     if(xsentry)
     {
         for(std::size_t i = 0; i < N; ++i)
         {
             if(os << array[i])
             {
-                if(print_separator<T>(os).fail())
+                if(datalib::print_separator<T>(os).fail())
                     break;
             }
             else break;
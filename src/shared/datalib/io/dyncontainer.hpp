@@ -18,20 +18,20 @@ namespace datalib {
 /*
  *  Input Checker
  */
-template<class CharT, class Traits, class ContainerType, typename = std::enable_if<is_dyncontainer<ContainerType>::value>::type>
+template<class CharT, class Traits, class ContainerType, typename = typename std::enable_if<is_dyncontainer<ContainerType>::value>::type>
 inline
 datalib::basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstream<CharT, Traits>& is, const ContainerType& cont)
 {
-    using reposer_t = datalib::basic_icheckstream<CharT, Traits>::reposer;
-    datalib::basic_icheckstream<CharT, Traits>::reposer xrepos(is, true);
-    datalib::basic_icheckstream<CharT, Traits>::sentry  xsentry(is);
+    using reposer_t = typename datalib::basic_icheckstream<CharT, Traits>::reposer;
+    typename datalib::basic_icheckstream<CharT, Traits>::reposer xrepos(is, true);
+    typename datalib::basic_icheckstream<CharT, Traits>::sentry  xsentry(is);
     if(xsentry)
     {
         bool good = !!is;
         while(good)
         {
             reposer_t repos(is);
-            is >> *(const ContainerType::value_type*)(nullptr);
+            is >> check_dummy<typename ContainerType::value_type>();
             good = !!is;
             repos(good);    // put the stream pointer back to where it was if the stream failed to read the previous element
         }
@@ -47,14 +47,14 @@ namespace std {
 /*
  *  Input
  */
-template<class CharT, class Traits, class ContainerType, typename = std::enable_if<is_dyncontainer<ContainerType>::value>::type>
+template<class CharT, class Traits, class ContainerType, typename = typename std::enable_if<datalib::is_dyncontainer<ContainerType>::value>::type>
 inline
 std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>& is, ContainerType& cont)
 {
-    std::basic_istream<CharT, Traits>::sentry  xsentry(is);
+    typename std::basic_istream<CharT, Traits>::sentry  xsentry(is);
     if(xsentry)
     {
-        ContainerType::value_type value;
+        typename ContainerType::value_type value;
         bool good = !!is;
         cont.clear();
         while(good)
@@ -74,11 +74,11 @@ std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>&
 /*
  *  Output
  */
-template<class CharT, class Traits, class ContainerType, typename = std::enable_if<is_dyncontainer<ContainerType>::value>::type>
+template<class CharT, class Traits, class ContainerType, typename = typename std::enable_if<datalib::is_dyncontainer<ContainerType>::value>::type>
 inline
 std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const ContainerType& cont)
 {
-    std::basic_ostream<CharT, Traits>::sentry xsentry(os);
+    typename std::basic_ostream<CharT, Traits>::sentry xsentry(os);
     if(xsentry)
     {
         for(auto it = cont.begin(); it != cont.end(); ++it)
@@ -86,7 +86,7 @@ std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>&
             if(os << *it)
             {
                 using value_type = typename ContainerType::value_type;
-                if(print_separator<value_type>(os).fail())
+                if(datalib::print_separator<value_type>(os).fail())
                     break;
             }
             else break;
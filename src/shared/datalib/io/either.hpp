@@ -7,6 +7,8 @@
 #include <datalib/data_info/either.hpp>
 #include <datalib/detail/stream/fwd.hpp>
 #include <datalib/detail/stream/kstream.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 #include <datalib/detail/mpl/seqeach.hpp>
 
 namespace datalib {
@@ -91,9 +93,9 @@ namespace detail
         {
             auto& is = stream;
 
-            // Since basic_icheckstream doesn't write anything in '>>' use a null reference,
-            // we won't take the time to construct a proper object
-            auto& dummy_ref = *((const typename TypeWr::type*)(nullptr));
+            // Since basic_icheckstream doesn't write anything in '>>' use a shared dummy
+            // instead of taking the time to construct a proper object
+            auto& dummy_ref = check_dummy<typename TypeWr::type>();
 
             // Check if it's possible to take the text on the stream pointer to the specified type
             if(is >> dummy_ref)
@@ -121,6 +123,67 @@ namespace detail
         }
 
     };
+
+    template<class Either>
+    struct lambda_either_scan_val
+    {
+        Either&         either;
+        line_scanner&   stream;
+        bool&           result;     // outputs the result of the operation (=true) but on failure doesn't change the variable
+
+        // Local-Scope Captures
+        lambda_either_scan_val(line_scanner& stream, Either& either, bool& result) :
+            stream(stream), either(either), result(result)
+        {}
+
+        // The Functor
+        template<class Integral, typename TypeWr>
+        typename std::enable_if<!std::is_same<typename TypeWr::type, boost::detail::variant::void_>::value, bool>::type
+        /* bool */ operator()(Integral, TypeWr)
+        {
+            // Try to scan this type, the scanner rolls back the cursor on failure
+            typename TypeWr::type value;
+            if(stream >> value)
+            {
+                // Yep! Move the value to the either object and stop iteration
+                either = std::move(value);
+                this->result = true;
+                return false;
+            }
+            stream.clear();
+            return true;
+        }
+
+        // Avoid boost's voidness type
+        template<class Integral, typename TypeWr>
+        typename std::enable_if<std::is_same<typename TypeWr::type, boost::detail::variant::void_>::value, bool>::type
+        /* bool */ operator()(Integral, TypeWr)
+        {
+            return false;
+        }
+    };
+
+    struct lambda_either_print_val : either_static_visitor<void>
+    {
+        line_printer&   stream;
+
+        // Local-Scope Captures
+        lambda_either_print_val(line_printer& stream) :
+            stream(stream)
+        {}
+
+        // The Functor
+        template<class T>
+        void operator()(const T& value) const
+        {
+            stream << value;
+        }
+
+        // Nothing to print for the empty state
+        void operator()(const either_blank&) const
+        {
+        }
+    };
 }
 
 
@@ -137,7 +200,7 @@ basic_icheckstream<CharT, Traits>& operator>>(basic_icheckstream<CharT, Traits>&
     {
         // Find index to associate the input to the either object
         int result = -1;
-        detail::lambda_either_find_index<std::decay<decltype(either)>::type> fun(is, either, result);
+        detail::lambda_either_find_index<typename std::decay<decltype(either)>::type> fun(is, either, result);
         foreach_type_variadic<Args...>()(fun);
 
         // If no index could be associated with the input, it indicates failure
@@ -147,13 +210,42 @@ basic_icheckstream<CharT, Traits>& operator>>(basic_icheckstream<CharT, Traits>&
 }
 
 
+template<class ...Args> inline
+line_scanner& operator>>(line_scanner& is, either<Args...>& either)
+{
+    if(is.sentry())
+    {
+        // Scan the first type which matches the input
+        bool result = false;
+        detail::lambda_either_scan_val<typename std::decay<decltype(either)>::type> fun(is, either, result);
+        foreach_type_variadic<Args...>()(fun);
+
+        // If no type could be associated with the input, it indicates failure
+        if(!result) is.failed();
+    }
+    return is;
+}
+
+
+/*
+ *  Fast Output
+ */
+template<class ...Args> inline
+line_printer& operator<<(line_printer& os, const either<Args...>& either)
+{
+    detail::lambda_either_print_val fun(os);
+    apply_visitor(fun, either);
+    return os;
+}
+
+
 /*
  *  Input
  */
 template<class CharT, class Traits, class ...Args> inline
 basic_imemstream<CharT, Traits>& operator>>(basic_imemstream<CharT, Traits>& is, either<Args...>& either)
 {
-    basic_imemstream<CharT, Traits>::sentry xsentry(is);
+    typename basic_imemstream<CharT, Traits>::sentry xsentry(is);
     if(xsentry)
     {
         int type_index = -1;
@@ -162,14 +254,14 @@ basic_imemstream<CharT, Traits>& operator>>(basic_imemstream<CharT, Traits>& is,
         auto tell = std::streamoff(is.rdbuf()->pubseekoff(0, std::ios::cur, std::ios::in));
         basic_icheckstream<CharT, Traits>  icheck((char*)(is.rdbuf()->buffer()) + tell, size_t(is.rdbuf()->size() - tell));
         // Find the index of the type we need to read (this index isn't the which()!)
-        detail::lambda_either_find_index<std::decay<decltype(either)>::type> index_fun(icheck, either, type_index);
+        detail::lambda_either_find_index<typename std::decay<decltype(either)>::type> index_fun(icheck, either, type_index);
         foreach_type_variadic<Args...>()(index_fun);
 
         if(type_index != -1)
         {
             // Read from the stream the specified type into the either object
             bool reading_result = false;
-            detail::lambda_either_read_val<std::decay<decltype(either)>::type> xreader_fun(is, either, type_index, reading_result);
+            detail::lambda_either_read_val<typename std::decay<decltype(either)>::type> xreader_fun(is, either, type_index, reading_result);
             foreach_type_variadic<Args...>()(xreader_fun);
             if(!reading_result) is.setstate(std::ios::failbit); // :(
         }
@@ -200,6 +292,6 @@ std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>&
 
 
 /*
- *  Output is implemented by the either class itself
+ *  Output is implemented by the either class itself (except for the Fast Output above)
  */
 
@@ -5,6 +5,8 @@
  */
 #pragma once
 #include <datalib/detail/stream/fwd.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 #include <type_traits>
 #include <stdexcept>
 
@@ -35,6 +37,35 @@ typename std::enable_if<std::is_enum<T>::value, basic_icheckstream<CharT, Traits
     return is;
 }
 
+/*
+ *  Fast Input
+ */
+template<class T> inline
+typename std::enable_if<std::is_enum<T>::value, line_scanner&>::type
+/* line_scanner& */ operator>>(datalib::line_scanner& is, T& value)
+{
+    using namespace datalib;
+    line_scanner::reposer xrepos(is);
+    try {
+        std::string str;
+        if(is >> str) from_string(str, value);
+    } catch(const std::invalid_argument&) {
+        is.failed();
+    }
+    return xrepos(!!is);
+}
+
+/*
+ *  Fast Output
+ */
+template<class T> inline
+typename std::enable_if<std::is_enum<T>::value, line_printer&>::type
+/* line_printer& */ operator<<(datalib::line_printer& os, const T& value)
+{
+    using namespace datalib;
+    return (os << datalib::to_string(value));
+}
+
 }
 
 namespace std
@@ -6,6 +6,8 @@
 #pragma once
 #include <datalib/data_info/hex.hpp>
 #include <datalib/detail/stream/fwd.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 #include <iomanip>
 
 namespace datalib
@@ -23,6 +25,30 @@ basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstream<CharT,
     return is;
 }
 
+/*
+ *  Fast Input
+ */
+template<class T> inline
+line_scanner& operator>>(datalib::line_scanner& is, hex<T>& h)
+{
+    auto b = is.base(16);
+    is >> h.get_();
+    is.base(b);
+    return is;
+}
+
+/*
+ *  Fast Output
+ */
+template<class T> inline
+line_printer& operator<<(datalib::line_printer& os, const hex<T>& h)
+{
+    auto b = os.base(16);
+    os << h.get_();
+    os.base(b);
+    return os;
+}
+
 /*
  *  Input
  */
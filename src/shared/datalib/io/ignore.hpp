@@ -6,6 +6,8 @@
 #pragma once
 #include <datalib/data_info/ignore.hpp>
 #include <datalib/detail/stream/fwd.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 #include <utility>
 
 namespace datalib {
@@ -16,22 +18,45 @@ namespace datalib {
 template<class CharT, class Traits, typename T, class IgTraits> inline
 basic_icheckstream<CharT, Traits>& operator>>(basic_icheckstream<CharT, Traits>& is, const ignore<T, IgTraits>& ig)
 {
-    basic_icheckstream<CharT, Traits>::sentry  xsentry(is);
+    typename basic_icheckstream<CharT, Traits>::sentry  xsentry(is);
     if(xsentry)
     {
-        auto& dummy = *((const T*)(nullptr));
-        is >> dummy;
+        is >> check_dummy<T>();
     }
     return is;
 }
 
+/*
+ *  Fast Input
+ */
+template<typename T, class IgTraits> inline
+line_scanner& operator>>(line_scanner& is, ignore<T, IgTraits>& ig)
+{
+    if(is.sentry())
+    {
+        T obj;
+        is >> obj;
+    }
+    return is;
+}
+
+/*
+ *  Fast Output
+ */
+template<typename T, class IgTraits> inline
+line_printer& operator<<(line_printer& os, const ignore<T, IgTraits>& ig)
+{
+    auto obj = IgTraits::output();
+    return (os << obj);
+}
+
 /*
  *  Input
  */
 template<class CharT, class Traits, class T, class IgTraits> inline
 std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>& is, ignore<T, IgTraits>& ig)
 {
-    std::basic_istream<CharT, Traits>::sentry xsentry(is);
+    typename std::basic_istream<CharT, Traits>::sentry xsentry(is);
     if(xsentry)
     {
         T obj;
@@ -46,7 +71,7 @@ std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>&
 template<class CharT, class Traits, class T, class IgTraits> inline
 std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const ignore<T, IgTraits>& ig)
 {
-    std::basic_ostream<CharT, Traits>::sentry xsentry(os);
+    typename std::basic_ostream<CharT, Traits>::sentry xsentry(os);
     if(xsentry)
     {
         auto obj = IgTraits::output();
@@ -7,6 +7,8 @@
 #define BOOST_OPTIONAL_NO_IOFWD
 #include <datalib/data_info/optional.hpp>
 #include <datalib/detail/stream/fwd.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 
 namespace datalib {
 
@@ -16,12 +18,12 @@ namespace datalib {
 template<class CharT, class Traits, class T> inline
 datalib::basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstream<CharT, Traits>& is, const optional<T>& opt)
 {
-    datalib::basic_icheckstream<CharT, Traits>::reposer xrepos(is);
-    datalib::basic_icheckstream<CharT, Traits>::sentry xsentry(is);
+    typename datalib::basic_icheckstream<CharT, Traits>::reposer xrepos(is);
+    typename datalib::basic_icheckstream<CharT, Traits>::sentry xsentry(is);
     if(xsentry)
     {
         // skip optional stuff if necessary
-        auto& dummy_ref = *((const T*)(nullptr));
+        auto& dummy_ref = check_dummy<T>();
         if(is >> dummy_ref)
         {
             xrepos.norepos();               // avoid repos on xrepos destruction, we are fine
@@ -33,6 +35,41 @@ datalib::basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstre
     return is;
 }
 
+/*
+ *  Fast Input
+ */
+template<class T> inline
+datalib::line_scanner& operator>>(datalib::line_scanner& is, optional<T>& opt)
+{
+    datalib::line_scanner::reposer xrepos(is);
+    if(is.sentry())
+    {
+        T obj;
+        if(is >> obj)
+        {
+            opt.emplace(std::move(obj));
+            return xrepos(true);
+        }
+    }
+    opt = none;
+    is.clear(); // clear failure flags, optional object
+    // expects reposition on xrepos destruction
+    return is;
+}
+
+/*
+ *  Fast Output
+ */
+template<class T> inline
+datalib::line_printer& operator<<(datalib::line_printer& os, const optional<T>& opt)
+{
+    if(opt)
+    {
+        ((os << opt.get()) && print_separator<T>(os));
+    }
+    return os;
+}
+
 /*
  *  Input
  */
@@ -40,7 +77,7 @@ template<class CharT, class Traits, class T> inline
 std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>& is, optional<T>& opt)
 {
     auto tell = is.tellg(); // before xsentry constructor runs!
-    std::basic_istream<CharT, Traits>::sentry xsentry(is);
+    typename std::basic_istream<CharT, Traits>::sentry xsentry(is);
     if(xsentry)
     {
         T obj;
@@ -63,7 +100,7 @@ std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>&
 template<class CharT, class Traits, class T> inline
 std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const optional<T>& opt)
 {
-    std::basic_ostream<CharT, Traits>::sentry xsentry(os);
+    typename std::basic_ostream<CharT, Traits>::sentry xsentry(os);
     if(xsentry)
     {
         if(opt) 
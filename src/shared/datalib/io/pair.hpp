@@ -6,6 +6,8 @@
 #pragma once
 #include <datalib/data_info/pair.hpp>
 #include <datalib/detail/stream/fwd.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 
 namespace datalib {
 
@@ -15,8 +17,8 @@ namespace datalib {
 template<class CharT, class Traits, class T1, class T2> inline
 datalib::basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstream<CharT, Traits>& is, const std::pair<T1, T2>& pair)
 {
-    datalib::basic_icheckstream<CharT, Traits>::reposer xrepos(is, true);
-    datalib::basic_icheckstream<CharT, Traits>::sentry  xsentry(is);
+    typename datalib::basic_icheckstream<CharT, Traits>::reposer xrepos(is, true);
+    typename datalib::basic_icheckstream<CharT, Traits>::sentry  xsentry(is);
     if(xsentry)
     {
         ((is >> pair.first) && (is >> pair.second));
@@ -24,6 +26,30 @@ datalib::basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstre
     return is;
 }
 
+/*
+ *  Fast Input
+ */
+template<class T1, class T2> inline
+datalib::line_scanner& operator>>(datalib::line_scanner& is, std::pair<T1, T2>& pair)
+{
+    datalib::line_scanner::reposer xrepos(is);
+    if(is.sentry())
+    {
+        ((is >> pair.first) && (is >> pair.second));
+    }
+    return xrepos(!!is);
+}
+
+/*
+ *  Fast Output
+ */
+template<class T1, class T2> inline
+datalib::line_printer& operator<<(datalib::line_printer& os, const std::pair<T1, T2>& pair)
+{
+    ((os << pair.first) && (print_separator<T1>(os)) && (os << pair.second) && (print_separator<T2>(os)));
+    return os;
+}
+
 }
 
 
@@ -35,7 +61,7 @@ namespace std {
 template<class CharT, class Traits, class T1, class T2> inline
 std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>& is, std::pair<T1, T2>& pair)
 {
-    std::basic_istream<CharT, Traits>::sentry xsentry(is);
+    typename std::basic_istream<CharT, Traits>::sentry xsentry(is);
     if(xsentry)
     {
         ((is >> pair.first) && (is >> pair.second));
@@ -49,10 +75,10 @@ std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>&
 template<class CharT, class Traits, class T1, class T2> inline
 std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const std::pair<T1, T2>& pair)
 {
-    std::basic_ostream<CharT, Traits>::sentry xsentry(os);
+    typename std::basic_ostream<CharT, Traits>::sentry xsentry(os);
     if(xsentry)
     {
-        ((os << pair.first) && (print_separator<T1>(os)) && (os << pair.second) && (print_separator<T2>(os)));
+        ((os << pair.first) && (datalib::print_separator<T1>(os)) && (os << pair.second) && (datalib::print_separator<T2>(os)));
     }
     return os;
 }
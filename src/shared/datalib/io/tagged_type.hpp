@@ -6,6 +6,8 @@
 #pragma once
 #include <datalib/data_info/tagged_type.hpp>
 #include <datalib/detail/stream/fwd.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 
 namespace datalib {
 
@@ -18,6 +20,24 @@ datalib::basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstre
     return (is >> get(tt));
 }
 
+/*
+ *  Fast Input
+ */
+template<class T, class Tag> inline
+datalib::line_scanner& operator>>(datalib::line_scanner& is, tagged_type<T, Tag>& tt)
+{
+    return (is >> get(tt));
+}
+
+/*
+ *  Fast Output
+ */
+template<class T, class Tag> inline
+datalib::line_printer& operator<<(datalib::line_printer& os, const tagged_type<T, Tag>& tt)
+{
+    return (os << get(tt));
+}
+
 
 /*
  *  Input
@@ -7,6 +7,8 @@
 #include <datalib/data_info/tuple.hpp>
 #include <datalib/detail/stream/fwd.hpp>
 #include <datalib/detail/stream/kstream.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 #include <datalib/detail/mpl/seqeach.hpp>
 
 namespace datalib {
@@ -41,6 +43,28 @@ namespace detail
         }
     };
 
+    template<class Tuple>
+    struct lambda_tuple_print_val
+    {
+        Tuple&          tuple;
+        line_printer&   stream;
+
+        // Local-Scope Captures
+        lambda_tuple_print_val(line_printer& stream, Tuple& tuple) :
+            stream(stream), tuple(tuple) {}
+
+        // The functor
+        template<typename Integral, typename TypeWr>
+        bool operator()(Integral, TypeWr, typename TypeWr::type& item)
+        {
+            if(stream << item)
+            {
+                print_separator<typename TypeWr::type>(stream);
+            }
+            return !!stream;
+        }
+    };
+
     template<class Tuple>
     struct lambda_tuple_read_val
     {
@@ -79,6 +103,25 @@ namespace detail
             return !!stream;
         }
     };
+
+    template<class Tuple>
+    struct lambda_tuple_scan_val
+    {
+        Tuple&          tuple;
+        line_scanner&   stream;
+
+        // Local-Scope Captures
+        lambda_tuple_scan_val(line_scanner& stream, Tuple& tuple) :
+            stream(stream), tuple(tuple) {}
+
+        // The functor
+        template<typename Integral, typename TypeWr>
+        bool operator()(Integral, TypeWr, typename TypeWr::type& item)
+        {
+            stream >> item;
+            return !!stream;
+        }
+    };
 }
 
 
@@ -92,17 +135,44 @@ namespace datalib {
 template<class CharT, class Traits, class ...Args> inline
 datalib::basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstream<CharT, Traits>& is, const std::tuple<Args...>& tuple)
 {
-    datalib::basic_icheckstream<CharT, Traits>::reposer xrepos(is, true);
-    datalib::basic_icheckstream<CharT, Traits>::sentry  xsentry(is);
+    typename datalib::basic_icheckstream<CharT, Traits>::reposer xrepos(is, true);
+    typename datalib::basic_icheckstream<CharT, Traits>::sentry  xsentry(is);
     if(xsentry)
     {
-        datalib::detail::lambda_tuple_check_val<std::decay<decltype(tuple)>::type> fun(is, tuple, xrepos);
+        datalib::detail::lambda_tuple_check_val<typename std::decay<decltype(tuple)>::type> fun(is, tuple, xrepos);
         datalib::foreach_in_tuple(const_cast<std::tuple<Args...>&>(tuple), fun);
         xrepos(!!is);
     }
     return is;
 }
 
+/*
+ *  Fast Input
+ */
+template<class ...Args> inline
+datalib::line_scanner& operator>>(datalib::line_scanner& is, std::tuple<Args...>& tuple)
+{
+    datalib::line_scanner::reposer xrepos(is);
+    if(is.sentry())
+    {
+        datalib::detail::lambda_tuple_scan_val<std::tuple<Args...>> fun(is, tuple);
+        datalib::foreach_in_tuple(tuple, fun);
+    }
+    return xrepos(!!is);
+}
+
+/*
+ *  Fast Output
+ */
+template<class ...Args> inline
+datalib::line_printer& operator<<(datalib::line_printer& os, const std::tuple<Args...>& tuple)
+{
+    auto& ncv_tuple = const_cast<std::tuple<Args...>&>(tuple);
+    datalib::detail::lambda_tuple_print_val<std::tuple<Args...>> fun(os, ncv_tuple);
+    datalib::foreach_in_tuple(ncv_tuple, fun);
+    return os;
+}
+
 }
 
 namespace std {
@@ -113,10 +183,10 @@ namespace std {
 template<class CharT, class Traits, class ...Args> inline
 std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>& is, std::tuple<Args...>& tuple)
 {
-    std::basic_istream<CharT, Traits>::sentry xsentry(is);
+    typename std::basic_istream<CharT, Traits>::sentry xsentry(is);
     if(xsentry)
     {
-        datalib::detail::lambda_tuple_read_val<std::decay<decltype(tuple)>::type> fun(is, tuple);
+        datalib::detail::lambda_tuple_read_val<typename std::decay<decltype(tuple)>::type> fun(is, tuple);
         datalib::foreach_in_tuple(tuple, fun);
     }
     return is;
@@ -129,11 +199,11 @@ template<class CharT, class Traits, class ...Args> inline
 std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const std::tuple<Args...>& tuple)
 {
     using basic_ostream = std::basic_ostream<CharT, Traits>;
-    basic_ostream::sentry xsentry(os);
+    typename basic_ostream::sentry xsentry(os);
     if(xsentry)
     {
         auto& ncv_tuple = const_cast<std::tuple<Args...>&>(tuple);
-        datalib::detail::lambda_tuple_write_val<std::decay<decltype(tuple)>::type> fun(os, ncv_tuple);
+        datalib::detail::lambda_tuple_write_val<typename std::decay<decltype(tuple)>::type> fun(os, ncv_tuple);
         datalib::foreach_in_tuple(ncv_tuple, fun);
     }
     return os;
@@ -6,6 +6,8 @@
 #pragma once
 #include <datalib/data_info/udata.hpp>
 #include <datalib/detail/stream/fwd.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 
 namespace datalib {
 
@@ -24,6 +26,26 @@ datalib::basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstre
     return is;
 }
 
+/*
+ *  Fast Input
+ */
+template<class T> inline
+datalib::line_scanner& operator>>(datalib::line_scanner& is, udata<T>&)
+{
+    // fail to read
+    return is.failed();
+}
+
+/*
+ *  Fast Output
+ */
+template<class T> inline
+datalib::line_printer& operator<<(datalib::line_printer& os, const udata<T>&)
+{
+    // dont write
+    return os;
+}
+
 
 /*
  *  Input
@@ -17,6 +17,9 @@
 #include <modloader/util/injector.hpp>
 #include <map>
 #include <vector>
+#include <algorithm>
+#include <cstring>
+#include <string>
 
 namespace injector
 {
@@ -85,6 +88,13 @@ namespace injector
                 return str;
             }
 
+            static string_container to_wchar(const char* value, size_t length)
+            {
+                string_container str;
+                assign_wchar(str, value, length);
+                return str;
+            }
+
             /*
              *  Used on SA to get a char string
              */
@@ -94,6 +104,28 @@ namespace injector
                 return str;
             }
 
+            static string_container to_char(const char* value, size_t length)
+            {
+                string_container str;
+                assign_char(str, value, length);
+                return str;
+            }
+
+            /*
+             *  Gets the hash of the key with @length characters (not necessarily null terminated)
+             */
+            static hash_type hash(const char* key, size_t length)
+            {
+                char buf[64];
+                if(length < sizeof(buf))
+                {
+                    memcpy(buf, key, length);
+                    buf[length] = '\0';
+                    return GetHash(buf);
+                }
+                return GetHash(std::string(key, length).c_str());
+            }
+
             /*
              *  Adds a GXT @key - @value pair to the text map for use in our GxtHook 
              */
@@ -103,6 +135,65 @@ namespace injector
                 data().tmap[table][GetHash(key)] = gvm.IsIII() || gvm.IsVC()? to_wchar(value) : to_char(value);
             }
 
+            /*
+             *  Adds a @value with @length characters (not necessarily null terminated) to the key hashed as @key_hash
+             */
+            static void add(hash_type key_hash, const char* value, size_t length, hash_type table = 0)
+            {
+                if(data().can_patch) patch();
+                auto& str = data().tmap[table][key_hash];
+                if(gvm.IsIII() || gvm.IsVC()) assign_wchar(str, value, length); else assign_char(str, value, length);
+            }
+
+            /*
+             *  Makes the table @table contain exactly the key-value pairs in the @entries list (see fxt_entry)
+             *  Keys whose values didn't change aren't touched, and keys not in @entries are removed.
+             *  Returns the number of keys added, changed or removed.
+             */
+            template<class EntryList>
+            static size_t reload_table(const EntryList& entries, hash_type table = 0)
+            {
+                if(data().can_patch) patch();
+
+                auto& tmap   = data().tmap[table];
+                bool is_wide = gvm.IsIII() || gvm.IsVC();
+                size_t changes = 0;
+
+                std::vector<hash_type> seen;
+                seen.reserve(entries.size());
+
+                for(auto& entry : entries)
+                {
+                    seen.emplace_back(entry.hash);
+                    auto it = tmap.find(entry.hash);
+                    if(it == tmap.end())
+                    {
+                        it = tmap.emplace(entry.hash, string_container()).first;
+                    }
+                    else if(is_wide? equals_wchar(it->second, entry.value, entry.length) : equals_char(it->second, entry.value, entry.length))
+                    {
+                        continue;
+                    }
+
+                    if(is_wide) assign_wchar(it->second, entry.value, entry.length); else assign_char(it->second, entry.value, entry.length);
+                    ++changes;
+                }
+
+                std::sort(seen.begin(), seen.end());
+                for(auto it = tmap.begin(); it != tmap.end(); )
+                {
+                    if(!std::binary_search(seen.begin(), seen.end(), it->first))
+                    {
+                        it = tmap.erase(it);
+                        ++changes;
+                    }
+                    else
+                        ++it;
+                }
+
+                return changes;
+            }
+
             /*
              *  Overrides the specified GXT @key
              */
@@ -222,6 +313,41 @@ namespace injector
             }
 
 
+            // Assigns a wchar string (III/VC) or char string (SA) from @value with @length characters into @str
+            static void assign_wchar(string_container& str, const char* value, size_t length)
+            {
+                str.clear(); str.reserve((length + 1) * 2);
+                for(size_t i = 0; i < length; ++i)
+                {
+                    str.emplace_back(value[i]); str.emplace_back('\0');   // character
+                }
+                str.emplace_back('\0'); str.emplace_back('\0'); // null terminator
+            }
+
+            static void assign_char(string_container& str, const char* value, size_t length)
+            {
+                str.assign(value, value + length);
+                str.emplace_back('\0');
+            }
+
+            // Compares a string built by assign_wchar or assign_char with @value with @length characters
+            static bool equals_wchar(const string_container& str, const char* value, size_t length)
+            {
+                if(str.size() != (length + 1) * 2)
+                    return false;
+                for(size_t i = 0; i < length; ++i)
+                {
+                    if(str[i * 2] != value[i] || str[i * 2 + 1] != '\0')
+                        return false;
+                }
+                return true;
+            }
+
+            static bool equals_char(const string_container& str, const char* value, size_t length)
+            {
+                return str.size() == length + 1 && std::equal(value, value + length, str.begin());
+            }
+
             // Get hash from key
             static hash_type GetHash(const char* key)
             {
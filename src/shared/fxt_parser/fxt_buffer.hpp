@@ -0,0 +1,110 @@
+/*
+ *  Injectors - Fake GTA Text Implementation
+ *	Parsing of FXT buffers, doesn't depend on the game nor on Windows
+ *
+ *  (C) 2014 LINK/2012 <dma_2012@hotmail.com>
+ * 
+ *  This source code is offered for use in the public domain. You may
+ *  use, modify or distribute it freely.
+ *
+ *  This code is distributed in the hope that it will be useful but
+ *  WITHOUT ANY WARRANTY. ALL WARRANTIES, EXPRESS OR IMPLIED ARE HEREBY
+ *  DISCLAIMED. This includes but is not limited to warranties of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ */
+#pragma once
+#include <cstdio>
+#include <vector>
+
+namespace injector
+{
+    /*
+     *  A key-value entry parsed from a FXT buffer
+     *  The value points into the parsed buffer, so it's only valid while the buffer is alive
+     */
+    template<class HashType>
+    struct fxt_entry
+    {
+        HashType    hash;       // Hash of the key, as given by the text manager upper hash functor
+        const char* value;      // Not null terminated
+        size_t      length;     // Length of value
+    };
+
+    /*
+     *  Parses the FXT content in the memory buffer @data calling @callback(key, key_length, value, value_length) for each entry
+     *  The key and value ranges point into @data and aren't null terminated. There's no line length limit.
+     */
+    template<class Callback>
+    void ParseFXTBuffer(const char* data, size_t size, Callback callback)
+    {
+        const char* end = data + size;
+        for(const char* line = data; line < end; )
+        {
+            const char *key = 0, *value = 0, *p;
+            size_t key_length = 0;
+
+            // Parses the fxt line, # is used as comments...
+            for(p = line; p != end && *p != '#' && *p != '\r' && *p != '\n'; ++p)
+            {
+                // If no key found yet and the current iterating character is a space, we've just found that the key is there
+                if(key == 0)
+                {
+                    if(*p == 0x20 || (*p >= 0x09 && *p <= 0x0D))
+                    {
+                        key = line;
+                        key_length = p - line;
+                    }
+                }
+                // But, if key has been found but no value found yet, we are actually reading the first character from the value!
+                else if(value == 0)
+                {
+                    value = p;
+                }
+            }
+
+            // Adds into the text map only if found both key and value
+            if(key && value) callback(key, key_length, value, size_t(p - value));
+
+            // Go to the next line
+            while(p != end && *p != '\n') ++p;
+            line = (p == end? end : p + 1);
+        }
+    }
+
+    /*
+     *  Parses the FXT content in the memory buffer @data into a list of entries, hashing the keys with @manager
+     */
+    template<class TextManager>
+    void ParseFXTBuffer(TextManager& manager, const char* data, size_t size, std::vector<fxt_entry<typename TextManager::hash_type>>& entries)
+    {
+        ParseFXTBuffer(data, size, [&](const char* key, size_t key_length, const char* value, size_t value_length)
+        {
+            fxt_entry<typename TextManager::hash_type> entry = { manager.hash(key, key_length), value, value_length };
+            entries.emplace_back(entry);
+        });
+    }
+
+    /*
+     *  Reads the entire file @filename into @buffer
+     */
+    inline bool ReadFXTFile(const char* filename, std::vector<char>& buffer)
+    {
+        if(FILE* f = fopen(filename, "rb"))
+        {
+            bool good = false;
+            if(fseek(f, 0, SEEK_END) == 0)
+            {
+                long size = ftell(f);
+                if(size >= 0 && fseek(f, 0, SEEK_SET) == 0)
+                {
+                    buffer.resize(size_t(size));
+                    good = (fread(buffer.data(), 1, buffer.size(), f) == buffer.size());
+                }
+            }
+            fclose(f);
+            return good;
+        }
+        return false;
+    }
+}
@@ -15,7 +15,9 @@
  */
 #pragma once
 #include <cstdio>
+#include <vector>
 #include "fxt.hpp"
+#include "fxt_buffer.hpp"
 
 namespace injector
 {
@@ -26,53 +28,35 @@ namespace injector
     template<class TextManager>
     bool ParseFXT(TextManager& manager, const char* filename, typename TextManager::hash_type table = 0)
     {
-        if(FILE* f = fopen(filename, "r"))
+        std::vector<char> buffer;
+        if(ReadFXTFile(filename, buffer))
         {
-            char buf[1024];
-            
-            // Alright, that format is pretty easy
-            while(fgets(buf, sizeof(buf), f))
+            ParseFXTBuffer(buffer.data(), buffer.size(), [&](const char* key, size_t key_length, const char* value, size_t value_length)
             {
-                char *key = 0, *value = 0;
-
-                // Parses the fxt line
-                for(char* p = buf; *p; ++p)
-                {
-                    // # is used as comments...
-                    if(*p == '#' || *p == '\r' || *p == '\n')
-                    {
-                        *p = 0;
-                        break;
-                    }
-
-                    // If no key found yet...
-                    if(key == 0)
-                    {
-                        // ...and the current iterating character is a space...
-                        if(*p == 0x20 || (*p >= 0x09 && *p <= 0x0D))
-                        {
-                            // ..we've just found that the key is there
-                            *p = 0;
-                            key = buf;
-                        }
-                    }
-                    // But, if key has been found but no value found yet...
-                    else if(value == 0)
-                    {
-                        // ...we are actually reading the first character from the value!
-                        value = p;
-                    }
-                }
-
-                // Adds into the text map only if found both key and value
-                if(key && value) manager.add(key, value, table);
-            }
+                manager.add(manager.hash(key, key_length), value, value_length, table);
+            });
+            return true;
+        }
+        return false;
+    }
 
-            // Done
-            fclose(f);
+    /*
+     *  Reloads a FXT file @filename into the table @table of the text manager @manager
+     *  Unlike removing the table and parsing it again, only the keys that changed are touched
+     *  If unable to open the file, returns false, otherwise returns true
+     */
+    template<class TextManager>
+    bool ReloadFXT(TextManager& manager, const char* filename, typename TextManager::hash_type table = 0)
+    {
+        std::vector<char> buffer;
+        std::vector<fxt_entry<typename TextManager::hash_type>> entries;
+        if(ReadFXTFile(filename, buffer))
+        {
+            entries.reserve(buffer.size() / 16);
+            ParseFXTBuffer(manager, buffer.data(), buffer.size(), entries);
+            manager.reload_table(entries, table);
             return true;
         }
-        
         return false;
     }
 
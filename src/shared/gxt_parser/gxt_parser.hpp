@@ -0,0 +1,276 @@
+/*
+ *  GTA Text (GXT) Table Index
+ *
+ *  (C) 2014 LINK/2012 <dma_2012@hotmail.com>
+ *
+ *  This source code is offered for use in the public domain. You may
+ *  use, modify or distribute it freely.
+ *
+ *  This code is distributed in the hope that it will be useful but
+ *  WITHOUT ANY WARRANTY. ALL WARRANTIES, EXPRESS OR IMPLIED ARE HEREBY
+ *  DISCLAIMED. This includes but is not limited to warranties of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ */
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <modloader/util/hash.hpp>
+
+namespace injector
+{
+    /*
+     *  GXT layouts:
+     *
+     *      III:    [TKEY][TDAT]                                            -> a single MAIN table
+     *      VC:     [TABL] then for each table [name(8)]?[TKEY][TDAT]       -> the MAIN table has no name before TKEY
+     *      SA:     [version(2)][bits_per_char(2)][TABL] then as in VC      -> TKEY entries are hashed keys instead of names
+     *
+     *      TABL entries are { char name[8]; uint32_t offset; }
+     *      Each block (TABL, TKEY, TDAT) begins with { char magic[4]; uint32_t size; }
+     */
+    enum class gxt_format
+    {
+        unknown,
+        iii,
+        vc,
+        sa,
+    };
+
+    /*
+     *  Information about a single table in a GXT file
+     */
+    struct gxt_table_info
+    {
+        std::string name;       // Table name (e.g. "MAIN", "INTRO")
+        uint32_t    offset;     // Offset of the table in the file, as in the TABL block
+        uint32_t    size;       // Size of the table, including its name, TKEY and TDAT blocks
+        uint32_t    digest;     // Digest of the table content
+
+        bool is_main() const
+        {
+            return name == "MAIN";
+        }
+    };
+
+    /*
+     *  Index of the tables in a GXT file
+     */
+    struct gxt_index
+    {
+        gxt_format                  format = gxt_format::unknown;
+        std::vector<gxt_table_info> tables;
+
+        bool empty() const
+        {
+            return tables.empty();
+        }
+
+        const gxt_table_info* find(const std::string& name) const
+        {
+            for(auto& t : tables)
+                if(t.name == name) return &t;
+            return nullptr;
+        }
+    };
+
+    /*
+     *  Changes between two gxt_index objects
+     */
+    struct gxt_diff
+    {
+        bool                     full = false;      // Everything must be reloaded (no previous index, format changed, MAIN changed, or
+                                                    // the table offsets changed, since the game keeps the TABL block in memory)
+        std::vector<std::string> changed;           // Tables present in both indices but with different content
+        std::vector<std::string> added;             // Tables only in the new index
+        std::vector<std::string> removed;           // Tables only in the old index
+
+        bool empty() const
+        {
+            return !full && changed.empty() && added.empty() && removed.empty();
+        }
+    };
+
+
+    namespace detail
+    {
+        inline uint32_t gxt_read32(const char* p)
+        {
+            uint32_t value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint16_t gxt_read16(const char* p)
+        {
+            uint16_t value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        // Reads the block header { magic, size } at @offset and outputs the block size
+        inline bool gxt_block(const char* data, size_t size, size_t offset, const char* magic, uint32_t& block_size)
+        {
+            if(offset > size || size - offset < 8 || memcmp(data + offset, magic, 4))
+                return false;
+            block_size = gxt_read32(data + offset + 4);
+            return (size - offset - 8) >= block_size;
+        }
+
+        // Finds the size of the table (TKEY+TDAT blocks) at @offset, which may be preceded by the table name
+        inline bool gxt_table_size(const char* data, size_t size, size_t offset, bool has_name, uint32_t& table_size)
+        {
+            uint32_t tkey_size, tdat_size;
+            size_t tkey = offset + (has_name? 8 : 0);
+            if(gxt_block(data, size, tkey, "TKEY", tkey_size))
+            {
+                size_t tdat = tkey + 8 + tkey_size;
+                if(gxt_block(data, size, tdat, "TDAT", tdat_size))
+                {
+                    table_size = uint32_t(tdat + 8 + tdat_size - offset);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        inline uint32_t gxt_digest(const char* data, size_t size)
+        {
+            modloader::fnv1a<32> hasher;
+            return hasher.final(hasher.transform(hasher.init(), data, size));
+        }
+    }
+
+    /*
+     *  Finds out the format of the GXT in the memory buffer @data
+     */
+    inline gxt_format GetGXTFormat(const char* data, size_t size)
+    {
+        if(size >= 8 && !memcmp(data + 4, "TABL", 4))
+        {
+            auto bits = detail::gxt_read16(data + 2);
+            if(detail::gxt_read16(data) == 4 && (bits == 8 || bits == 16))
+                return gxt_format::sa;
+        }
+        if(size >= 4 && !memcmp(data, "TABL", 4))
+            return gxt_format::vc;
+        if(size >= 4 && !memcmp(data, "TKEY", 4))
+            return gxt_format::iii;
+        return gxt_format::unknown;
+    }
+
+    /*
+     *  Builds the table index of the GXT in the memory buffer @data
+     *  Returns false if the buffer isn't a valid GXT
+     */
+    inline bool ParseGXTIndex(const char* data, size_t size, gxt_index& index)
+    {
+        index.tables.clear();
+        index.format = GetGXTFormat(data, size);
+
+        if(index.format == gxt_format::iii)
+        {
+            uint32_t table_size;
+            if(!detail::gxt_table_size(data, size, 0, false, table_size))
+                return false;
+            index.tables.push_back(gxt_table_info { "MAIN", 0, table_size, detail::gxt_digest(data, table_size) });
+            return true;
+        }
+        else if(index.format == gxt_format::vc || index.format == gxt_format::sa)
+        {
+            uint32_t tabl_size;
+            size_t tabl = (index.format == gxt_format::sa? 4 : 0);
+            if(!detail::gxt_block(data, size, tabl, "TABL", tabl_size) || tabl_size % 12)
+                return false;
+
+            for(const char* p = data + tabl + 8, *end = p + tabl_size; p != end; p += 12)
+            {
+                gxt_table_info table;
+                table.name.assign(p, strnlen(p, 8));
+                table.offset = detail::gxt_read32(p + 8);
+
+                // The MAIN table has no name before its TKEY block
+                if(!detail::gxt_table_size(data, size, table.offset, !table.is_main(), table.size))
+                {
+                    index.tables.clear();
+                    return false;
+                }
+
+                table.digest = detail::gxt_digest(data + table.offset, table.size);
+                index.tables.push_back(std::move(table));
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    /*
+     *  Builds the table index of the GXT file @filename
+     */
+    inline bool ParseGXTIndex(const char* filename, gxt_index& index)
+    {
+        bool good = false;
+        if(FILE* f = fopen(filename, "rb"))
+        {
+            std::vector<char> buffer;
+            if(fseek(f, 0, SEEK_END) == 0)
+            {
+                long size = ftell(f);
+                if(size > 0 && fseek(f, 0, SEEK_SET) == 0)
+                {
+                    buffer.resize(size_t(size));
+                    if(fread(buffer.data(), 1, buffer.size(), f) == buffer.size())
+                        good = ParseGXTIndex(buffer.data(), buffer.size(), index);
+                }
+            }
+            fclose(f);
+        }
+        return good;
+    }
+
+    /*
+     *  Finds out which tables changed from the @older index to the @newer index
+     */
+    inline gxt_diff DiffGXTIndex(const gxt_index& older, const gxt_index& newer)
+    {
+        gxt_diff diff;
+
+        if(older.empty() || newer.empty() || older.format != newer.format)
+        {
+            diff.full = true;
+            return diff;
+        }
+
+        for(auto& table : newer.tables)
+        {
+            auto old_table = older.find(table.name);
+            if(old_table == nullptr)
+            {
+                diff.added.push_back(table.name);
+                diff.full = true;
+            }
+            else if(old_table->digest != table.digest || old_table->size != table.size || old_table->offset != table.offset)
+            {
+                diff.changed.push_back(table.name);
+                if(table.is_main() || old_table->offset != table.offset)
+                    diff.full = true;
+            }
+        }
+
+        for(auto& table : older.tables)
+        {
+            if(newer.find(table.name) == nullptr)
+            {
+                diff.removed.push_back(table.name);
+                diff.full = true;
+            }
+        }
+
+        return diff;
+    }
+}
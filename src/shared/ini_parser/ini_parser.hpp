@@ -30,12 +30,182 @@
 
 #include <string>       // for std::string
 #include <map>          // for std::map
+#include <list>         // for std::list
+#include <unordered_map>// for std::unordered_map
 #include <cstdio>       // for std::FILE
+#include <cctype>       // for std::isspace
 #include <algorithm>    // for std::find_if
 #include <functional>   // for std::function
+#include <stdexcept>    // for std::out_of_range
 
 namespace linb
 {
+    /*
+     *  Insertion-ordered hashed container, may be used as the KeyContainer or SectionContainer of basic_ini.
+     *  Iterates in the same order the elements were inserted, so reading and writing back an ini keeps its layout.
+     *  Elements are stored in a list (stable references) and indexed by a hash table pointing into the list.
+     */
+    template<class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+    class ordered_hash_map
+    {
+        public:
+            typedef Key                                     key_type;
+            typedef T                                       mapped_type;
+            typedef std::pair<const Key, T>                 value_type;
+            typedef std::list<value_type>                   list_type;
+
+            typedef typename list_type::size_type               size_type;
+            typedef typename list_type::difference_type         difference_type;
+            typedef typename list_type::iterator                iterator;
+            typedef typename list_type::const_iterator          const_iterator;
+            typedef typename list_type::reverse_iterator        reverse_iterator;
+            typedef typename list_type::const_reverse_iterator  const_reverse_iterator;
+            typedef typename list_type::reference               reference;
+            typedef typename list_type::const_reference         const_reference;
+            typedef typename list_type::pointer                 pointer;
+            typedef typename list_type::const_pointer           const_pointer;
+
+        private:
+            // The index refers to the keys stored in the list, so keys aren't stored twice
+            typedef std::reference_wrapper<const Key> key_ref;
+            struct ref_hash  { size_t operator()(const key_ref& k) const { return Hash()(k.get()); } };
+            struct ref_equal { bool operator()(const key_ref& a, const key_ref& b) const { return KeyEqual()(a.get(), b.get()); } };
+
+            list_type items;
+            std::unordered_map<key_ref, iterator, ref_hash, ref_equal> index;
+
+        public:
+            ordered_hash_map()
+            { }
+
+            ordered_hash_map(const ordered_hash_map& rhs) : items(rhs.items)
+            { this->reindex(); }
+
+            ordered_hash_map(ordered_hash_map&& rhs) :
+                items(std::move(rhs.items)), index(std::move(rhs.index))
+            { }
+
+            // The list elements have a const key so they can't be assigned, copy and swap instead
+            ordered_hash_map& operator=(const ordered_hash_map& rhs)
+            {
+                ordered_hash_map copy(rhs);
+                this->swap(copy);
+                return *this;
+            }
+
+            ordered_hash_map& operator=(ordered_hash_map&& rhs)
+            {
+                ordered_hash_map moved(std::move(rhs));
+                this->swap(moved);
+                return *this;
+            }
+
+            // Swapping lists keeps the iterators valid, so the indices stay valid as well
+            void swap(ordered_hash_map& rhs)
+            {
+                this->items.swap(rhs.items);
+                this->index.swap(rhs.index);
+            }
+
+            /* Iterator methods */
+            iterator begin()                        { return items.begin(); }
+            const_iterator begin() const            { return items.begin(); }
+            iterator end()                          { return items.end(); }
+            const_iterator end() const              { return items.end(); }
+            const_iterator cbegin() const           { return items.cbegin(); }
+            const_iterator cend() const             { return items.cend(); }
+            reverse_iterator rbegin()               { return items.rbegin(); }
+            const_reverse_iterator rbegin() const   { return items.rbegin(); }
+            reverse_iterator rend()                 { return items.rend(); }
+            const_reverse_iterator rend() const     { return items.rend(); }
+            const_reverse_iterator crbegin() const  { return items.crbegin(); }
+            const_reverse_iterator crend() const    { return items.crend(); }
+
+            /* Capacity information */
+            bool empty() const                      { return items.empty(); }
+            size_type size() const                  { return items.size(); }
+            size_type max_size() const              { return items.max_size(); }
+
+            /* Modifiers */
+            void clear()
+            {
+                index.clear();
+                items.clear();
+            }
+
+            template<class K, class... Args>
+            std::pair<iterator, bool> emplace(K&& key, Args&&... args)
+            {
+                auto it = this->find(key);
+                if(it != this->end())
+                    return std::make_pair(it, false);
+                items.emplace_back(std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+                it = std::prev(items.end());
+                index.emplace(std::cref(it->first), it);
+                return std::make_pair(it, true);
+            }
+
+            iterator erase(const_iterator pos)
+            {
+                index.erase(std::cref(pos->first));
+                return items.erase(pos);
+            }
+
+            size_type erase(const key_type& key)
+            {
+                auto it = this->find(key);
+                if(it == this->end()) return 0;
+                this->erase(it);
+                return 1;
+            }
+
+            /* Lookup */
+            iterator find(const key_type& key)
+            {
+                auto it = index.find(std::cref(key));
+                return it == index.end()? items.end() : it->second;
+            }
+
+            const_iterator find(const key_type& key) const
+            {
+                auto it = index.find(std::cref(key));
+                return it == index.end()? items.end() : const_iterator(it->second);
+            }
+
+            size_type count(const key_type& key) const
+            { return index.count(std::cref(key)); }
+
+            /* Acessing index methods */
+            mapped_type& operator[](const key_type& key)
+            { return this->emplace(key).first->second; }
+            mapped_type& operator[](key_type&& key)
+            { return this->emplace(std::move(key)).first->second; }
+
+            mapped_type& at(const key_type& key)
+            {
+                auto it = this->find(key);
+                if(it == this->end()) throw std::out_of_range("ordered_hash_map::at");
+                return it->second;
+            }
+
+            const mapped_type& at(const key_type& key) const
+            {
+                auto it = this->find(key);
+                if(it == this->end()) throw std::out_of_range("ordered_hash_map::at");
+                return it->second;
+            }
+
+        private:
+            void reindex()
+            {
+                index.clear();
+                index.reserve(items.size());
+                for(auto it = items.begin(); it != items.end(); ++it)
+                    index.emplace(std::cref(it->first), it);
+            }
+    };
+
     template<
         class CharT             = char,     /* Not compatible with other type here, since we're using C streams */
         class StringType        = std::basic_string<CharT>,
@@ -162,92 +332,117 @@ namespace linb
 #if 1
             bool read_file(const char_type* filename)
             {
-                /* Using C stream in a STL-like container, funny?
+                /* Reads the entire file into a single buffer and parses it in place
                  */
-                if(FILE* f = fopen(filename, "r"))
+                if(FILE* f = fopen(filename, "rb"))
                 {
-                    key_container* keys = nullptr;
-                    char_type buf[2048];
-                    string_type line;
-                    string_type key;
-                    string_type value;
-                    string_type null_string;
-                    size_type pos;
-                    
-                    // Trims an string
-                    auto trim = [](string_type& s, bool trimLeft, bool trimRight) -> string_type&
+                    std::basic_string<char_type> buffer;
+                    char_type chunk[4096];
+                    size_t count;
+
+                    if(fseek(f, 0, SEEK_END) == 0)
                     {
-                        if(s.size())
-                        {
-                            // Ignore UTF-8 BOM
-                            while(s.size() >= 3 && s[0] == (char)(0xEF) && s[1] == (char)(0xBB) && s[2] == (char)(0xBF))
-                                s.erase(s.begin(), s.begin() + 3);
-
-                            if(trimLeft)
-                                s.erase(s.begin(), std::find_if(s.begin(), s.end(), std::not1(std::function<int(int)>(::isspace))));
-                            if(trimRight)
-                                s.erase(std::find_if(s.rbegin(), s.rend(), std::not1(std::function<int(int)>(::isspace))).base(), s.end());
-                        }
-                        return s;
-                    };
-                    
-                    // Start parsing
-                    while(fgets(buf, sizeof(buf), f))
+                        long fsize = ftell(f);
+                        if(fsize > 0) buffer.reserve(size_t(fsize));
+                        fseek(f, 0, SEEK_SET);
+                    }
+
+                    while((count = fread(chunk, sizeof(char_type), sizeof(chunk) / sizeof(char_type), f)) != 0)
+                        buffer.append(chunk, count);
+
+                    fclose(f);
+                    this->read_buffer(buffer.data(), buffer.size());
+                    return true;
+                }
+                return false;
+            }
+
+            /*
+             *  Parses the ini content in the specified memory buffer into this container
+             *  No temporary string is built per line, only the key and value strings themselves
+             */
+            void read_buffer(const char_type* buffer, size_t size)
+            {
+                key_container* keys = nullptr;
+                const char_type* end = buffer + size;
+                string_type key;
+                string_type value;
+                string_type null_string;
+
+                auto is_space = [](char_type c) { return std::isspace((unsigned char)(c)) != 0; };
+
+                // Trims the range [b, e)
+                auto trim_left  = [&](const char_type* b, const char_type* e) { while(b != e && is_space(*b)) ++b; return b; };
+                auto trim_right = [&](const char_type* b, const char_type* e) { while(e != b && is_space(*(e-1))) --e; return e; };
+
+                for(const char_type* line = buffer; line < end; )
+                {
+                    const char_type* eol = std::find(line, end, char_type('\n'));
+                    const char_type* b   = line;
+                    const char_type* e   = std::find(line, eol, char_type(';'));   // Remove anything after a comment
+                    line = (eol == end? end : eol + 1);
+
+                    // Ignore UTF-8 BOM
+                    while(e - b >= 3 && b[0] == (char)(0xEF) && b[1] == (char)(0xBB) && b[2] == (char)(0xBF))
+                        b += 3;
+
+                    // Trim the line, and if it gets empty, skip this line
+                    b = trim_left(b, e);
+                    e = trim_right(b, e);
+                    if(b == e)
+                        continue;
+
+                    // Find section name
+                    if(*b == '[' && *(e-1) == ']')
                     {
-                        // What a thing, reading into a char buffer and then putting in the string...
-                        line = buf;
-                        
-                        // Find comment and remove anything after it from the line
-                        if((pos = line.find_first_of(';')) != line.npos)
-                            line.erase(pos);
-                        
-                        // Trim the string, and if it gets empty, skip this line
-                        if(trim(line, true, true).empty())
-                            continue;
-                        
-                        // Find section name
-                        if(line.front() == '[' && line.back() == ']')
+                        const char_type* kb = trim_left(b + 1, e - 1);
+                        key.assign(kb, trim_right(kb, e - 1));
+                        keys = &this->data[std::move(key)];  // Create section
+                    }
+                    else
+                    {
+                        // Find key and value positions
+                        const char_type* eq = std::find(b, e, char_type('='));
+                        if(eq == e)
                         {
-                            pos = line.length() - 1; //line.find_first_of(']');
-                            if(pos != line.npos)
-                            {
-                                trim(key.assign(line, 1, pos-1), true, true);
-                                keys = &data[std::move(key)];  // Create section
-                            }
-                            else
-                                keys = nullptr;
+                            // There's only the key
+                            key.assign(b, e);   // No need for trim, line is already trimmed
+                            value.clear();
                         }
                         else
                         {
-                            // Find key and value positions
-                            pos = line.find_first_of('=');
-                            if(pos == line.npos)
-                            {
-                                // There's only the key
-                                key = line;         // No need for trim, line is already trimmed
-                                value.clear();
-                            }
-                            else
-                            {
-                                // There's the key and the value
-                                trim(key.assign(line, 0, pos), false, true);                  // trim the right
-                                trim(value.assign(line, pos + 1, line.npos), true, false);    // trim the left
-                            }
-
-                            // Put the key/value into the current keys object, or into the section "" if no section has been found
-                            #if __cplusplus >= 201103L || _MSC_VER >= 1800
-                            (keys ? *keys : data[null_string]).emplace(std::move(key), std::move(value));
-                            #else
-                            (keys ? *keys : data[null_string])[key] = value;
-                            key.clear(); value.clear();
-                            #endif
+                            // There's the key and the value
+                            key.assign(b, trim_right(b, eq));
+                            value.assign(trim_left(eq + 1, e), e);
                         }
+
+                        // Put the key/value into the current keys object, or into the section "" if no section has been found
+                        (keys ? *keys : this->data[null_string]).emplace(std::move(key), std::move(value));
+                        key.clear(); value.clear();
+                    }
+                }
+            }
+
+            /*
+             *  Dumps the content of this container into a string in the ini format
+             */
+            void write_buffer(string_type& out) const
+            {
+                bool first = true;
+                for(auto& sec : this->data)
+                {
+                    if(!first) out.push_back('\n');
+                    out.push_back('[');
+                    out.append(sec.first).append("]\n");
+                    first = false;
+                    for(auto& kv : sec.second)
+                    {
+                        out.append(kv.first);
+                        if(!kv.second.empty())
+                            out.append(" = ").append(kv.second);
+                        out.push_back('\n');
                     }
-                    
-                    fclose(f);
-                    return true;
                 }
-                return false;
             }
 
             /*
@@ -255,23 +450,13 @@ namespace linb
              */
             bool write_file(const char_type* filename)
             {
+                string_type out;
+                this->write_buffer(out);
                 if(FILE* f = fopen(filename, "w"))
                 {
-                    bool first = true;
-                    for(auto& sec : this->data)
-                    {
-                        fprintf(f, first? "[%s]\n" : "\n[%s]\n", sec.first.c_str());
-                        first = false;
-                        for(auto& kv : sec.second)
-                        {
-                            if(kv.second.empty())
-                                fprintf(f, "%s\n", kv.first.c_str());
-                            else
-                                fprintf(f, "%s = %s\n", kv.first.c_str(), kv.second.c_str());
-                        }
-                    }
+                    bool good = fwrite(out.data(), sizeof(char_type), out.size(), f) == out.size();
                     fclose(f);
-                    return true;
+                    return good;
                 }
                 return false;
             }
@@ -308,6 +493,14 @@ namespace linb
      *      * Sections must have unique keys
      */
     typedef basic_ini<>     ini;
+
+    /* Insertion ordered and hashed basic_ini
+     *
+     *  Same limitations as above, but iterates (and writes) sections and keys in the order they were read/inserted
+     */
+    typedef basic_ini<char, std::string,
+                      ordered_hash_map<std::string, std::string>,
+                      ordered_hash_map<std::string, ordered_hash_map<std::string, std::string>>>   ordered_ini;
 }
     
 #endif
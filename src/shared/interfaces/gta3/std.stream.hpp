@@ -41,6 +41,12 @@ struct IStreamRefresher
                                                     // (then call RequestRefresh again and so on).
     virtual void RebuildTxdAssociationMap() = 0;    // On construction this interface builds this association map.
                                                     // If txd related to models change, call this method to rebuild the map.
+
+    // Batches
+    virtual void BeginBatch() = 0;                  // Starts a batch of refreshes (each one being Clear, RequestRefresh, PrepareRefresh...),
+                                                    // the game entities are indexed once for the entire batch, so no entity may be
+                                                    // created or deleted by the game until EndBatch.
+    virtual void EndBatch() = 0;                    // Ends the batch started by BeginBatch.
 };
 
 // Creates a refresher interface if possible, returns a null pointer on failure.
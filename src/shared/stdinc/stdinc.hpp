@@ -38,3 +38,4 @@
 #include <modloader/util/path.hpp>
 #include <modloader/util/hash.hpp>
 #include <modloader/util/detour.hpp>
+#include <modloader/util/redirect.hpp>
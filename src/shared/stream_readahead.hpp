@@ -0,0 +1,303 @@
+/*
+ *  This source code is offered for use in the public domain. You may
+ *  use, modify or distribute it freely.
+ *
+ *  This code is distributed in the hope that it will be useful but
+ *  WITHOUT ANY WARRANTY. ALL WARRANTIES, EXPRESS OR IMPLIED ARE HEREBY
+ *  DISCLAIMED. This includes but is not limited to warranties of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ *  stream_readahead
+ *      Read ahead of loose streamed files (std.stream), used by the streaming thread and by the stream_replay tool.
+ */
+namespace stream_readahead
+{
+    /*
+     *  predictor
+     *      Learns which resources commonly follow each resource in the request history.
+     *      A resource is a successor of each of the @window resources requested before it, so unrelated requests in between
+     *      (e.g. from another channel) don't hide it.
+     *      Keeps a few successors per resource, when full the least seen is replaced (starting from its count plus one, so
+     *      recent successors can take over old ones). Not thread-safe.
+     */
+    class predictor
+    {
+        public:
+            explicit predictor(size_t max_successors = 4, size_t window = 4) :
+                max_successors(max_successors), window(window)
+            {}
+
+            // Tells the resource @key has been requested
+            void observe(uint32_t key)
+            {
+                for(auto prev : history)
+                {
+                    if(prev != key) add(table[prev], key);
+                }
+
+                history.erase(std::remove(history.begin(), history.end(), key), history.end());
+                history.push_back(key);
+                if(history.size() > window) history.pop_front();
+            }
+
+            // Finds the resources seen after @key at least @min_count times, most seen first
+            void predict(uint32_t key, std::vector<uint32_t>& out, uint32_t min_count = 2) const
+            {
+                auto it = table.find(key);
+                if(it != table.end())
+                {
+                    auto list = it->second;
+                    std::sort(list.begin(), list.end(), [](const successor& a, const successor& b) { return a.count > b.count; });
+                    for(auto& s : list)
+                    {
+                        if(s.count >= min_count) out.push_back(s.key);
+                    }
+                }
+            }
+
+            void clear()
+            {
+                table.clear();
+                history.clear();
+            }
+
+        private:
+            struct successor
+            {
+                uint32_t key;
+                uint32_t count;
+            };
+
+            struct count_less
+            {
+                bool operator()(const successor& a, const successor& b) const { return a.count < b.count; }
+            };
+
+            size_t                                              max_successors, window;
+            std::unordered_map<uint32_t, std::vector<successor>> table;
+            std::deque<uint32_t>                                history;    // The last requests, oldest first
+
+            void add(std::vector<successor>& list, uint32_t key)
+            {
+                auto it = std::find_if(list.begin(), list.end(), [&](const successor& s) { return s.key == key; });
+                if(it != list.end())
+                    ++it->count;
+                else if(list.size() < max_successors)
+                    list.push_back(successor { key, 1 });
+                else
+                {
+                    auto min = std::min_element(list.begin(), list.end(), count_less());
+                    min->key = key;
+                    min->count = min->count + 1;
+                }
+            }
+    };
+
+    /*
+     *  cache
+     *      Bounded memory cache of whole files, filled by a background thread.
+     *      Entries are known by a key (the resource id) and validated by the path and size of the file when taken.
+     *      Thread-safe.
+     */
+    class cache
+    {
+        public:
+            struct statistics
+            {
+                uint64_t hits       = 0;    // Reads served from memory
+                uint64_t misses     = 0;    // Reads not in memory
+                uint64_t loaded     = 0;    // Files read ahead
+                uint64_t evicted    = 0;    // Files evicted before being taken
+                uint64_t dropped    = 0;    // Read aheads dropped because too many were queued
+            };
+
+            // @budget is the memory limit in bytes, @max_queue the limit of read aheads waiting for the background thread
+            explicit cache(size_t budget, size_t max_queue = 32) :
+                budget(budget), max_queue(max_queue)
+            {
+                this->worker = std::thread([this] { this->run(); });
+            }
+
+            ~cache()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    this->stop = true;
+                }
+                cv.notify_all();
+                worker.join();
+            }
+
+            // Reads ahead the file at @path with @size bytes for the resource @key, unless in memory or being read already
+            void prefetch(uint32_t key, const std::string& path, size_t size)
+            {
+                if(size == 0 || size > budget / 4)
+                    return;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = entries.find(key);
+                if(it != entries.end() && it->second.path == path && it->second.data.size() == size)
+                    return;
+                for(auto& j : jobs)
+                {
+                    if(j.key == key) return;
+                }
+                if(loading && loading_key == key)
+                    return;
+
+                if(jobs.size() >= max_queue)
+                {
+                    jobs.pop_front();   // The oldest predictions are the least useful
+                    ++stats.dropped;
+                }
+                jobs.push_back(job { key, path, size });
+                cv.notify_one();
+            }
+
+            // Copies the file at @path with @size bytes for the resource @key into @out if it's in memory
+            bool take(uint32_t key, const std::string& path, size_t size, void* out)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = entries.find(key);
+                if(it != entries.end() && it->second.path == path && it->second.data.size() == size)
+                {
+                    memcpy(out, it->second.data.data(), size);
+                    lru.splice(lru.end(), lru, it->second.lru);     // It's in the game memory now, so the first to go
+                    it->second.taken = true;
+                    ++stats.hits;
+                    return true;
+                }
+                ++stats.misses;
+                return false;
+            }
+
+            // Forgets every file in memory or waiting to be read, as the files may have changed
+            void clear()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                entries.clear();
+                lru.clear();
+                jobs.clear();
+                this->used = 0;
+                ++this->generation;
+            }
+
+            statistics get_statistics()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return stats;
+            }
+
+        private:
+            struct job
+            {
+                uint32_t    key;
+                std::string path;
+                size_t      size;
+            };
+
+            struct entry
+            {
+                std::string                     path;
+                std::vector<char>               data;
+                std::list<uint32_t>::iterator   lru;
+                bool                            taken;
+            };
+
+            size_t                              budget, used = 0, max_queue;
+            std::unordered_map<uint32_t, entry> entries;
+            std::list<uint32_t>                 lru;            // Keys, the next to be evicted at the back
+            std::deque<job>                     jobs;
+            statistics                          stats;
+            uint64_t                            generation = 0; // Changes on clear(), to discard reads that were in progress
+            bool                                loading = false;
+            uint32_t                            loading_key = 0;
+            bool                                stop = false;
+            std::mutex                          mutex;
+            std::condition_variable             cv;
+            std::thread                         worker;
+
+            void run()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while(true)
+                {
+                    cv.wait(lock, [this] { return stop || !jobs.empty(); });
+                    if(stop) break;
+
+                    job j = std::move(jobs.front());
+                    jobs.pop_front();
+                    uint64_t gen = this->generation;
+                    this->loading = true;
+                    this->loading_key = j.key;
+
+                    lock.unlock();
+                    std::vector<char> data(j.size);
+                    bool ok = read(j.path, data);
+                    lock.lock();
+
+                    this->loading = false;
+                    if(ok && gen == this->generation)
+                        insert(j.key, std::move(j.path), std::move(data));
+                }
+            }
+
+            void insert(uint32_t key, std::string path, std::vector<char> data)
+            {
+                auto it = entries.find(key);
+                if(it != entries.end())
+                {
+                    this->used -= it->second.data.size();
+                    lru.erase(it->second.lru);
+                    entries.erase(it);
+                }
+
+                while(used + data.size() > budget && !lru.empty())
+                {
+                    auto victim = entries.find(lru.back());
+                    if(!victim->second.taken) ++stats.evicted;
+                    this->used -= victim->second.data.size();
+                    entries.erase(victim);
+                    lru.pop_back();
+                }
+
+                lru.push_front(key);
+                this->used += data.size();
+                ++stats.loaded;
+
+                entry e;
+                e.path  = std::move(path);
+                e.data  = std::move(data);
+                e.lru   = lru.begin();
+                e.taken = false;
+                entries.emplace(key, std::move(e));
+            }
+
+            static bool read(const std::string& path, std::vector<char>& data)
+            {
+                bool result = false;
+                if(FILE* f = fopen(path.c_str(), "rb"))
+                {
+                    result = (fread(data.data(), 1, data.size(), f) == data.size());
+                    fclose(f);
+                }
+                return result;
+            }
+    };
+}
@@ -0,0 +1,255 @@
+/*
+ *  This source code is offered for use in the public domain. You may
+ *  use, modify or distribute it freely.
+ *
+ *  This code is distributed in the hope that it will be useful but
+ *  WITHOUT ANY WARRANTY. ALL WARRANTIES, EXPRESS OR IMPLIED ARE HEREBY
+ *  DISCLAIMED. This includes but is not limited to warranties of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+ *  stream_trace
+ *      Compact binary trace of the requests served by the streaming thread, recorded by std.stream (-streamtrace command line)
+ *      and played back by the stream_replay tool.
+ *
+ *      The trace is the magic and version followed by entries, each one a tag byte and its content (integers are little endian):
+ *          'F' file:       u16 index, u16 length, path relative to the game directory (not null terminated)
+ *          'R' request:    the fields of the record, in order
+ *      A file entry always comes before the first request reading from it.
+ */
+namespace stream_trace
+{
+    static const uint32_t version = 1;
+
+    static const char* magic()
+    {
+        return "MLSTRACE";
+    }
+
+    enum : uint8_t
+    {
+        flag_loose  = 1,    // The file is a loose file from a mod (otherwise it's a cd image)
+        flag_failed = 2,    // The read failed
+    };
+
+    struct record
+    {
+        int32_t  id;            // Resource id, -1 if unknown
+        uint8_t  type;          // Resource type (as in std.stream ResType), zero if unknown
+        uint8_t  flags;         // flag_*
+        uint8_t  channel;       // Stream channel the request was queued on
+        uint16_t file;          // Index of the file read from
+        uint64_t offset;        // Offset of the read in bytes
+        uint32_t size;          // Size of the read in bytes
+        uint64_t queued;        // When the request was queued, in microseconds since the start of the trace
+        uint32_t queue_time;    // Microseconds the request waited in the queue
+        uint32_t service_time;  // Microseconds the read took
+    };
+
+    static const size_t record_size = 4+1+1+1+2+8+4+8+4+4;
+
+    namespace detail
+    {
+        template<class T>
+        inline void put(std::string& out, T value)
+        {
+            for(size_t i = 0; i < sizeof(T); ++i)
+                out.push_back(char(uint8_t(uint64_t(value) >> (i * 8))));
+        }
+
+        template<class T>
+        inline T get(const char*& p)
+        {
+            uint64_t value = 0;
+            for(size_t i = 0; i < sizeof(T); ++i)
+                value |= uint64_t(uint8_t(*p++)) << (i * 8);
+            return T(value);
+        }
+    }
+
+    /*
+     *  writer
+     *      Writes a trace into a file, buffering the entries. Not thread-safe.
+     */
+    class writer
+    {
+        public:
+            writer() = default;
+            writer(const writer&) = delete;
+            writer& operator=(const writer&) = delete;
+            ~writer() { close(); }
+
+            // Starts a trace at @path, replacing the file if any
+            bool open(const char* path)
+            {
+                close();
+                if((this->f = fopen(path, "wb")) != nullptr)
+                {
+                    buffer.assign(magic(), 8);
+                    detail::put<uint32_t>(buffer, version);
+                    return true;
+                }
+                return false;
+            }
+
+            // Flushes the buffered entries and closes the trace
+            void close()
+            {
+                if(this->f)
+                {
+                    flush();
+                    fclose(f);
+                    this->f = nullptr;
+                }
+                this->files.clear();
+            }
+
+            bool is_open() const
+            {
+                return this->f != nullptr;
+            }
+
+            // Gets the index of the file at @path, adding it to the trace if new
+            uint16_t file(const std::string& path)
+            {
+                auto it = files.find(path);
+                if(it == files.end())
+                {
+                    uint16_t index = uint16_t(files.size());
+                    uint16_t len   = uint16_t(std::min<size_t>(path.size(), 0xFFFF));
+                    buffer.push_back('F');
+                    detail::put<uint16_t>(buffer, index);
+                    detail::put<uint16_t>(buffer, len);
+                    buffer.append(path, 0, len);
+                    it = files.emplace(path, index).first;
+                }
+                return it->second;
+            }
+
+            // Adds a request to the trace
+            void add(const record& r)
+            {
+                buffer.push_back('R');
+                detail::put(buffer, r.id);
+                detail::put(buffer, r.type);
+                detail::put(buffer, r.flags);
+                detail::put(buffer, r.channel);
+                detail::put(buffer, r.file);
+                detail::put(buffer, r.offset);
+                detail::put(buffer, r.size);
+                detail::put(buffer, r.queued);
+                detail::put(buffer, r.queue_time);
+                detail::put(buffer, r.service_time);
+                if(buffer.size() >= 0x10000)
+                    flush();
+            }
+
+            // Writes the buffered entries into the file
+            void flush()
+            {
+                if(this->f && !buffer.empty())
+                {
+                    fwrite(buffer.data(), 1, buffer.size(), f);
+                    fflush(f);
+                }
+                buffer.clear();
+            }
+
+        private:
+            FILE*                           f = nullptr;
+            std::string                     buffer;
+            std::map<std::string, uint16_t> files;
+    };
+
+    /*
+     *  trace
+     *      A trace read into memory
+     */
+    struct trace
+    {
+        std::vector<std::string>    files;      // Paths by file index
+        std::vector<bool>           loose;      // Whether each file is a loose file (as seen in the requests)
+        std::vector<record>         records;    // In the order they were served
+
+        // Reads the trace in the buffer @data, a trace cut short (e.g. the game crashed) is read up to its last whole entry
+        bool parse(const std::string& data)
+        {
+            const char* p   = data.data();
+            const char* end = data.data() + data.size();
+
+            files.clear(); loose.clear(); records.clear();
+
+            if(data.size() < 12 || memcmp(p, magic(), 8))
+                return false;
+            p += 8;
+            if(detail::get<uint32_t>(p) != version)
+                return false;
+
+            // Almost all the entries are requests, so that's about the number of records
+            records.reserve(size_t(end - p) / (1 + record_size));
+
+            while(p < end)
+            {
+                char tag = *p++;
+                if(tag == 'F')
+                {
+                    if(end - p < 4) break;
+                    uint16_t index = detail::get<uint16_t>(p);
+                    uint16_t len   = detail::get<uint16_t>(p);
+                    if(end - p < len) break;
+                    if(index >= files.size()) files.resize(index + 1), loose.resize(index + 1);
+                    files[index].assign(p, len);
+                    p += len;
+                }
+                else if(tag == 'R')
+                {
+                    if(size_t(end - p) < record_size) break;
+                    record r;
+                    r.id            = detail::get<int32_t>(p);
+                    r.type          = detail::get<uint8_t>(p);
+                    r.flags         = detail::get<uint8_t>(p);
+                    r.channel       = detail::get<uint8_t>(p);
+                    r.file          = detail::get<uint16_t>(p);
+                    r.offset        = detail::get<uint64_t>(p);
+                    r.size          = detail::get<uint32_t>(p);
+                    r.queued        = detail::get<uint64_t>(p);
+                    r.queue_time    = detail::get<uint32_t>(p);
+                    r.service_time  = detail::get<uint32_t>(p);
+                    if(r.file >= files.size())
+                        return false;
+                    if(r.flags & flag_loose) loose[r.file] = true;
+                    records.emplace_back(r);
+                }
+                else
+                    return false;
+            }
+            return true;
+        }
+
+        // Reads the trace file at @path
+        bool load(const char* path)
+        {
+            std::string data;
+            if(FILE* f = fopen(path, "rb"))
+            {
+                char buf[0x10000];
+                size_t n;
+                while((n = fread(buf, 1, sizeof(buf), f)) != 0)
+                    data.append(buf, n);
+                fclose(f);
+                return parse(data);
+            }
+            return false;
+        }
+    };
+}
@@ -6,6 +6,8 @@
 #pragma once
 #include <type_wrapper/datalib/data_info/floating_point.hpp>
 #include <datalib/detail/stream/fwd.hpp>
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/detail/stream/printer.hpp>
 #include <iomanip>
 #include <limits>
 
@@ -18,6 +20,25 @@ datalib::basic_icheckstream<CharT, Traits>& operator>>(datalib::basic_icheckstre
     return (is >> tw.get_());
 }
 
+/*
+ *  Fast Input
+ */
+template<class T, class Comp> inline
+datalib::line_scanner& operator>>(datalib::line_scanner& is, basic_floating_point<T, Comp>& tw)
+{
+    return (is >> tw.get_());
+}
+
+/*
+ *  Fast Output
+ */
+template<class T, class Comp> inline
+datalib::line_printer& operator<<(datalib::line_printer& os, const basic_floating_point<T, Comp>& tw)
+{
+    os.precision(std::numeric_limits<T>::digits10 + 2);
+    return (os << tw.get_());
+}
+
 /*
  *  Input
  */
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The behaviour arbitration against installing every file in order while displacing the installed one (as the update did)
+ *
+ */
+#include "test.hpp"
+#include "../core/behaviour_arbitration.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+
+struct fake_handler { int id; };
+
+struct fake_file
+{
+    const fake_handler* handler;
+    uint64_t            behaviour;
+    int                 priority;   // Priority of the mod of this file
+};
+
+using arbitration = behaviour_arbitration<fake_handler, fake_file>;
+using installed_map = std::map<std::pair<const fake_handler*, uint64_t>, const fake_file*>;
+
+// A folder update: the files installed before it and the files to be installed, in install order
+struct update
+{
+    std::vector<fake_handler>   handlers;
+    std::vector<fake_file>      before;     // Installed before the update
+    std::vector<fake_file>      pending;    // To be installed, mods by ascending priority
+    installed_map               installed;
+
+    update(std::mt19937& rng, size_t nfiles, int nbehaviours) : handlers(3)
+    {
+        before.reserve(nbehaviours * handlers.size());
+        for(auto& handler : handlers)
+        {
+            for(int b = 0; b < nbehaviours; ++b)
+            {
+                if(rng() % 2)
+                {
+                    before.push_back(fake_file { &handler, uint64_t(b), int(rng() % 10) });
+                    installed[std::make_pair(&handler, uint64_t(b))] = &before.back();
+                }
+            }
+        }
+
+        for(size_t i = 0; i < nfiles; ++i)
+            pending.push_back(fake_file { &handlers[rng() % handlers.size()], uint64_t(rng() % nbehaviours), int(rng() % 10) });
+        std::stable_sort(pending.begin(), pending.end(), [](const fake_file& a, const fake_file& b) { return a.priority < b.priority; });
+    }
+
+    const int* installed_priority(const fake_file& file) const
+    {
+        auto it = installed.find(std::make_pair(file.handler, file.behaviour));
+        return it != installed.end()? &it->second->priority : nullptr;
+    }
+};
+
+// Installs each pending file unless the installed one has a higher priority, returns the installed files and counts the installs
+static installed_map install_in_order(const update& u, size_t& installs)
+{
+    installed_map installed = u.installed;
+    for(auto& file : u.pending)
+    {
+        auto& current = installed[std::make_pair(file.handler, file.behaviour)];
+        if(current && file.priority < current->priority)
+            continue;
+        current = &file;
+        ++installs;
+    }
+    return installed;
+}
+
+// Installs only the winners of the arbitration, returns the installed files and counts the installs
+static installed_map install_winners(const update& u, size_t& installs)
+{
+    arbitration winners;
+    for(auto& file : u.pending)
+        winners.offer(*file.handler, file.behaviour, const_cast<fake_file&>(file), file.priority, u.installed_priority(file));
+
+    installed_map installed = u.installed;
+    for(auto& file : u.pending)
+    {
+        if(winners.is_winner(*file.handler, file.behaviour, file))
+        {
+            installed[std::make_pair(file.handler, file.behaviour)] = &file;
+            ++installs;
+        }
+    }
+    return installed;
+}
+
+TEST(behaviour_arbitration_same_as_in_order)
+{
+    std::mt19937 rng(42);
+    for(int round = 0; round < 2000; ++round)
+    {
+        update u(rng, rng() % 60, 1 + int(rng() % 12));
+        size_t in_order = 0, arbitrated = 0;
+
+        // Same files end up installed, each behaviour installed at most once
+        CHECK(install_winners(u, arbitrated) == install_in_order(u, in_order));
+        CHECK(arbitrated <= in_order);
+        CHECK(arbitrated <= u.handlers.size() * 12);
+    }
+}
+
+TEST(behaviour_arbitration_priorities)
+{
+    fake_handler handler { 0 };
+    fake_file low { &handler, 1, 1 }, high { &handler, 1, 5 }, same { &handler, 1, 3 };
+    int installed = 3;
+
+    // Lower priority than the installed file, the installed one stays
+    arbitration a;
+    a.offer(handler, 1, low, low.priority, &installed);
+    CHECK(a.winner(handler, 1) == nullptr && a.size() == 1);
+
+    // Same priority displaces, the last offered wins
+    a.offer(handler, 1, same, same.priority, &installed);
+    a.offer(handler, 1, high, high.priority, &installed);
+    CHECK(a.is_winner(handler, 1, high) && !a.is_winner(handler, 1, same));
+
+    // Nothing installed, any file wins
+    arbitration b;
+    b.offer(handler, 2, low, low.priority, nullptr);
+    CHECK(b.is_winner(handler, 2, low) && b.winner(handler, 1) == nullptr);
+    b.clear();
+    CHECK(b.empty());
+}
+
+BENCH(behaviour_arbitration_update)
+{
+    // A first run with many overlapping mods: 20k files over 2100 behaviours (3 handlers of 700), nothing installed yet
+    std::mt19937 rng(43);
+    update u(rng, 20000, 700);
+    u.installed.clear();
+
+    size_t in_order = 0, arbitrated = 0;
+    tests::benchmark("install in order", 100, [&](size_t) { tests::keep(install_in_order(u, in_order).size()); });
+    tests::benchmark("arbitrate then install", 100, [&](size_t) { tests::keep(install_winners(u, arbitrated).size()); });
+    printf("    installs per update: %zu in order, %zu arbitrated\n", in_order / 100, arbitrated / 100);
+}
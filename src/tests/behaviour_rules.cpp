@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The behaviour classifier against a linear walk on the rules of each plugin, with the rule tables of the standard plugins
+ *
+ */
+#include "test.hpp"
+#include "../core/behaviour_rules.hpp"
+#include <modloader/util/path_string.hpp>
+#include <fnmatch.h>
+#include <memory>
+#include <random>
+
+// The loader one is in wildcard.cpp, both the classifier and the linear walk use this one
+bool match_wildcard(const char* pattern, const char* string)
+{
+    return fnmatch(pattern, string, FNM_CASEFOLD) == 0;
+}
+
+static uint32_t h(const char* filename) { return uint32_t(modloader::hash(filename)); }
+
+struct fake_plugin
+{
+    std::vector<modloader_rule_t> rules;
+};
+
+// A modloader::file for the @path (relative to the game dir), normalized and laid out as the scan does
+struct fake_file
+{
+    std::string     path;
+    modloader::file file;
+
+    fake_file(std::string path_, size_t mod_len, bool is_dir = false) : path(modloader::NormalizePath(std::move(path_)))
+    {
+        size_t filename = path.find_last_of("/\\") + 1;
+        size_t filext   = path.find('.', filename);
+
+        std::memset(&file, 0, sizeof(file));
+        file.flags        = is_dir? MODLOADER_FF_IS_DIRECTORY : 0;
+        file.buffer       = path.c_str();
+        file.wpos_eos      = uint16_t(path.size());
+        file.wpos_filedir  = uint16_t(mod_len);
+        file.wpos_filename = uint16_t(filename);
+        file.wpos_filext   = uint16_t(filext == std::string::npos? path.size() : filext + 1);
+        file.hash         = h(path.c_str() + filename);
+    }
+
+    fake_file(const fake_file&) = delete;
+};
+
+/*
+ *  The rules of the standard plugins (behaviour values don't matter, they only need to be told apart)
+ */
+static std::vector<fake_plugin> standard_plugins()
+{
+    const uint32_t flags = MODLOADER_RULE_NODIR | MODLOADER_RULE_ORHASH;
+    std::vector<fake_plugin> plugins(5);
+
+    // std.tracks
+    plugins[0].rules.push_back(modloader_rule_t { 0, flags, "", "streams", nullptr, MODLOADER_BEHAVIOUR_YES, 1ull << 32 });
+    for(auto name : { "aa", "tk", "adverts", "ambience", "cutscene", "beats", "ch", "co", "cr", "ds", "hc", "mh", "mr", "nj", "re", "rg" })
+        plugins[0].rules.push_back(modloader_rule_t { h(name), flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, 1ull << 32 });
+    plugins[0].rules.push_back(modloader_rule_t { h("traklkup.dat"), flags, "dat", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, 2ull << 32 });
+    plugins[0].rules.push_back(modloader_rule_t { h("strmpaks.dat"), flags, "dat", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, 3ull << 32 });
+
+    // std.bank
+    for(auto name : { "feet", "genrl", "pain_a", "script", "spc_ea", "spc_fa", "spc_ga", "spc_na", "spc_pa" })
+        plugins[1].rules.push_back(modloader_rule_t { h(name), flags, "", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, 1ull << 32 });
+    for(auto name : { "banklkup.dat", "bankslot.dat", "eventvol.dat", "pakfiles.dat" })
+        plugins[1].rules.push_back(modloader_rule_t { h(name), flags, "dat", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, 2ull << 32 });
+
+    // std.text
+    plugins[2].rules.push_back(modloader_rule_t { 0, flags, "fxt", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, 1ull << 32 });
+    plugins[2].rules.push_back(modloader_rule_t { 0, flags, "gxt", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, 0 });
+
+    // std.scm and std.movies
+    plugins[3].rules.push_back(modloader_rule_t { h("main.scm"), flags, "scm", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, 0 });
+    plugins[4].rules.push_back(modloader_rule_t { h("logo.mpg"), MODLOADER_RULE_NODIR, "mpg", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, h("logo.mpg") });
+    plugins[4].rules.push_back(modloader_rule_t { h("gtatitles.mpg"), MODLOADER_RULE_NODIR, "mpg", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, h("gtatitles.mpg") });
+    plugins[4].rules.push_back(modloader_rule_t { h("gtatitlesger.mpg"), MODLOADER_RULE_NODIR, "mpg", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, h("gtatitles.mpg") });
+    return plugins;
+}
+
+// The name of the folder the file is right inside, as taken by the rules
+static std::string parent_folder(const modloader::file& file)
+{
+    std::string dir(file.filepath(), file.filename());
+    while(!dir.empty() && (dir.back() == '/' || dir.back() == '\\')) dir.pop_back();
+    return dir.substr(dir.find_last_of("/\\") + 1);
+}
+
+// The first rule of the @plugin matching the @file, by walking all of its rules
+static const modloader_rule_t* find_linear(const fake_plugin& plugin, const modloader::file& file)
+{
+    for(auto& rule : plugin.rules)
+    {
+        if((rule.flags & MODLOADER_RULE_NODIR) && file.is_dir()) continue;
+        if(rule.hash && rule.hash != file.hash) continue;
+        if(rule.extension && _stricmp(rule.extension, file.filext())) continue;
+        if(rule.folder && (file.filepath() == file.filename() || _stricmp(rule.folder, parent_folder(file).c_str()))) continue;
+        if(rule.glob && !match_wildcard(rule.glob, file.filedir())) continue;
+        return &rule;
+    }
+    return nullptr;
+}
+
+static behaviour_classifier<fake_plugin> compile(const std::vector<fake_plugin>& plugins)
+{
+    behaviour_classifier<fake_plugin> classifier;
+    for(auto& plugin : plugins)
+        classifier.add(plugin, plugin.rules.data(), plugin.rules.size());
+    return classifier;
+}
+
+// Random paths around the names the rules look for
+static std::string random_path(std::mt19937& rng)
+{
+    static const char* const folders[] = { "streams", "STREAMS", "sfx", "text", "data", "audio", "my mod", "streams.old" };
+    static const char* const names[] = {
+        "aa", "AA", "beats", "rg", "feet", "GENRL", "spc_pa", "traklkup.dat", "STRMPAKS.DAT", "banklkup.dat", "pakfiles.dat",
+        "american.gxt", "spanish.GXT", "mod.fxt", "main.scm", "Main.SCM", "logo.mpg", "GTAtitlesGER.mpg", "intro.mpg",
+        "readme.txt", "aa.dat", "streams", "noext", "sound_1.wav",
+    };
+    std::string path = "modloader/mod" + std::to_string(rng() % 3) + "/";
+    for(int n = int(rng() % 3); n > 0; --n)
+        path.append(folders[rng() % (sizeof(folders) / sizeof(*folders))]).append(rng() % 2? "/" : "\\");
+    return path.append(names[rng() % (sizeof(names) / sizeof(*names))]);
+}
+
+TEST(behaviour_rules_same_as_linear)
+{
+    std::mt19937 rng(39);
+    auto plugins = standard_plugins();
+
+    // Plus a plugin with every kind of condition, including more than one rule matching the same file
+    plugins.emplace_back();
+    plugins.back().rules.push_back(modloader_rule_t { 0, MODLOADER_RULE_NODIR, nullptr, nullptr, "*.txt", MODLOADER_BEHAVIOUR_CALLME, 0 });
+    plugins.back().rules.push_back(modloader_rule_t { 0, 0, nullptr, "audio", nullptr, MODLOADER_BEHAVIOUR_YES, 1 });
+    plugins.back().rules.push_back(modloader_rule_t { h("aa.dat"), 0, "dat", "data", nullptr, MODLOADER_BEHAVIOUR_YES, 2 });
+    plugins.back().rules.push_back(modloader_rule_t { 0, 0, "dat", nullptr, nullptr, MODLOADER_BEHAVIOUR_YES, 3 });
+    plugins.back().rules.push_back(modloader_rule_t { 0, 0, nullptr, nullptr, "text*", MODLOADER_BEHAVIOUR_YES, 4 });
+    plugins.back().rules.push_back(modloader_rule_t { 0, 0, nullptr, nullptr, nullptr, MODLOADER_BEHAVIOUR_NO, 5 });   // never added
+
+    auto classifier = compile(plugins);
+    std::vector<behaviour_classifier<fake_plugin>::match> matches;
+
+    for(int i = 0; i < 200000; ++i)
+    {
+        fake_file f(random_path(rng), strlen("modloader/mod0/"), rng() % 16 == 0);
+        classifier.classify(f.file, matches);
+
+        size_t expected_count = 0;
+        for(auto& plugin : plugins)
+        {
+            const modloader_rule_t* expected = find_linear(plugin, f.file);
+            if(expected && expected->result == MODLOADER_BEHAVIOUR_NO)
+                expected = nullptr;
+
+            auto match = behaviour_classifier<fake_plugin>::find(matches, plugin);
+            CHECK((match? match->rule : nullptr) == expected);
+            if(expected) ++expected_count;
+        }
+        CHECK(matches.size() == expected_count);
+    }
+}
+
+TEST(behaviour_rules_standard_plugins)
+{
+    auto plugins = standard_plugins();
+    auto classifier = compile(plugins);
+    std::vector<behaviour_classifier<fake_plugin>::match> matches;
+
+    // Behaviour given by the @plugin to the file at @path, zero if none
+    auto behaviour = [&](const char* path, size_t plugin, bool is_dir = false) -> uint64_t {
+        fake_file f(path, strlen("modloader/mod/"), is_dir);
+        classifier.classify(f.file, matches);
+        auto match = behaviour_classifier<fake_plugin>::find(matches, plugins[plugin]);
+        if(match && behaviour_classifier<fake_plugin>::apply(*match->rule, f.file) == MODLOADER_BEHAVIOUR_YES)
+            return f.file.behaviour;
+        return 0;
+    };
+
+    CHECK(behaviour("modloader/mod/Streams/MyStation", 0) == ((1ull << 32) | h("mystation")));
+    CHECK(behaviour("modloader/mod/audio/RG", 0) == ((1ull << 32) | h("rg")));
+    CHECK(behaviour("modloader/mod/audio/RG", 0, true) == 0);
+    CHECK(behaviour("modloader/mod/streams/rg.ogg", 0) == 0);
+    CHECK(behaviour("modloader/mod/TrakLkUp.dat", 0) == ((2ull << 32) | h("traklkup.dat")));
+    CHECK(behaviour("modloader/mod/sfx/GENRL", 1) == ((1ull << 32) | h("genrl")));
+    CHECK(behaviour("modloader/mod/sfx/MYPAK", 1) == 0);       // asked to the plugin GetBehaviour
+    CHECK(behaviour("modloader/mod/text/american.gxt", 2) == h("american.gxt"));
+    CHECK(behaviour("modloader/mod/text/mod.fxt", 2) == ((1ull << 32) | h("mod.fxt")));
+    CHECK(behaviour("modloader/mod/main.scm", 3) == h("main.scm"));
+    CHECK(behaviour("modloader/mod/other.scm", 3) == 0);
+    CHECK(behaviour("modloader/mod/movies/GTAtitlesGER.mpg", 4) == h("gtatitles.mpg"));
+    CHECK(behaviour("modloader/mod/movies/logo.mpg", 4) == h("logo.mpg"));
+}
+
+BENCH(behaviour_rules_lookup)
+{
+    // A scan of 100k files through the rules of the standard plugins
+    std::mt19937 rng(40);
+    auto plugins = standard_plugins();
+    auto classifier = compile(plugins);
+
+    std::vector<std::unique_ptr<fake_file>> files;
+    for(int i = 0; i < 100000; ++i)
+        files.emplace_back(new fake_file(random_path(rng), strlen("modloader/mod0/")));
+
+    size_t handled = 0;
+    tests::benchmark("walk the rules of each plugin", files.size(), [&](size_t i) {
+        for(auto& plugin : plugins)
+            handled += (find_linear(plugin, files[i]->file) != nullptr);
+    });
+
+    std::vector<behaviour_classifier<fake_plugin>::match> matches;
+    tests::benchmark("behaviour_classifier", files.size(), [&](size_t i) {
+        classifier.classify(files[i]->file, matches);
+        handled += matches.size();
+    });
+    tests::keep(handled);
+}
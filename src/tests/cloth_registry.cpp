@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The std.stream clothing registry against a list searched linearly (as the clothes map was, by hash and by file)
+ *
+ */
+#include "test.hpp"
+#include "../plugins/gta3/std.stream/cloth_registry.hpp"
+#include <algorithm>
+#include <functional>
+#include <random>
+
+struct fake_file { int id; };
+using registry = cloth_registry<fake_file>;
+
+struct linear_item { uint32_t offset, hash; const fake_file* file; };
+
+TEST(cloth_registry_same_as_linear)
+{
+    std::mt19937 rng(37);
+    std::vector<fake_file> files(64);
+    registry reg;
+    std::vector<linear_item> list;
+
+    auto find_linear = [&](std::function<bool(const linear_item&)> pred) -> const linear_item* {
+        auto it = std::find_if(list.begin(), list.end(), pred);
+        return it != list.end()? &*it : nullptr;
+    };
+    auto same = [](const registry::item* a, const linear_item* b) {
+        return (a == nullptr && b == nullptr) || (a && b && a->offset == b->offset && a->hash == b->hash && a->file == b->file);
+    };
+
+    for(int step = 0; step < 100000; ++step)
+    {
+        uint32_t offset = uint32_t(rng() % 80) * 2048;
+        uint32_t hash   = uint32_t(rng() % 80) * 7919;
+        const fake_file* file = &files[rng() % files.size()];
+
+        switch(rng() % 6)
+        {
+            case 0: case 1:
+            {
+                bool taken = find_linear([&](const linear_item& i) { return i.offset == offset || i.hash == hash || i.file == file; }) != nullptr;
+                CHECK(reg.insert(offset, hash, file) == !taken);
+                if(!taken) list.push_back(linear_item { offset, hash, file });
+                break;
+            }
+            case 2:
+            {
+                auto it = std::find_if(list.begin(), list.end(), [&](const linear_item& i) { return i.offset == offset; });
+                CHECK(reg.erase(offset) == (it != list.end()));
+                if(it != list.end()) list.erase(it);
+                break;
+            }
+            case 3:
+            {
+                auto it = std::find_if(list.begin(), list.end(), [&](const linear_item& i) { return i.file == file; });
+                CHECK(reg.erase_file(file) == (it != list.end()));
+                if(it != list.end()) list.erase(it);
+                break;
+            }
+            default:
+                CHECK(same(reg.find(offset), find_linear([&](const linear_item& i) { return i.offset == offset; })));
+                CHECK(same(reg.find_hash(hash), find_linear([&](const linear_item& i) { return i.hash == hash; })));
+                CHECK(same(reg.find_file(file), find_linear([&](const linear_item& i) { return i.file == file; })));
+                break;
+        }
+        CHECK(reg.size() == list.size());
+    }
+
+    reg.clear();
+    CHECK(reg.empty() && reg.find_file(&files[0]) == nullptr);
+}
+
+TEST(cloth_registry_directions_consistent)
+{
+    fake_file a, b;
+    registry reg;
+    CHECK(reg.insert(0x800, 111, &a));
+    CHECK(!reg.insert(0x800, 222, &b));     // offset taken
+    CHECK(!reg.insert(0x1000, 111, &b));    // hash taken
+    CHECK(!reg.insert(0x1000, 222, &a));    // file taken
+    CHECK(reg.insert(0x1000, 222, &b));
+
+    CHECK(reg.find_hash(222)->file == &b && reg.find_file(&a)->offset == 0x800);
+    CHECK(reg.erase_file(&a) && !reg.erase_file(&a));
+    CHECK(reg.find(0x800) == nullptr && reg.find_hash(111) == nullptr);
+    CHECK(reg.insert(0x800, 333, &a) && reg.find_hash(333)->file == &a);
+}
+
+BENCH(cloth_registry_lookup)
+{
+    // SA has about 400 clothing items, lookups by hash and by file were scans of the map
+    std::vector<fake_file> files(400);
+    registry reg;
+    std::vector<linear_item> list;
+    for(uint32_t i = 0; i < files.size(); ++i)
+    {
+        reg.insert(i * 2048, i * 7919, &files[i]);
+        list.push_back(linear_item { i * 2048, i * 7919, &files[i] });
+    }
+
+    size_t found = 0;
+    tests::benchmark("linear find by hash", 1000000, [&](size_t i) {
+        uint32_t hash = uint32_t(i % 400) * 7919;
+        found += std::find_if(list.begin(), list.end(), [&](const linear_item& x) { return x.hash == hash; })->offset;
+    });
+    tests::benchmark("cloth_registry find by hash", 1000000, [&](size_t i) {
+        found += reg.find_hash(uint32_t(i % 400) * 7919)->offset;
+    });
+    tests::benchmark("linear find by file", 1000000, [&](size_t i) {
+        const fake_file* file = &files[i % 400];
+        found += std::find_if(list.begin(), list.end(), [&](const linear_item& x) { return x.file == file; })->offset;
+    });
+    tests::benchmark("cloth_registry find by file", 1000000, [&](size_t i) {
+        found += reg.find_file(&files[i % 400])->offset;
+    });
+    tests::keep(found);
+}
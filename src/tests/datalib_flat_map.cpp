@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The datalib flat_sorted_map against the std::map it replaces in the data stores
+ *
+ */
+#include "test.hpp"
+#include <datalib/detail/flat_sorted_map.hpp>
+#include <datalib/data_store.hpp>
+#include <datalib/dominance.hpp>
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+#include <map>
+#include <set>
+#include <sstream>
+#include <random>
+
+using namespace datalib;
+
+using flat_map = flat_sorted_map<int, std::string>;
+using std_map  = std::map<int, std::string>;
+
+template<class Map>
+using store = data_store<Map>;
+
+// Merges the stores as gta3::store_merger::merge does, walking every key of every store for its dominant value
+template<class Map>
+static std::vector<std::pair<int, std::string>> merge(std::vector<store<Map>>& stores, int flags)
+{
+    std::set<std::reference_wrapper<const int>, std::less<int>> keys;
+    for(auto& st : stores)
+    {
+        if(st.ready())
+            for(auto& kv : st.container()) keys.emplace(std::cref(kv.first));
+    }
+
+    std::vector<std::pair<int, std::string>> output;
+    for(auto& key : keys)
+    {
+        if(auto* vdom = find_dominant_data(stores.begin(), stores.end(), key.get(), flags))
+            output.emplace_back(key, *vdom);
+    }
+    return output;
+}
+
+// Stores of a data file, the default one followed by the ones of the mods, editing, adding and removing lines of it
+static void make_stores(std::mt19937& rng, size_t num_keys, size_t num_custom, std::vector<store<std_map>>& maps, std::vector<store<flat_map>>& flats)
+{
+    std::vector<std::pair<int, std::string>> lines;
+    for(size_t i = 0; i < num_keys; ++i)
+        lines.emplace_back(int(i * 2), "default " + std::to_string(i % 7));
+
+    for(size_t n = 0; n <= num_custom; ++n)
+    {
+        store<std_map> map;
+        store<flat_map> flat;
+        map.set_as_default(n == 0); flat.set_as_default(n == 0);
+        map.set_as_ready(n != 2);   flat.set_as_ready(n != 2);     // one of the mods didn't have it
+        for(auto& line : lines)
+        {
+            auto kv = line;
+            if(n > 0)
+            {
+                switch(rng() % 16)
+                {
+                    case 0: continue;                                               // removed
+                    case 1: kv.second = "mod " + std::to_string(rng() % 3); break;  // edited, sometimes as another mod
+                    case 2: map.container().emplace(kv.first + 1, "added");         // added (out of order in the flat map)
+                            flat.container().emplace(kv.first + 1, "added");
+                            break;
+                }
+            }
+            map.container().emplace(kv.first, kv.second);
+            flat.container().emplace(kv.first, kv.second);
+        }
+        maps.push_back(std::move(map));
+        flats.push_back(std::move(flat));
+    }
+}
+
+static bool same_content(const flat_map& a, const std_map& b)
+{
+    auto same_pair = [](const flat_map::value_type& x, const std_map::value_type& y) { return x.first == y.first && x.second == y.second; };
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), same_pair);
+}
+
+TEST(flat_map_same_as_map)
+{
+    std::mt19937 rng(34);
+    for(int round = 0; round < 200; ++round)
+    {
+        flat_map flat;
+        std_map  map;
+        int range = 1 + int(rng() % 500);
+        bool increasing = (round % 4 == 0);     // as most data files are
+        int next = 0;
+
+        for(int step = 0; step < 1000; ++step)
+        {
+            int key = increasing? (next += int(rng() % 3)) : int(rng() % range);
+            std::string value = std::to_string(rng());
+
+            switch(rng() % (increasing? 1 : 8))
+            {
+                case 0: case 1: case 2: case 3:
+                {
+                    auto a = flat.emplace(key, value);
+                    auto b = map.emplace(key, value);
+                    if(increasing) CHECK(a.second == b.second && a.first->second == b.first->second);
+                    break;
+                }
+                case 4:
+                    CHECK(flat.count(key) == map.count(key));
+                    CHECK((flat.find(key) == flat.end()) == (map.find(key) == map.end()));
+                    if(map.count(key)) CHECK(flat.at(key) == map.at(key));
+                    break;
+                case 5:
+                    flat[key] = value;
+                    map[key] = value;
+                    break;
+                case 6:
+                    flat.erase(key);
+                    map.erase(key);
+                    break;
+                case 7:
+                {
+                    auto a = flat.lower_bound(key);
+                    auto b = map.lower_bound(key);
+                    CHECK((a == flat.end()) == (b == map.end()));
+                    if(b != map.end()) CHECK(a->first == b->first && a->second == b->second);
+                    break;
+                }
+            }
+
+            if(step % 97 == 0) CHECK(same_content(flat, map));
+        }
+        CHECK(same_content(flat, map));
+    }
+}
+
+TEST(flat_map_keeps_first_duplicate)
+{
+    flat_map flat;
+    flat.emplace(5, "first");
+    flat.emplace(1, "one");
+    flat.emplace(5, "second");          // out of order, found as a duplicate only when normalized
+    flat.insert(std::make_pair(1, "uno"));
+    CHECK(flat.size() == 2);
+    CHECK(flat.at(5) == "first" && flat.at(1) == "one");
+
+    CHECK(!flat.emplace(5, "third").second);     // in order, same key as the last element
+    CHECK(flat.size() == 2 && flat.at(5) == "first");
+
+    bool thrown = false;
+    try { flat.at(3); } catch(const std::out_of_range&) { thrown = true; }
+    CHECK(thrown);
+}
+
+TEST(flat_map_copy_move_compare)
+{
+    flat_map a;
+    for(int k : { 3, 1, 2, 1 }) a.emplace(k, std::to_string(k));
+
+    flat_map b(a);                      // copies the pending sort too
+    flat_map c;
+    c.emplace(1, "1"); c.emplace(2, "2"); c.emplace(3, "3");
+    CHECK(a == c && b == c && !(a < c) && a <= c);
+
+    flat_map d(std::move(b));
+    d[4] = "4";
+    CHECK(d != c && c < d && d.size() == 4);
+
+    flat_map e;
+    e = d;
+    e.erase(4);
+    CHECK(e == c && d.size() == 4);
+
+    e.clear();
+    CHECK(e.empty() && e.size() == 0 && e.begin() == e.end());
+}
+
+TEST(flat_map_same_dominance_merge)
+{
+    // The merge result (which value wins each key) doesn't depend on the container of the stores
+    std::mt19937 rng(341);
+    for(int round = 0; round < 20; ++round)
+    {
+        std::vector<store<std_map>> maps;
+        std::vector<store<flat_map>> flats;
+        make_stores(rng, 50 + rng() % 500, 1 + rng() % 4, maps, flats);
+
+        for(int flags : { 0, flag_RemoveIfNotExistInOneCustomButInDefault, flag_RemoveIfNotExistInAnyCustom })
+        {
+            auto a = merge(maps, flags);
+            auto b = merge(flats, flags);
+            CHECK(a == b);
+            CHECK(!a.empty());
+        }
+    }
+
+    // Same value in the default and a mod, the one of the other mod wins, and the first mod wins over the later ones
+    std::vector<store<flat_map>> stores(3);
+    for(auto& st : stores) st.set_as_ready();
+    stores[0].set_as_default();
+    stores[0].container().emplace(1, "a"); stores[1].container().emplace(1, "a"); stores[2].container().emplace(1, "b");
+    stores[0].container().emplace(2, "a"); stores[1].container().emplace(2, "b"); stores[2].container().emplace(2, "c");
+    CHECK((merge(stores, 0) == std::vector<std::pair<int, std::string>> { { 1, "b" }, { 2, "b" } }));
+}
+
+TEST(flat_map_serialize)
+{
+    // The cache archives of both containers hold the same, and a flat map reads back sorted
+    flat_map flat;
+    std_map map;
+    for(int k : { 5, 1, 3, 1, 9 }) flat.emplace(k, std::to_string(k)), map.emplace(k, std::to_string(k));
+
+    std::stringstream ss;
+    {
+        cereal::BinaryOutputArchive ar(ss);
+        ar(flat, map);
+    }
+
+    flat_map flat_in;
+    std_map map_in;
+    {
+        cereal::BinaryInputArchive ar(ss);
+        ar(flat_in, map_in);
+    }
+    CHECK(same_content(flat_in, map_in) && same_content(flat_in, map) && flat_in == flat);
+}
+
+BENCH(flat_map_parse_merge_serialize)
+{
+    // An IDE worth of lines in the default store and four mods, as std.data parses, merges and caches them
+    std::mt19937 rng(342);
+    std::vector<store<std_map>> maps;
+    std::vector<store<flat_map>> flats;
+    make_stores(rng, 20000, 4, maps, flats);
+
+    std::vector<std::string> lines;
+    for(auto& kv : maps[1].container()) lines.push_back(std::to_string(kv.first) + " " + kv.second);
+
+    // Parse, with the added lines out of order in the file
+    std::shuffle(lines.begin() + lines.size() / 2, lines.begin() + lines.size() / 2 + 500, rng);
+    auto parse = [&](auto& map) {
+        for(auto& line : lines)
+        {
+            char* end;
+            int key = int(strtol(line.c_str(), &end, 10));
+            map.emplace(key, std::string(end + 1));
+        }
+        tests::keep(map.size());
+    };
+    tests::benchmark("std::map parse 20k lines", 100, [&](size_t) { std_map map; parse(map); });
+    tests::benchmark("flat_sorted_map parse 20k lines", 100, [&](size_t) { flat_map flat; flat.reserve(lines.size()); parse(flat); flat.count(0); });
+
+    // Merge, the dominance walk over every key of every store
+    size_t merged = 0;
+    tests::benchmark("std::map merge 5 stores", 20, [&](size_t) { merged += merge(maps, 0).size(); });
+    tests::benchmark("flat_sorted_map merge 5 stores", 20, [&](size_t) { merged += merge(flats, 0).size(); });
+    tests::keep(merged);
+
+    // Serialize, writing and reading the store cache archive
+    auto round_trip = [](auto& map) {
+        std::stringstream ss;
+        {
+            cereal::BinaryOutputArchive ar(ss);
+            ar(map);
+        }
+        typename std::decay<decltype(map)>::type in;
+        cereal::BinaryInputArchive ar(ss);
+        ar(in);
+        tests::keep(in.size());
+    };
+    tests::benchmark("std::map serialize + deserialize", 100, [&](size_t) { round_trip(maps[1].container()); });
+    tests::benchmark("flat_sorted_map serialize + deserialize", 100, [&](size_t) { round_trip(flats[1].container()); });
+}
+
+BENCH(flat_map_load_and_lookup)
+{
+    // Keys of a data file (e.g. IDE ids), mostly in increasing order
+    std::vector<int> keys;
+    for(int i = 0; i < 20000; ++i) keys.push_back(i % 1000 == 999? i - 500 : i);
+    std::string value = "some value";
+
+    tests::benchmark("std::map load 20k keys", 200, [&](size_t) {
+        std_map map;
+        for(int k : keys) map.emplace(k, value);
+        tests::keep(map.size());
+    });
+    tests::benchmark("flat_sorted_map load 20k keys", 200, [&](size_t) {
+        flat_map flat;
+        flat.reserve(keys.size());
+        for(int k : keys) flat.emplace(k, value);
+        tests::keep(flat.size());
+    });
+
+    std_map map;
+    flat_map flat;
+    for(int k : keys) map.emplace(k, value), flat.emplace(k, value);
+
+    size_t found = 0;
+    tests::benchmark("std::map find", 5000000, [&](size_t i) {
+        found += map.count(keys[(i * 7919) % keys.size()]);
+    });
+    tests::benchmark("flat_sorted_map find", 5000000, [&](size_t i) {
+        found += flat.count(keys[(i * 7919) % keys.size()]);
+    });
+    tests::benchmark("std::map iterate", 2000, [&](size_t) {
+        for(auto& pair : map) found += pair.first;
+    });
+    tests::benchmark("flat_sorted_map iterate", 2000, [&](size_t) {
+        for(auto& pair : flat) found += pair.first;
+    });
+    tests::keep(found);
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The datalib line_printer and buffered_writer against the ostringstream and ofstream they replace
+ *
+ */
+#include "test.hpp"
+#include <datalib/detail/stream/printer.hpp>
+#include <fstream>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace datalib;
+
+struct point { int x; double y; };
+
+static std::ostream& operator<<(std::ostream& os, const point& p)
+{
+    return os << p.x << ':' << p.y;
+}
+
+// Prints @value by both ways with the given settings and checks the text is the same
+template<class T>
+static bool same_as_stream(T value, int base, int precision)
+{
+    std::ostringstream stream;
+    stream.precision(precision);
+    if(base == 16) stream.setf(std::ios::hex, std::ios::basefield);
+    stream << value << ' ';
+
+    std::string out;
+    line_printer printer(out);
+    printer.precision(precision);
+    printer.base(base);
+    printer << value << ' ';
+
+    if(out != stream.str())
+    {
+        fprintf(stderr, "    printer \"%s\" stream \"%s\" (base %d, precision %d)\n", out.c_str(), stream.str().c_str(), base, precision);
+        return false;
+    }
+    return true;
+}
+
+template<class T>
+static void check_integers(std::mt19937_64& rng)
+{
+    using limits = std::numeric_limits<T>;
+    for(int base : { 10, 16 })
+    {
+        for(T value : { T(0), T(1), T(-1), T(10), T(15), T(16), limits::min(), limits::max(), T(limits::min() + 1), T(limits::max() - 1) })
+            CHECK(same_as_stream(value, base, 6));
+        for(int i = 0; i < 20000; ++i)
+            CHECK(same_as_stream(T(rng() >> (rng() % 64)), base, 6));
+    }
+}
+
+TEST(printer_integers_same_as_stream)
+{
+    std::mt19937_64 rng(32);
+    check_integers<short>(rng);
+    check_integers<unsigned short>(rng);
+    check_integers<int>(rng);
+    check_integers<unsigned int>(rng);
+    check_integers<long>(rng);
+    check_integers<unsigned long>(rng);
+    check_integers<long long>(rng);
+    check_integers<unsigned long long>(rng);
+}
+
+TEST(printer_reals_same_as_stream)
+{
+    std::mt19937_64 rng(33);
+    std::uniform_real_distribution<double> mantissa(-10.0, 10.0);
+    std::uniform_int_distribution<int> exponent(-40, 40);
+
+    for(int precision : { 0, 1, 3, 6, 9, 17, 40 })
+    {
+        for(double value : { 0.0, -0.0, 1.0, -1.5, 0.1, 100000.0, 1000000.0, 1e-5, 123456789.0,
+                             double(std::numeric_limits<float>::max()), std::numeric_limits<double>::min() })
+        {
+            CHECK(same_as_stream(value, 10, precision));
+            CHECK(same_as_stream(float(value), 10, precision));
+        }
+
+        for(int i = 0; i < 5000; ++i)
+        {
+            double value = mantissa(rng) * std::pow(10.0, exponent(rng));
+            CHECK(same_as_stream(value, 10, precision));
+            CHECK(same_as_stream(float(value), 10, precision));
+            CHECK(same_as_stream(value, 16, precision));        // the base doesn't apply to reals
+        }
+    }
+}
+
+TEST(printer_others_same_as_stream)
+{
+    CHECK(same_as_stream(true, 10, 6) && same_as_stream(false, 16, 6));
+    CHECK(same_as_stream('x', 10, 6) && same_as_stream((unsigned char)('y'), 16, 6));
+    CHECK(same_as_stream("some text", 10, 6) && same_as_stream(std::string("more text"), 16, 6));
+
+    // Types without an overload go through the ostringstream fallback, with the printer settings
+    std::string out;
+    line_printer printer(out);
+    printer.base(16);
+    printer.precision(3);
+    printer << point { 255, 1.23456 } << ' ' << 255;
+    CHECK(!printer.fail() && out == "ff:1.23 ff");
+}
+
+TEST(buffered_writer_same_as_ofstream)
+{
+    std::mt19937 rng(34);
+    tests::temp_dir dir;
+
+    for(int round = 0; round < 20; ++round)
+    {
+        // Lines of every size, some bigger than the buffer itself, with both line endings
+        {
+            std::ofstream stream((dir / "a.dat").c_str());
+            buffered_writer writer((dir / "b.dat").c_str());
+            int nlines = std::uniform_int_distribution<int>(0, 3000)(rng);
+            for(int l = 0; l < nlines; ++l)
+            {
+                size_t len = (rng() % 50 == 0)? rng() % (2 * buffered_writer::buffer_size) : rng() % 200;
+                std::string line(len, char('a' + rng() % 26));
+                const char* eol = (rng() % 2? "\r\n" : "\n");
+                stream << line << eol;
+                writer << line << eol;
+            }
+            CHECK(writer.close());
+        }
+
+        std::string a, b;
+        CHECK(dir.read("a.dat", a) && dir.read("b.dat", b));
+        CHECK(a == b);
+    }
+
+    buffered_writer bad((dir / "no/such/dir.dat").c_str());
+    CHECK(!bad);
+    bad << "ignored";
+    CHECK(!bad.close());
+}
+
+TEST(buffered_writer_content)
+{
+    tests::temp_dir dir;
+    {
+        std::ofstream stream((dir / "a.dat").c_str());
+        buffered_writer writer((dir / "b.dat").c_str());
+        for(int i = 0; i < 50000; ++i)
+        {
+            std::string line;
+            line_printer printer(line);
+            printer << i << ", " << (i * 0.25f) << ", " << "model" << i % 7 << '\n';
+            writer << line;
+            stream << i << ", " << (i * 0.25f) << ", " << "model" << i % 7 << '\n';
+        }
+        std::string big(3 * buffered_writer::buffer_size, 'z');
+        writer << big << '\n';
+        stream << big << '\n';
+        CHECK(writer.close());
+    }
+
+    std::string a, b;
+    CHECK(dir.read("a.dat", a) && dir.read("b.dat", b));
+    CHECK(a == b);
+}
+
+BENCH(printer_data_lines)
+{
+    std::string out;
+    size_t length = 0;
+
+    tests::benchmark("ostringstream line", 500000, [&](size_t i) {
+        std::ostringstream stream;
+        stream << int(1000 + i) << ", " << "model" << ", " << "txd" << ", " << float(i % 300) + 0.5f << ", " << unsigned(i % 4096);
+        length += stream.str().size();
+    });
+    tests::benchmark("line_printer line", 500000, [&](size_t i) {
+        out.clear();
+        line_printer printer(out);
+        printer << int(1000 + i) << ", " << "model" << ", " << "txd" << ", " << float(i % 300) + 0.5f << ", " << unsigned(i % 4096);
+        length += out.size();
+    });
+    tests::keep(length);
+
+    tests::temp_dir dir;
+    std::string line = "1000, some_model, some_txd, 299.5, 4095\n";
+    tests::benchmark("ofstream 200k lines", 5, [&](size_t) {
+        std::ofstream stream((dir / "a.dat").c_str());
+        for(int i = 0; i < 200000; ++i) stream << line;
+    });
+    tests::benchmark("buffered_writer 200k lines", 5, [&](size_t) {
+        buffered_writer writer((dir / "b.dat").c_str());
+        for(int i = 0; i < 200000; ++i) writer << line;
+    });
+}
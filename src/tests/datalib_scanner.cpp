@@ -0,0 +1,465 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The datalib line_scanner against the icheckstream+imemstream pair it replaces on data lines,
+ *  both on single values and on data_slice lines shaped as the std.data stores
+ *
+ */
+#include "test.hpp"
+#include <datalib/detail/stream/scanner.hpp>
+#include <datalib/data_slice.hpp>
+#include <datalib/io/either.hpp>
+#include <datalib/io/tuple.hpp>
+#include <datalib/io/array.hpp>
+#include <datalib/io/string.hpp>
+#include <datalib/io/ignore.hpp>
+#include <datalib/io/hex.hpp>
+#include <datalib/io/tagged_type.hpp>
+#include <datalib/io/dyncontainer.hpp>
+#include <datalib/data_info/vector.hpp>
+#include <type_wrapper/floating_point.hpp>
+#include <type_wrapper/datalib/io/floating_point.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+
+using namespace datalib;
+
+static const std::vector<const char*> tokens = {
+    "0", "1", "-1", "+5", "123", "00012", "65535", "65536", "-32768", "-32769",
+    "2147483647", "2147483648", "-2147483648", "4294967295", "4294967296", "-4294967295",
+    "18446744073709551615", "18446744073709551616", "99999999999999999999999",
+    "0x1F", "0XfF", "1f", "ff", "-ff", "1.5", "-0.25", "+.5", ".5", "1.", "1.e3", "1e5", "1E-2", "2.5e+10",
+    "1e", "1e+", "1.5f", "3.4e39", "1e-50", "abc", "1,", "-", "+", "x", "7", "0x", "--1", "1-",
+};
+
+static const std::vector<const char*> bool_tokens = { "0", "1", "1", "0", "01", "2", "-1", "true", "1.0", "0x0" };
+
+static const char* const blanks[] = { " ", "  ", "\t", " \t ", "," };
+
+// Two passes over the line, as data_slice did before the scanner: check every value, then read them
+template<class T>
+static bool scan_by_stream(const std::string& line, int base, T* out, int nvalues)
+{
+    icheckstream checker(line);
+    imemstream   stream(line);
+    if(base == 16)
+    {
+        checker.setf(std::ios::hex, std::ios::basefield);
+        stream.setf(std::ios::hex, std::ios::basefield);
+    }
+
+    for(int i = 0; i < nvalues; ++i) checker >> static_cast<const T&>(out[i]);
+    if(!checker) return false;
+    for(int i = 0; i < nvalues; ++i) stream >> out[i];
+    return !stream.fail();
+}
+
+template<class T>
+static bool scan_by_scanner(const std::string& line, int base, T* out, int nvalues)
+{
+    line_scanner scanner(line);
+    scanner.base(base);
+    for(int i = 0; i < nvalues; ++i) scanner >> out[i];
+    return !scanner.fail();
+}
+
+template<class T>
+static bool same_value(T a, T b)
+{
+    return a == b || (std::isnan(double(a)) && std::isnan(double(b)));
+}
+
+// Scans @nvalues values of type T from random lines of @words, returns how many lines were accepted
+template<class T>
+static int check_same_as_stream(std::mt19937& rng, int nvalues, int base, const std::vector<const char*>& words = tokens)
+{
+    int accepted = 0;
+    for(int round = 0; round < 3000; ++round)
+    {
+        std::string line;
+        int ntokens = std::uniform_int_distribution<int>(0, 4)(rng);
+        if(rng() % 3 == 0) line += blanks[rng() % 3];
+        for(int i = 0; i < ntokens; ++i)
+        {
+            if(i) line += blanks[rng() % (sizeof(blanks) / sizeof(*blanks))];
+            line += words[rng() % words.size()];
+        }
+        if(rng() % 3 == 0) line += blanks[rng() % 3];
+
+        T a[3] = {}, b[3] = {};
+        bool ok_stream  = scan_by_stream(line, base, a, nvalues);
+        bool ok_scanner = scan_by_scanner(line, base, b, nvalues);
+
+        CHECK(ok_stream == ok_scanner);
+        if(ok_stream != ok_scanner)
+            fprintf(stderr, "    line \"%s\" (base %d): stream %d, scanner %d\n", line.c_str(), base, ok_stream, ok_scanner);
+        else if(ok_stream)
+        {
+            ++accepted;
+            for(int i = 0; i < nvalues; ++i)
+            {
+                CHECK(same_value(a[i], b[i]));
+                if(!same_value(a[i], b[i]))
+                    fprintf(stderr, "    line \"%s\" (base %d): value %d differs\n", line.c_str(), base, i);
+            }
+        }
+    }
+    return accepted;
+}
+
+TEST(scanner_integers_same_as_stream)
+{
+    std::mt19937 rng(31);
+    for(int base : { 10, 16 })
+    {
+        for(int n = 1; n <= 3; ++n)
+        {
+            CHECK(check_same_as_stream<int>(rng, n, base) > 0);
+            CHECK(check_same_as_stream<unsigned int>(rng, n, base) > 0);
+            CHECK(check_same_as_stream<short>(rng, n, base) > 0);
+            CHECK(check_same_as_stream<unsigned short>(rng, n, base) > 0);
+            CHECK(check_same_as_stream<long long>(rng, n, base) > 0);
+            CHECK(check_same_as_stream<unsigned long long>(rng, n, base) > 0);
+        }
+    }
+}
+
+TEST(scanner_reals_same_as_stream)
+{
+    std::mt19937 rng(32);
+    for(int n = 1; n <= 3; ++n)
+    {
+        CHECK(check_same_as_stream<float>(rng, n, 10) > 0);
+        CHECK(check_same_as_stream<double>(rng, n, 10) > 0);
+    }
+}
+
+TEST(scanner_bools_same_as_stream)
+{
+    std::mt19937 rng(33);
+    for(int n = 1; n <= 3; ++n)
+        CHECK(check_same_as_stream<bool>(rng, n, 10, bool_tokens) > 0);
+}
+
+TEST(scanner_rolls_back_on_failure)
+{
+    std::string line = "  12 abc 3.5";
+    line_scanner scanner(line);
+    int i = 0; float f = 0; std::string s;
+
+    CHECK(scanner >> i && i == 12);
+    CHECK(!(scanner >> i) && i == 12);
+    CHECK(scanner.tell() == line.data() + 4);   // where it was before the failure
+    scanner.clear();
+    CHECK(scanner >> s && s == "abc");
+    CHECK(scanner >> f && f == 3.5f);
+    CHECK(!(scanner >> s));                     // end of line
+}
+
+BENCH(scanner_data_lines)
+{
+    // An IDE objs line like: id, model, txd, draw distance, flags
+    std::vector<std::string> lines;
+    for(int i = 0; i < 10000; ++i)
+        lines.push_back(std::to_string(1000 + i) + " 12345 678 " + std::to_string(i % 300) + ".5 " + std::to_string(i % 4096));
+
+    int ivalue[3]; float fvalue; unsigned uvalue;
+    size_t ok = 0;
+
+    tests::benchmark("icheckstream+imemstream line", lines.size() * 20, [&](size_t i) {
+        auto& line = lines[i % lines.size()];
+        icheckstream checker(line);
+        if(checker >> ivalue[0] >> ivalue[1] >> ivalue[2] >> fvalue >> uvalue)
+        {
+            imemstream stream(line);
+            ok += !!(stream >> ivalue[0] >> ivalue[1] >> ivalue[2] >> fvalue >> uvalue);
+        }
+    });
+    tests::benchmark("line_scanner line", lines.size() * 20, [&](size_t i) {
+        line_scanner scanner(lines[i % lines.size()]);
+        ok += !!(scanner >> ivalue[0] >> ivalue[1] >> ivalue[2] >> fvalue >> uvalue);
+    });
+    CHECK(ok == lines.size() * 40);
+}
+
+//
+//  data_slice lines, parse() (line_scanner) against check() followed by set() (icheckstream+imemstream)
+//
+
+namespace
+{
+    // A value of two numbers with only stream overloads, read by the scanner through its fallback
+    struct span
+    {
+        int lo, hi;
+        bool operator==(const span& rhs) const { return lo == rhs.lo && hi == rhs.hi; }
+    };
+
+    template<class CharT, class Traits>
+    basic_icheckstream<CharT, Traits>& operator>>(basic_icheckstream<CharT, Traits>& is, const span& s)
+    {
+        return is >> s.lo >> s.hi;
+    }
+
+    std::istream& operator>>(std::istream& is, span& s)
+    {
+        return is >> s.lo >> s.hi;
+    }
+
+    std::ostream& operator<<(std::ostream& os, const span& s)
+    {
+        return os << s.lo << ' ' << s.hi;
+    }
+
+    // The types of std.data (see utility.hpp)
+    struct tag_insen_t {};
+    using real_t = basic_floating_point<float, floating_point_comparer::relative_epsilon<float>>;
+    template<class T, std::size_t N>
+    using pack = std::array<T, N>;
+    using vec2 = pack<real_t, 2>;
+    using vec3 = pack<real_t, 3>;
+    using rgb  = pack<int16_t, 3>;
+    using rgba = pack<int16_t, 4>;
+    using modelname = tagged_type<std::string, tag_insen_t>;
+    using texname   = modelname;
+    using animname  = modelname;
+    using labelname = modelname;
+
+    // ide.cpp sections, as on San Andreas
+    using objs0e = std::tuple<real_t, int>;
+    using objs1e = std::tuple<int, real_t, int>;
+    using objs2e = std::tuple<int, real_t, real_t, int>;
+    using objs3e = std::tuple<int, real_t, real_t, real_t, int>;
+    using ide_objs = data_slice<int, modelname, texname, either<objs3e, objs2e, objs1e, objs0e>>;
+    using ide_hier = data_slice<int, modelname, texname, delimopt, animname, real_t>;
+    using ide_peds = data_slice<int, modelname, texname, std::string, std::string, std::string, hex<uint32_t>, hex<uint32_t>, std::tuple<animname, int, int>, std::tuple<std::string, std::string, std::string>>;
+    using ide_cars = data_slice<int, modelname, texname, std::string, std::string, labelname, animname, std::string, int, int, hex<uint32_t>, delimopt, int, real_t, real_t, int>;
+
+    // handling.cpp sections, as on San Andreas
+    using handling_main  = data_slice<std::string, real_t, real_t, real_t, vec3, int, real_t, real_t, real_t, int, real_t, real_t, real_t, char, char, real_t, real_t, char, pack<real_t, 3>, real_t, pack<real_t, 4>, real_t, real_t, int, hex<uint64_t>, hex<uint32_t>, char, char, int>;
+    using handling_boat  = data_slice<char, std::string, vec2, real_t, real_t, real_t, real_t, real_t, vec3, vec3, real_t>;
+    using handling_bike  = data_slice<char, std::string, pack<real_t, 15>>;
+    using handling_plane = data_slice<char, std::string, pack<real_t, 11>, pack<real_t, 2>, either<real_t, std::string>, real_t, real_t, real_t, real_t, vec3>;
+    using handling_anim  = data_slice<char, int, int, int, pack<bool, 18>, pack<real_t, 13>, int>;
+
+    // A timecyc.dat row as on San Andreas (there's no timecyc store, the file is only detoured)
+    using timecyc_row = data_slice<rgb, rgb, rgb, rgb, rgb, rgb, rgb, real_t, real_t, real_t, int, int, int, real_t, real_t, real_t, rgb, rgb, rgba, int, rgb, int, rgb, int>;
+
+    // Values going through the fallback, alone and inside the io types
+    using fallback_line = data_slice<int, span, std::tuple<span, int>, delimopt, std::vector<int>>;
+
+    const char* const ide_objs_lines[] = {
+        "615, veg_tree3, gta_tree_boak, 1, 299, 0",
+        "1234, lodbigbridge, cs_lod, 2, 500, 500, 1048580",
+        "3000 model_x tex_x 3 100 120 150 4",
+        "3001, model_y, tex_y, 300, 2097152",
+    };
+    const char* const ide_hier_lines[] = { "3500, cutobj01, generic", "3501, cutobj02, generic, cutanim, 20.5" };
+    const char* const ide_peds_lines[] = {
+        "7, male01, male01, CIVMALE, STAT_STREET_GUY, man, 1103, 0, man, 1, 2, PED_TYPE_GEN, VOICE_GEN_RC, VOICE_GEN_RC",
+        "9, bfori, bfori, CIVFEMALE, STAT_SENSIBLE_GIRL, woman, 1203, 1, fatwoman, 2, 5, VOICE_GEN_BFORI, VOICE_GEN_BFORI, VOICE_GEN_BFORI",
+    };
+    const char* const ide_cars_lines[] = {
+        "400, landstal, landstal, car, LANDSTAL, LANDSTK, null, richfamily, 10, 7, 0, 250, 0.768, 0.768, 0",
+        "522, nrg500, nrg500, bike, NRG500, NRG500, bikes, bike, 5, 0, 0, 16, 0.6, 0.6, 0",
+        "539, vortex, vortex, car, VORTEX, VORTEX, null, ignore, 1, 0, 0, -1, 0.6, 0.6, 0",
+    };
+    const char* const handling_main_lines[] = {
+        "LANDSTAL 1700.0 5008.3 2.5 0.0 0.0 -0.3 85 0.75 0.85 0.5 5 165.0 8.0 25.0 4 D 6.2 0.60 0 35.0 2.4 0.08 0.0 0.28 -0.14 0.5 0.25 0.27 0.23 25000 20200020 504400 1 1 1",
+        "BRAVURA 1300.0 2200.8 1.7 0.0 0.3 0.0 70 0.65 0.80 0.52 5 160.0 7.2 10.0 F P 8.0 0.8 0 30.0 1.3 0.08 0.0 0.31 -0.15 0.57 0.0 0.26 0.5 9000 0 2 1 1 0",
+    };
+    const char* const handling_boat_lines[] = { "% COASTG 0.6 0.5 3.0 1.0 1.0 5.0 0.6 0.9 0.01 0.99 0.01 0.4 -0.3 0.02 0.35" };
+    const char* const handling_bike_lines[] = { "! NRG500 0.15 0.2 0.2 35.0 0.4 15.0 -0.2 0.5 10.0 0.2 0.8 0.6 0.5 0.5 1.0" };
+    const char* const handling_plane_lines[] = {
+        "$ RUSTLER 0.45 0.0 -0.0005 0.0 0.0 -0.007 0.0 0.0 0.0 0.0 0.0 1.0 1.0 0.0 0.0 0.0 0.1 0.0 0.0 0.1 0.1",
+        "$ SKIMMER 0.45 0.0 -0.0005 0.0 0.0 -0.007 0.0 0.0 0.0 0.0 0.0 1.0 1.0 abc 0.0 0.0 0.1 0.0 0.0 0.1 0.1",
+    };
+    const char* const handling_anim_lines[] = { "^ 0 1 0 0 1 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 1 0.1 0.1 0.1 0.2 0.2 0.2 1.0 1.0 1.0 0.3 0.3 0.3 0.5 2" };
+    const char* const timecyc_lines[] = {
+        "0 0 0  0 0 0  10 10 10  0 0 0  10 10 10  255 128 0  5 0 0  0.0 0.0 0.0 150 80 80 800.0 100.0 1.0 40 40 40 20 20 20 90 90 90 240 0 0 0 0 0 0 0 0 0",
+        "20 20 35  30 30 30  30 30 30  16 26 72  56 77 130  255 128 0  5 0 0  1.9 0.5 0.0 60 60 60 800.0 -10.0 1.0 50 45 60 50 45 60 60 70 100 240 128 128 128 64 128 128 128 32 0",
+    };
+    const char* const fallback_lines[] = { "1 2 3 4 5 6 7 8 9 10", "1 2 3 10 20 1", "-5 -1 -2 0 0 3 7 8 9", "0 0 0 0 0 0 0 0" };
+
+    // The lines and their mangles: other separators, cut short, tokens swapped by others and trailing tokens
+    template<size_t N>
+    std::vector<std::string> mangle(std::mt19937& rng, const char* const (&samples)[N])
+    {
+        static const char* const others[] = { "x", "0", "-3", "1.5", "ff", "1x", "1e3", ",", "" };
+        std::vector<std::string> lines;
+        for(const char* sample : samples)
+        {
+            std::vector<std::string> tokens;
+            std::istringstream ss(sample);
+            for(std::string token; ss >> token; )
+            {
+                if(token.back() == ',') token.pop_back();
+                tokens.push_back(token);
+            }
+
+            auto join = [&](const std::vector<std::string>& tokens, size_t count)
+            {
+                std::string line;
+                for(size_t i = 0; i < count && i < tokens.size(); ++i)
+                    line.append(i? blanks[rng() % (sizeof(blanks) / sizeof(*blanks))] : "").append(tokens[i]);
+                return line;
+            };
+
+            lines.push_back(sample);
+            for(size_t i = 0; i <= tokens.size(); ++i)
+                lines.push_back(join(tokens, i));
+            for(int round = 0; round < 200; ++round)
+            {
+                auto changed = tokens;
+                changed[rng() % changed.size()] = others[rng() % (sizeof(others) / sizeof(*others))];
+                if(rng() % 4 == 0) changed.push_back(others[rng() % (sizeof(others) / sizeof(*others))]);
+                lines.push_back(join(changed, changed.size()));
+            }
+        }
+        return lines;
+    }
+
+    // The line as the stores get it (see gta3::trim_config_line), commas are separators
+    std::string config_line(std::string line)
+    {
+        std::replace(line.begin(), line.end(), ',', ' ');
+        return line;
+    }
+
+    // Parses the samples and their mangles with both backends, returns how many lines were accepted
+    template<class Slice, size_t N>
+    int check_slice_same_as_stream(std::mt19937& rng, const char* const (&samples)[N])
+    {
+        for(const char* sample : samples)
+        {
+            Slice slice;
+            CHECK(slice.parse(config_line(sample)));
+        }
+
+        int accepted = 0;
+        for(auto& raw : mangle(rng, samples))
+        {
+            auto line = config_line(raw);
+
+            Slice a, b;
+            bool ok_scanner = a.parse(line);
+            bool ok_stream  = b.check(line) && b.set(line);
+
+            CHECK(ok_stream == ok_scanner);
+            if(ok_stream != ok_scanner)
+                fprintf(stderr, "    line \"%s\": stream %d, scanner %d\n", line.c_str(), ok_stream, ok_scanner);
+            else if(ok_stream)
+            {
+                ++accepted;
+                std::string sa, sb;
+                CHECK(a.get(sa) && b.get(sb));
+
+                // set() keeps reading the optional values past the ones check() accepted when they start as one ("1x"),
+                // the scanner stops where check() does, so it's the stream result of what check() accepted
+                Slice t;
+                bool same = (a == b && sa == sb) || (a.count() < b.count() && sb.compare(0, sa.size(), sa) == 0 && t.check(sa) && t.set(sa) && t == a);
+                CHECK(same);
+
+                // What's printed reads back and prints the same (an empty container prints nothing, so isn't read back)
+                Slice c;
+                std::string sc;
+                CHECK(c.parse(sa) && c.get(sc) && sc == sa);
+                if(!same)
+                    fprintf(stderr, "    line \"%s\": stream \"%s\", scanner \"%s\"\n", line.c_str(), sb.c_str(), sa.c_str());
+            }
+        }
+        return accepted;
+    }
+}
+
+TEST(scanner_fallback_same_as_stream)
+{
+    span s = {}, h = {};
+    int i = 0;
+
+    // The value, then the cursor right after it
+    std::string line = "1 2 7";
+    line_scanner scanner(line);
+    CHECK(scanner >> s >> i && s == (span { 1, 2 }) && i == 7);
+
+    // A failure in the middle puts the cursor back
+    line = "3 4 5 x 7";
+    line_scanner bad(line);
+    CHECK(bad >> s && !(bad >> h) && bad.tell() == line.data() + 3);
+    bad.clear();
+    CHECK(bad >> i && i == 5);
+
+    // The base of the scanner goes into the streams
+    line = "a ff 10 10";
+    line_scanner hexed(line);
+    hexed.base(16);
+    CHECK(hexed >> h >> s && h == (span { 10, 255 }) && s == (span { 16, 16 }));
+
+    // Dynamic containers go through it too, and take the rest of the line
+    std::vector<int> v;
+    line = "1 2 3 x";
+    line_scanner rest(line);
+    CHECK(rest >> i >> v && v == (std::vector<int> { 2, 3 }));
+
+    std::mt19937 rng(34);
+    CHECK(check_slice_same_as_stream<fallback_line>(rng, fallback_lines) > 0);
+}
+
+TEST(scanner_ide_same_as_stream)
+{
+    std::mt19937 rng(35);
+    CHECK(check_slice_same_as_stream<ide_objs>(rng, ide_objs_lines) > 0);
+    CHECK(check_slice_same_as_stream<ide_hier>(rng, ide_hier_lines) > 0);
+    CHECK(check_slice_same_as_stream<ide_peds>(rng, ide_peds_lines) > 0);
+    CHECK(check_slice_same_as_stream<ide_cars>(rng, ide_cars_lines) > 0);
+}
+
+TEST(scanner_handling_same_as_stream)
+{
+    std::mt19937 rng(36);
+    CHECK(check_slice_same_as_stream<handling_main>(rng, handling_main_lines) > 0);
+    CHECK(check_slice_same_as_stream<handling_boat>(rng, handling_boat_lines) > 0);
+    CHECK(check_slice_same_as_stream<handling_bike>(rng, handling_bike_lines) > 0);
+    CHECK(check_slice_same_as_stream<handling_plane>(rng, handling_plane_lines) > 0);
+    CHECK(check_slice_same_as_stream<handling_anim>(rng, handling_anim_lines) > 0);
+}
+
+TEST(scanner_timecyc_same_as_stream)
+{
+    std::mt19937 rng(37);
+    CHECK(check_slice_same_as_stream<timecyc_row>(rng, timecyc_lines) > 0);
+}
+
+template<class Slice, size_t N>
+static void bench_slice(const char* what, const char* const (&samples)[N])
+{
+    std::vector<std::string> lines;
+    for(int i = 0; i < 5000; ++i)
+        lines.push_back(config_line(samples[i % N]));
+
+    Slice slice;
+    size_t ok = 0;
+    std::string stream_what  = std::string(what) + " check+set";
+    std::string scanner_what = std::string(what) + " parse";
+
+    tests::benchmark(stream_what.c_str(), lines.size() * 4, [&](size_t i) {
+        auto& line = lines[i % lines.size()];
+        ok += slice.check(line) && slice.set(line);
+    });
+    tests::benchmark(scanner_what.c_str(), lines.size() * 4, [&](size_t i) {
+        ok += slice.parse(lines[i % lines.size()]);
+    });
+    CHECK(ok == lines.size() * 8);
+}
+
+BENCH(scanner_store_lines)
+{
+    bench_slice<ide_objs>("ide objs", ide_objs_lines);
+    bench_slice<ide_cars>("ide cars", ide_cars_lines);
+    bench_slice<handling_main>("handling main", handling_main_lines);
+    bench_slice<handling_plane>("handling plane", handling_plane_lines);
+    bench_slice<timecyc_row>("timecyc row", timecyc_lines);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The datalib section_table lookups against the linear search over the section_info list
+ *
+ */
+#include "test.hpp"
+#include <datalib/gta3/section_info.hpp>
+#include <random>
+
+using namespace datalib;
+
+// Copy of the @sections list without the lookup table, so by_name searches it linearly
+template<size_t N>
+static std::array<gta3::section_info, N> without_table(std::array<gta3::section_info, N> sections)
+{
+    for(auto& s : sections) s.table = nullptr;
+    return sections;
+}
+
+template<size_t N>
+static void check_same_as_linear(std::mt19937& rng, const std::array<gta3::section_info, N>& table_sections)
+{
+    auto linear_sections = without_table(table_sections);
+    const gta3::section_info* with_table = table_sections.data();
+    const gta3::section_info* linear     = linear_sections.data();
+
+    auto index = [](const gta3::section_info* base, const gta3::section_info* s) { return s? int(s - base) : -1; };
+
+    // Lines made of the section names, cut or followed by more text
+    std::vector<std::string> pieces = { "", " ", "x", "1 2 3", "\t", "E", "IMG", "S" };
+    for(size_t i = 0; i + 1 < N; ++i) pieces.push_back(table_sections[i].name);
+
+    for(int round = 0; round < 20000; ++round)
+    {
+        std::string line = pieces[rng() % pieces.size()];
+        if(rng() % 2) line += pieces[rng() % pieces.size()];
+        if(rng() % 3 == 0 && !line.empty()) line.resize(rng() % line.size());
+
+        CHECK(index(with_table, gta3::section_info::by_name(with_table, line)) == index(linear, gta3::section_info::by_name(linear, line)));
+        CHECK(index(with_table, gta3::section_info::by_name(with_table, line.c_str())) == index(linear, gta3::section_info::by_name(linear, line.c_str())));
+
+        for(int n : { -1, 0, 1, 2, 3, 4, 8 })
+        {
+            int a = index(with_table, gta3::section_info::by_name(with_table, line, n));
+            int b = index(linear, gta3::section_info::by_name(linear, line, n));
+            CHECK(a == b);
+            if(a != b) fprintf(stderr, "    line \"%s\" n %d: table %d, linear %d\n", line.c_str(), n, a, b);
+        }
+    }
+}
+
+TEST(section_table_same_as_linear)
+{
+    std::mt19937 rng(33);
+    check_same_as_linear(rng, gta3::make_section_info("IMG", "CDIMAGE", "TEXDICTION", "MODELFILE", "IDE", "COLFILE", "MAPZONE", "IPL", "HIERFILE", "SPLASH", "EXIT"));
+    check_same_as_linear(rng, gta3::make_section_info("objs", "tobj", "hier", "anim", "weap", "cars", "peds", "txdp", "2dfx", "path"));
+    check_same_as_linear(rng, gta3::make_section_info(" ", "%", "!", "$", "^", "\n"));
+    check_same_as_linear(rng, gta3::make_section_info("\xA3", "$", "%"));
+
+    // Names that are prefixes of each other, and unnamed sections
+    check_same_as_linear(rng, gta3::make_section_info("car4", "car", "", "ca", "col", "c", "carx"));
+}
+
+TEST(section_table_shared_by_copies)
+{
+    auto sections = gta3::make_section_info("objs", "cars", "peds");
+    auto copy = sections;
+
+    CHECK(sections[0].table && sections[0].table == copy[3].table);
+    CHECK(sections[3].name == nullptr && sections[3].id == -1 && sections[2].id == 2);
+    CHECK(gta3::section_info::by_name(copy.data(), "cars") == &copy[1]);   // indices into the copy, not the original
+    CHECK(gta3::section_info::by_name(copy.data(), "car") == nullptr);
+    CHECK(gta3::section_info::by_name(copy.data(), "pedsxx", -1) == &copy[2]);
+}
+
+BENCH(section_lookup)
+{
+    auto table_sections = gta3::make_section_info("IMG", "CDIMAGE", "TEXDICTION", "MODELFILE", "IDE", "COLFILE", "MAPZONE", "IPL", "HIERFILE", "SPLASH", "EXIT");
+    auto linear_sections = without_table(table_sections);
+
+    std::vector<std::string> lines = { "IDE DATA\\MAPS\\GENERIC.IDE", "IPL DATA\\MAPS\\LA\\LAn.IPL", "COLFILE 0 MODELS\\COLL\\WEAPONS.COL",
+                                       "EXIT", "SPLASH loadsc0", "TEXDICTION MODELS\\MISC.TXD", "IMG MODELS\\GTA_INT.IMG" };
+    size_t found = 0;
+
+    tests::benchmark("linear prefix lookup", 5000000, [&](size_t i) {
+        found += gta3::section_info::by_name(linear_sections.data(), lines[i % lines.size()], -1)->id;
+    });
+    tests::benchmark("section_table prefix lookup", 5000000, [&](size_t i) {
+        found += gta3::section_info::by_name(table_sections.data(), lines[i % lines.size()], -1)->id;
+    });
+
+    auto linear_ide = without_table(gta3::make_section_info("objs", "tobj", "hier", "anim", "weap", "cars", "peds", "txdp", "2dfx", "path"));
+    auto table_ide  = gta3::make_section_info("objs", "tobj", "hier", "anim", "weap", "cars", "peds", "txdp", "2dfx", "path");
+    std::vector<std::string> names = { "objs", "path", "cars", "2dfx", "end", "tobj" };
+
+    tests::benchmark("linear exact lookup", 5000000, [&](size_t i) {
+        found += (gta3::section_info::by_name(linear_ide.data(), names[i % names.size()]) != nullptr);
+    });
+    tests::benchmark("section_table exact lookup", 5000000, [&](size_t i) {
+        found += (gta3::section_info::by_name(table_ide.data(), names[i % names.size()]) != nullptr);
+    });
+    tests::keep(found);
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The resolved path cache of the file detours, with a fake filesystem probe
+ *
+ */
+#include "test.hpp"
+#include <modloader/util/detour_cache.hpp>
+#include <map>
+#include <random>
+
+using modloader::file_detour_cache;
+
+static const size_t max_path = 260;
+
+/*
+ *  Resolves paths as basic_file_detour::resolve does: a transform functor (as the IPL and GXT ones, a lookup on the plugin
+ *  files) followed by a probe of the filesystem for the resulting path.
+ */
+struct fake_detour
+{
+    std::map<std::string, std::string> files;   // argument -> overriding path (what the plugin has installed)
+    std::map<std::string, bool>        disk;    // paths that exist on the disk
+    size_t                             probes = 0;
+
+    const char* resolve(const char* arg, char* fullpath)
+    {
+        auto it = files.find(arg);
+        if(it != files.end())
+        {
+            ++probes;
+            snprintf(fullpath, max_path, "C:/game/%s", it->second.c_str());
+            if(disk.count(fullpath))
+                return it->second.c_str();
+        }
+        return nullptr;
+    }
+
+    // Path the hooked function gets to open
+    std::string open(file_detour_cache* cache, const char* arg)
+    {
+        char fullpath[max_path];
+        if(cache)
+        {
+            std::string lpath;
+            return cache->resolve_into<max_path>(arg, fullpath, lpath, [this](const char* filename, char* fullpath) {
+                return this->resolve(filename, fullpath);
+            })? fullpath : arg;
+        }
+        return resolve(arg, fullpath)? fullpath : arg;
+    }
+
+    void install(const std::string& arg, const std::string& path)
+    {
+        files[arg] = path;
+        disk["C:/game/" + path] = true;
+    }
+};
+
+TEST(detour_cache_skips_probes)
+{
+    fake_detour detour;
+    file_detour_cache cache;
+    detour.install("DATA/MAPS/LA/LAN.IPL", "modloader/my map/lan.ipl");
+
+    CHECK(detour.open(&cache, "DATA/MAPS/LA/LAN.IPL") == "C:/game/modloader/my map/lan.ipl");
+    CHECK(detour.open(&cache, "DATA/MAPS/LA/LAN.IPL") == "C:/game/modloader/my map/lan.ipl");
+    CHECK(detour.open(&cache, "DATA/MAPS/LA/LAE.IPL") == "DATA/MAPS/LA/LAE.IPL");   // not overriden, cached as such
+    CHECK(detour.open(&cache, "DATA/MAPS/LA/LAE.IPL") == "DATA/MAPS/LA/LAE.IPL");
+    CHECK(detour.probes == 1);
+    CHECK(cache.size() == 2 && cache.num_hits() == 2 && cache.num_misses() == 2);
+
+    auto e = cache.find("DATA/MAPS/LA/LAN.IPL");
+    CHECK(e && e->overriden() && e->lpath == "modloader/my map/lan.ipl");
+
+    // A file missing on the disk isn't an override
+    detour.files["TEXT/AMERICAN.GXT"] = "modloader/gone/american.gxt";
+    CHECK(detour.open(&cache, "TEXT/AMERICAN.GXT") == "TEXT/AMERICAN.GXT");
+    CHECK(detour.probes == 2);
+}
+
+TEST(detour_cache_invalidation)
+{
+    fake_detour detour;
+    file_detour_cache cache;
+
+    CHECK(detour.open(&cache, "TEXT/AMERICAN.GXT") == "TEXT/AMERICAN.GXT");
+
+    // Installing changes the transform state, stale until invalidated (as the plugins do on install and uninstall)
+    detour.install("TEXT/AMERICAN.GXT", "modloader/text/american.gxt");
+    CHECK(detour.open(&cache, "TEXT/AMERICAN.GXT") == "TEXT/AMERICAN.GXT");
+    cache.invalidate();
+    CHECK(cache.size() == 0);
+    CHECK(detour.open(&cache, "TEXT/AMERICAN.GXT") == "C:/game/modloader/text/american.gxt");
+
+    detour.files.erase("TEXT/AMERICAN.GXT");
+    cache.invalidate();
+    CHECK(detour.open(&cache, "TEXT/AMERICAN.GXT") == "TEXT/AMERICAN.GXT");
+}
+
+TEST(detour_cache_invalidated_during_call)
+{
+    // The hooked function may reenter the detour, or the files be refreshed, while it still uses the paths it was given
+    fake_detour detour;
+    file_detour_cache cache;
+    detour.install("TEXT/AMERICAN.GXT", "modloader/text/american.gxt");
+    auto resolver = [&](const char* filename, char* fullpath) { return detour.resolve(filename, fullpath); };
+
+    char fullpath[max_path];
+    std::string lpath;
+    CHECK(cache.resolve_into<max_path>("TEXT/AMERICAN.GXT", fullpath, lpath, resolver));
+
+    cache.invalidate();
+    for(int i = 0; i < 100; ++i)
+    {
+        char inner[max_path];
+        std::string inner_lpath;
+        std::string arg = "DATA/MAPS/FILE" + std::to_string(i) + ".IPL";
+        detour.install(arg, "modloader/a mod with a name too long for the small string buffer/" + arg);
+        CHECK(cache.resolve_into<max_path>(arg.c_str(), inner, inner_lpath, resolver));
+    }
+    cache.invalidate();
+
+    CHECK(std::string(fullpath) == "C:/game/modloader/text/american.gxt" && lpath == "modloader/text/american.gxt");
+
+    // Not overriden, the buffers are left alone
+    CHECK(!cache.resolve_into<max_path>("TEXT/SPANISH.GXT", fullpath, lpath, resolver));
+    CHECK(std::string(fullpath) == "C:/game/modloader/text/american.gxt");
+}
+
+TEST(detour_cache_same_as_uncached)
+{
+    std::mt19937 rng(35);
+    fake_detour cached, uncached;
+    file_detour_cache cache;
+
+    std::vector<std::string> args;
+    for(int i = 0; i < 40; ++i) args.push_back("DATA/MAPS/FILE" + std::to_string(i) + ".IPL");
+
+    for(int step = 0; step < 50000; ++step)
+    {
+        auto& arg = args[rng() % args.size()];
+        if(rng() % 1000 == 0)
+        {
+            // Install, reinstall (another path) or uninstall, followed by the invalidation
+            if(rng() % 3)
+            {
+                std::string path = "modloader/mod" + std::to_string(rng() % 5) + "/" + arg;
+                cached.install(arg, path);
+                uncached.install(arg, path);
+            }
+            else
+            {
+                cached.files.erase(arg);
+                uncached.files.erase(arg);
+            }
+            cache.invalidate();
+        }
+        else
+        {
+            CHECK(cached.open(&cache, arg.c_str()) == uncached.open(nullptr, arg.c_str()));
+        }
+    }
+
+    CHECK(cache.num_hits() > 10 * cache.num_misses());
+    CHECK(cached.probes < uncached.probes / 10);
+}
+
+BENCH(detour_cache_open)
+{
+    // Probes the real filesystem, as GetFileAttributesA does (by opening the file, a bit slower than that)
+    tests::temp_dir dir;
+    struct disk_detour
+    {
+        const tests::temp_dir& dir;
+        const char* resolve(const char* arg, char* fullpath)
+        {
+            std::string path = "override_" + std::string(arg);
+            snprintf(fullpath, max_path, "%s", (dir / path).c_str());
+            return dir.exists(path)? arg : nullptr;
+        }
+    } detour { dir };
+
+    std::vector<std::string> args;
+    for(int i = 0; i < 200; ++i)
+    {
+        args.push_back("file" + std::to_string(i) + ".ipl");
+        if(i % 2) dir.write("override_" + args.back(), "");
+    }
+
+    size_t overriden = 0;
+    tests::benchmark("resolve and probe every open", 200000, [&](size_t i) {
+        char fullpath[max_path];
+        overriden += (detour.resolve(args[i % args.size()].c_str(), fullpath) != nullptr);
+    });
+
+    file_detour_cache cache;
+    tests::benchmark("cached open", 200000, [&](size_t i) {
+        overriden += cache.resolve<max_path>(args[i % args.size()].c_str(), [&](const char* arg, char* fullpath) {
+            return detour.resolve(arg, fullpath);
+        }).overriden();
+    });
+    CHECK(overriden == 200000);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The std.stream entity index against a sweep of the pools for each refresh, over synthetic pools
+ *
+ */
+#include "test.hpp"
+#include "../plugins/gta3/std.stream/entity_index.hpp"
+#include <map>
+#include <random>
+
+struct fake_entity { int model; };
+
+// Same interface the index uses from CPool
+struct fake_pool
+{
+    int                         m_Size;
+    std::vector<fake_entity>    slots;
+    std::vector<bool>           used;
+
+    fake_pool(std::mt19937& rng, int size, int nmodels) : m_Size(size), slots(size), used(size)
+    {
+        for(int i = 0; i < size; ++i)
+        {
+            used[i] = (rng() % 4) != 0;
+            slots[i].model = int(rng() % nmodels);
+        }
+    }
+
+    fake_entity* GetAt(int i) { return used[i]? &slots[i] : nullptr; }
+};
+
+struct fake_traits
+{
+    using id_t = int;
+    static id_t GetEntityModel(void* entity) { return static_cast<fake_entity*>(entity)->model; }
+};
+
+// Entities using the models in @models, by sweeping the pools as the refresher did before the index
+static std::vector<std::pair<int, void*>> sweep(std::vector<fake_pool>& pools, const std::map<int, bool>& models)
+{
+    std::vector<std::pair<int, void*>> out;
+    for(auto& model : models)
+        for(auto& pool : pools)
+            for(int i = 0; i < pool.m_Size; ++i)
+                if(auto* e = pool.GetAt(i))
+                    if(e->model == model.first) out.emplace_back(e->model, e);
+    return out;
+}
+
+TEST(entity_index_same_as_sweep)
+{
+    std::mt19937 rng(38);
+    for(int round = 0; round < 50; ++round)
+    {
+        std::vector<fake_pool> pools;
+        for(int p = 0; p < 4; ++p) pools.emplace_back(rng, 1 + int(rng() % 500), 1 + int(rng() % 100));
+
+        entity_model_index<fake_traits> index;
+        CHECK(!index.ready());
+        for(auto& pool : pools) index.add_pool(&pool);
+        CHECK(index.ready());
+
+        // Many refreshes share the index, as in a batch
+        for(int refresh = 0; refresh < 20; ++refresh)
+        {
+            std::map<int, bool> models;
+            int nmodels = int(rng() % 5);
+            for(int m = 0; m < nmodels; ++m) models[int(rng() % 120)] = true;
+
+            std::vector<std::pair<int, void*>> found;
+            index.find_all(models, [&](int id, void* entity) { found.emplace_back(id, entity); });
+            CHECK(found == sweep(pools, models));    // same entities in the same pool and slot order
+        }
+
+        index.clear();
+        CHECK(!index.ready());
+        size_t count = 0;
+        index.find(0, [&](int, void*) { ++count; });
+        CHECK(count == 0);
+    }
+}
+
+BENCH(entity_index_refreshes)
+{
+    // A batch of 200 refreshes (IDE lines) of one model each, over 10k slots of pools
+    std::mt19937 rng(39);
+    std::vector<fake_pool> pools;
+    for(int p = 0; p < 4; ++p) pools.emplace_back(rng, 2500, 20000);
+
+    size_t found = 0;
+    tests::benchmark("sweep the pools on each refresh", 20, [&](size_t) {
+        for(int line = 0; line < 200; ++line)
+            found += sweep(pools, std::map<int, bool> { { line * 97, true } }).size();
+    });
+    tests::benchmark("index the pools once per batch", 20, [&](size_t) {
+        entity_model_index<fake_traits> index;
+        for(auto& pool : pools) index.add_pool(&pool);
+        for(int line = 0; line < 200; ++line)
+            index.find_all(std::map<int, bool> { { line * 97, true } }, [&](int, void*) { ++found; });
+    });
+    tests::keep(found);
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The per-mod file arena of the core, against a std::map of strings
+ *
+ */
+#include "test.hpp"
+#include "../core/file_arena.hpp"
+#include <map>
+#include <random>
+
+// Record like the core FileInformation, the key is the path past the mod directory
+struct fake_file
+{
+    const char* buffer;
+    size_t      length;
+    size_t      pos_filedir;
+    int         value;
+
+    fake_file(const char* buffer, size_t length, size_t pos_filedir, int value) :
+        buffer(buffer), length(length), pos_filedir(pos_filedir), value(value)
+    {}
+
+    const char* key() const            { return buffer + pos_filedir; }
+    const char* filebuffer() const     { return buffer; }
+    size_t filebuffer_len() const      { return length; }
+};
+
+static const std::string mod_path = "modloader/some mod/";
+
+static fake_file& add(file_arena<fake_file>& arena, const std::string& name, int value)
+{
+    std::string path = mod_path + name;
+    const char* p = arena.store_path(path.data(), path.length());
+    return arena.emplace(p, path.length(), mod_path.length(), value);
+}
+
+static std::vector<std::string> keys(file_arena<fake_file>& arena)
+{
+    std::vector<std::string> out;
+    for(auto& f : arena) out.emplace_back(f.key());
+    return out;
+}
+
+TEST(file_arena_index_and_order)
+{
+    file_arena<fake_file> arena;
+    add(arena, "b.dff", 2);
+    add(arena, "a.dff", 1);
+    add(arena, "dir/c.txd", 3);
+
+    CHECK(arena.size() == 3);
+    CHECK(arena.find("a.dff") && arena.find("a.dff")->value == 1);
+    CHECK(std::string(arena.find("dir/c.txd")->filebuffer()) == mod_path + "dir/c.txd");
+    CHECK(arena.find("c.txd") == nullptr);
+    CHECK((keys(arena) == std::vector<std::string> { "a.dff", "b.dff", "dir/c.txd" }));
+
+    // Erasing through the iterator keeps iterating
+    for(auto it = arena.begin(); it != arena.end(); )
+    {
+        if(it->value == 2) it = arena.erase(it);
+        else ++it;
+    }
+    CHECK((keys(arena) == std::vector<std::string> { "a.dff", "dir/c.txd" }));
+
+    arena.erase(*arena.find("a.dff"));
+    add(arena, "0.dff", 0);
+    CHECK((keys(arena) == std::vector<std::string> { "0.dff", "dir/c.txd" }));
+    CHECK(arena.find("a.dff") == nullptr && arena.find("b.dff") == nullptr);
+
+    arena.clear();
+    CHECK(arena.empty() && arena.begin() == arena.end() && arena.path_capacity() == 0);
+}
+
+TEST(file_arena_same_as_map)
+{
+    std::mt19937 rng(42);
+    file_arena<fake_file> arena;
+    std::map<std::string, int> model;
+
+    for(int step = 0; step < 20000; ++step)
+    {
+        std::string name = "file" + std::to_string(rng() % 500) + (rng() % 2? ".dff" : ".txd");
+        bool in_model = model.count(name) != 0;
+        CHECK(in_model == (arena.find(name.c_str()) != nullptr));
+
+        if(!in_model)
+        {
+            int value = int(rng());
+            add(arena, name, value);
+            model[name] = value;
+        }
+        else if(rng() % 2)
+        {
+            arena.erase(*arena.find(name.c_str()));
+            model.erase(name);
+        }
+        else
+        {
+            CHECK(arena.find(name.c_str())->value == model[name]);
+            CHECK(std::string(arena.find(name.c_str())->filebuffer()) == mod_path + name);
+        }
+
+        if(step % 1000 == 0)
+        {
+            std::vector<std::string> expected;
+            for(auto& pair : model) expected.push_back(pair.first);
+            CHECK(keys(arena) == expected);
+        }
+    }
+    CHECK(arena.size() == model.size());
+}
+
+TEST(file_arena_reuses_paths)
+{
+    // Hot refreshes removing and adding files must not grow the arena forever
+    file_arena<fake_file> arena;
+    add(arena, "keep.txt", 0);  // keeps the arena from being emptied
+
+    size_t capacity = 0;
+    for(int round = 0; round < 200; ++round)
+    {
+        for(int i = 0; i < 1000; ++i)
+            add(arena, "models/file" + std::to_string(round % 7) + "_" + std::to_string(i) + ".dff", i);
+
+        for(auto it = arena.begin(); it != arena.end(); )
+        {
+            if(it->value != 0 || std::string(it->key()) != "keep.txt") it = arena.erase(it);
+            else ++it;
+        }
+
+        if(round == 10) capacity = arena.path_capacity();
+    }
+
+    CHECK(arena.size() == 1 && arena.find("keep.txt") != nullptr);
+    CHECK(arena.path_capacity() == capacity);
+    CHECK(arena.path_capacity() <= 2 * 64 * 1024);
+
+    // Paths of different sizes every round free whole chunks instead
+    for(int round = 0; round < 50; ++round)
+    {
+        std::string dir = "d" + std::string(size_t(round), 'x') + "/";
+        for(int i = 0; i < 2000; ++i)
+            add(arena, dir + std::to_string(i), 1);
+        for(int i = 0; i < 2000; ++i)
+            arena.erase(*arena.find((dir + std::to_string(i)).c_str()));
+    }
+    CHECK(arena.size() == 1);
+    CHECK(arena.path_capacity() <= 3 * 64 * 1024);
+    CHECK(arena.path_released() <= arena.path_capacity());
+}
+
+BENCH(file_arena_scan)
+{
+    std::vector<std::string> names;
+    for(int i = 0; i < 20000; ++i)
+        names.push_back("models/generic/file" + std::to_string(i * 7919 % 20000) + ".dff");
+    std::sort(names.begin(), names.end());  // as the directory walker gives them
+
+    struct map_record { std::string path; int value; };
+
+    tests::benchmark("std::map add 20k files", 50, [&](size_t) {
+        std::map<std::string, map_record> files;
+        for(auto& name : names) files.emplace(name, map_record { mod_path + name, 1 });
+        tests::keep(files.size());
+    });
+    tests::benchmark("file_arena add 20k files", 50, [&](size_t) {
+        file_arena<fake_file> arena;
+        for(auto& name : names) add(arena, name, 1);
+        tests::keep(arena.size());
+    });
+
+    // Allocations to hold the files (the paths are built beforehand as the scanner reuses a buffer for them)
+    // The map has a node, a key and a path per file, the arena an index node per file and the chunks and blocks
+    std::vector<std::string> paths;
+    for(auto& name : names) paths.push_back(mod_path + name);
+
+    size_t before = tests::allocations();
+    std::map<std::string, map_record> files;
+    for(size_t i = 0; i < names.size(); ++i) files.emplace(names[i], map_record { paths[i], 1 });
+    size_t map_allocations = tests::allocations() - before;
+
+    before = tests::allocations();
+    file_arena<fake_file> arena;
+    for(auto& path : paths)
+        arena.emplace(arena.store_path(path.data(), path.length()), path.length(), mod_path.length(), 1);
+    size_t arena_allocations = tests::allocations() - before;
+
+    printf("    allocations for 20k files: %u std::map, %u file_arena\n", unsigned(map_allocations), unsigned(arena_allocations));
+    CHECK(map_allocations >= 3 * names.size() && arena_allocations < map_allocations / 2);
+
+    size_t found = 0;
+    tests::benchmark("std::map rescan 20k files", 50, [&](size_t) {
+        for(auto& name : names) found += files.count(name);
+        for(auto& pair : files) found += pair.second.value;
+        tests::keep(found);
+    });
+    tests::benchmark("file_arena rescan 20k files", 50, [&](size_t) {
+        for(auto& name : names) found += (arena.find(name.c_str()) != nullptr);
+        for(auto& f : arena) found += f.value;
+        tests::keep(found);
+    });
+    tests::benchmark("file_arena refresh 1k of 20k files", 500, [&](size_t i) {
+        auto& name = names[(i * 1000) % names.size()];
+        for(size_t k = 0; k < 1000; ++k) arena.erase(*arena.find(names[(i * 1000 + k) % names.size()].c_str()));
+        for(size_t k = 0; k < 1000; ++k) add(arena, names[(i * 1000 + k) % names.size()], 1);
+        found += name.size();
+    });
+    CHECK(arena.size() == names.size());
+    printf("    path bytes: %u allocated, %u released\n", unsigned(arena.path_capacity()), unsigned(arena.path_released()));
+}
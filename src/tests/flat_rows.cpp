@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The datalib flat rows against the cereal archives they replace in the std.data store cache
+ *
+ */
+#include "test.hpp"
+#include <datalib/flat_rows.hpp>
+#include <datalib/data_slice.hpp>
+#include <datalib/data_store.hpp>
+#include <datalib/detail/flat_sorted_map.hpp>
+#include <datalib/detail/either.hpp>
+#include <datalib/detail/optional.hpp>
+#include <datalib/io/either.hpp>
+#include <datalib/io/tuple.hpp>
+#include <datalib/io/array.hpp>
+#include <datalib/io/string.hpp>
+#include <datalib/io/ignore.hpp>
+#include <datalib/io/hex.hpp>
+#include <datalib/io/tagged_type.hpp>
+#include <type_wrapper/floating_point.hpp>
+#include <type_wrapper/datalib/io/floating_point.hpp>
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/array.hpp>
+#include <cereal/types/bitset.hpp>
+#include <cereal/types/boost_variant.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/tuple.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/boost_optional.hpp>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+
+using namespace datalib;
+
+// Serializer for type_wrapper<> as std.data has it (see utility.hpp)
+template<class Archive, class T, class Base>
+inline void serialize(Archive& ar, type_wrapper<T, Base>& tw)
+{
+    ar(tw.get_());
+}
+
+namespace
+{
+    // The types of std.data (see utility.hpp)
+    struct tag_insen_t {};
+    using real_t = basic_floating_point<float, floating_point_comparer::relative_epsilon<float>>;
+    template<class T, std::size_t N>
+    using pack = std::array<T, N>;
+    using vec3 = pack<real_t, 3>;
+    using modelname = tagged_type<std::string, tag_insen_t>;
+    using texname   = modelname;
+    using animname  = modelname;
+    using labelname = modelname;
+
+    // ide.cpp sections, as on San Andreas
+    using objs0e = std::tuple<real_t, int>;
+    using objs1e = std::tuple<int, real_t, int>;
+    using objs2e = std::tuple<int, real_t, real_t, int>;
+    using objs3e = std::tuple<int, real_t, real_t, real_t, int>;
+    using ide_objs = data_slice<int, modelname, texname, either<objs3e, objs2e, objs1e, objs0e>>;
+    using ide_cars = data_slice<int, modelname, texname, std::string, std::string, labelname, animname, std::string, int, int, hex<uint32_t>, delimopt, int, real_t, real_t, int>;
+
+    // The remaining value kinds, optional values and containers
+    using misc_row = data_slice<int, vec3, pack<bool, 4>, optional<int>, either<real_t, std::string>, delimopt, std::vector<std::string>, std::vector<int16_t>>;
+
+    // Holds a shared pointer, which only cereal knows to write (it tracks the pointers)
+    struct shared_row
+    {
+        std::shared_ptr<int> ptr;
+        bool operator==(const shared_row& rhs) const { return ptr == rhs.ptr; }
+
+        template<class Archive>
+        void serialize(Archive& ar) { ar(ptr); }
+    };
+
+    // A store with its traits, as gta3::data_store serializes itself
+    template<class Map>
+    struct traits_store : data_store<Map>
+    {
+        int eof = 0;
+
+        template<class Archive>
+        void serialize(Archive& ar)
+        {
+            data_store<Map>::serialize(ar);
+            ar(this->eof);
+        }
+    };
+
+    const char* const objs_lines[] = {
+        "615 veg_tree3 gta_tree_boak 1 299 0",
+        "1234 lodbigbridge cs_lod 2 500 500 1048580",
+        "3000 model_x tex_x 3 100 120 150 4",
+        "3001 model_y tex_y 300 2097152",
+    };
+    const char* const cars_lines[] = {
+        "400 landstal landstal car LANDSTAL LANDSTK null richfamily 10 7 0 250 0.768 0.768 0",
+        "522 nrg500 nrg500 bike NRG500 NRG500 bikes bike 5 0 0 16 0.6 0.6 0",
+        "539 vortex vortex car VORTEX VORTEX null ignore 1 0 0",
+    };
+
+    template<class Slice, size_t N>
+    Slice sample_slice(const char* const (&samples)[N], size_t i)
+    {
+        Slice slice;
+        CHECK(slice.parse(samples[i % N]));
+        slice.template set<0>(int(i));
+        return slice;
+    }
+
+    misc_row sample_misc(std::mt19937& rng, size_t i)
+    {
+        misc_row row;
+        row.set<0>(int(i));
+        row.set<1>(vec3 { float(rng() % 1000) / 8.0f, -1.5f, float(i) });
+        row.set<2>(pack<bool, 4> { (rng() & 1) != 0, true, false, (rng() & 1) != 0 });
+        row.set<3>(rng() % 2? optional<int>(int(rng() % 100)) : optional<int>());
+        if(rng() % 2) row.set<4>(either<real_t, std::string>(real_t(0.25f)));
+        else          row.set<4>(either<real_t, std::string>(std::string("name_") + std::to_string(i)));
+        if(rng() % 3)
+        {
+            row.set<6>(std::vector<std::string>(rng() % 4, "item"));
+            row.set<7>(std::vector<int16_t>(rng() % 5, int16_t(i)));
+        }
+        return row;
+    }
+
+    // Stores of @count rows, as the ones in a std.data cache file
+    template<class Map, class MakeRow>
+    traits_store<Map> make_store(size_t count, bool is_default, MakeRow make_row)
+    {
+        traits_store<Map> store;
+        store.set_as_default(is_default);
+        store.set_as_ready(true);
+        store.eof = int(count);
+        for(size_t i = 0; i < count; ++i)
+            store.container().emplace(int(i * 3), make_row(i));
+        return store;
+    }
+
+    template<class T>
+    std::string to_cereal(const T& value)
+    {
+        std::ostringstream ss;
+        {
+            cereal::BinaryOutputArchive archive(ss);
+            archive(const_cast<T&>(value));
+        }
+        return ss.str();
+    }
+
+    template<class T>
+    void from_cereal(const std::string& data, T& value)
+    {
+        std::istringstream ss(data);
+        cereal::BinaryInputArchive archive(ss);
+        archive(value);
+    }
+
+    // Writes @store as flat rows and reads it back, the result must be what cereal wrote and read back
+    template<class Store>
+    void check_same_as_cereal(const Store& store)
+    {
+        std::string rows;
+        CHECK(save_flat_rows(rows, store));
+
+        Store flat, cereal;
+        CHECK(load_flat_rows(rows.data(), rows.size(), flat));
+        from_cereal(to_cereal(store), cereal);
+
+        CHECK(flat.is_default_store() == store.is_default_store() && flat.ready() == store.ready() && flat.eof == store.eof);
+        CHECK(flat.container().size() == store.container().size());
+        CHECK(flat.container() == cereal.container());
+        CHECK(to_cereal(flat) == to_cereal(store));
+
+        // Written again, it's the same bytes
+        std::string again;
+        CHECK(save_flat_rows(again, flat) && again == rows);
+    }
+}
+
+TEST(flat_rows_same_as_cereal)
+{
+    std::mt19937 rng(26);
+    auto objs = [](size_t i) { return sample_slice<ide_objs>(objs_lines, i); };
+    auto cars = [](size_t i) { return sample_slice<ide_cars>(cars_lines, i); };
+    auto misc = [&](size_t i) { return sample_misc(rng, i); };
+
+    for(size_t count : { 0, 1, 7, 300 })
+    {
+        check_same_as_cereal(make_store<std::map<int, ide_objs>>(count, true, objs));
+        check_same_as_cereal(make_store<flat_sorted_map<int, ide_objs>>(count, false, objs));
+        check_same_as_cereal(make_store<std::map<int, ide_cars>>(count, false, cars));
+        check_same_as_cereal(make_store<flat_sorted_map<int, misc_row>>(count, false, misc));
+    }
+
+    // A store that isn't ready, and the parts of a slice that weren't set
+    traits_store<std::map<int, misc_row>> store;
+    misc_row partial;
+    partial.set<0>(1);
+    partial.set<4>(either<real_t, std::string>());
+    store.container().emplace(1, std::move(partial));
+    check_same_as_cereal(store);
+
+    // The slice printed from what's read back is the same as the original
+    auto cars_store = make_store<flat_sorted_map<int, ide_cars>>(3, false, cars);
+    std::string rows;
+    decltype(cars_store) flat;
+    CHECK(save_flat_rows(rows, cars_store) && load_flat_rows(rows.data(), rows.size(), flat));
+    for(size_t i = 0; i < 3; ++i)
+    {
+        std::string a, b;
+        CHECK(cars_store.container().find(int(i * 3))->second.get(a));
+        CHECK(flat.container().find(int(i * 3))->second.get(b));
+        CHECK(a == b && !a.empty());
+    }
+}
+
+TEST(flat_rows_malformed)
+{
+    std::mt19937 rng(27);
+    auto store = make_store<std::map<int, misc_row>>(5, false, [&](size_t i) { return sample_misc(rng, i); });
+    std::string rows;
+    CHECK(save_flat_rows(rows, store));
+
+    // Cut short anywhere, or followed by something else
+    for(size_t size = 0; size < rows.size(); ++size)
+    {
+        decltype(store) loaded;
+        CHECK(!load_flat_rows(rows.data(), size, loaded));
+    }
+    decltype(store) loaded;
+    auto longer = rows + '\0';
+    CHECK(!load_flat_rows(longer.data(), longer.size(), loaded));
+
+    // An either state that doesn't exist
+    std::string bad;
+    either<real_t, std::string> e = real_t(1.0f);
+    CHECK(save_flat_rows(bad, e));
+    bad[0] = 3;
+    CHECK(!load_flat_rows(bad.data(), bad.size(), e));
+
+    // A size larger than the rows
+    bad.clear();
+    CHECK(save_flat_rows(bad, std::vector<int>(4, 1)));
+    bad[3] = 0x7F;
+    std::vector<int> v;
+    CHECK(!load_flat_rows(bad.data(), bad.size(), v));
+}
+
+TEST(flat_rows_fallback)
+{
+    // Shared pointers have no flat form, the cache writes such stores with cereal
+    traits_store<std::map<int, shared_row>> store;
+    store.container()[1].ptr = std::make_shared<int>(5);
+    std::string rows;
+    CHECK(!save_flat_rows(rows, store));
+
+    std::map<int, std::unique_ptr<int>> pointers;
+    rows.clear();
+    CHECK(save_flat_rows(rows, pointers));  // empty, so there's nothing to fail
+    pointers[1].reset(new int(2));
+    rows.clear();
+    CHECK(!save_flat_rows(rows, pointers));
+}
+
+BENCH(flat_rows_load)
+{
+    std::mt19937 rng(28);
+    auto objs = make_store<flat_sorted_map<int, ide_objs>>(20000, false, [](size_t i) { return sample_slice<ide_objs>(objs_lines, i); });
+    auto cars = make_store<std::map<int, ide_cars>>(2000, false, [](size_t i) { return sample_slice<ide_cars>(cars_lines, i); });
+    auto misc = make_store<flat_sorted_map<int, misc_row>>(20000, false, [&](size_t i) { return sample_misc(rng, i); });
+
+    // The cache file holds the flat rows in a cereal string, so reading them takes that copy too
+    auto run = [](const std::string& name, auto& store)
+    {
+        using store_type = typename std::decay<decltype(store)>::type;
+        auto blob = to_cereal(store);
+
+        std::string rows, flat_blob;
+        CHECK(save_flat_rows(rows, store));
+        flat_blob = to_cereal(rows);
+        printf("    %s: cereal %u bytes, flat %u bytes\n", name.c_str(), unsigned(blob.size()), unsigned(flat_blob.size()));
+
+        tests::benchmark((name + " cereal").c_str(), 20, [&](size_t)
+        {
+            store_type loaded;
+            from_cereal(blob, loaded);
+            tests::keep(loaded.container().size());
+        });
+        tests::benchmark((name + " flat").c_str(), 20, [&](size_t)
+        {
+            store_type loaded;
+            std::string data;
+            from_cereal(flat_blob, data);
+            CHECK(load_flat_rows(data.data(), data.size(), loaded));
+            tests::keep(loaded.container().size());
+        });
+    };
+
+    run("ide objs x20000", objs);
+    run("ide cars x2000", cars);
+    run("misc rows x20000", misc);
+}
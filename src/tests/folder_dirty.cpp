@@ -0,0 +1,551 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The folder update visiting only the dirty mods and files, over mods and handlers built in memory
+ *
+ */
+#include "test.hpp"
+#include "../core/file_arena.hpp"
+#include "../core/behaviour_arbitration.hpp"
+#include "../core/install_batch.hpp"
+#include "../core/dirty_update.hpp"
+#include <map>
+#include <memory>
+#include <set>
+
+namespace
+{
+    enum class fake_status : uint8_t { Unchanged, Added, Updated, Removed };
+
+    struct fake_folder;
+    struct fake_mod;
+    struct fake_handler;
+
+    // File like the core FileInformation, its key is the path (mod name included)
+    struct fake_file
+    {
+        const char*     buffer;
+        size_t          length;
+        fake_mod&       parent;
+        fake_handler*   handler;
+        uint64_t        behaviour;
+        bool            installed;
+        bool            waiting;
+        fake_status     status;
+
+        fake_file(const char* buffer, size_t length, fake_mod& parent, fake_handler* handler, uint64_t behaviour) :
+            buffer(buffer), length(length), parent(parent), handler(handler), behaviour(behaviour),
+            installed(false), waiting(false), status(fake_status::Added)
+        {}
+
+        const char* key() const            { return buffer; }
+        const char* filebuffer() const     { return buffer; }
+        size_t filebuffer_len() const      { return length; }
+    };
+
+    struct fake_mod
+    {
+        fake_folder&            parent;
+        std::string             name;
+        int                     priority;
+        file_arena<fake_file>   files;
+        std::vector<fake_file*> dirty;
+        fake_status             status;
+        bool                    ignored;
+
+        fake_mod(fake_folder& parent, std::string name, int priority) :
+            parent(parent), name(std::move(name)), priority(priority), status(fake_status::Added), ignored(false)
+        {}
+
+        bool IsIgnored() const  { return ignored; }
+        void SetUnchanged()     { if(status != fake_status::Removed) status = fake_status::Unchanged; }
+    };
+
+    struct fake_folder
+    {
+        std::map<std::string, std::unique_ptr<fake_mod>> mods;
+        std::set<fake_mod*> dirty;
+    };
+
+    using steps = dirty_update<fake_mod, fake_file>;
+    using batch = install_batch<fake_handler, fake_file>;
+
+    // Handler like the core PluginInformation, holding the installed file of each behaviour
+    struct fake_handler
+    {
+        std::map<uint64_t, fake_file*>      behv;
+        std::multimap<uint64_t, fake_file*> waiting;
+        std::set<std::string>               failing;    // Files failing to install and uninstall
+
+        fake_file* FindFileWithBehaviour(uint64_t behaviour)
+        {
+            auto it = behv.find(behaviour);
+            return it != behv.end()? it->second : nullptr;
+        }
+
+        void AddWaiting(fake_file& file)
+        {
+            if(!file.waiting)
+            {
+                waiting.emplace(file.behaviour, &file);
+                file.waiting = true;
+            }
+        }
+
+        void RemoveWaiting(fake_file& file)
+        {
+            if(file.waiting)
+            {
+                auto range = waiting.equal_range(file.behaviour);
+                for(auto it = range.first; it != range.second; ++it)
+                {
+                    if(it->second == &file)
+                    {
+                        waiting.erase(it);
+                        break;
+                    }
+                }
+                file.waiting = false;
+            }
+        }
+
+        void WakeWaiting(uint64_t behaviour)
+        {
+            auto range = waiting.equal_range(behaviour);
+            for(auto it = range.first; it != range.second; )
+            {
+                fake_file& file = *it->second;
+                it = waiting.erase(it);
+                file.waiting = false;
+                steps::mark_dirty_file(file.parent, file);
+            }
+        }
+
+        bool Complete(batch::action act, fake_file& file, bool result)
+        {
+            if(act == batch::action::install && result)
+                CHECK(behv.emplace(file.behaviour, &file).second);
+            else if(act == batch::action::uninstall && result)
+            {
+                behv.erase(file.behaviour);
+                this->WakeWaiting(file.behaviour);
+            }
+            return result;
+        }
+    };
+
+    // Commits the batches as the core FileInformation::Commit does, recording what was sent to the handlers
+    struct fake_hooks
+    {
+        using batch_type       = batch;
+        using arbitration_type = behaviour_arbitration<fake_handler, fake_file>;
+
+        std::vector<std::string> ops;           // "install mod/file" and so on, in commit order
+        std::vector<std::string> visited;       // Mods visited by the install step
+        std::vector<std::string> extinguished;  // Files extinguished
+        std::vector<std::string> blocked_files; // Files whose displaced file failed to uninstall
+
+        bool less(const fake_mod& a, const fake_mod& b) const
+        {
+            return a.priority != b.priority? a.priority < b.priority : a.name < b.name;
+        }
+
+        void extinguishing(fake_mod&, fake_file& file, bool)    { extinguished.emplace_back(file.key()); }
+        void updating(fake_mod& mod)                            { visited.emplace_back(mod.name); }
+        void blocked(fake_file& file)                           { blocked_files.emplace_back(file.key()); }
+
+        void commit(batch& b)
+        {
+            static const char* actions[] = { "uninstall ", "reinstall ", "install " };
+            for(auto& op : b)
+            {
+                fake_file& file = *op.file;
+                ops.emplace_back(actions[size_t(op.act)] + std::string(file.key()));
+                CHECK(file.installed == (op.act != batch::action::install));
+
+                bool result = !(op.plugin && op.plugin->failing.count(file.key()));
+                bool done = op.plugin? op.plugin->Complete(op.act, file, result) : true;
+                file.installed = (op.act == batch::action::uninstall)? !done : done;
+                if(file.status != fake_status::Removed)
+                    file.status = fake_status::Unchanged;
+            }
+        }
+    };
+
+    using strings = std::vector<std::string>;
+
+    // A mods folder scanned and updated as the core does, but the scan is told what changed on the disk
+    struct fake_tree
+    {
+        fake_folder                 folder;
+        fake_handler                handlers[2];
+        fake_hooks                  last;       // Hooks of the last update
+
+        fake_mod& add_mod(const std::string& name, int priority = 50)
+        {
+            auto& mod = folder.mods[name];
+            mod.reset(new fake_mod(folder, name, priority));
+            return *mod;
+        }
+
+        fake_mod& mod(const std::string& name)
+        {
+            return *folder.mods.at(name);
+        }
+
+        // The file @name added to @mod, handled by @handler (or none if negative) with @behaviour
+        fake_file& add_file(fake_mod& mod, const std::string& name, int handler = 0, uint64_t behaviour = 0)
+        {
+            std::string path = mod.name + "/" + name;
+            const char* p = mod.files.store_path(path.data(), path.length());
+            return mod.files.emplace(p, path.length(), mod, handler >= 0? &handlers[handler] : nullptr, behaviour);
+        }
+
+        fake_file& file(const std::string& path)
+        {
+            auto& m = this->mod(path.substr(0, path.find('/')));
+            fake_file* f = m.files.find(path.c_str());
+            CHECK(f != nullptr);
+            return *f;
+        }
+
+        bool has_file(const std::string& path)
+        {
+            auto it = folder.mods.find(path.substr(0, path.find('/')));
+            return it != folder.mods.end() && it->second->files.find(path.c_str()) != nullptr;
+        }
+
+        // Ends the scan of @mod (see ModInformation::Scan), whose files got their status already
+        void scan(fake_mod& mod, bool reprioritized = false)
+        {
+            if(mod.status != fake_status::Added)
+            {
+                mod.status = fake_status::Unchanged;
+                for(auto& f : mod.files)
+                {
+                    if(f.status != fake_status::Unchanged) { mod.status = fake_status::Updated; break; }
+                }
+            }
+            if(reprioritized && mod.status == fake_status::Unchanged)
+                mod.status = fake_status::Updated;
+            steps::mark_dirty_files(mod, reprioritized);
+        }
+
+        // Full scan, where nothing else changed on the disk
+        void scan_all()
+        {
+            for(auto& pair : folder.mods)
+            {
+                if(pair.second->status != fake_status::Removed)
+                    scan(*pair.second);
+            }
+        }
+
+        void touch(fake_mod& mod, const std::string& name)
+        {
+            file(mod.name + "/" + name).status = fake_status::Updated;
+            scan(mod);
+        }
+
+        void remove_file(fake_mod& mod, const std::string& name)
+        {
+            file(mod.name + "/" + name).status = fake_status::Removed;
+            scan(mod);
+        }
+
+        void set_priority(fake_mod& mod, int priority)
+        {
+            mod.priority = priority;
+            scan(mod, true);
+        }
+
+        // An ignored mod isn't walked, so all its files are gone on the scan
+        void ignore(fake_mod& mod)
+        {
+            mod.ignored = true;
+            for(auto& f : mod.files) f.status = fake_status::Removed;
+            scan(mod);
+        }
+
+        // The mod directory is gone (see FolderInformation::Scan)
+        void remove_mod(fake_mod& mod)
+        {
+            mod.status = fake_status::Removed;
+            folder.dirty.insert(&mod);
+        }
+
+        // Updates the folder, then collects the removed mods with no files left (see FolderInformation::Update)
+        fake_hooks& update()
+        {
+            last = fake_hooks();
+            steps::update(folder.dirty, last);
+
+            for(auto it = folder.mods.begin(); it != folder.mods.end(); )
+            {
+                fake_mod& m = *it->second;
+                if(m.status == fake_status::Removed && m.files.empty())
+                {
+                    CHECK(folder.dirty.count(&m) == 0);
+                    it = folder.mods.erase(it);
+                }
+                else
+                    ++it;
+            }
+            return last;
+        }
+
+        // Whether nothing is left for the next update to visit
+        bool clean()
+        {
+            for(auto& pair : folder.mods)
+            {
+                if(!pair.second->dirty.empty()) return false;
+            }
+            return folder.dirty.empty();
+        }
+
+        // The file installed with @behaviour by @handler, as a path
+        std::string holder(int handler, uint64_t behaviour)
+        {
+            fake_file* f = handlers[handler].FindFileWithBehaviour(behaviour);
+            return f? f->key() : "";
+        }
+    };
+}
+
+TEST(folder_dirty_add_mod)
+{
+    fake_tree t;
+    auto& a = t.add_mod("a");
+    t.add_file(a, "a.dff", 0, 1);
+    t.add_file(a, "a.txd", 0, 2);
+    t.add_file(a, "readme.txt", -1);
+    auto& b = t.add_mod("b");
+    t.add_file(b, "b.dff", 0, 3);
+    t.add_file(b, "b.ifp", 1, 1);
+    t.scan_all();
+
+    auto& u = t.update();
+    CHECK((u.ops == strings { "install a/a.dff", "install a/a.txd", "install a/readme.txt", "install b/b.dff", "install b/b.ifp" }));
+    CHECK((u.visited == strings { "a", "b" }));
+    CHECK(t.clean() && t.holder(0, 3) == "b/b.dff" && t.holder(1, 1) == "b/b.ifp");
+
+    // Nothing changed, nothing is visited
+    t.scan_all();
+    CHECK(t.clean());
+    CHECK(t.update().ops.empty() && t.last.visited.empty());
+
+    // A new mod, only it is visited
+    auto& c = t.add_mod("c", 40);
+    t.add_file(c, "c.col", 1, 2);
+    t.scan_all();
+    CHECK((t.update().ops == strings { "install c/c.col" }));
+    CHECK((t.last.visited == strings { "c" }) && t.clean());
+}
+
+TEST(folder_dirty_single_file)
+{
+    fake_tree t;
+    auto& a = t.add_mod("a");
+    t.add_file(a, "a.dff", 0, 1);
+    t.add_file(a, "a.txd", 0, 2);
+    auto& b = t.add_mod("b");
+    t.add_file(b, "b.dff", 0, 3);
+    t.scan_all();
+    t.update();
+
+    // An updated file is the only one reinstalled, its mod is marked with only it to visit
+    t.touch(a, "a.txd");
+    CHECK((t.folder.dirty == std::set<fake_mod*> { &a }) && a.dirty.size() == 1 && b.dirty.empty());
+    CHECK((t.update().ops == strings { "reinstall a/a.txd" }));
+    CHECK((t.last.visited == strings { "a" }) && t.clean());
+
+    // A file added and another removed in the same mod
+    t.add_file(b, "b2.dff", 0, 4);
+    t.remove_file(b, "b.dff");
+    CHECK(b.dirty.size() == 2 && a.dirty.empty());
+    CHECK((t.update().ops == strings { "uninstall b/b.dff", "install b/b2.dff" }));
+    CHECK((t.last.extinguished == strings { "b/b.dff" }) && (t.last.visited == strings { "b" }));
+    CHECK(!t.has_file("b/b.dff") && t.holder(0, 3) == "" && t.holder(0, 4) == "b/b2.dff" && t.clean());
+
+    // A file failing to install keeps its mod dirty, only it is tried again
+    t.handlers[0].failing.insert("a/a2.dff");
+    t.add_file(a, "a2.dff", 0, 5);
+    t.scan(a);
+    CHECK((t.update().ops == strings { "install a/a2.dff" }));
+    CHECK((t.folder.dirty == std::set<fake_mod*> { &a }) && (a.dirty == std::vector<fake_file*> { &t.file("a/a2.dff") }));
+
+    t.handlers[0].failing.clear();
+    CHECK((t.update().ops == strings { "install a/a2.dff" }));
+    CHECK(t.file("a/a2.dff").installed && t.clean());
+}
+
+TEST(folder_dirty_losing_arbitration)
+{
+    fake_tree t;
+    auto& a = t.add_mod("a", 50);
+    t.add_file(a, "x.dff", 0, 7);
+    t.add_file(a, "y.dff", 0, 8);
+    auto& b = t.add_mod("b", 60);
+    t.add_file(b, "x.dff", 0, 7);
+    t.scan_all();
+
+    // The file of the lower priority mod never gets installed, it waits for the behaviour instead of being visited again
+    CHECK((t.update().ops == strings { "install a/y.dff", "install b/x.dff" }));
+    CHECK(t.file("a/x.dff").waiting && !t.file("a/x.dff").installed && t.clean());
+
+    // Scanning its mod again arbitrates it again, to lose again
+    t.scan_all();
+    CHECK((a.dirty == std::vector<fake_file*> { &t.file("a/x.dff") }) && !t.file("a/x.dff").waiting);
+    CHECK(t.update().ops.empty() && t.file("a/x.dff").waiting && t.clean());
+
+    // Other changes of the winner mod don't wake it
+    t.add_file(b, "z.dff", 0, 9);
+    t.scan(b);
+    CHECK((t.update().ops == strings { "install b/z.dff" }) && (t.last.visited == strings { "b" }));
+    CHECK(t.file("a/x.dff").waiting && t.clean());
+
+    // The winner going away wakes it, its mod is visited without being scanned
+    t.remove_file(b, "x.dff");
+    CHECK((t.folder.dirty == std::set<fake_mod*> { &b }));
+    CHECK((t.update().ops == strings { "uninstall b/x.dff", "install a/x.dff" }));
+    CHECK((t.last.visited == strings { "a", "b" }) && t.holder(0, 7) == "a/x.dff" && t.clean());
+
+    // And coming back displaces it, which then waits again
+    t.add_file(b, "x.dff", 0, 7);
+    t.scan(b);
+    CHECK((t.update().ops == strings { "uninstall a/x.dff", "install b/x.dff" }));
+    CHECK((t.last.visited == strings { "b" }) && t.file("a/x.dff").waiting && t.clean());
+
+    // A file whose displaced file failed to uninstall waits for it, until its mod is scanned again
+    t.handlers[0].failing.insert("b/x.dff");
+    auto& c = t.add_mod("c", 70);
+    t.add_file(c, "x.dff", 0, 7);
+    t.scan(c);
+    CHECK((t.update().ops == strings { "uninstall b/x.dff" }));
+    CHECK((t.last.blocked_files == strings { "c/x.dff" }) && t.holder(0, 7) == "b/x.dff");
+    CHECK(t.file("c/x.dff").waiting && t.clean());
+
+    t.handlers[0].failing.clear();
+    t.scan(c);
+    CHECK((t.update().ops == strings { "uninstall b/x.dff", "install c/x.dff" }));
+    CHECK(t.file("b/x.dff").waiting && t.file("a/x.dff").waiting && t.clean());
+}
+
+TEST(folder_dirty_priority_change)
+{
+    fake_tree t;
+    auto& a = t.add_mod("a", 50);
+    t.add_file(a, "x.dff", 0, 1);
+    t.add_file(a, "y.dff", 0, 2);
+    auto& b = t.add_mod("b", 60);
+    t.add_file(b, "x.dff", 0, 1);
+    auto& c = t.add_mod("c", 50);
+    t.add_file(c, "c.dff", 0, 3);
+    t.scan_all();
+    t.update();
+    CHECK(t.holder(0, 1) == "b/x.dff" && t.file("a/x.dff").waiting);
+
+    // Raising the priority of the waiting mod gets its file installed, displacing the other one
+    t.set_priority(a, 70);
+    CHECK((t.folder.dirty == std::set<fake_mod*> { &a }) && (a.dirty == std::vector<fake_file*> { &t.file("a/x.dff") }));
+    CHECK((t.update().ops == strings { "uninstall b/x.dff", "install a/x.dff" }));
+    CHECK((t.last.visited == strings { "a" }) && t.file("b/x.dff").waiting && t.clean());
+
+    // Lowering it back wakes the files it had displaced
+    t.set_priority(a, 40);
+    CHECK((t.folder.dirty == std::set<fake_mod*> { &a, &b }) && a.dirty.empty() && c.dirty.empty());
+    CHECK((t.update().ops == strings { "uninstall a/x.dff", "install b/x.dff" }));
+    CHECK((t.last.visited == strings { "a", "b" }) && t.file("a/x.dff").waiting && t.clean());
+
+    // A priority change which changes no winner installs nothing
+    t.set_priority(a, 45);
+    CHECK(t.update().ops.empty() && t.file("a/x.dff").waiting && t.clean());
+}
+
+TEST(folder_dirty_remove_and_reenable_mod)
+{
+    fake_tree t;
+    auto& a = t.add_mod("a", 50);
+    t.add_file(a, "x.dff", 0, 1);
+    auto& b = t.add_mod("b", 60);
+    t.add_file(b, "x.dff", 0, 1);
+    t.add_file(b, "b.txd", 1, 2);
+    auto& c = t.add_mod("c", 50);
+    t.add_file(c, "c.dff", 0, 3);
+    t.scan_all();
+    t.update();
+
+    // Disabling a mod uninstalls all its files, the file it displaced comes back
+    t.ignore(b);
+    CHECK((t.folder.dirty == std::set<fake_mod*> { &b }) && c.dirty.empty());
+    CHECK((t.update().ops == strings { "uninstall b/b.txd", "uninstall b/x.dff", "install a/x.dff" }));
+    CHECK((t.last.visited == strings { "a" }) && b.files.empty() && t.holder(0, 1) == "a/x.dff" && t.clean());
+
+    // Re-enabling it finds all its files again, only those and the displaced one are touched
+    b.ignored = false;
+    t.add_file(b, "x.dff", 0, 1);
+    t.add_file(b, "b.txd", 1, 2);
+    t.scan(b);
+    CHECK((t.update().ops == strings { "uninstall a/x.dff", "install b/b.txd", "install b/x.dff" }));
+    CHECK((t.last.visited == strings { "b" }) && t.file("a/x.dff").waiting && t.clean());
+
+    // Removing it gives the behaviour back again, and the mod is collected
+    t.remove_mod(b);
+    CHECK((t.update().ops == strings { "uninstall b/b.txd", "uninstall b/x.dff", "install a/x.dff" }));
+    CHECK((t.last.extinguished == strings { "b/b.txd", "b/x.dff" }) && (t.last.visited == strings { "a", "b" }));
+    CHECK(t.folder.mods.count("b") == 0 && t.holder(0, 1) == "a/x.dff" && t.holder(1, 2) == "" && t.clean());
+
+    // A removed mod whose file fails to uninstall stays dirty until it goes
+    t.handlers[0].failing.insert("c/c.dff");
+    t.remove_mod(c);
+    CHECK((t.update().ops == strings { "uninstall c/c.dff" }));
+    CHECK(t.folder.mods.count("c") && (t.folder.dirty == std::set<fake_mod*> { &c }));
+    t.handlers[0].failing.clear();
+    CHECK((t.update().ops == strings { "uninstall c/c.dff" }));
+    CHECK(t.folder.mods.count("c") == 0 && t.clean());
+}
+
+// Mods made of many files, one of them updated at a time (as the hot refresh does), against updating by visiting every file
+BENCH(folder_dirty_single_file_updates)
+{
+    const size_t nmods = 200, nfiles = 500;
+
+    fake_tree t;
+    std::vector<fake_mod*> mods;
+    for(size_t m = 0; m < nmods; ++m)
+    {
+        auto& mod = t.add_mod("mod" + std::to_string(m), int(m % 10));
+        for(size_t f = 0; f < nfiles; ++f)
+            t.add_file(mod, "file" + std::to_string(f) + ".dff", 0, m * nfiles + f);
+        mods.push_back(&mod);
+    }
+    t.scan_all();
+    t.update();
+
+    std::vector<fake_file*> files;
+    for(auto* mod : mods)
+    {
+        for(auto& f : mod->files) files.push_back(&f);
+    }
+
+    size_t ops = 0;
+    tests::benchmark("update one file (dirty)", 2000, [&](size_t i)
+    {
+        fake_file& file = *files[(i * 7919) % files.size()];
+        file.status = fake_status::Updated;
+        t.scan(file.parent);
+        ops += t.update().ops.size();
+    });
+
+    tests::benchmark("update one file (visit all files)", 20, [&](size_t i)
+    {
+        fake_file& file = *files[(i * 7919) % files.size()];
+        file.status = fake_status::Updated;
+        t.scan_all();
+        ops += t.update().ops.size();
+    });
+
+    tests::keep(ops);
+}
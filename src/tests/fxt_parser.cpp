@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  FXT buffer parsing against the line by line (fgets) parser it replaced
+ *
+ */
+#include "test.hpp"
+#include <fxt_parser/fxt_buffer.hpp>
+#include <cctype>
+#include <random>
+#include <utility>
+
+using fxt_pairs = std::vector<std::pair<std::string, std::string>>;
+
+// The previous parser, which read the file line by line into a 1024 bytes buffer
+static bool ParseFXTByLine(const char* filename, fxt_pairs& out)
+{
+    if(FILE* f = fopen(filename, "r"))
+    {
+        char buf[1024];
+        while(fgets(buf, sizeof(buf), f))
+        {
+            char *key = 0, *value = 0;
+            for(char* p = buf; *p; ++p)
+            {
+                if(*p == '#' || *p == '\r' || *p == '\n')
+                {
+                    *p = 0;
+                    break;
+                }
+
+                if(key == 0)
+                {
+                    if(*p == 0x20 || (*p >= 0x09 && *p <= 0x0D))
+                    {
+                        *p = 0;
+                        key = buf;
+                    }
+                }
+                else if(value == 0)
+                {
+                    value = p;
+                }
+            }
+            if(key && value) out.emplace_back(key, value);
+        }
+        fclose(f);
+        return true;
+    }
+    return false;
+}
+
+static fxt_pairs ParseBuffer(const std::string& text)
+{
+    fxt_pairs out;
+    injector::ParseFXTBuffer(text.data(), text.size(), [&](const char* key, size_t key_length, const char* value, size_t value_length)
+    {
+        out.emplace_back(std::string(key, key_length), std::string(value, value_length));
+    });
+    return out;
+}
+
+TEST(fxt_parse_buffer)
+{
+    auto pairs = ParseBuffer("KEY1 Value one\r\n"
+                             "# comment line\n"
+                             "KEY2\tTabbed value # trailing comment\n"
+                             "NOVALUE\n"
+                             "NOVALUE2 \n"
+                             "\n"
+                             "KEY3  two spaces\n"
+                             "LAST no newline");
+
+    CHECK(pairs.size() == 4);
+    CHECK((pairs[0] == std::make_pair(std::string("KEY1"), std::string("Value one"))));
+    CHECK((pairs[1] == std::make_pair(std::string("KEY2"), std::string("Tabbed value "))));
+    CHECK((pairs[2] == std::make_pair(std::string("KEY3"), std::string(" two spaces"))));
+    CHECK((pairs[3] == std::make_pair(std::string("LAST"), std::string("no newline"))));
+}
+
+TEST(fxt_long_lines)
+{
+    // The line by line parser split lines longer than its buffer, the buffer parser has no limit
+    std::string value(5000, 'x');
+    auto pairs = ParseBuffer("LONG " + value + "\nNEXT y\n");
+    CHECK(pairs.size() == 2 && pairs[0].second == value && pairs[1].first == "NEXT");
+}
+
+TEST(fxt_same_as_line_parser)
+{
+    std::mt19937 rng(1234);
+    const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_ \t#\r\n~!abc";
+
+    tests::temp_dir dir;
+    for(int round = 0; round < 200; ++round)
+    {
+        // Random content made of short lines (shorter than the buffer of the line by line parser)
+        std::string text;
+        int nlines = std::uniform_int_distribution<int>(0, 60)(rng);
+        for(int l = 0; l < nlines; ++l)
+        {
+            int len = std::uniform_int_distribution<int>(0, 80)(rng);
+            for(int i = 0; i < len; ++i)
+            {
+                char c = alphabet[std::uniform_int_distribution<int>(0, sizeof(alphabet) - 2)(rng)];
+                if(c != '\n') text.push_back(c);
+            }
+            if(l + 1 != nlines || rng() % 2) text.push_back('\n');
+        }
+
+        CHECK(dir.write("a.fxt", text));
+
+        fxt_pairs by_line;
+        std::vector<char> buffer;
+        CHECK(ParseFXTByLine((dir / "a.fxt").c_str(), by_line));
+        CHECK(injector::ReadFXTFile((dir / "a.fxt").c_str(), buffer));
+        CHECK(std::string(buffer.begin(), buffer.end()) == text);
+        CHECK(ParseBuffer(text) == by_line);
+    }
+}
+
+TEST(fxt_entries)
+{
+    struct fake_manager
+    {
+        using hash_type = uint32_t;
+        static hash_type hash(const char* key, size_t length)
+        {
+            hash_type h = 2166136261u;
+            for(size_t i = 0; i < length; ++i) h = (h ^ uint8_t(toupper(key[i]))) * 16777619u;
+            return h;
+        }
+    } manager;
+
+    std::string text = "abc 1\nABC 2\nxyz 3\n";
+    std::vector<injector::fxt_entry<uint32_t>> entries;
+    injector::ParseFXTBuffer(manager, text.data(), text.size(), entries);
+
+    CHECK(entries.size() == 3);
+    CHECK(entries[0].hash == entries[1].hash && entries[0].hash != entries[2].hash);
+    CHECK(std::string(entries[2].value, entries[2].length) == "3");
+    CHECK(entries[2].value == text.data() + text.size() - 2);  // points into the buffer
+
+    std::vector<char> buffer;
+    CHECK(!injector::ReadFXTFile("/nonexistent/dir/a.fxt", buffer));
+}
+
+BENCH(fxt_parse)
+{
+    // The corpus of the request, 50k keys, reported in keys per second
+    const size_t keys = 50000, runs = 20;
+    std::string text;
+    for(size_t i = 0; i < keys; ++i)
+        text += "KEY" + std::to_string(i) + " Some text value for the key number " + std::to_string(i) + "\n";
+
+    tests::temp_dir dir;
+    dir.write("a.fxt", text);
+
+    size_t count = 0;
+    double line = tests::benchmark("fgets line parser (50k keys)", runs, [&](size_t) {
+        fxt_pairs out; out.reserve(keys);
+        ParseFXTByLine((dir / "a.fxt").c_str(), out);
+        count += out.size();
+    });
+    double buffer = tests::benchmark("buffer parser (50k keys)", runs, [&](size_t) {
+        std::vector<char> buffer;
+        injector::ReadFXTFile((dir / "a.fxt").c_str(), buffer);
+        injector::ParseFXTBuffer(buffer.data(), buffer.size(), [&](const char*, size_t, const char*, size_t) { ++count; });
+    });
+    printf("    %-40s %12.0f keys/sec\n", "fgets line parser", line * keys);
+    printf("    %-40s %12.0f keys/sec\n", "buffer parser", buffer * keys);
+    CHECK(count == keys * runs * 2);
+}
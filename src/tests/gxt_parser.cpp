@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  GXT table index and its diff, over SA and VC images built in memory
+ *
+ */
+#include "test.hpp"
+#include <gxt_parser/gxt_parser.hpp>
+#include <algorithm>
+#include <utility>
+
+using namespace injector;
+
+namespace
+{
+    struct table_src
+    {
+        std::string name;
+        std::vector<std::pair<std::string, std::string>> entries;   // key, text
+    };
+
+    // CRC32 of the key, as the SA TKEY entries hold
+    uint32_t key_crc(const std::string& key)
+    {
+        uint32_t crc = 0xFFFFFFFF;
+        for(char c : key)
+        {
+            crc ^= uint8_t(c);
+            for(int i = 0; i < 8; ++i)
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+        return crc;
+    }
+
+    void put32(std::string& out, uint32_t value)
+    {
+        out.append((const char*)(&value), 4);
+    }
+
+    void put_name(std::string& out, const std::string& name)
+    {
+        char buf[8] = {};
+        memcpy(buf, name.data(), (std::min)(name.size(), sizeof(buf)));
+        out.append(buf, 8);
+    }
+
+    // The TKEY and TDAT blocks of a table, SA keys are CRCs and texts are 8 bits, VC keys are names and texts are 16 bits
+    std::string build_table(gxt_format format, const table_src& table)
+    {
+        std::string tkey, tdat;
+        for(auto& entry : table.entries)
+        {
+            put32(tkey, uint32_t(tdat.size()));
+            if(format == gxt_format::sa)
+                put32(tkey, key_crc(entry.first));
+            else
+                put_name(tkey, entry.first);
+
+            for(char c : entry.second)
+                tdat.append(format == gxt_format::sa? std::string(1, c) : std::string { c, 0 });
+            tdat.append(format == gxt_format::sa? 1 : 2, '\0');
+        }
+
+        std::string out = "TKEY";
+        put32(out, uint32_t(tkey.size()));
+        out += tkey;
+        out += "TDAT";
+        put32(out, uint32_t(tdat.size()));
+        out += tdat;
+        return out;
+    }
+
+    // A GXT image with @tables, MAIN first as the game expects
+    std::string build_gxt(gxt_format format, const std::vector<table_src>& tables)
+    {
+        std::string header, body;
+        if(format == gxt_format::sa)
+            header.append("\x04\x00\x08\x00", 4);
+        header += "TABL";
+        put32(header, uint32_t(tables.size() * 12));
+
+        size_t base = header.size() + tables.size() * 12;
+        for(auto& table : tables)
+        {
+            put_name(header, table.name);
+            put32(header, uint32_t(base + body.size()));
+            if(table.name != "MAIN") put_name(body, table.name);
+            body += build_table(format, table);
+        }
+        return header + body;
+    }
+
+    std::vector<table_src> sample_tables()
+    {
+        return {
+            { "MAIN",  { { "FEM_OK", "OK" }, { "FEM_ON", "ON" }, { "FEM_OFF", "OFF" } } },
+            { "INTRO", { { "INT1_A", "Grove Street. Home." }, { "INT1_B", "At least it was before I..." } } },
+            { "SWEET1", { { "SWE1_A", "Get in the car." } } },
+            { "RYDER1", { { "RYD1_A", "Hey, CJ!" }, { "RYD1_B", "Damn, fool." } } },
+        };
+    }
+
+    gxt_index index_of(gxt_format format, const std::vector<table_src>& tables)
+    {
+        gxt_index index;
+        auto image = build_gxt(format, tables);
+        CHECK(ParseGXTIndex(image.data(), image.size(), index));
+        return index;
+    }
+
+    table_src& table_named(std::vector<table_src>& tables, const std::string& name)
+    {
+        return *std::find_if(tables.begin(), tables.end(), [&](const table_src& t) { return t.name == name; });
+    }
+}
+
+TEST(gxt_parser_index)
+{
+    for(auto format : { gxt_format::sa, gxt_format::vc })
+    {
+        auto tables = sample_tables();
+        auto image  = build_gxt(format, tables);
+
+        gxt_index index;
+        CHECK(GetGXTFormat(image.data(), image.size()) == format);
+        CHECK(ParseGXTIndex(image.data(), image.size(), index));
+        CHECK(index.format == format && index.tables.size() == tables.size());
+
+        // Each table is where the TABL block says, and they follow each other up to the end of the file
+        uint32_t next = uint32_t((format == gxt_format::sa? 4 : 0) + 8 + tables.size() * 12);
+        for(size_t i = 0; i < tables.size() && i < index.tables.size(); ++i)
+        {
+            auto& info = index.tables[i];
+            auto table = build_table(format, tables[i]);
+            CHECK(info.name == tables[i].name && info.offset == next);
+            CHECK(info.size == table.size() + (info.is_main()? 0 : 8));
+            CHECK(info.is_main() || image.compare(info.offset, 8, std::string(tables[i].name).append(8 - tables[i].name.size(), '\0')) == 0);
+            CHECK(image.compare(info.offset + info.size - table.size(), table.size(), table) == 0);
+            next = info.offset + info.size;
+        }
+        CHECK(next == image.size());
+
+        CHECK(index.find("RYDER1") == &index.tables[3] && index.find("NOPE") == nullptr);
+        CHECK(index.tables[1].digest != index.tables[2].digest);
+
+        // The same tables in another file have the same digests, even if they're somewhere else
+        auto moved = tables;
+        moved.erase(moved.begin() + 1);
+        auto moved_index = index_of(format, moved);
+        CHECK(moved_index.find("RYDER1")->digest == index.find("RYDER1")->digest);
+        CHECK(moved_index.find("RYDER1")->offset != index.find("RYDER1")->offset);
+    }
+
+    // III has a single table and no TABL block
+    auto image = build_table(gxt_format::vc, sample_tables()[0]);
+    gxt_index index;
+    CHECK(ParseGXTIndex(image.data(), image.size(), index));
+    CHECK(index.format == gxt_format::iii && index.tables.size() == 1);
+    CHECK(index.tables[0].is_main() && index.tables[0].offset == 0 && index.tables[0].size == image.size());
+}
+
+TEST(gxt_parser_malformed)
+{
+    for(auto format : { gxt_format::sa, gxt_format::vc })
+    {
+        auto image = build_gxt(format, sample_tables());
+        size_t tabl = (format == gxt_format::sa? 4 : 0);
+        gxt_index index;
+
+        // Cut short anywhere
+        for(size_t size : { size_t(0), size_t(3), tabl + 8, tabl + 20, image.size() / 2, image.size() - 1 })
+            CHECK(!ParseGXTIndex(image.data(), size, index) && index.empty());
+
+        // TABL size not made of entries
+        auto bad = image;
+        bad[tabl + 4] += 1;
+        CHECK(!ParseGXTIndex(bad.data(), bad.size(), index) && index.empty());
+
+        // A table offset out of the file, or not at a table
+        bad = image;
+        bad[tabl + 8 + 12 + 8 + 3] = 0x7F;
+        CHECK(!ParseGXTIndex(bad.data(), bad.size(), index) && index.empty());
+        bad = image;
+        bad[tabl + 8 + 12 + 8] += 4;
+        CHECK(!ParseGXTIndex(bad.data(), bad.size(), index) && index.empty());
+    }
+
+    gxt_index index;
+    CHECK(!ParseGXTIndex("GXT?", 4, index) && index.format == gxt_format::unknown);
+}
+
+TEST(gxt_parser_diff)
+{
+    for(auto format : { gxt_format::sa, gxt_format::vc })
+    {
+        auto tables = sample_tables();
+        auto base   = index_of(format, tables);
+
+        // Nothing changed
+        CHECK(DiffGXTIndex(base, index_of(format, tables)).empty());
+
+        // A mission table edited in place (same size), only it changed
+        auto edited = tables;
+        table_named(edited, "SWEET1").entries[0].second = "Get in the van.";
+        auto diff = DiffGXTIndex(base, index_of(format, edited));
+        CHECK(!diff.full && diff.changed == std::vector<std::string> { "SWEET1" } && diff.added.empty() && diff.removed.empty());
+
+        // The last mission table growing moves no other table
+        edited = tables;
+        table_named(edited, "RYDER1").entries.push_back({ "RYD1_C", "Let's roll." });
+        diff = DiffGXTIndex(base, index_of(format, edited));
+        CHECK(!diff.full && diff.changed == std::vector<std::string> { "RYDER1" });
+
+        // A mission table growing in the middle moves the ones after it, whose offsets the game keeps in the TABL block
+        edited = tables;
+        table_named(edited, "INTRO").entries[1].second += " Anyway.";
+        diff = DiffGXTIndex(base, index_of(format, edited));
+        CHECK(diff.full && diff.changed == (std::vector<std::string> { "INTRO", "SWEET1", "RYDER1" }));
+
+        // MAIN is always loaded, so it takes everything
+        edited = tables;
+        table_named(edited, "MAIN").entries[0].second = "Ok";
+        diff = DiffGXTIndex(base, index_of(format, edited));
+        CHECK(diff.full && diff.changed == std::vector<std::string> { "MAIN" });
+
+        // Added and removed tables, the TABL block size changes so every other table moves too
+        edited = tables;
+        edited.push_back({ "BCRASH1", { { "BCR1_A", "Hold on!" } } });
+        diff = DiffGXTIndex(base, index_of(format, edited));
+        CHECK(diff.full && diff.added == std::vector<std::string> { "BCRASH1" } && diff.changed.size() == tables.size() && diff.removed.empty());
+
+        edited = tables;
+        edited.pop_back();
+        diff = DiffGXTIndex(base, index_of(format, edited));
+        CHECK(diff.full && diff.removed == std::vector<std::string> { "RYDER1" } && diff.changed.size() == edited.size() && diff.added.empty());
+
+        // No previous index, or another format
+        CHECK(DiffGXTIndex(gxt_index(), base).full);
+        CHECK(DiffGXTIndex(base, gxt_index()).full);
+        CHECK(DiffGXTIndex(base, index_of(format == gxt_format::sa? gxt_format::vc : gxt_format::sa, tables)).full);
+    }
+}
+
+TEST(gxt_parser_file)
+{
+    tests::temp_dir dir;
+    auto image = build_gxt(gxt_format::sa, sample_tables());
+    CHECK(dir.write("american.gxt", image));
+
+    gxt_index from_file, from_memory;
+    CHECK(ParseGXTIndex((dir / "american.gxt").c_str(), from_file));
+    CHECK(ParseGXTIndex(image.data(), image.size(), from_memory));
+    CHECK(DiffGXTIndex(from_memory, from_file).empty());
+
+    CHECK(dir.write("empty.gxt", ""));
+    CHECK(!ParseGXTIndex((dir / "empty.gxt").c_str(), from_file));
+    CHECK(!ParseGXTIndex((dir / "missing.gxt").c_str(), from_file));
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  linb::basic_ini with the ordered_hash_map containers against the std::map ones
+ *
+ */
+#include "test.hpp"
+#include <ini_parser/ini_parser.hpp>
+
+using ordered_map = linb::ordered_hash_map<std::string, std::string>;
+
+static const char sample_ini[] =
+    "\xEF\xBB\xBF; Leading comment\r\n"
+    "[Config]\n"
+    "  Zeta = 1 \n"
+    "Alpha=2\n"
+    "Empty\n"
+    "Spaced Key =  spaced value  ; comment\n"
+    "Alpha = duplicated\n"
+    "\n"
+    "[ Profiles.Default.Priority ]\r\n"
+    "mod b = 50\n"
+    "mod a = 25\n"
+    "[Profiles.Default.IgnoreMods]\n"
+    "old mod\n"
+    "[Config]\n"
+    "Late = 3";
+
+// Checks whether @a and @b have the same sections, keys and values regardless of order
+template<class IniA, class IniB>
+static bool same_content(const IniA& a, const IniB& b)
+{
+    if(a.size() != b.size()) return false;
+    for(auto& sec : a)
+    {
+        auto& bkeys = const_cast<IniB&>(b).at(sec.first);
+        if(bkeys.size() != sec.second.size()) return false;
+        for(auto& kv : sec.second)
+        {
+            auto it = bkeys.find(kv.first);
+            if(it == bkeys.end() || it->second != kv.second) return false;
+        }
+    }
+    return true;
+}
+
+TEST(ini_parse_same_as_map)
+{
+    linb::ini sorted;
+    linb::ordered_ini ordered;
+    sorted.read_buffer(sample_ini, sizeof(sample_ini) - 1);
+    ordered.read_buffer(sample_ini, sizeof(sample_ini) - 1);
+
+    CHECK(sorted.size() == 3);
+    CHECK(same_content(sorted, ordered));
+    CHECK(ordered.get("Config", "Alpha", "") == "2");   // the first one is kept
+    CHECK(ordered.get("Config", "Spaced Key", "") == "spaced value");
+    CHECK(ordered.get("Config", "Empty", "x") == "");
+    CHECK(ordered.get("Config", "Late", "") == "3");
+    CHECK(ordered.get("Profiles.Default.Priority", "mod a", "") == "25");
+    CHECK(ordered.at("Profiles.Default.IgnoreMods").count("old mod") == 1);
+}
+
+TEST(ini_keeps_insertion_order)
+{
+    linb::ordered_ini ini;
+    ini.read_buffer(sample_ini, sizeof(sample_ini) - 1);
+
+    std::vector<std::string> sections, keys;
+    for(auto& sec : ini) sections.push_back(sec.first);
+    for(auto& kv : ini["Config"]) keys.push_back(kv.first);
+
+    CHECK((sections == std::vector<std::string> { "Config", "Profiles.Default.Priority", "Profiles.Default.IgnoreMods" }));
+    CHECK((keys == std::vector<std::string> { "Zeta", "Alpha", "Empty", "Spaced Key", "Late" }));
+}
+
+TEST(ini_write_round_trip)
+{
+    linb::ini sorted;
+    linb::ordered_ini ordered;
+    sorted.read_buffer(sample_ini, sizeof(sample_ini) - 1);
+    ordered.read_buffer(sample_ini, sizeof(sample_ini) - 1);
+
+    std::string sorted_out, ordered_out;
+    sorted.write_buffer(sorted_out);
+    ordered.write_buffer(ordered_out);
+
+    linb::ini sorted2;
+    linb::ordered_ini ordered2;
+    sorted2.read_buffer(sorted_out.data(), sorted_out.size());
+    ordered2.read_buffer(ordered_out.data(), ordered_out.size());
+    CHECK(same_content(sorted, sorted2));
+    CHECK(same_content(ordered, ordered2));
+    CHECK(same_content(sorted2, ordered2));
+
+    // Writing what has been read gives back the same text
+    std::string ordered_out2;
+    ordered2.write_buffer(ordered_out2);
+    CHECK(ordered_out == ordered_out2);
+    CHECK(ordered_out.find("[Config]\nZeta = 1\nAlpha = 2\nEmpty\n") == 0);
+
+    // And so does the file interface
+    tests::temp_dir dir;
+    CHECK(ordered.write_file(dir / "a.ini"));
+    linb::ordered_ini from_file;
+    CHECK(from_file.read_file((dir / "a.ini").c_str()));
+    CHECK(same_content(ordered, from_file));
+}
+
+TEST(ordered_hash_map_copy_and_move)
+{
+    ordered_map a;
+    a["x"] = "1"; a["y"] = "2"; a["z"] = "3";
+
+    ordered_map b;
+    b["old"] = "0";
+    b = a;                              // as UpdateOldConfig_023_024 does with whole sections
+    a["x"] = "changed";
+    a.erase("y");
+
+    CHECK(b.size() == 3 && b.count("old") == 0);
+    CHECK(b.at("x") == "1" && b.at("y") == "2");
+    CHECK(b.begin()->first == "x" && b.rbegin()->first == "z");
+
+    ordered_map& self = b;
+    b = self;
+    CHECK(b.size() == 3 && b.find("z") != b.end());
+
+    ordered_map c;
+    c = std::move(b);
+    c["w"] = "4";
+    CHECK(c.size() == 4 && c.at("y") == "2" && c.rbegin()->first == "w");
+
+    // Erasing then inserting back moves the key to the end
+    c.erase("x");
+    c["x"] = "5";
+    CHECK(c.begin()->first == "y" && c.rbegin()->first == "x" && c.find("x")->second == "5");
+}
+
+// Builds a profile-like ini with @nsections sections of @nkeys keys each
+static std::string make_big_ini(int nsections, int nkeys)
+{
+    std::string out;
+    for(int s = 0; s < nsections; ++s)
+    {
+        out += "[Profiles.P" + std::to_string(s) + ".Priority]\n";
+        for(int k = 0; k < nkeys; ++k)
+            out += "some mod number " + std::to_string((k * 7919) % nkeys) + " = " + std::to_string(k % 100) + "\n";
+    }
+    return out;
+}
+
+BENCH(ini_parse_and_lookup)
+{
+    std::string text = make_big_ini(4, 5000);
+    linb::ini sorted;
+    linb::ordered_ini ordered;
+
+    tests::benchmark("parse std::map ini (20k keys)", 20, [&](size_t) {
+        sorted.clear(); sorted.read_buffer(text.data(), text.size());
+    });
+    tests::benchmark("parse ordered_hash_map ini (20k keys)", 20, [&](size_t) {
+        ordered.clear(); ordered.read_buffer(text.data(), text.size());
+    });
+
+    std::vector<std::string> keys;
+    for(int k = 0; k < 5000; ++k) keys.push_back("some mod number " + std::to_string(k));
+
+    auto& skeys = sorted["Profiles.P2.Priority"];
+    auto& okeys = ordered["Profiles.P2.Priority"];
+    size_t found = 0;
+    tests::benchmark("lookup std::map key", 2000000, [&](size_t i) {
+        found += skeys.count(keys[i % keys.size()]);
+    });
+    tests::benchmark("lookup ordered_hash_map key", 2000000, [&](size_t i) {
+        found += okeys.count(keys[i % keys.size()]);
+    });
+    CHECK(found == 4000000);
+
+    std::string out;
+    tests::benchmark("write ordered_hash_map ini", 20, [&](size_t) {
+        out.clear(); ordered.write_buffer(out);
+    });
+}
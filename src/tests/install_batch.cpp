@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The install batch against sending each operation to its plugin in order (as the update did before it)
+ *
+ */
+#include "test.hpp"
+#include "../core/install_batch.hpp"
+#include <random>
+
+struct fake_file : modloader_file_t
+{
+    int id;
+};
+
+// A plugin fails the operations on the files with id multiple of its @fail_every, a batch plugin records its calls
+struct fake_plugin
+{
+    bool                has_batch;
+    int                 fail_every;
+    size_t              batch_calls = 0;
+    std::vector<std::pair<int, int>> received;    // (action, file id) in the order received
+
+    fake_plugin(bool has_batch, int fail_every) : has_batch(has_batch), fail_every(fail_every) {}
+
+    bool call(int act, const modloader_file_t* file)
+    {
+        int id = static_cast<const fake_file*>(file)->id;
+        received.emplace_back(act, id);
+        return (id % fail_every) != 0;
+    }
+};
+
+using batch = install_batch<fake_plugin, fake_file>;
+
+static void dispatch(batch& b)
+{
+    b.dispatch([](fake_plugin& plugin) { return plugin.has_batch; },
+        [](fake_plugin& plugin, modloader_batch_t& files)
+        {
+            ++plugin.batch_calls;
+            for(size_t i = 0; i < files.uninstall_len; ++i) files.uninstall_result[i] = !plugin.call(0, files.uninstall[i]);
+            for(size_t i = 0; i < files.reinstall_len; ++i) files.reinstall_result[i] = !plugin.call(1, files.reinstall[i]);
+            for(size_t i = 0; i < files.install_len; ++i)   files.install_result[i]   = !plugin.call(2, files.install[i]);
+        },
+        [](fake_plugin& plugin, batch::action act, fake_file& file)
+        {
+            return plugin.call(int(act), &file);
+        });
+}
+
+TEST(install_batch_same_as_in_order)
+{
+    std::mt19937 rng(44);
+    for(int round = 0; round < 500; ++round)
+    {
+        std::vector<fake_plugin> plugins;
+        for(int p = 0; p < 5; ++p) plugins.emplace_back(rng() % 2 == 0, 2 + int(rng() % 5));
+
+        std::vector<fake_file> files(rng() % 100);
+        for(size_t i = 0; i < files.size(); ++i) files[i].id = int(i);
+
+        batch b;
+        std::vector<std::pair<fake_plugin*, int>> added;  // (plugin, action) for each file
+        for(auto& file : files)
+        {
+            fake_plugin* plugin = (rng() % 8)? &plugins[rng() % plugins.size()] : nullptr;
+            int act = int(rng() % 3);
+            b.add(plugin, batch::action(act), file);
+            added.emplace_back(plugin, act);
+        }
+        CHECK(b.size() == files.size() && b.empty() == files.empty());
+
+        dispatch(b);
+
+        // Same results as sending each operation by itself, files without a plugin always succeed
+        size_t k = 0;
+        for(auto& o : b)
+        {
+            CHECK(o.file == &files[k] && o.plugin == added[k].first && int(o.act) == added[k].second);
+            CHECK(o.result == (o.plugin == nullptr || (o.file->id % o.plugin->fail_every) != 0));
+            ++k;
+        }
+
+        for(auto& plugin : plugins)
+        {
+            // Plugins without batch support receive their operations in the order they were added,
+            // the ones with it receive a single call with the operations grouped by action (uninstalls first)
+            std::vector<std::pair<int, int>> expected;
+            for(int act = 0; act < 3; ++act)
+            {
+                for(size_t i = 0; i < files.size(); ++i)
+                {
+                    if(added[i].first == &plugin && (plugin.has_batch? added[i].second == act : act == 0))
+                        expected.emplace_back(added[i].second, files[i].id);
+                }
+            }
+            CHECK(plugin.received == expected);
+            CHECK(plugin.batch_calls == ((plugin.has_batch && !expected.empty())? 1 : 0));
+        }
+
+        b.clear();
+        CHECK(b.empty() && b.begin() == b.end());
+    }
+}
+
+TEST(install_batch_default_results)
+{
+    // A batch plugin that doesn't touch the results failed every file (Mod Loader sets them to 1 before the call)
+    fake_plugin plugin(true, 1);
+    fake_file files[3];
+    batch b;
+    for(int i = 0; i < 3; ++i)
+    {
+        files[i].id = i;
+        b.add(&plugin, batch::action(i), files[i]);
+    }
+
+    b.dispatch([](fake_plugin&) { return true; },
+        [](fake_plugin& plugin, modloader_batch_t& files)
+        {
+            ++plugin.batch_calls;
+            CHECK(files.uninstall_len == 1 && files.reinstall_len == 1 && files.install_len == 1);
+            CHECK(files.uninstall_result[0] == 1 && files.reinstall_result[0] == 1 && files.install_result[0] == 1);
+        },
+        [](fake_plugin&, batch::action, fake_file&) { CHECK(!"batch plugin called per file"); return true; });
+
+    CHECK(plugin.batch_calls == 1);
+    for(auto& o : b) CHECK(o.result == false);
+}
+
+BENCH(install_batch_dispatch)
+{
+    // A first run installing 20k files over 40 plugins, half of them taking batches
+    std::mt19937 rng(45);
+    std::vector<fake_plugin> plugins;
+    for(int p = 0; p < 40; ++p) plugins.emplace_back(p % 2 == 0, 1000000);
+
+    std::vector<fake_file> files(20000);
+    std::vector<fake_plugin*> owner(files.size());
+    for(size_t i = 0; i < files.size(); ++i)
+    {
+        files[i].id = int(i) + 1;
+        owner[i] = &plugins[rng() % plugins.size()];
+    }
+
+    auto reset = [&] { for(auto& plugin : plugins) plugin.received.clear(), plugin.batch_calls = 0; };
+
+    tests::benchmark("send each file in order", 50, [&](size_t) {
+        reset();
+        for(size_t i = 0; i < files.size(); ++i) tests::keep(owner[i]->call(2, &files[i]));
+    });
+    batch b;    // reused by each step, as the update does
+    tests::benchmark("install_batch::dispatch", 50, [&](size_t) {
+        reset();
+        b.clear();
+        for(size_t i = 0; i < files.size(); ++i) b.add(owner[i], batch::action::install, files[i]);
+        dispatch(b);
+        tests::keep(b.size());
+    });
+
+    size_t calls = 0;
+    for(auto& plugin : plugins) calls += plugin.has_batch? plugin.batch_calls : plugin.received.size();
+    printf("    plugin calls per update: %zu in order, %zu batched\n", files.size(), calls);
+}
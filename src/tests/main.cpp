@@ -0,0 +1,100 @@
+/*
+ * Tests Runner for Mod Loader
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  Runs the tests and benchmarks of the headers that don't depend on the game, also builds on non-Windows systems.
+ *
+ *  Usage: tests [options] [filter...]
+ *      --bench             Runs the benchmarks instead of the tests
+ *      --list              Lists the tests (or benchmarks) instead of running them
+ *      filter              Runs only the tests whose name contains any of the filters
+ *
+ */
+#include "test.hpp"
+#include <new>
+
+// Counts the allocations for the benchmarks that report them (see tests::allocations)
+void* operator new(size_t size)
+{
+    ++tests::allocations();
+    if(void* p = malloc(size? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    ++tests::allocations();
+    return malloc(size? size : 1);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+int main(int argc, char* argv[])
+{
+    bool bench = false, list = false;
+    std::vector<std::string> filters;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if(!strcmp(argv[i], "--bench"))
+            bench = true;
+        else if(!strcmp(argv[i], "--list"))
+            list = true;
+        else if(argv[i][0] == '-')
+            return fprintf(stderr, "Unknown option %s\n", argv[i]), EXIT_FAILURE;
+        else
+            filters.emplace_back(argv[i]);
+    }
+
+    auto matches = [&](const tests::test_case& t)
+    {
+        if(t.is_bench != bench) return false;
+        if(filters.empty()) return true;
+        for(auto& f : filters) { if(strstr(t.name, f.c_str())) return true; }
+        return false;
+    };
+
+    size_t count = 0, failed = 0;
+    for(auto& t : tests::registry())
+    {
+        if(!matches(t))
+            continue;
+
+        ++count;
+        if(list)
+        {
+            printf("%s\n", t.name);
+            continue;
+        }
+
+        printf("%s\n", t.name);
+        fflush(stdout);
+
+        int before = tests::failures();
+        t.func();
+        if(tests::failures() != before)
+        {
+            ++failed;
+            fprintf(stderr, "FAILED %s\n", t.name);
+        }
+    }
+
+    if(!list)
+        printf("%u %s, %u failed\n", unsigned(count), bench? "benchmarks" : "tests", unsigned(failed));
+    return failed? EXIT_FAILURE : EXIT_SUCCESS;
+}
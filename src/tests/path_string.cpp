@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The path_view functions against the std::string path functions
+ *
+ */
+#include "test.hpp"
+#include <modloader/util/path_string.hpp>
+#include <random>
+
+using namespace modloader;
+
+// The previous IsFileInsideFolder, which normalized copies of both paths
+static bool IsFileInsideFolderByCopy(std::string file, bool bJust, std::string folder)
+{
+    file = NormalizePath(file);
+    folder= NormalizePath(folder);
+
+    int numFolds = std::count(file.begin(), file.end(), cNormalizedSlash);
+
+    for(int i = 1; i <= numFolds; ++i)
+    {
+        if(GetPathComponentBack(file, i+1) == folder)
+            return true;
+        else if(bJust)
+            break;
+    }
+
+    return false;
+}
+
+// Random paths made of components, slashes of both kinds, spaces, dots and BOMs
+static std::string random_path(std::mt19937& rng)
+{
+    static const char* const pieces[] = {
+        "modloader", "Models", "GTA3.IMG", "data", "maps", "LA", "lan.ipl", "readme.txt", "My Mod", "a", "B", ".", "..",
+        "file.", ".ext", "x.y.z", "/", "\\", "//", " ", "\t", "\xEF\xBB\xBF", "\xC3\xA9t\xC3\xA9", "",
+    };
+    std::string path;
+    int n = std::uniform_int_distribution<int>(0, 8)(rng);
+    for(int i = 0; i < n; ++i)
+    {
+        path += pieces[rng() % (sizeof(pieces) / sizeof(*pieces))];
+        if(rng() % 2) path += (rng() % 2? '/' : '\\');
+    }
+    return path;
+}
+
+TEST(path_normalize_same_as_string)
+{
+    std::mt19937 rng(36);
+    char buf[512];
+    for(int i = 0; i < 500000; ++i)
+    {
+        std::string path = random_path(rng);
+        std::string expected = NormalizePath(path);
+
+        size_t len = NormalizePath(path_view(path), buf, sizeof(buf));
+        CHECK(len == expected.size() && std::string(buf) == expected);
+
+        std::string inplace = path;
+        size_t inplace_len = NormalizePathInPlace(&inplace[0], inplace.size());
+        CHECK(inplace.substr(0, inplace_len) == expected);
+
+        // The std::string functions don't trim, they work on the normalized paths in the game
+        for(size_t count = 1; count <= 3; ++count)
+        {
+            CHECK(GetLastPathComponent(path_view(expected), count) == GetLastPathComponent(expected, count));
+            CHECK(GetPathComponentBack(path_view(expected), count).str() == GetPathComponentBack(expected, count));
+            CHECK(GetLastPathComponent(path_view(path), count) == GetLastPathComponent(path, count));
+            CHECK(GetPathComponentBack(path_view(path), count).str() == GetPathComponentBack(path, count));
+        }
+        CHECK(GetFileExtension(path_view(path)).str() == GetFileExtension(path));
+
+        std::string other = (rng() % 2)? random_path(rng) : path;
+        if(rng() % 2) std::transform(other.begin(), other.end(), other.begin(), ::toupper);
+        std::string a = path, b = other;
+        std::replace(a.begin(), a.end(), '/', '\\'), modloader::tolower(a);
+        std::replace(b.begin(), b.end(), '/', '\\'), modloader::tolower(b);
+        CHECK(ComparePathView(path, other) == (a == b));
+
+        std::string folder = (rng() % 2)? random_path(rng) : GetPathComponentBack(path, 1 + rng() % 3);
+        bool just = (rng() % 2) != 0;
+        CHECK(IsFileInsideFolder(path, just, folder) == IsFileInsideFolderByCopy(path, just, folder));
+    }
+}
+
+TEST(path_components)
+{
+    std::vector<std::string> components;
+    size_t pos = 0; path_view component;
+    std::string path = "//modloader\\My Mod//models\\\\gta3.img/";
+    while(NextPathComponent(path, pos, component))
+        components.push_back(component.str());
+    CHECK((components == std::vector<std::string> { "modloader", "My Mod", "models", "gta3.img" }));
+
+    pos = 0;
+    CHECK(!NextPathComponent("", pos, component) && !NextPathComponent("///", pos, component));
+
+    char buf[8];
+    CHECK(NormalizePath(path_view("Short/"), buf, sizeof(buf)) == 5 && std::string(buf) == "short");
+    CHECK(NormalizePath(path_view("Too/long/path"), buf, sizeof(buf)) == path_view::npos);
+
+    CHECK(IsFileInsideFolder("modloader/My Mod/models/a.dff", false, "MY MOD"));
+    CHECK(!IsFileInsideFolder("modloader/My Mod/models/a.dff", true, "my mod"));
+    CHECK(IsFileInsideFolder("modloader/My Mod/models/a.dff", true, "models/"));
+}
+
+BENCH(path_functions)
+{
+    std::mt19937 rng(37);
+    std::vector<std::string> paths;
+    for(int i = 0; i < 1000; ++i)
+        paths.push_back("modloader/Some Mod " + std::to_string(i) + "/Models/Generic/" + std::to_string(rng()) + ".DFF");
+
+    size_t total = 0;
+    tests::benchmark("NormalizePath (string)", 2000000, [&](size_t i) {
+        total += NormalizePath(paths[i % paths.size()]).size();
+    });
+    tests::benchmark("NormalizePath (view into buffer)", 2000000, [&](size_t i) {
+        char buf[260];
+        total += NormalizePath(path_view(paths[i % paths.size()]), buf, sizeof(buf));
+    });
+    tests::benchmark("GetPathComponentBack (string)", 2000000, [&](size_t i) {
+        total += GetPathComponentBack(paths[i % paths.size()], 2).size();
+    });
+    tests::benchmark("GetPathComponentBack (view)", 2000000, [&](size_t i) {
+        total += GetPathComponentBack(path_view(paths[i % paths.size()]), 2).size;
+    });
+    tests::benchmark("IsFileInsideFolder (copies)", 2000000, [&](size_t i) {
+        total += IsFileInsideFolderByCopy(paths[i % paths.size()], false, "models");
+    });
+    tests::benchmark("IsFileInsideFolder (views)", 2000000, [&](size_t i) {
+        total += IsFileInsideFolder(paths[i % paths.size()], false, "models");
+    });
+    tests::keep(total);
+}
@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The PE import table walker over images built in memory (well formed, truncated and corrupted), and the translator registry
+ *
+ */
+#include "test.hpp"
+#include "../plugins/gta3/std.asi/pe_imports.hpp"
+#include "../plugins/gta3/std.asi/args_translator/translator_registry.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+
+// An import as the test expects the walker to report it
+struct expected_import
+{
+    std::string libname;
+    std::string symbol;         // empty if by ordinal or without ILT
+    uint16_t    ordinal;
+    bool        by_ordinal;
+    uint32_t    slot;           // Offset of the IAT entry in the image
+
+    bool operator==(const expected_import& o) const
+    {
+        return libname == o.libname && symbol == o.symbol && ordinal == o.ordinal && by_ordinal == o.by_ordinal && slot == o.slot;
+    }
+};
+
+/*
+ *  Builds a mapped 32 bits PE image with an import table, as the linkers lay it out
+ */
+struct pe_builder
+{
+    struct library
+    {
+        std::string name;
+        std::vector<std::pair<std::string, uint16_t>> symbols;  // by name, or by ordinal if the name is empty
+        bool has_ilt;
+    };
+
+    std::vector<uint8_t>         image;
+    std::vector<expected_import> imports;
+
+    void put(uint32_t off, uint32_t value, size_t n)
+    {
+        if(image.size() < off + n) image.resize(off + n);
+        memcpy(&image[off], &value, n);
+    }
+
+    uint32_t put_string(const std::string& s, uint32_t align = 1)
+    {
+        uint32_t off = uint32_t((image.size() + align - 1) / align * align);
+        image.resize(off + s.size() + 1);
+        memcpy(&image[off], s.c_str(), s.size() + 1);
+        return off;
+    }
+
+    pe_builder(const std::vector<library>& libs)
+    {
+        const uint32_t lfanew = 0x80, opt = lfanew + 24, desc = 0x200;
+
+        put(0, 0x5A4D, 2);
+        put(0x3C, lfanew, 4);
+        put(lfanew, 0x00004550, 4);
+        put(opt, 0x10B, 2);
+        put(opt + 92, 16, 4);
+        put(opt + 96 + 8, desc, 4);
+        put(opt + 96 + 12, uint32_t(20 * (libs.size() + 1)), 4);
+        image.resize(desc + 20 * (libs.size() + 1), 0);
+
+        for(size_t l = 0; l < libs.size(); ++l)
+        {
+            auto& lib = libs[l];
+            uint32_t count = uint32_t(lib.symbols.size());
+            uint32_t name  = put_string(lib.name);
+            uint32_t ilt   = put_string(std::string(4 * (count + 1) + 3, '\0'), 4);
+            uint32_t iat   = put_string(std::string(4 * (count + 1) + 3, '\0'), 4);
+
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                auto& sym = lib.symbols[i];
+                uint32_t thunk = sym.first.empty()? (0x80000000 | sym.second) : put_string(std::string(2, '\0') + sym.first, 2);
+                if(lib.has_ilt) put(ilt + 4 * i, thunk, 4);
+                put(iat + 4 * i, 0x10000000 + i, 4);    // bound to some address
+                imports.push_back(expected_import { lib.name, lib.has_ilt? sym.first : "",
+                                                    uint16_t(lib.has_ilt && sym.first.empty()? sym.second : 0),
+                                                    lib.has_ilt && sym.first.empty(), iat + 4 * i });
+            }
+
+            uint32_t d = desc + 20 * uint32_t(l);
+            put(d + 0, lib.has_ilt? ilt : 0, 4);
+            put(d + 12, name, 4);
+            put(d + 16, iat, 4);
+        }
+    }
+};
+
+static bool walk(std::vector<uint8_t>& image, std::vector<expected_import>& out)
+{
+    out.clear();
+    uint8_t* base = image.data();
+    return walk_pe_imports(base, image.size(), [&](const pe_import& imp) {
+        out.push_back(expected_import { imp.libname, imp.symbol? imp.symbol : "", imp.ordinal, imp.by_ordinal,
+                                        uint32_t((uint8_t*)(imp.slot) - base) });
+    });
+}
+
+static std::vector<pe_builder::library> sample_libraries()
+{
+    return {
+        { "KERNEL32.dll", { { "CreateFileA", 0 }, { "GetFileAttributesA", 0 }, { "", 42 }, { "LoadLibraryA", 0 } }, true },
+        { "msvcrt.dll",   { { "fopen", 0 }, { "_stat", 0 } }, true },
+        { "user32.dll",   { { "MessageBoxA", 0 }, { "", 7 } }, false },     // Borland like, no ILT
+        { "empty.dll",    { }, true },
+    };
+}
+
+TEST(pe_imports_well_formed)
+{
+    pe_builder pe(sample_libraries());
+    std::vector<expected_import> found;
+    CHECK(walk(pe.image, found));
+    CHECK(found == pe.imports);
+
+    // No import directory at all
+    pe_builder none({});
+    CHECK(walk(none.image, found) && found.empty());
+
+    // Not a PE image
+    std::vector<uint8_t> junk(4096, 0x90);
+    CHECK(!walk(junk, found) && found.empty());
+}
+
+TEST(pe_imports_truncated)
+{
+    pe_builder pe(sample_libraries());
+    std::vector<expected_import> found;
+
+    // Every truncation fails or gives a prefix of the imports, never reading past the end (caught by the sanitizers)
+    for(size_t size = 0; size < pe.image.size(); ++size)
+    {
+        std::vector<uint8_t> image(pe.image.begin(), pe.image.begin() + size);
+        image.shrink_to_fit();
+        bool ok = walk(image, found);
+        CHECK(found.size() <= pe.imports.size() && std::equal(found.begin(), found.end(), pe.imports.begin()));
+        CHECK(!ok || found.size() == pe.imports.size());
+    }
+}
+
+TEST(pe_imports_corrupted)
+{
+    std::mt19937 rng(41);
+    pe_builder pe(sample_libraries());
+    std::vector<expected_import> found;
+
+    for(int round = 0; round < 20000; ++round)
+    {
+        std::vector<uint8_t> image = pe.image;
+        for(int n = 1 + int(rng() % 4); n > 0; --n)
+        {
+            size_t off = rng() % image.size();
+            if(rng() % 2)
+                image[off] = uint8_t(rng());
+            else if(off + 4 <= image.size())    // a wild offset
+            {
+                uint32_t value = uint32_t(rng() % 2? rng() : rng() % (image.size() + 64));
+                memcpy(&image[off], &value, 4);
+            }
+        }
+
+        walk(image, found);
+        for(auto& imp : found)
+            CHECK(imp.slot + 4 <= image.size());
+    }
+}
+
+/*
+ *  Translator registry
+ */
+struct fake_translator
+{
+    std::string lib, sym;
+    const char* GetLibName() const { return lib.c_str(); }
+    const char* GetSymbol() const  { return sym.c_str(); }
+};
+
+// The lookup PatchImports did before the registry, on a list sorted by library (case insensitive) and symbol
+// The range of the library was found once, then each symbol imported from it was searched in the range
+using sorted_range = std::pair<std::vector<fake_translator*>::const_iterator, std::vector<fake_translator*>::const_iterator>;
+
+static sorted_range find_sorted_library(const std::vector<fake_translator*>& list, const char* libname)
+{
+    auto lib_lb = [](fake_translator* a, const char* b) { return _stricmp(a->GetLibName(), b) < 0; };
+    auto lib_ub = [](const char* a, fake_translator* b) { return _stricmp(a, b->GetLibName()) < 0; };
+
+    auto it_lib = std::lower_bound(list.begin(), list.end(), libname, lib_lb);
+    if((it_lib != list.end() && !_stricmp((*it_lib)->GetLibName(), libname)) == false)
+        it_lib = std::lower_bound(list.begin(), list.end(), "", lib_lb);
+    if(it_lib == list.end())
+        return sorted_range(list.end(), list.end());
+    return sorted_range(it_lib, std::upper_bound(it_lib, list.end(), (*it_lib)->GetLibName(), lib_ub));
+}
+
+static fake_translator* find_sorted(const sorted_range& lib, const char* symbol)
+{
+    auto it_sym = std::lower_bound(lib.first, lib.second, symbol, [](fake_translator* a, const char* b) {
+        return strcmp(a->GetSymbol(), b) < 0;
+    });
+    return (it_sym != lib.second && !strcmp((*it_sym)->GetSymbol(), symbol))? *it_sym : nullptr;
+}
+
+// The translators of std.asi
+static std::vector<fake_translator> sample_translators()
+{
+    std::vector<fake_translator> list;
+    for(auto sym : { "CreateFile", "SetCurrentDirectory", "FindFirstFile", "FindNextFile", "GetModuleFileName", "LoadLibrary",
+                     "LoadLibraryEx", "GetPrivateProfileInt", "GetPrivateProfileSection", "GetPrivateProfileSectionNames",
+                     "GetPrivateProfileString", "GetPrivateProfileStruct", "WritePrivateProfileSection", "WritePrivateProfileString",
+                     "WritePrivateProfileStruct", "GetFileAttributes", "GetFileAttributesEx" })
+    {
+        list.push_back(fake_translator { "kernel32.dll", std::string(sym) + "A" });
+        list.push_back(fake_translator { "kernel32.dll", std::string(sym) + "W" });
+    }
+    list.push_back(fake_translator { "kernel32.dll", "FindClose" });
+
+    for(auto sym : { "fopen", "freopen", "fopen_s", "freopen_s", "rename", "remove",
+                     "_wfopen", "_wfreopen", "_wfopen_s", "_wfreopen_s", "_wrename", "_wremove" })
+        list.push_back(fake_translator { "", sym });
+
+    for(auto sym : { "D3DXCreateTextureFromFile", "D3DXCompileShaderFromFile", "D3DXAssembleShaderFromFile", "D3DXCreateVolumeTextureFromFile",
+                     "D3DXCreateCubeTextureFromFile", "D3DXLoadMeshFromX", "D3DXCreateEffectFromFile", "D3DXSaveSurfaceToFile" })
+    {
+        list.push_back(fake_translator { "", std::string(sym) + "A" });
+        list.push_back(fake_translator { "", std::string(sym) + "W" });
+    }
+
+    for(auto sym : { "BASS_MusicLoad", "BASS_SampleLoad", "BASS_StreamCreateFile" })
+        list.push_back(fake_translator { "bass.dll", sym });
+    return list;
+}
+
+static std::vector<fake_translator*> sorted(std::vector<fake_translator>& translators)
+{
+    std::vector<fake_translator*> list;
+    for(auto& t : translators) list.push_back(&t);
+    std::sort(list.begin(), list.end(), [](fake_translator* a, fake_translator* b) {
+        int x = _stricmp(a->GetLibName(), b->GetLibName());
+        if(x == 0) x = strcmp(a->GetSymbol(), b->GetSymbol());
+        return x < 0;
+    });
+    return list;
+}
+
+TEST(translator_registry_same_as_sorted_list)
+{
+    auto translators = sample_translators();
+    auto list = sorted(translators);
+    translator_registry<fake_translator> registry;
+    registry.build(list);
+
+    for(auto lib : { "KERNEL32.DLL", "kernel32.dll", "MSVCRT.dll", "d3dx9_43.dll", "Bass.dll", "user32.dll", "", "kernel32" })
+        for(auto sym : { "CreateFileA", "createfilea", "GetFileAttributesW", "FindClose", "fopen", "_wremove", "_stat",
+                         "D3DXLoadMeshFromXA", "BASS_SampleLoad", "MessageBoxA", "" })
+        {
+            CHECK(registry.find(lib, sym) == find_sorted(find_sorted_library(list, lib), sym));
+            CHECK(registry.find(registry.find_library(lib), sym) == registry.find(lib, sym));
+        }
+
+    // Only the symbols of the loaded libraries have an address
+    std::map<std::string, uintptr_t> addresses;
+    for(auto* t : list) if(t->lib == "kernel32.dll") addresses.emplace(t->sym, 0x1000 + 16 * addresses.size());
+    registry.build_addresses([&](fake_translator* t) -> uintptr_t { return t->lib == "kernel32.dll"? addresses[t->sym] : 0; });
+    CHECK(registry.has_addresses());
+    for(auto& a : addresses)
+        CHECK(registry.find_symbol(a.second) && registry.find_symbol(a.second) == a.first);
+    CHECK(registry.find_symbol(0x1001) == nullptr && registry.find_symbol(0) == nullptr);
+}
+
+BENCH(translator_registry_lookup)
+{
+    auto translators = sample_translators();
+    auto list = sorted(translators);
+    translator_registry<fake_translator> registry;
+    registry.build(list);
+
+    // The import table of a typical ASI, a few libraries each with many symbols, most of them without a translator
+    std::vector<std::pair<std::string, std::vector<std::string>>> imports;
+    for(auto lib : { "KERNEL32.dll", "USER32.dll", "MSVCR100.dll", "d3d9.dll", "d3dx9_43.dll", "WINMM.dll", "bass.dll", "ADVAPI32.dll" })
+    {
+        imports.emplace_back(lib, std::vector<std::string>());
+        for(int i = 0; i < 25; ++i)
+            imports.back().second.push_back(i % 10? "ImportedFunction" + std::to_string(i) : "CreateFileA");
+    }
+
+    size_t found = 0;
+    tests::benchmark("binary search on the sorted list (per table)", 200000, [&](size_t) {
+        for(auto& lib : imports)
+        {
+            auto range = find_sorted_library(list, lib.first.c_str());
+            for(auto& sym : lib.second)
+                found += find_sorted(range, sym.c_str()) != nullptr;
+        }
+    });
+    tests::benchmark("translator_registry (per table)", 200000, [&](size_t) {
+        for(auto& lib : imports)
+        {
+            auto range = registry.find_library(lib.first.c_str());
+            for(auto& sym : lib.second)
+                found += registry.find(range, sym.c_str()) != nullptr;
+        }
+    });
+    tests::keep(found);
+}
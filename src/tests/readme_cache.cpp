@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The std.data readme cache, over launches adding, editing and removing readmes (as UpdateReadmeState and WriteReadmeCache)
+ *
+ */
+#include "test.hpp"
+#include "../plugins/gta3/std.data/readme_cache.hpp"
+
+#ifndef _WIN32
+namespace
+{
+    struct readme
+    {
+        std::string content;
+        uint64_t    time;
+    };
+
+    uint32_t hash(const std::string& s)
+    {
+        uint32_t h = 2166136261u;
+        for(char c : s) h = (h ^ uint8_t(c)) * 16777619u;
+        return h;
+    }
+
+    std::string digest(const std::string& content)
+    {
+        return readme_cache::digest(content.data(), content.data() + content.size());
+    }
+
+    // The readmes in the mods and the cache directory, each launch installs every readme
+    struct game
+    {
+        tests::temp_dir                 dir;
+        std::map<std::string, readme>   readmes;    // By path
+        std::set<std::string>           installed;  // Readmes of the last launch
+        int reads, parses, cached;                  // Of the last launch
+        bool wrote_index;
+
+        game() { dir.mkdir("readme"); }
+
+        std::string cache_dir() const { return dir / "readme/"; }
+
+        static std::string parse(const std::string& content)
+        {
+            std::string data = content;
+            for(auto& c : data) c = char(::toupper(uint8_t(c)));
+            return data;
+        }
+
+        void launch()
+        {
+            reads = parses = cached = 0;
+            wrote_index = false;
+
+            // No index, so one must be written, and so must it when readmes went away (as UninstallReadme does)
+            readme_cache rc;
+            bool had_cache = rc.open(cache_dir());
+            bool changed = !had_cache;
+            for(auto& path : installed)
+                changed = changed || !readmes.count(path);
+
+            std::map<std::string, std::string> digests;
+            std::set<std::string> changed_readmes;
+            for(auto& pair : readmes)
+            {
+                auto& r = pair.second;
+                std::string d, entry;
+
+                // Unchanged readmes know their digest from the index, the others need to be read to find it
+                bool has_raw = false;
+                if(!rc.find(key(pair.first), d))
+                {
+                    ++reads;
+                    has_raw = true;
+                    d = digest(r.content);
+                }
+
+                if(dir.read("readme/" + d + ".ld", entry))
+                {
+                    ++cached;
+                    CHECK(entry == parse(r.content));
+                    changed = changed || has_raw;
+                }
+                else
+                {
+                    if(!has_raw) ++reads;
+                    ++parses;
+                    changed = true;
+                    changed_readmes.emplace(pair.first);
+                }
+                digests[pair.first] = d;
+            }
+
+            installed.clear();
+            for(auto& pair : readmes)
+                installed.emplace(pair.first);
+
+            if(changed && (!readmes.empty() || had_cache))
+            {
+                readme_cache::index_type index;
+                for(auto& path : changed_readmes)
+                    CHECK(dir.write("readme/" + digests[path] + ".ld", parse(readmes[path].content)));
+                for(auto& pair : digests)
+                    index[key(pair.first)] = pair.second;
+                CHECK(rc.save(std::move(index)));
+                wrote_index = true;
+            }
+        }
+
+        readme_cache::key key(const std::string& path)
+        {
+            auto& r = readmes[path];
+            return readme_cache::key { hash(path), r.content.size(), r.time };
+        }
+
+        size_t entries() const
+        {
+            size_t n = 0;
+            if(DIR* d = opendir((dir / "readme").c_str()))
+            {
+                while(dirent* de = readdir(d))
+                {
+                    std::string name = de->d_name;
+                    n += name.size() > 3 && name.compare(name.size() - 3, 3, ".ld") == 0;
+                }
+                closedir(d);
+            }
+            return n;
+        }
+    };
+}
+
+TEST(readme_cache_add_edit_remove)
+{
+    game g;
+    g.readmes["a/readme.txt"] = { "model 400 car", 1 };
+    g.readmes["b/readme.txt"] = { "handling foo", 1 };
+    g.readmes["c/readme.txt"] = { "nothing here", 1 };
+    g.launch();
+    CHECK(g.parses == 3 && g.reads == 3 && g.cached == 0 && g.wrote_index && g.entries() == 3);
+
+    // Unchanged, nothing is read, parsed nor written
+    g.launch();
+    CHECK(g.parses == 0 && g.reads == 0 && g.cached == 3 && !g.wrote_index);
+
+    // Added, only it is read and parsed
+    g.readmes["d/readme.txt"] = { "weapon bar", 1 };
+    g.launch();
+    CHECK(g.parses == 1 && g.reads == 1 && g.cached == 3 && g.wrote_index && g.entries() == 4);
+
+    // Edited, only it is parsed, and its old entry goes away
+    g.readmes["b/readme.txt"] = { "handling baz", 2 };
+    g.launch();
+    CHECK(g.parses == 1 && g.reads == 1 && g.cached == 3 && g.wrote_index && g.entries() == 4);
+    CHECK(!g.dir.exists("readme/" + digest("handling foo") + ".ld"));
+
+    // Touched (same content, other time), read but not parsed, and the index learns it so the next launch doesn't read it
+    g.readmes["a/readme.txt"].time = 3;
+    g.launch();
+    CHECK(g.parses == 0 && g.reads == 1 && g.cached == 4 && g.wrote_index);
+    g.launch();
+    CHECK(g.reads == 0 && !g.wrote_index);
+
+    // Copied into another mod, shares the entry
+    g.readmes["e/readme.txt"] = g.readmes["a/readme.txt"];
+    g.launch();
+    CHECK(g.parses == 0 && g.reads == 1 && g.cached == 5 && g.wrote_index && g.entries() == 4);
+    g.launch();
+    CHECK(g.reads == 0 && !g.wrote_index);
+
+    // One of the copies removed, the entry stays for the other
+    g.readmes.erase("a/readme.txt");
+    g.launch();
+    CHECK(g.parses == 0 && g.reads == 0 && g.cached == 4 && g.wrote_index && g.entries() == 4);
+
+    // Removed, its entry is deleted
+    g.readmes.erase("c/readme.txt");
+    g.launch();
+    CHECK(g.parses == 0 && g.cached == 3 && g.wrote_index && g.entries() == 3);
+    CHECK(!g.dir.exists("readme/" + digest("nothing here") + ".ld"));
+
+    // Every readme removed, so is every entry
+    g.readmes.clear();
+    g.launch();
+    CHECK(g.wrote_index && g.entries() == 0);
+}
+
+TEST(readme_cache_recovery)
+{
+    game g;
+    g.readmes["a/readme.txt"] = { "model 400 car", 1 };
+    g.readmes["b/readme.txt"] = { "handling foo", 1 };
+    g.launch();
+
+    // An entry lost, the index knows the readme but it's parsed again
+    std::remove((g.cache_dir() + digest("handling foo") + ".ld").c_str());
+    g.launch();
+    CHECK(g.parses == 1 && g.reads == 1 && g.cached == 1 && g.entries() == 2);
+
+    // A corrupt index, everything is read again but the entries are still found by content
+    g.dir.write("readme/index", std::string("MLREADME\x01\0\0\0garbage", 19));
+    readme_cache rc;
+    CHECK(!rc.open(g.cache_dir()));
+    g.launch();
+    CHECK(g.parses == 0 && g.reads == 2 && g.cached == 2 && g.wrote_index);
+    g.launch();
+    CHECK(g.parses == 0 && g.reads == 0 && g.cached == 2 && !g.wrote_index);
+
+    // Cut short or garbage after the records
+    std::string index;
+    CHECK(g.dir.read("readme/index", index));
+    for(const std::string& content : { index.substr(0, index.size() - 1), index + "x", index.substr(0, 11) })
+    {
+        g.dir.write("readme/index", content);
+        std::string d;
+        CHECK(!rc.open(g.cache_dir()) && !rc.find(readme_cache::key { hash("a/readme.txt"), 13, 1 }, d));
+    }
+}
+
+TEST(readme_cache_digest)
+{
+    CHECK(digest("ab") != digest("ba"));
+    CHECK(digest("") != digest(std::string(1, '\0')));
+    CHECK(digest("model 400 car") == digest("model 400 car"));
+    CHECK(digest("").size() == 33 && digest(std::string(300, 'x')).size() == 35);
+}
+#endif
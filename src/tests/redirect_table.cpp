@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The hashed redirect table against a map keyed by the lower case filename (as the redirect hooks used before it)
+ *
+ */
+#include "test.hpp"
+#include <modloader/util/redirect.hpp>
+#include <map>
+#include <random>
+
+using modloader::hashed_redirect_table;
+
+// The lookup done by the hooks before, a copy of the last path component in lower case into a map
+static const std::string* find_by_copy(const std::map<std::string, std::string>& map, const char* filepath)
+{
+    std::string filename = &filepath[modloader::GetLastPathComponent(std::string(filepath))];
+    auto it = map.find(modloader::tolower(filename));
+    return it != map.end()? &it->second : nullptr;
+}
+
+static std::string random_case(std::mt19937& rng, std::string s)
+{
+    for(auto& c : s) if(rng() % 2) c = char(::toupper(uint8_t(c)));
+    return s;
+}
+
+TEST(redirect_table_same_as_map)
+{
+    std::mt19937 rng(40);
+    hashed_redirect_table table;
+    std::map<std::string, std::string> map;
+
+    std::vector<std::string> names;
+    for(int i = 0; i < 64; ++i) names.push_back("file" + std::to_string(i) + (i % 3? ".txd" : ""));
+
+    for(int step = 0; step < 200000; ++step)
+    {
+        const std::string& name = names[rng() % names.size()];
+        switch(rng() % 4)
+        {
+            case 0:
+            {
+                std::string path = "modloader/mod" + std::to_string(rng() % 8) + "/" + name;
+                bool inserted = map.emplace(name, path).second;
+                CHECK(table.insert(random_case(rng, name), path) == inserted);
+                break;
+            }
+            case 1:
+                CHECK(table.erase(random_case(rng, name)) == (map.erase(name) != 0));
+                break;
+            default:
+            {
+                std::string filepath = (rng() % 2? "models\\txd\\" : rng() % 2? "MODELS/" : "") + random_case(rng, name);
+                const std::string* expected = find_by_copy(map, filepath.c_str());
+                auto e = table.find_path(filepath);
+                CHECK(e? (expected && e->path == *expected) : !expected);
+
+                const char* path = table.redirect(random_case(rng, name));
+                CHECK(path? (expected && *expected == path) : !expected);
+                break;
+            }
+        }
+        CHECK(table.size() == map.size());
+    }
+
+    table.clear();
+    CHECK(table.empty() && table.find("file1.txd") == nullptr);
+}
+
+TEST(redirect_table_hash)
+{
+    // Same as modloader::file::hash, which is the hash of the lower case filename
+    std::mt19937 rng(41);
+    for(int i = 0; i < 10000; ++i)
+    {
+        std::string name = "Stream" + std::to_string(rng()) + ".TXD";
+        std::string lower = name;
+        CHECK(hashed_redirect_table::hash(name) == uint32_t(modloader::hash(modloader::tolower(lower))));
+    }
+}
+
+TEST(redirect_table_hash_collision)
+{
+    // Finds two names with the same hash, both must be kept apart in the table
+    std::unordered_map<uint32_t, std::string> seen;
+    std::string a, b;
+    for(uint32_t i = 0; a.empty(); ++i)
+    {
+        std::string name = "f" + std::to_string(i);
+        auto it = seen.emplace(hashed_redirect_table::hash(name), name);
+        if(!it.second) a = it.first->second, b = name;
+    }
+
+    hashed_redirect_table table;
+    CHECK(table.insert(a, "path/a") && table.insert(b, "path/b"));
+    CHECK(!table.insert(a, "path/c"));
+    CHECK(table.size() == 2);
+    CHECK(std::string(table.redirect(a)) == "path/a" && std::string(table.redirect(b)) == "path/b");
+    CHECK(table.erase(b) && table.redirect(b) == nullptr);
+    CHECK(std::string(table.redirect(a)) == "path/a");
+}
+
+BENCH(redirect_table_lookup)
+{
+    // Hooks get the path the game asks for, a few of those are overriden
+    std::mt19937 rng(42);
+    hashed_redirect_table table;
+    std::map<std::string, std::string> map;
+    for(int i = 0; i < 100; ++i)
+    {
+        std::string name = "sprite" + std::to_string(i) + ".txd";
+        table.insert(name, "modloader/sprites/" + name);
+        map.emplace(name, "modloader/sprites/" + name);
+    }
+
+    std::vector<std::string> paths;
+    for(int i = 0; i < 1000; ++i)
+        paths.push_back("MODELS\\TXD\\SPRITE" + std::to_string(rng() % 400) + ".TXD");
+
+    size_t found = 0;
+    tests::benchmark("lower case copy into std::map", 2000000, [&](size_t i) {
+        found += find_by_copy(map, paths[i % paths.size()].c_str()) != nullptr;
+    });
+    tests::benchmark("hashed_redirect_table::find_path", 2000000, [&](size_t i) {
+        found += table.find_path(paths[i % paths.size()]) != nullptr;
+    });
+    tests::keep(found);
+}
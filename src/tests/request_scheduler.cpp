@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The std.bank request scheduler, with a loading thread as the bank loader has (build with -fsanitize=thread too)
+ *
+ */
+#include "test.hpp"
+#include "../plugins/gta3/std.bank/request_scheduler.hpp"
+#include <atomic>
+#include <random>
+#include <thread>
+
+using priority = request_scheduler::priority;
+
+// Takes the requests available right now, completing each one, returns their ids in the order taken
+static std::vector<int> take_all(request_scheduler& s, size_t count, std::vector<int>* joined = nullptr)
+{
+    std::vector<int> out;
+    int id;
+    for(size_t i = 0; i < count && s.take(id); ++i)
+    {
+        out.push_back(id);
+        s.complete(id, [&](int k, bool is_joined) { if(is_joined && joined) joined->push_back(k); });
+    }
+    return out;
+}
+
+TEST(request_scheduler_order)
+{
+    // Immediate requests go first, otherwise in submission order, but a group always in submission order
+    request_scheduler s;
+    CHECK(s.submit(0, 100, 0, priority::background));
+    CHECK(s.submit(1, 101, 1, priority::background));
+    CHECK(s.submit(2, 102, 1, priority::immediate));    // after 1, same group
+    CHECK(s.submit(3, 103, 2, priority::immediate));
+    CHECK(take_all(s, 4) == (std::vector<int> { 3, 0, 1, 2 }));
+    CHECK(s.wait_all());
+}
+
+TEST(request_scheduler_join)
+{
+    // Identical to the last request of the group joins it, and raises its priority
+    request_scheduler s;
+    CHECK(s.submit(0, 100, 0, priority::background));
+    CHECK(s.submit(1, 200, 1, priority::background));
+    CHECK(!s.submit(2, 200, 1, priority::immediate));
+    CHECK(s.submit(3, 100, 1, priority::background));   // same key, other group
+    CHECK(s.submit(4, 200, 1, priority::background));   // not the last one anymore
+
+    std::vector<int> joined;
+    CHECK(take_all(s, 4, &joined) == (std::vector<int> { 1, 0, 3, 4 }));
+    CHECK(joined == (std::vector<int> { 2 }));
+    CHECK(s.wait_all());
+
+    // A request being loaded can still be joined, until completed
+    int id;
+    CHECK(s.submit(5, 300, 0, priority::background) && s.take(id) && id == 5);
+    CHECK(!s.submit(6, 300, 0, priority::background));
+    joined.clear();
+    s.complete(5, [&](int k, bool is_joined) { if(is_joined) joined.push_back(k); });
+    CHECK(joined == (std::vector<int> { 6 }));
+    CHECK(s.wait_all());
+}
+
+TEST(request_scheduler_stop)
+{
+    // Stopping wakes up the loading thread and whoever is waiting for the requests, which will never complete
+    request_scheduler s;
+    bool taken = true, waited = true;
+    std::thread loader([&] { int id; taken = s.take(id); });
+    s.submit(0, 100, 0, priority::background);
+    std::thread waiter([&] { waited = s.wait_all(); });
+
+    loader.join();
+    CHECK(taken);   // the request, never completed
+    s.stop();
+    waiter.join();
+    CHECK(!waited);
+
+    int id;
+    CHECK(!s.take(id) && !s.wait_all());
+}
+
+TEST(request_scheduler_threads)
+{
+    // The game thread issuing requests into free slots and flushing, as CAECustomBankLoader::Service and Flush do
+    enum { null, in_progress, done, done_joined };
+    const int requests = 50, slots = 6;
+
+    struct request
+    {
+        std::atomic<int> status;
+        int slot, seq;
+    };
+
+    request_scheduler s;
+    request r[requests];
+    for(auto& x : r) x.status = null;
+
+    std::atomic<long> loads(0), joins(0), order_violations(0);
+    std::thread loader([&]
+    {
+        std::mt19937 rng(52);
+        int last_seq[slots] = {};
+        int i;
+        while(s.take(i))
+        {
+            if(r[i].seq < last_seq[r[i].slot]) ++order_violations;
+            last_seq[r[i].slot] = r[i].seq;
+            ++loads;
+            if(rng() % 16 == 0) std::this_thread::sleep_for(std::chrono::microseconds(20));
+            s.complete(i, [&](int k, bool joined) { if(joined) ++joins; r[k].status = joined? done_joined : done; });
+        }
+    });
+
+    std::mt19937 rng(53);
+    int seq = 0;
+    for(int step = 0; step < 20000; ++step)
+    {
+        for(int i = 0; i < requests; ++i)
+        {
+            int status = r[i].status;
+            if(status == done || status == done_joined)
+                r[i].status = null;
+            else if(status == null && rng() % 8 == 0)
+            {
+                r[i].slot = int(rng() % slots);
+                r[i].seq = ++seq;
+                r[i].status = in_progress;
+                uint64_t key = (uint64_t(r[i].slot) << 32) | (rng() % 3);
+                s.submit(i, key, r[i].slot, rng() % 2? priority::immediate : priority::background);
+            }
+        }
+
+        if(step % 1000 == 0)
+        {
+            CHECK(s.wait_all());
+            for(auto& x : r) CHECK(x.status != in_progress);
+        }
+    }
+
+    CHECK(s.wait_all());
+    s.stop();
+    loader.join();
+
+    CHECK(loads + joins == seq);
+    CHECK(order_violations == 0);
+}
+
+BENCH(request_scheduler_throughput)
+{
+    // Requests handed to the loading thread and flushed in batches of a bank worth
+    request_scheduler s;
+    std::thread loader([&] { int i; while(s.take(i)) s.complete(i, [](int, bool) {}); });
+
+    tests::benchmark("submit 45 requests + wait_all", 20000, [&](size_t n) {
+        for(int i = 0; i < 45; ++i)
+            s.submit(i, (uint64_t(n) << 8) | i, i % 45, i % 4? priority::background : priority::immediate);
+        s.wait_all();
+    });
+
+    s.stop();
+    loader.join();
+}
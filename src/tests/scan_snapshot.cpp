@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The scan snapshot and walker over a directory tree in the temporary directory
+ *
+ */
+#include "test.hpp"
+#include "../core/scan_snapshot.hpp"
+#include <algorithm>
+
+#ifndef _WIN32
+#include <fcntl.h>
+
+// The filesystem under the directory @base, as the scan sees it on Windows (paths separated by backslashes)
+struct posix_filesystem : scan_filesystem
+{
+    std::string base;
+    size_t      writes = 0;
+
+    explicit posix_filesystem(std::string base) : base(std::move(base)) {}
+
+    std::string native(std::string path) const
+    {
+        std::replace(path.begin(), path.end(), '\\', '/');
+        return base + "/" + path;
+    }
+
+    bool list(const std::string& dir, std::vector<entry>& out)
+    {
+        std::string path = native(dir);
+        DIR* d = opendir(path.c_str());
+        if(d == nullptr) return false;
+        while(dirent* de = readdir(d))
+        {
+            struct stat st;
+            if(de->d_name[0] == '.' || stat((path + "/" + de->d_name).c_str(), &st) != 0)
+                continue;
+            bool is_dir = S_ISDIR(st.st_mode);
+            entry e = { de->d_name, is_dir, is_dir? 0 : uint64_t(st.st_size),
+                        uint64_t(st.st_mtim.tv_sec) * 1000000000 + uint64_t(st.st_mtim.tv_nsec) };
+            out.emplace_back(std::move(e));
+        }
+        closedir(d);
+        return true;
+    }
+
+    bool time(const std::string& dir, uint64_t& out)
+    {
+        struct stat st;
+        if(stat(native(dir).c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) return false;
+        out = uint64_t(st.st_mtim.tv_sec) * 1000000000 + uint64_t(st.st_mtim.tv_nsec);
+        return true;
+    }
+
+    bool read(const std::string& path, std::string& out)
+    {
+        out.clear();
+        FILE* f = fopen(native(path).c_str(), "rb");
+        if(f == nullptr) return false;
+        char buf[4096];
+        size_t n;
+        while((n = fread(buf, 1, sizeof(buf), f)) != 0) out.append(buf, n);
+        return fclose(f) == 0;
+    }
+
+    bool write(const std::string& path, const std::string& data)
+    {
+        ++writes;
+        FILE* f = fopen(native(path).c_str(), "wb");
+        if(f == nullptr) return false;
+        bool result = fwrite(data.data(), 1, data.size(), f) == data.size();
+        return (fclose(f) == 0) && result;
+    }
+};
+
+// Sets the modification time of @path to a second since the epoch, so later changes surely give a different time
+static void set_old_time(const std::string& path, time_t secs)
+{
+    struct timespec times[2] = { { secs, 0 }, { secs, 0 } };
+    utimensat(AT_FDCWD, path.c_str(), times, 0);
+}
+
+static std::vector<std::string> paths(const scan_snapshot::tree& tree)
+{
+    std::vector<std::string> out;
+    for(auto& r : tree.records) out.emplace_back(r.path);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+static bool walk(posix_filesystem& fs, const std::string& root, const scan_snapshot::tree* prev, scan_snapshot::tree& next,
+                 bool prune, size_t* pruned = nullptr)
+{
+    scan_walker walker(fs, prune);
+    bool result = walker.walk(root, prev, next, [](scan_snapshot::record& r, bool&) {
+        if(!(r.flags & scan_snapshot::is_dir) && r.path.find(".dff") != r.path.npos)
+        {
+            r.flags |= scan_snapshot::handled;
+            r.behaviour = r.size;
+        }
+        return true;
+    });
+    if(pruned) *pruned = walker.num_pruned();
+    return result;
+}
+
+struct mod_tree
+{
+    tests::temp_dir     dir;
+    posix_filesystem    fs;
+
+    mod_tree() : fs(dir.path())
+    {
+        dir.mkdir("mod");
+        dir.mkdir("mod/models");
+        dir.mkdir("mod/models/cars");
+        dir.mkdir("mod/text");
+        dir.write("mod/readme.txt", "hello");
+        dir.write("mod/models/cars/infernus.dff", "0123456789");
+        dir.write("mod/models/cars/infernus.txd", "abc");
+        dir.write("mod/text/american.gxt", "gxt");
+
+        time_t t = 1000;
+        for(auto* name : { "mod/models/cars", "mod/models", "mod/text", "mod" })
+            set_old_time(dir / name, t++);
+    }
+};
+
+TEST(scan_snapshot_full_walk)
+{
+    mod_tree m;
+    scan_snapshot snap;
+    auto& tree = snap.trees["mod\\"];
+
+    CHECK(walk(m.fs, "mod\\", nullptr, tree, false));
+    CHECK(paths(tree) == (std::vector<std::string> { "models", "models\\cars", "models\\cars\\infernus.dff",
+                                                     "models\\cars\\infernus.txd", "readme.txt", "text", "text\\american.gxt" }));
+    CHECK(tree.children == 3);
+
+    for(auto& r : tree.records)
+    {
+        if(r.path == "models\\cars\\infernus.dff")
+            CHECK(r.size == 10 && (r.flags & scan_snapshot::handled) && r.behaviour == 10);
+        if(r.path == "models")
+            CHECK((r.flags & scan_snapshot::is_dir) && (r.flags & scan_snapshot::descended) && r.children == 1 && r.descendants == 3);
+    }
+
+    // A directory which can't be listed fails the walk
+    scan_snapshot::tree missing;
+    CHECK(!walk(m.fs, "nothere\\", nullptr, missing, false));
+}
+
+TEST(scan_snapshot_save_and_load)
+{
+    mod_tree m;
+    scan_snapshot snap;
+    CHECK(walk(m.fs, "mod\\", nullptr, snap.trees["mod\\"], false));
+
+    CHECK(snap.save(m.fs, "scan.snapshot") && m.fs.writes == 1);
+    CHECK(m.dir.exists("scan.snapshot"));
+
+    scan_snapshot loaded;
+    CHECK(loaded.load(m.fs, "scan.snapshot"));
+    CHECK(loaded.trees.size() == 1);
+    CHECK(scan_walker::compare(snap.trees["mod\\"], loaded.trees["mod\\"], [](const std::string&, const char*) {}) == 0);
+    CHECK(loaded.serialize() == snap.serialize());
+
+    // Saving an unchanged snapshot doesn't touch the disk, neither right after loading it
+    CHECK(snap.save(m.fs, "scan.snapshot") && m.fs.writes == 1);
+    CHECK(loaded.save(m.fs, "scan.snapshot") && m.fs.writes == 1);
+
+    // A changed one is written again
+    m.dir.write("mod/text/spanish.gxt", "gxt");
+    CHECK(walk(m.fs, "mod\\", nullptr, snap.trees["mod\\"], false));
+    CHECK(snap.save(m.fs, "scan.snapshot") && m.fs.writes == 2);
+    CHECK(loaded.load(m.fs, "scan.snapshot") && loaded.serialize() == snap.serialize());
+
+    // Truncated or garbage files are refused and leave the snapshot empty
+    std::string data;
+    CHECK(m.dir.read("scan.snapshot", data));
+    for(size_t len : { size_t(0), size_t(4), data.size() / 2, data.size() - 1 })
+    {
+        m.dir.write("scan.snapshot", data.substr(0, len));
+        CHECK(!loaded.load(m.fs, "scan.snapshot") && loaded.trees.empty());
+    }
+    m.dir.write("scan.snapshot", data + "x");
+    CHECK(!loaded.load(m.fs, "scan.snapshot") && loaded.trees.empty());
+    CHECK(!loaded.load(m.fs, "nothere.snapshot") && loaded.trees.empty());
+
+    // After a failed load the next save writes the file again
+    CHECK(loaded.save(m.fs, "scan.snapshot") && m.fs.writes == 3);
+}
+
+TEST(scan_snapshot_warm_walk)
+{
+    mod_tree m;
+    scan_snapshot::tree cold;
+    CHECK(walk(m.fs, "mod\\", nullptr, cold, false));
+
+    // Nothing changed, only the root is listed and the rest is taken from the previous tree
+    scan_snapshot::tree warm;
+    size_t pruned = 0;
+    CHECK(walk(m.fs, "mod\\", &cold, warm, true, &pruned));
+    CHECK(pruned == 3);
+    CHECK(scan_walker::compare(cold, warm, [](const std::string&, const char*) {}) == 0);
+
+    // A file added deep in the tree changes only the time of the directory right above it, which gets listed again
+    m.dir.write("mod/models/cars/cheetah.dff", "01234");
+    scan_snapshot::tree full, warm2;
+    CHECK(walk(m.fs, "mod\\", nullptr, full, false));
+    CHECK(walk(m.fs, "mod\\", &cold, warm2, true, &pruned));
+    CHECK(pruned == 2);     // "models" and "text"
+    CHECK(scan_walker::compare(full, warm2, [](const std::string& path, const char* what) {
+        fprintf(stderr, "%s: %s\n", path.c_str(), what);
+    }) == 0);
+
+    // A file removed is gone from the warm tree too
+    unlink((m.dir / "mod/text/american.gxt").c_str());
+    scan_snapshot::tree full2, warm3;
+    CHECK(walk(m.fs, "mod\\", nullptr, full2, false));
+    CHECK(walk(m.fs, "mod\\", &warm2, warm3, true));
+    CHECK(scan_walker::compare(full2, warm3, [](const std::string&, const char*) {}) == 0);
+    auto names = paths(warm3);
+    CHECK(std::count(names.begin(), names.end(), "text\\american.gxt") == 0);
+    CHECK(std::count(names.begin(), names.end(), "models\\cars\\cheetah.dff") == 1);
+}
+
+#endif
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The std.stream read ahead predictor and cache, the cache reading from files in the temporary directory
+ *
+ */
+#include "test.hpp"
+#include <stream_readahead.hpp>
+#include <random>
+
+using stream_readahead::predictor;
+using stream_readahead::cache;
+
+static std::vector<uint32_t> predict(const predictor& p, uint32_t key, uint32_t min_count = 2)
+{
+    std::vector<uint32_t> out;
+    p.predict(key, out, min_count);
+    return out;
+}
+
+static std::vector<uint32_t> sorted(std::vector<uint32_t> v)
+{
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+// Waits for the background thread of @c to have read @count files (or given up on them)
+static bool wait_loaded(cache& c, uint64_t count)
+{
+    for(int i = 0; i < 5000; ++i)
+    {
+        auto stats = c.get_statistics();
+        if(stats.loaded + stats.dropped >= count) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+TEST(stream_readahead_predictor)
+{
+    // A vehicle always followed by its texture and its wheels
+    predictor p;
+    for(int i = 0; i < 2; ++i)
+    {
+        p.observe(100); p.observe(101); p.observe(102);
+        p.observe(500 + i);     // something else each time
+    }
+    CHECK(sorted(predict(p, 100)) == (std::vector<uint32_t> { 101, 102 }));
+    CHECK(predict(p, 101) == (std::vector<uint32_t> { 102 }));
+    CHECK(predict(p, 500).empty());
+    CHECK(sorted(predict(p, 500, 1)) == (std::vector<uint32_t> { 100, 101, 102, 501 }));
+    CHECK(predict(p, 999).empty());
+
+    // Requests in between (within the window) don't hide a successor
+    predictor q(8, 4);
+    for(int i = 0; i < 2; ++i)
+    {
+        q.observe(1); q.observe(700 + i); q.observe(800 + i); q.observe(2);
+    }
+    CHECK(predict(q, 1) == (std::vector<uint32_t> { 2 }));
+
+    // Past the window it's not a successor anymore
+    predictor r(8, 2);
+    for(int i = 0; i < 2; ++i)
+    {
+        r.observe(1); r.observe(700 + i); r.observe(800 + i); r.observe(2);
+    }
+    CHECK(sorted(predict(r, 1, 1)) == (std::vector<uint32_t> { 700, 701, 800, 801 }));
+
+    // A repeated request isn't a successor of itself
+    predictor s;
+    s.observe(5); s.observe(5); s.observe(5);
+    CHECK(predict(s, 5, 1).empty());
+
+    p.clear();
+    CHECK(predict(p, 100, 1).empty());
+}
+
+TEST(stream_readahead_predictor_replacement)
+{
+    // With room for two successors, a new successor replaces the least seen and can take over with time
+    predictor p(2, 1);
+    for(int i = 0; i < 3; ++i) { p.observe(1); p.observe(2); }
+    p.observe(1); p.observe(3);
+    CHECK(predict(p, 1, 1) == (std::vector<uint32_t> { 2, 3 }));
+
+    p.observe(1); p.observe(4);     // replaces 3 (seen once), starting from two
+    CHECK(predict(p, 1, 1) == (std::vector<uint32_t> { 2, 4 }));
+    for(int i = 0; i < 3; ++i) { p.observe(1); p.observe(4); }
+    CHECK(predict(p, 1, 1) == (std::vector<uint32_t> { 4, 2 }));
+}
+
+TEST(stream_readahead_cache)
+{
+    tests::temp_dir dir;
+    std::string a(1000, 'a'), b(3000, 'b'), c(3000, 'c');
+    CHECK(dir.write("a.dff", a) && dir.write("b.txd", b) && dir.write("c.txd", c));
+
+    cache ch(12000);
+    std::vector<char> out(4000);
+
+    // Not there until read ahead
+    CHECK(!ch.take(1, dir / "a.dff", a.size(), out.data()));
+    ch.prefetch(1, dir / "a.dff", a.size());
+    CHECK(wait_loaded(ch, 1));
+    CHECK(ch.take(1, dir / "a.dff", a.size(), out.data()) && std::string(out.data(), a.size()) == a);
+
+    // The path and size must be the same as when read ahead
+    CHECK(!ch.take(1, dir / "b.txd", a.size(), out.data()));
+    CHECK(!ch.take(1, dir / "a.dff", a.size() + 1, out.data()));
+
+    // Prefetching what's already there doesn't read it again, files bigger than a quarter of the budget aren't read
+    ch.prefetch(1, dir / "a.dff", a.size());
+    ch.prefetch(9, dir / "big.img", 3001);
+    ch.prefetch(2, dir / "b.txd", b.size());
+    CHECK(wait_loaded(ch, 2));
+    CHECK(ch.get_statistics().loaded == 2);
+
+    // Over the budget the taken files go first, then the least recently read
+    ch.prefetch(3, dir / "c.txd", c.size());
+    ch.prefetch(4, dir / "a.dff", a.size());
+    ch.prefetch(5, dir / "b.txd", b.size());
+    ch.prefetch(6, dir / "c.txd", c.size());
+    CHECK(wait_loaded(ch, 6));
+    CHECK(!ch.take(1, dir / "a.dff", a.size(), out.data()));
+    CHECK(!ch.take(2, dir / "b.txd", b.size(), out.data()));
+    CHECK(ch.take(3, dir / "c.txd", c.size(), out.data()) && std::string(out.data(), c.size()) == c);
+    CHECK(ch.take(4, dir / "a.dff", a.size(), out.data()));
+    CHECK(ch.take(5, dir / "b.txd", b.size(), out.data()) && std::string(out.data(), b.size()) == b);
+    CHECK(ch.take(6, dir / "c.txd", c.size(), out.data()));
+    CHECK(ch.get_statistics().evicted == 1);    // 2 wasn't taken, 1 was
+
+    // A file which can't be read isn't kept (the reads are in order, so 8 being there means 7 was tried)
+    ch.prefetch(7, dir / "nothere.dff", 100);
+    ch.prefetch(8, dir / "a.dff", a.size());
+    CHECK(wait_loaded(ch, 7));
+    CHECK(!ch.take(7, dir / "nothere.dff", 100, out.data()));
+
+    // Cleared, nothing is there anymore
+    ch.clear();
+    CHECK(!ch.take(3, dir / "c.txd", c.size(), out.data()) && !ch.take(8, dir / "a.dff", a.size(), out.data()));
+
+    auto stats = ch.get_statistics();
+    CHECK(stats.hits == 5 && stats.misses == 8 && stats.evicted == 1);
+}
+
+TEST(stream_readahead_cache_threads)
+{
+    // The game thread taking and clearing while the background thread reads
+    tests::temp_dir dir;
+    std::vector<std::string> data;
+    for(int i = 0; i < 16; ++i)
+    {
+        data.push_back(std::string(100 + i * 50, char('a' + i)));
+        CHECK(dir.write("f" + std::to_string(i), data.back()));
+    }
+
+    std::mt19937 rng(50);
+    cache ch(4000, 4);
+    std::vector<char> out(1000);
+    for(int step = 0; step < 20000; ++step)
+    {
+        uint32_t i = rng() % data.size();
+        switch(rng() % 8)
+        {
+            case 0:
+                if(rng() % 50 == 0) ch.clear();
+                break;
+            case 1: case 2: case 3:
+                ch.prefetch(i, dir / ("f" + std::to_string(i)), data[i].size());
+                break;
+            default:
+                if(ch.take(i, dir / ("f" + std::to_string(i)), data[i].size(), out.data()))
+                    CHECK(std::string(out.data(), data[i].size()) == data[i]);
+                break;
+        }
+    }
+
+    auto stats = ch.get_statistics();
+    CHECK(stats.hits + stats.misses > 0);
+}
+
+BENCH(stream_readahead_take)
+{
+    // Taking a loose model from memory against reading it from the disk
+    tests::temp_dir dir;
+    std::vector<std::string> paths;
+    for(int i = 0; i < 64; ++i)
+    {
+        paths.push_back(dir / ("model" + std::to_string(i) + ".dff"));
+        dir.write("model" + std::to_string(i) + ".dff", std::string(32768, char(i)));
+    }
+
+    cache ch(64 * 32768 * 2, 64);
+    for(uint32_t i = 0; i < paths.size(); ++i) ch.prefetch(i, paths[i], 32768);
+    wait_loaded(ch, paths.size());
+
+    std::vector<char> out(32768);
+    tests::benchmark("fopen + fread", 20000, [&](size_t i) {
+        if(FILE* f = fopen(paths[i % paths.size()].c_str(), "rb"))
+        {
+            tests::keep(fread(out.data(), 1, out.size(), f));
+            fclose(f);
+        }
+    });
+    tests::benchmark("cache::take", 20000, [&](size_t i) {
+        tests::keep(ch.take(uint32_t(i % paths.size()), paths[i % paths.size()], 32768, out.data()));
+    });
+
+    predictor p;
+    std::mt19937 rng(51);
+    std::vector<uint32_t> requests;
+    for(int i = 0; i < 4096; ++i) requests.push_back(rng() % 2000);
+    std::vector<uint32_t> predicted;
+    tests::benchmark("predictor::observe + predict", 1000000, [&](size_t i) {
+        uint32_t key = requests[i % requests.size()];
+        p.observe(key);
+        predicted.clear();
+        p.predict(key, predicted);
+    });
+    tests::keep(predicted.size());
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The stream trace written by std.stream and read back by the stream_replay tool
+ *
+ */
+#include "test.hpp"
+#include <stream_trace.hpp>
+#include <random>
+
+static bool same(const stream_trace::record& a, const stream_trace::record& b)
+{
+    return a.id == b.id && a.type == b.type && a.flags == b.flags && a.channel == b.channel && a.file == b.file
+        && a.offset == b.offset && a.size == b.size && a.queued == b.queued
+        && a.queue_time == b.queue_time && a.service_time == b.service_time;
+}
+
+static stream_trace::record random_record(std::mt19937_64& rng, uint16_t file, bool loose)
+{
+    stream_trace::record r;
+    r.id            = (rng() % 8)? int32_t(rng() % 30000) : -1;
+    r.type          = uint8_t(rng() % 8);
+    r.flags         = uint8_t((loose? stream_trace::flag_loose : 0) | (rng() % 16? 0 : stream_trace::flag_failed));
+    r.channel       = uint8_t(rng() % 2);
+    r.file          = file;
+    r.offset        = rng() % (uint64_t(1) << 40);
+    r.size          = uint32_t(rng());
+    r.queued        = rng();
+    r.queue_time    = uint32_t(rng());
+    r.service_time  = uint32_t(rng());
+    return r;
+}
+
+TEST(stream_trace_write_and_read)
+{
+    tests::temp_dir dir;
+    std::mt19937_64 rng(46);
+    std::vector<std::string> paths = { "models/gta3.img", "models/gta_int.img", "modloader/cars/infernus.dff", "modloader/cars/infernus.txd" };
+    std::vector<stream_trace::record> written;
+
+    // Enough requests to flush the buffer a few times
+    stream_trace::writer w;
+    CHECK(!w.is_open());
+    CHECK(w.open((dir / "trace.bin").c_str()) && w.is_open());
+    for(int i = 0; i < 10000; ++i)
+    {
+        size_t k = rng() % paths.size();
+        uint16_t file = w.file(paths[k]);
+        written.push_back(random_record(rng, file, k >= 2));
+        w.add(written.back());
+    }
+    CHECK(w.file(paths[0]) == w.file(paths[0]));
+    w.close();
+    CHECK(!w.is_open());
+
+    stream_trace::trace t;
+    CHECK(t.load((dir / "trace.bin").c_str()));
+    CHECK(t.records.size() == written.size());
+    for(size_t i = 0; i < written.size() && i < t.records.size(); ++i)
+        CHECK(same(t.records[i], written[i]));
+
+    // Files are indexed in the order they were first seen
+    CHECK(t.files.size() == paths.size());
+    for(auto& r : t.records)
+        CHECK(t.files[r.file] == paths[0] || t.files[r.file] == paths[1] || t.loose[r.file]);
+    for(size_t i = 0; i < t.files.size(); ++i)
+        CHECK(t.loose[i] == (t.files[i].find("modloader/") == 0));
+
+    CHECK(!t.load((dir / "nothere.bin").c_str()));
+}
+
+TEST(stream_trace_reopen)
+{
+    // A reopened writer starts a new trace, with the file indices from zero
+    tests::temp_dir dir;
+    std::mt19937_64 rng(47);
+    stream_trace::writer w;
+    CHECK(w.open((dir / "a.bin").c_str()));
+    w.file("a"); w.file("b");
+    w.add(random_record(rng, w.file("c"), false));
+    CHECK(w.open((dir / "b.bin").c_str()));
+    CHECK(w.file("c") == 0);
+    w.add(random_record(rng, 0, true));
+    w.close();
+
+    stream_trace::trace a, b;
+    CHECK(a.load((dir / "a.bin").c_str()) && a.files.size() == 3 && a.records.size() == 1 && a.records[0].file == 2);
+    CHECK(b.load((dir / "b.bin").c_str()) && b.files.size() == 1 && b.files[0] == "c" && b.loose[0]);
+}
+
+TEST(stream_trace_malformed)
+{
+    tests::temp_dir dir;
+    std::mt19937_64 rng(48);
+    stream_trace::writer w;
+    CHECK(w.open((dir / "trace.bin").c_str()));
+    for(int i = 0; i < 50; ++i)
+        w.add(random_record(rng, w.file("file" + std::to_string(i % 7)), false));
+    w.close();
+
+    std::string data;
+    CHECK(dir.read("trace.bin", data));
+    stream_trace::trace full;
+    CHECK(full.parse(data) && full.records.size() == 50);
+
+    // A trace cut short is read up to its last whole entry
+    size_t last = 0;
+    for(size_t len = 12; len <= data.size(); ++len)
+    {
+        stream_trace::trace t;
+        CHECK(t.parse(data.substr(0, len)));
+        CHECK(t.records.size() >= last && t.records.size() <= full.records.size());
+        for(size_t i = 0; i < t.records.size(); ++i)
+            CHECK(same(t.records[i], full.records[i]));
+        last = t.records.size();
+    }
+    CHECK(last == 50);
+
+    // Bad header, unknown entries and requests on files not seen yet are refused
+    stream_trace::trace t;
+    CHECK(!t.parse(""));
+    CHECK(!t.parse(data.substr(0, 11)));
+    CHECK(!t.parse("MLSTRACX" + data.substr(8)));
+    std::string ver = data; ver[8] = 2;
+    CHECK(!t.parse(ver));
+    CHECK(!t.parse(data + "X"));
+    CHECK(!t.parse(data.substr(0, 12) + 'R' + std::string(stream_trace::record_size, '\0')));
+    CHECK(t.records.empty() && t.files.empty());
+}
+
+BENCH(stream_trace_throughput)
+{
+    // A long session: 1M requests over a few hundred files
+    tests::temp_dir dir;
+    std::mt19937_64 rng(49);
+    std::vector<std::string> paths;
+    for(int i = 0; i < 300; ++i) paths.push_back("modloader/mod" + std::to_string(i % 20) + "/file" + std::to_string(i) + ".dff");
+    std::vector<stream_trace::record> records;
+    for(int i = 0; i < 1000; ++i) records.push_back(random_record(rng, 0, true));
+
+    stream_trace::writer w;
+    w.open((dir / "trace.bin").c_str());
+    tests::benchmark("writer::file + writer::add", 1000000, [&](size_t i) {
+        stream_trace::record r = records[i % records.size()];
+        r.file = w.file(paths[i % paths.size()]);
+        w.add(r);
+    });
+    w.close();
+
+    std::string data;
+    dir.read("trace.bin", data);
+    size_t count = 0;
+    tests::benchmark("trace::parse (1M requests)", 10, [&](size_t) {
+        stream_trace::trace t;
+        t.parse(data);
+        count += t.records.size();
+    });
+    tests::keep(count);
+}
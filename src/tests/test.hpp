@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ */
+#ifndef TESTS_TEST_HPP
+#define	TESTS_TEST_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// The MSVC runtime names used by the shared headers
+inline int _stricmp(const char* a, const char* b)               { return strcasecmp(a, b); }
+inline int _strnicmp(const char* a, const char* b, size_t n)    { return strncasecmp(a, b, n); }
+#endif
+
+/*
+ *  Tests and benchmarks of the headers that don't depend on the game (see main.cpp for the runner)
+ *
+ *      TEST(name)  { CHECK(expr); }        -> Runs by default
+ *      BENCH(name) { benchmark(...); }     -> Runs only with --bench
+ *
+ *  A failed CHECK is reported and the test goes on, the runner fails if any CHECK has failed.
+ */
+namespace tests
+{
+    struct test_case
+    {
+        const char* name;
+        void      (*func)();
+        bool        is_bench;
+    };
+
+    inline std::vector<test_case>& registry()
+    {
+        static std::vector<test_case> list;
+        return list;
+    }
+
+    inline int& failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    struct registrar
+    {
+        registrar(const char* name, void (*func)(), bool is_bench)
+        {
+            registry().push_back(test_case { name, func, is_bench });
+        }
+    };
+
+    inline void fail(const char* file, int line, const char* expr)
+    {
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+        ++failures();
+    }
+
+    // Calls @func(i) @iterations times and prints how many calls per second it took
+    template<class F>
+    inline double benchmark(const char* what, size_t iterations, F func)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < iterations; ++i)
+            func(i);
+        auto end = std::chrono::steady_clock::now();
+
+        double secs = std::chrono::duration<double>(end - begin).count();
+        double ops  = secs > 0? iterations / secs : 0.0;
+        printf("    %-40s %12.0f ops/sec\n", what, ops);
+        return ops;
+    }
+
+    // Number of calls to operator new so far, counted by the runner (see main.cpp)
+    inline std::atomic<size_t>& allocations()
+    {
+        static std::atomic<size_t> count(0);
+        return count;
+    }
+
+    // Keeps the compiler from throwing away the result of a benchmarked computation
+    inline volatile char& sink()
+    {
+        static volatile char value;
+        return value;
+    }
+
+    template<class T>
+    inline void keep(const T& value)
+    {
+        sink() = *(const volatile char*)(&value);
+    }
+
+    /*
+     *  temp_dir
+     *      Unique directory created under the system temporary directory, removed (with its content) on destruction
+     */
+    class temp_dir
+    {
+        public:
+            temp_dir()
+            {
+#ifdef _WIN32
+                char buf[MAX_PATH];
+                GetTempPathA(sizeof(buf), buf);
+                for(unsigned i = GetTickCount(); ; ++i)
+                {
+                    this->dir = std::string(buf) + "ml_test_" + std::to_string(i);
+                    if(CreateDirectoryA(dir.c_str(), nullptr)) break;
+                }
+#else
+                const char* tmp = getenv("TMPDIR");
+                std::string templ = std::string(tmp && *tmp? tmp : "/tmp") + "/ml_test_XXXXXX";
+                if(mkdtemp(&templ[0])) this->dir = templ;
+#endif
+            }
+
+            ~temp_dir()
+            {
+                if(dir.size()) remove_all(dir);
+            }
+
+            temp_dir(const temp_dir&) = delete;
+            temp_dir& operator=(const temp_dir&) = delete;
+
+            // Path to the directory, without a trailing slash
+            const std::string& path() const { return dir; }
+
+            // Path to @name inside the directory
+            std::string operator/(const std::string& name) const { return dir + "/" + name; }
+
+            // Creates the directory @name inside the directory
+            bool mkdir(const std::string& name) const
+            {
+#ifdef _WIN32
+                return CreateDirectoryA((*this / name).c_str(), nullptr) != 0;
+#else
+                return ::mkdir((*this / name).c_str(), 0755) == 0;
+#endif
+            }
+
+            // Writes @content into the file @name inside the directory
+            bool write(const std::string& name, const std::string& content) const
+            {
+                bool result = false;
+                if(FILE* f = fopen((*this / name).c_str(), "wb"))
+                {
+                    result = fwrite(content.data(), 1, content.size(), f) == content.size();
+                    result = (fclose(f) == 0) && result;
+                }
+                return result;
+            }
+
+            // Reads the file @name inside the directory into @content
+            bool read(const std::string& name, std::string& content) const
+            {
+                content.clear();
+                if(FILE* f = fopen((*this / name).c_str(), "rb"))
+                {
+                    char buf[4096];
+                    size_t n;
+                    while((n = fread(buf, 1, sizeof(buf), f)) != 0)
+                        content.append(buf, n);
+                    fclose(f);
+                    return true;
+                }
+                return false;
+            }
+
+            bool exists(const std::string& name) const
+            {
+                if(FILE* f = fopen((*this / name).c_str(), "rb"))
+                    return fclose(f), true;
+                return false;
+            }
+
+        private:
+            static void remove_all(const std::string& path)
+            {
+#ifdef _WIN32
+                WIN32_FIND_DATAA fd;
+                HANDLE hFind = FindFirstFileA((path + "\\*").c_str(), &fd);
+                if(hFind != INVALID_HANDLE_VALUE)
+                {
+                    do
+                    {
+                        std::string name = fd.cFileName;
+                        if(name == "." || name == "..") continue;
+                        if(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) remove_all(path + "/" + name);
+                        else DeleteFileA((path + "/" + name).c_str());
+                    } while(FindNextFileA(hFind, &fd));
+                    FindClose(hFind);
+                }
+                RemoveDirectoryA(path.c_str());
+#else
+                if(DIR* d = opendir(path.c_str()))
+                {
+                    while(dirent* e = readdir(d))
+                    {
+                        std::string name = e->d_name, full = path + "/" + name;
+                        struct stat st;
+                        if(name == "." || name == ".." || lstat(full.c_str(), &st) != 0) continue;
+                        if(S_ISDIR(st.st_mode)) remove_all(full);
+                        else unlink(full.c_str());
+                    }
+                    closedir(d);
+                }
+                rmdir(path.c_str());
+#endif
+            }
+
+        private:
+            std::string dir;
+    };
+}
+
+#define TEST_REGISTER(name, is_bench)                                                       \
+    static void name();                                                                     \
+    static tests::registrar name##_registrar(#name, &name, is_bench);                       \
+    static void name()
+
+#define TEST(name)  TEST_REGISTER(name, false)
+#define BENCH(name) TEST_REGISTER(name, true)
+
+#define CHECK(expr) ((expr)? (void)(0) : tests::fail(__FILE__, __LINE__, #expr))
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The std.bank wave cache, over wave files and cache files in the temporary directory
+ *
+ */
+#include "test.hpp"
+#include "../plugins/gta3/std.bank/CWaveCache.hpp"
+
+namespace
+{
+    void put32(std::string& s, uint32_t v) { for(int i = 0; i < 4; ++i) s.push_back(char(v >> (i * 8))); }
+    void put16(std::string& s, uint16_t v) { for(int i = 0; i < 2; ++i) s.push_back(char(v >> (i * 8))); }
+
+    std::string wave(uint32_t rate, const std::string& pcm)
+    {
+        std::string fmt, s("RIFF");
+        put16(fmt, 1); put16(fmt, 1); put32(fmt, rate); put32(fmt, rate * 2); put16(fmt, 2); put16(fmt, 16);
+        put32(s, uint32_t(4 + 8 + fmt.size() + 8 + pcm.size()));
+        s += "WAVE";
+        s += "fmt "; put32(s, uint32_t(fmt.size())); s += fmt;
+        s += "data"; put32(s, uint32_t(pcm.size())); s += pcm;
+        return s;
+    }
+}
+
+TEST(wave_cache_hits)
+{
+    tests::temp_dir dir;
+    dir.write("a.wav", wave(22050, std::string(1000, 'x')));
+    dir.write("b.wav", wave(44100, std::string(10, 'y')));
+    dir.write("bad.wav", "junk");
+    std::string cache = dir / "waves.wc";
+
+    {
+        // Nothing cached yet, every wave is opened
+        CWaveCache c;
+        CHECK(!c.Load(cache));
+        auto a = c.Peek(1, 1044, 5, (dir / "a.wav").c_str());
+        CHECK(a.valid && a.audio_format == 1 && a.sound_size == 1000 && a.sound_offset == 44 && a.sample_rate == 22050);
+        CHECK(a.num_channels == 1 && a.bps == 16);
+        CHECK(c.Peek(2, 54, 5, (dir / "b.wav").c_str()).sample_rate == 44100);
+        CHECK(!c.Peek(3, 4, 5, (dir / "bad.wav").c_str()).valid);
+        CHECK(c.GetMisses() == 3 && c.GetHits() == 0);
+        CHECK(c.Save(cache));
+    }
+
+    {
+        // Unchanged waves come from the cache without being opened (it's moved away to prove it)
+        rename((dir / "a.wav").c_str(), (dir / "a.bak").c_str());
+        CWaveCache c;
+        CHECK(c.Load(cache));
+        auto a = c.Peek(1, 1044, 5, (dir / "a.wav").c_str());
+        CHECK(a.valid && a.sound_size == 1000 && a.sound_offset == 44);
+
+        // A different time or size opens it again, invalid waves aren't remembered
+        CHECK(c.Peek(2, 54, 6, (dir / "b.wav").c_str()).valid);
+        CHECK(!c.Peek(3, 4, 5, (dir / "bad.wav").c_str()).valid);
+        CHECK(c.GetHits() == 1 && c.GetMisses() == 2);
+        CHECK(c.Save(cache));
+        rename((dir / "a.bak").c_str(), (dir / "a.wav").c_str());
+    }
+
+    {
+        // Only the waves looked up are kept
+        CWaveCache c;
+        CHECK(c.Load(cache));
+        c.Peek(2, 54, 6, (dir / "b.wav").c_str());
+        CHECK(c.GetHits() == 1);
+        CHECK(c.Save(cache));
+
+        CWaveCache d;
+        CHECK(d.Load(cache));
+        d.Peek(1, 1044, 5, (dir / "a.wav").c_str());
+        d.Peek(2, 54, 6, (dir / "b.wav").c_str());
+        CHECK(d.GetMisses() == 1 && d.GetHits() == 1);
+    }
+}
+
+TEST(wave_cache_save_only_changed)
+{
+    tests::temp_dir dir;
+    dir.write("a.wav", wave(22050, std::string(100, 'x')));
+    std::string cache = dir / "waves.wc";
+
+    CWaveCache c;
+    c.Peek(1, 144, 5, (dir / "a.wav").c_str());
+    CHECK(c.Save(cache));
+
+    // Nothing changed, the file isn't written (a directory in its place would make it fail)
+    std::string saved;
+    CHECK(dir.read("waves.wc", saved));
+    CWaveCache d;
+    CHECK(d.Load(cache));
+    d.Peek(1, 144, 5, (dir / "a.wav").c_str());
+    remove(cache.c_str());
+    CHECK(dir.mkdir("waves.wc"));
+    CHECK(d.Save(cache));
+}
+
+TEST(wave_cache_malformed)
+{
+    tests::temp_dir dir;
+    dir.write("a.wav", wave(22050, std::string(100, 'x')));
+    std::string cache = dir / "waves.wc";
+
+    CWaveCache c;
+    c.Peek(1, 144, 5, (dir / "a.wav").c_str());
+    c.Peek(2, 144, 5, (dir / "a.wav").c_str());
+    CHECK(c.Save(cache));
+    std::string good;
+    CHECK(dir.read("waves.wc", good));
+
+    // Truncated, bad magic, other version or trailing bytes: nothing is taken from the cache
+    std::string version = good; version[8] = 99;
+    std::string magic = good; magic[0] = 'X';
+    for(const std::string& content : { good.substr(0, 7), good.substr(0, 12 + 20), good.substr(0, good.size() - 1),
+                                       good + "abc", version, magic, std::string() })
+    {
+        dir.write("waves.wc", content);
+        CWaveCache d;
+        CHECK(!d.Load(cache));
+        d.Peek(1, 144, 5, (dir / "a.wav").c_str());
+        CHECK(d.GetHits() == 0 && d.GetMisses() == 1);
+    }
+}
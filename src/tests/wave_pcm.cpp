@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  The RIFF chunks walk of CWavePCM, over wave files in the temporary directory and in memory
+ *
+ */
+#include "test.hpp"
+#include <CWavePCM.hpp>
+
+namespace
+{
+    void put32(std::string& s, uint32_t v) { for(int i = 0; i < 4; ++i) s.push_back(char(v >> (i * 8))); }
+    void put16(std::string& s, uint16_t v) { for(int i = 0; i < 2; ++i) s.push_back(char(v >> (i * 8))); }
+
+    std::string chunk(const char* id, const std::string& body)
+    {
+        std::string s(id, 4);
+        put32(s, uint32_t(body.size()));
+        s += body;
+        if(body.size() & 1) s.push_back(0);     // chunks are word aligned
+        return s;
+    }
+
+    std::string fmt(uint16_t format = 1, uint16_t channels = 1, uint32_t rate = 22050, uint16_t bps = 16)
+    {
+        std::string b;
+        put16(b, format); put16(b, channels); put32(b, rate); put32(b, rate * channels * bps / 8);
+        put16(b, uint16_t(channels * bps / 8)); put16(b, bps);
+        return chunk("fmt ", b);
+    }
+
+    // A RIFF WAVE with the chunks in @body, @size is the RIFF size if not the right one
+    std::string riff(const std::string& body, int64_t size = -1)
+    {
+        std::string s("RIFF");
+        put32(s, size < 0? uint32_t(body.size() + 4) : uint32_t(size));
+        return s + "WAVE" + body;
+    }
+
+    // What both the file reader and the memory parser found
+    struct parsed
+    {
+        bool        file_pcm;       // CWavePCM::Peek on the file
+        bool        file_chunks;    // CWavePCM::HasChunks after it
+        bool        mem_pcm;        // CWavePCM::Parse on the content
+        uint32_t    offset, size, rate;
+    };
+
+    parsed parse(const tests::temp_dir& dir, const std::string& content)
+    {
+        parsed r = {};
+        dir.write("wave.wav", content);
+
+        CWavePCM file, mem;
+        r.file_pcm    = file.Peek((dir / "wave.wav").c_str());
+        r.file_chunks = file.HasChunks();
+        r.mem_pcm     = mem.Parse(content.data(), content.size());
+        CHECK(!file.IsOpen());
+
+        if(r.file_chunks)
+        {
+            r.offset = file.GetSoundBufferOffset();
+            r.size   = file.GetSoundBufferSize();
+            r.rate   = file.GetSampleRate();
+            if(r.mem_pcm) CHECK(mem.GetSoundBufferOffset() == r.offset && mem.GetSoundBufferSize() == r.size);
+        }
+        return r;
+    }
+}
+
+TEST(wave_pcm_valid)
+{
+    tests::temp_dir dir;
+    std::string pcm(1000, 'x');
+
+    // The usual layout
+    parsed r = parse(dir, riff(fmt() + chunk("data", pcm)));
+    CHECK(r.file_pcm && r.mem_pcm && r.offset == 12 + 24 + 8 && r.size == 1000 && r.rate == 22050);
+
+    // Data before fmt, and an odd sized chunk before them (padded)
+    r = parse(dir, riff(chunk("LIST", std::string(7, 'a')) + chunk("data", pcm) + fmt(1, 2, 44100)));
+    CHECK(r.file_pcm && r.mem_pcm && r.offset == 12 + 16 + 8 && r.rate == 44100);
+
+    // A chunk bigger than what the reader reads at once before them
+    r = parse(dir, riff(chunk("LIST", std::string(5000, 'a')) + fmt() + chunk("data", pcm)));
+    CHECK(r.file_pcm && r.mem_pcm && r.offset == 12 + 5008 + 24 + 8);
+
+    // Fmt chunk bigger than the PCM one (extension bytes)
+    std::string ext = fmt();
+    ext[4] = 18;
+    ext.insert(ext.end(), { 0, 0 });
+    r = parse(dir, riff(ext + chunk("data", pcm)));
+    CHECK(r.file_pcm && r.mem_pcm && r.offset == 12 + 26 + 8);
+
+    // RIFF size left unset by the writer
+    r = parse(dir, riff(fmt() + chunk("data", pcm), 0));
+    CHECK(r.file_pcm && r.mem_pcm && r.size == 1000);
+
+    // The memory parser needs only up to the data chunk header
+    std::string content = riff(fmt() + chunk("data", pcm));
+    CWavePCM head;
+    CHECK(head.Parse(content.data(), 12 + 24 + 8) && head.GetSoundBufferSize() == 1000);
+    CHECK(!head.Parse(content.data(), 12 + 24 + 7));
+}
+
+TEST(wave_pcm_malformed)
+{
+    tests::temp_dir dir;
+    std::string pcm(1000, 'x');
+    std::string good = riff(fmt() + chunk("data", pcm));
+
+    // Not PCM, the chunks are there but it isn't accepted
+    parsed r = parse(dir, riff(fmt(3) + chunk("data", pcm)));
+    CHECK(!r.file_pcm && r.file_chunks && !r.mem_pcm);
+
+    // Not RIFF, not WAVE
+    std::string bad = good; bad[0] = 'X';
+    r = parse(dir, bad);
+    CHECK(!r.file_pcm && !r.file_chunks && !r.mem_pcm);
+    bad = good; bad[8] = 'X';
+    r = parse(dir, bad);
+    CHECK(!r.file_pcm && !r.file_chunks && !r.mem_pcm);
+
+    // Missing data or fmt chunk, fmt chunk too small for PCM
+    r = parse(dir, riff(fmt() + chunk("LIST", "abcd")));
+    CHECK(!r.file_pcm && !r.file_chunks && !r.mem_pcm);
+    r = parse(dir, riff(chunk("data", pcm)));
+    CHECK(!r.file_pcm && !r.file_chunks && !r.mem_pcm);
+    r = parse(dir, riff(chunk("fmt ", "abcd") + chunk("data", pcm)));
+    CHECK(!r.file_pcm && !r.mem_pcm);
+
+    // Cut short anywhere before the sound buffer
+    for(size_t len = 0; len < 12 + 24 + 8; ++len)
+    {
+        r = parse(dir, good.substr(0, len));
+        CHECK(!r.file_pcm && !r.mem_pcm);
+    }
+
+    // The chunks past the RIFF size don't count
+    r = parse(dir, riff(fmt(), 4 + 24) + chunk("data", pcm));
+    CHECK(!r.file_pcm && !r.file_chunks && !r.mem_pcm);
+
+    // A chunk size running past 32 bits offsets
+    std::string huge = riff(fmt(), 0) + "LIST";
+    put32(huge, 0xFFFFFFF0);
+    r = parse(dir, huge + chunk("data", pcm));
+    CHECK(!r.file_pcm && !r.mem_pcm);
+
+    // No file at all
+    CWavePCM none;
+    CHECK(!none.Peek((dir / "nothere.wav").c_str()) && !none.HasChunks());
+}
+
+BENCH(wave_pcm_peek)
+{
+    // The header of a wave in the SFX folder, from the disk and from memory
+    tests::temp_dir dir;
+    std::string content = riff(chunk("LIST", std::string(60, 'a')) + fmt() + chunk("data", std::string(20000, 'x')));
+    dir.write("wave.wav", content);
+    std::string path = dir / "wave.wav";
+
+    tests::benchmark("CWavePCM::Peek", 20000, [&](size_t) {
+        CWavePCM w;
+        tests::keep(w.Peek(path.c_str()));
+    });
+    tests::benchmark("CWavePCM::Parse", 2000000, [&](size_t) {
+        CWavePCM w;
+        tests::keep(w.Parse(content.data(), content.size()));
+    });
+}
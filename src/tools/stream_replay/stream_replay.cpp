@@ -0,0 +1,483 @@
+/*
+ * Streaming Trace Replayer for Mod Loader
+ * Copyright (C) 2015  LINK/2012 <dma_2012@hotmail.com>
+ * Licensed under the MIT License, see LICENSE at top level directory.
+ *
+ *  Plays back a trace recorded by std.stream (-streamtrace command line) against the real files, using the same
+ *  queueing model of the game: each channel has at most one request in flight and a single thread serves the
+ *  requests in the order they were queued. Used to compare I/O strategies with reproducible request sequences.
+ *
+ *  Usage: stream_replay <trace> <gamedir> [options]
+ *      --burst             Queue each request as soon as its channel is free, ignoring the recorded arrival times
+ *      --speed <x>         Scale of the recorded arrival times (2 = twice as fast)
+ *      --handles <n>       Keep up to n loose files open between requests (default 0, opens and closes each like the game)
+ *      --coalesce          Serve queued requests for contiguous ranges of the same file with a single read
+ *      --prefetch <kib>    Read the next kib KiB after each read and serve the requests inside it from memory
+ *      --readahead <mib>   Read ahead the loose files predicted to follow each request into a mib MiB cache (as std.stream
+ *                          does with -streamreadahead), the texture dictionaries of models aren't in the trace so only the
+ *                          learned successors are read ahead
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stream_trace.hpp>
+#include <stream_readahead.hpp>
+
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+using clock_type = std::chrono::steady_clock;
+
+struct options
+{
+    bool    burst       = false;
+    double  speed       = 1.0;
+    size_t  handles     = 0;
+    bool    coalesce    = false;
+    size_t  prefetch    = 0;        // In bytes
+    size_t  readahead   = 0;        // In bytes
+};
+
+/*
+ *  Request being replayed
+ */
+struct request
+{
+    const stream_trace::record* rec;
+    clock_type::time_point      queued;     // When it was queued by the replay
+    clock_type::time_point      begin;      // When the serving thread took it
+    clock_type::time_point      end;        // When it was served
+    bool                        result;
+};
+
+/*
+ *  Statistics of a set of times in microseconds
+ */
+struct stats
+{
+    std::vector<uint64_t> values;
+
+    void add(uint64_t v) { values.push_back(v); }
+
+    void print(const char* name)
+    {
+        if(values.empty())
+            return;
+
+        std::sort(values.begin(), values.end());
+        uint64_t sum = 0;
+        for(auto v : values) sum += v;
+
+        auto pct = [this](double p) { return values[std::min(values.size() - 1, size_t(p * values.size()))]; };
+        printf("    %-24s mean %8.1f  p50 %8llu  p95 %8llu  p99 %8llu  max %8llu (us)\n", name, double(sum) / values.size(),
+            (unsigned long long)(pct(0.50)), (unsigned long long)(pct(0.95)),
+            (unsigned long long)(pct(0.99)), (unsigned long long)(values.back()));
+    }
+};
+
+/*
+ *  Finds the actual path of a game path (case insensitive, with backslashes) under @root
+ */
+static std::string resolve_path(const std::string& root, std::string path)
+{
+    std::replace(path.begin(), path.end(), '\\', '/');
+    std::string result = root;
+    if(!result.empty() && result.back() != '/') result.push_back('/');
+
+#ifdef _WIN32
+    return result + path;
+#else
+    size_t pos = 0;
+    while(pos < path.size())
+    {
+        size_t next = path.find('/', pos);
+        if(next == path.npos) next = path.size();
+        std::string comp = path.substr(pos, next - pos);
+        pos = next + 1;
+
+        if(comp.empty() || comp == ".")
+            continue;
+
+        std::string found = comp;
+        if(DIR* dir = opendir(result.empty()? "." : result.c_str()))
+        {
+            while(dirent* e = readdir(dir))
+            {
+                if(comp.size() == strlen(e->d_name) && std::equal(comp.begin(), comp.end(), e->d_name,
+                    [](char a, char b) { return tolower(uint8_t(a)) == tolower(uint8_t(b)); }))
+                {
+                    found = e->d_name;
+                    if(found == comp) break;
+                }
+            }
+            closedir(dir);
+        }
+
+        result += found;
+        if(pos <= path.size()) result.push_back('/');
+    }
+    return result;
+#endif
+}
+
+static bool seek(FILE* f, uint64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(f, int64_t(offset), SEEK_SET) == 0;
+#else
+    return fseeko(f, off_t(offset), SEEK_SET) == 0;
+#endif
+}
+
+/*
+ *  The files the trace reads from, opened according to the replay options
+ */
+class file_set
+{
+    public:
+        uint64_t num_opens = 0;     // Number of times a file was opened
+        uint64_t num_reads = 0;     // Number of reads from the disk
+        uint64_t num_bytes = 0;     // Number of bytes read from the disk
+        uint64_t num_hits  = 0;     // Number of requests served from the prefetch window
+
+        file_set(const stream_trace::trace& trace, const std::string& root, const options& opt) :
+            opt(opt), files(trace.files.size())
+        {
+            for(size_t i = 0; i < files.size(); ++i)
+            {
+                files[i].loose = trace.loose[i];
+                if(!trace.files[i].empty())
+                    files[i].path = resolve_path(root, trace.files[i]);
+            }
+        }
+
+        ~file_set()
+        {
+            for(auto& f : files)
+            {
+                if(f.handle) fclose(f.handle);
+            }
+        }
+
+        // Gets the actual path of the file @index
+        const std::string& path(uint16_t index) const
+        {
+            return files[index].path;
+        }
+
+        // Reads @size bytes at @offset of the file @index into @buf
+        bool read(uint16_t index, uint64_t offset, uint32_t size, char* buf)
+        {
+            auto& f = files[index];
+
+            if(f.window_size && offset >= f.window_offset && offset + size <= f.window_offset + f.window_size)
+            {
+                memcpy(buf, &f.window[size_t(offset - f.window_offset)], size);
+                ++num_hits;
+                return true;
+            }
+
+            if(!open(f))
+                return false;
+
+            bool result = false;
+            if(seek(f.handle, offset))
+            {
+                if(opt.prefetch)
+                {
+                    f.window.resize(size + opt.prefetch);
+                    size_t n = fread(&f.window[0], 1, f.window.size(), f.handle);
+                    f.window_offset = offset;
+                    f.window_size   = n;
+                    num_bytes += n;
+                    if(n >= size) memcpy(buf, &f.window[0], size), result = true;
+                }
+                else
+                {
+                    size_t n = fread(buf, 1, size, f.handle);
+                    num_bytes += n;
+                    result = (n == size);
+                }
+                ++num_reads;
+            }
+
+            close(f);
+            return result;
+        }
+
+    private:
+        struct file
+        {
+            std::string         path;
+            bool                loose   = false;
+            FILE*               handle  = nullptr;
+            std::vector<char>   window;             // Prefetched data
+            uint64_t            window_offset = 0;
+            size_t              window_size   = 0;
+        };
+
+        const options&      opt;
+        std::vector<file>   files;
+        std::list<file*>    open_loose;             // Loose files kept open, most recently used first
+
+        bool open(file& f)
+        {
+            if(f.handle == nullptr)
+            {
+                if(f.path.empty() || (f.handle = fopen(f.path.c_str(), "rb")) == nullptr)
+                    return false;
+                setvbuf(f.handle, nullptr, _IONBF, 0);
+                ++num_opens;
+            }
+
+            if(f.loose && opt.handles)
+            {
+                open_loose.remove(&f);
+                open_loose.push_front(&f);
+                if(open_loose.size() > opt.handles)
+                {
+                    fclose(open_loose.back()->handle);
+                    open_loose.back()->handle = nullptr;
+                    open_loose.pop_back();
+                }
+            }
+            return true;
+        }
+
+        // The cd images are kept open by the game, the loose files are closed after each read unless caching handles
+        void close(file& f)
+        {
+            if(f.loose && !opt.handles)
+            {
+                fclose(f.handle);
+                f.handle = nullptr;
+            }
+        }
+};
+
+/*
+ *  Replays the trace, returning the served requests
+ */
+static std::vector<request> replay(const stream_trace::trace& trace, file_set& files, const options& opt,
+                                   stream_readahead::cache* ahead, double& wall)
+{
+    std::vector<request> requests(trace.records.size());
+    std::map<uint8_t, std::vector<request*>> channels;  // Requests of each channel, in the order they were queued
+
+    for(size_t i = 0; i < requests.size(); ++i)
+    {
+        requests[i].rec = &trace.records[i];
+        requests[i].result = false;
+    }
+
+    std::vector<request*> sorted;
+    for(auto& r : requests) sorted.push_back(&r);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const request* a, const request* b) {
+        return a->rec->queued < b->rec->queued;
+    });
+    for(auto* r : sorted) channels[r->rec->channel].push_back(r);
+
+    std::mutex mutex;
+    std::condition_variable cv_queue, cv_done;
+    std::deque<request*> queue;
+
+    // The loose files of each resource, to read them ahead
+    std::map<int32_t, const stream_trace::record*> loose;
+    for(auto& r : trace.records)
+    {
+        if((r.flags & stream_trace::flag_loose) && r.id != -1) loose.emplace(r.id, &r);
+    }
+
+    stream_readahead::predictor predictor;
+    std::vector<uint32_t> next;
+    auto read_ahead = [&](const stream_trace::record& rec)
+    {
+        if(rec.id == -1) return;
+        next.clear();
+        predictor.observe(uint32_t(rec.id));
+        predictor.predict(uint32_t(rec.id), next);
+        for(auto nid : next)
+        {
+            auto it = loose.find(int32_t(nid));
+            if(it != loose.end()) ahead->prefetch(nid, files.path(it->second->file), it->second->size);
+        }
+    };
+
+    auto start = clock_type::now();
+    uint64_t first = sorted.empty()? 0 : sorted.front()->rec->queued;
+
+    // One thread per channel queues its requests, waiting for the previous one to be served
+    std::vector<std::thread> producers;
+    for(auto& pair : channels)
+    {
+        auto* list = &pair.second;
+        producers.emplace_back([&, list]
+        {
+            for(auto* r : *list)
+            {
+                if(!opt.burst)
+                {
+                    auto at = std::chrono::microseconds(uint64_t(double(r->rec->queued - first) / opt.speed));
+                    std::this_thread::sleep_until(start + at);
+                }
+
+                std::unique_lock<std::mutex> lock(mutex);
+                if(ahead) read_ahead(*r->rec);
+                r->queued = clock_type::now();
+                queue.push_back(r);
+                cv_queue.notify_one();
+                cv_done.wait(lock, [&] { return r->end != clock_type::time_point(); });
+            }
+        });
+    }
+
+    // The streaming thread
+    std::vector<char> buffer;
+    std::vector<request*> batch;
+    for(size_t served = 0; served < requests.size(); )
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv_queue.wait(lock, [&] { return !queue.empty(); });
+
+            batch.assign(1, queue.front());
+            queue.pop_front();
+
+            // Take the next requests while they continue the range of the first
+            while(opt.coalesce && !queue.empty())
+            {
+                auto* last = batch.back()->rec;
+                auto* next = queue.front()->rec;
+                if(next->file != last->file || next->offset != last->offset + last->size)
+                    break;
+                batch.push_back(queue.front());
+                queue.pop_front();
+            }
+        }
+
+        auto begin = clock_type::now();
+        uint64_t offset = batch.front()->rec->offset;
+        uint32_t size   = uint32_t(batch.back()->rec->offset + batch.back()->rec->size - offset);
+        if(buffer.size() < size) buffer.resize(size);
+        auto* rec = batch.front()->rec;
+        bool result = (ahead && batch.size() == 1 && (rec->flags & stream_trace::flag_loose)
+                       && ahead->take(uint32_t(rec->id), files.path(rec->file), size, buffer.data()))
+                       || files.read(rec->file, offset, size, buffer.data());
+        auto end = clock_type::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(auto* r : batch)
+            {
+                r->begin  = begin;
+                r->end    = end;
+                r->result = result;
+            }
+            served += batch.size();
+        }
+        cv_done.notify_all();
+    }
+
+    for(auto& t : producers) t.join();
+    wall = std::chrono::duration<double>(clock_type::now() - start).count();
+    return requests;
+}
+
+static void usage()
+{
+    fprintf(stderr,
+        "usage: stream_replay <trace> <gamedir> [options]\n"
+        "    --burst             queue each request as soon as its channel is free\n"
+        "    --speed <x>         scale of the recorded arrival times\n"
+        "    --handles <n>       keep up to n loose files open between requests\n"
+        "    --coalesce          serve contiguous queued requests with a single read\n"
+        "    --prefetch <kib>    read ahead kib KiB after each read\n"
+        "    --readahead <mib>   read ahead the predicted loose files into a mib MiB cache\n");
+}
+
+int main(int argc, char* argv[])
+{
+    options opt;
+    std::vector<const char*> args;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value  = (i + 1 < argc);
+
+        if(arg == "--burst")                    opt.burst = true;
+        else if(arg == "--coalesce")            opt.coalesce = true;
+        else if(arg == "--speed" && has_value)  opt.speed = std::max(0.001, atof(argv[++i]));
+        else if(arg == "--handles" && has_value)  opt.handles = size_t(strtoul(argv[++i], nullptr, 0));
+        else if(arg == "--prefetch" && has_value) opt.prefetch = size_t(strtoul(argv[++i], nullptr, 0)) * 1024;
+        else if(arg == "--readahead" && has_value) opt.readahead = size_t(strtoul(argv[++i], nullptr, 0)) * 1024 * 1024;
+        else if(arg.size() > 1 && arg[0] == '-')  return usage(), 1;
+        else args.push_back(argv[i]);
+    }
+
+    if(args.size() != 2)
+        return usage(), 1;
+
+    stream_trace::trace trace;
+    if(!trace.load(args[0]))
+    {
+        fprintf(stderr, "Failed to read the trace \"%s\"\n", args[0]);
+        return 1;
+    }
+
+    file_set files(trace, args[1], opt);
+    double wall;
+    std::unique_ptr<stream_readahead::cache> ahead(opt.readahead? new stream_readahead::cache(opt.readahead) : nullptr);
+    auto requests = replay(trace, files, opt, ahead.get(), wall);
+
+    // Report the recorded and replayed times
+    stats rec_queue, rec_service, queue, service, loose_service, cd_service;
+    uint64_t bytes = 0, failed = 0, rec_failed = 0;
+    for(auto& r : requests)
+    {
+        auto us = [](clock_type::duration d) { return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(d).count()); };
+        rec_queue.add(r.rec->queue_time);
+        rec_service.add(r.rec->service_time);
+        queue.add(us(r.begin - r.queued));
+        service.add(us(r.end - r.begin));
+        (r.rec->flags & stream_trace::flag_loose? loose_service : cd_service).add(us(r.end - r.begin));
+        bytes += r.rec->size;
+        if(!r.result) ++failed;
+        if(r.rec->flags & stream_trace::flag_failed) ++rec_failed;
+    }
+
+    printf("%u requests, %u files, %.1f MiB requested\n", unsigned(requests.size()), unsigned(trace.files.size()), bytes / 1048576.0);
+    printf("recorded (%u failed):\n", unsigned(rec_failed));
+    rec_queue.print("queue");
+    rec_service.print("service");
+    printf("replayed in %.3fs (%u failed):\n", wall, unsigned(failed));
+    queue.print("queue");
+    service.print("service");
+    cd_service.print("service (cd image)");
+    loose_service.print("service (loose)");
+    printf("    %llu opens, %llu reads, %.1f MiB read, %llu prefetch hits\n",
+        (unsigned long long)(files.num_opens), (unsigned long long)(files.num_reads),
+        files.num_bytes / 1048576.0, (unsigned long long)(files.num_hits));
+    if(ahead)
+    {
+        auto st = ahead->get_statistics();
+        printf("    read ahead: %llu hits, %llu misses, %llu files read ahead, %llu evicted unused, %llu dropped\n",
+            (unsigned long long)(st.hits), (unsigned long long)(st.misses), (unsigned long long)(st.loaded),
+            (unsigned long long)(st.evicted), (unsigned long long)(st.dropped));
+    }
+    return 0;
+}